@@ -0,0 +1,108 @@
+// DeadEnds
+//
+// deadendsc.c is the client of the DeadEnds daemon. It sends one request made from its arguments
+// and writes the reply to standard output. Relative script paths are made absolute since the
+// daemon runs in another directory.
+//
+// usage: deadendsc [-S socket] command [argument...]
+//   e.g. deadendsc search modified.ged "john /smith/" 10
+//        deadendsc script modified.ged myscript.ll
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <limits.h>
+#include "deadendsd.h"
+
+#define READBUFFERSIZE 65536
+
+static void usage(void);
+
+// main is the main program of the DeadEnds client. The exit status is 0 if the daemon replied OK,
+// 1 if it replied with an error, and 2 if it could not be reached.
+int main(int argc, char* argv[]) {
+	String socketPath = getenv("DE_SOCKET");
+	if (!socketPath) socketPath = DEFAULTSOCKET;
+	int ch;
+	while ((ch = getopt(argc, argv, "S:")) != -1) {
+		if (ch != 'S') {
+			usage();
+			exit(2);
+		}
+		socketPath = optarg;
+	}
+	if (optind >= argc) {
+		usage();
+		exit(2);
+	}
+
+	// Build the request line.
+	char request[MAXREQUEST];
+	char absolute[PATH_MAX];
+	int length = 0;
+	for (int i = optind; i < argc; i++) {
+		String field = argv[i];
+		if (i == optind + 2 && eqstr(argv[optind], "script") && realpath(field, absolute))
+			field = absolute;
+		length += snprintf(request + length, MAXREQUEST - length, "%s%s", i > optind ? "\t" : "",
+						   field);
+		if (length >= MAXREQUEST - 1) {
+			fprintf(stderr, "deadendsc: request is too long.\n");
+			exit(2);
+		}
+	}
+	request[length++] = '\n';
+
+	// Connect, send the request and copy the reply.
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr*) &address, sizeof(address)) < 0) {
+		fprintf(stderr, "deadendsc: could not connect to %s.\n", socketPath);
+		exit(2);
+	}
+	if (write(fd, request, length) != length) {
+		fprintf(stderr, "deadendsc: could not send the request.\n");
+		exit(2);
+	}
+	static char buffer[READBUFFERSIZE];
+	char status[MAXREQUEST]; // First line of the reply.
+	int statusLength = 0;
+	bool inBody = false;
+	ssize_t count;
+	while ((count = read(fd, buffer, READBUFFERSIZE)) > 0) {
+		String p = buffer;
+		if (!inBody) {
+			String newline = memchr(buffer, '\n', count);
+			int take = newline ? (int) (newline - buffer) + 1 : (int) count;
+			if (statusLength + take < MAXREQUEST) memcpy(status + statusLength, buffer, take);
+			statusLength += take;
+			p += take;
+			count -= take;
+			inBody = newline != null;
+		}
+		if (count > 0) fwrite(p, 1, count, stdout);
+	}
+	close(fd);
+	fflush(stdout);
+	if (statusLength > 0 && statusLength < MAXREQUEST) status[statusLength - 1] = 0;
+	if (!inBody) {
+		fprintf(stderr, "deadendsc: no reply from the daemon.\n");
+		exit(2);
+	}
+	if (strncmp(status, "OK", 2) != 0) {
+		fprintf(stderr, "deadendsc: %s\n", strncmp(status, "ERROR ", 6) ? status : status + 6);
+		exit(1);
+	}
+	return 0;
+}
+
+// usage prints the deadendsc usage message.
+static void usage(void) {
+	fprintf(stderr, "usage: deadendsc [-S socket] command [argument...]\n");
+	fprintf(stderr, "commands: databases; record db key; search db query [limit];\n");
+	fprintf(stderr, "          ancestors db key [generations]; descendants db key [generations];\n");
+	fprintf(stderr, "          inbreeding db; script db file [write]\n");
+}
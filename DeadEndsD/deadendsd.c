@@ -0,0 +1,224 @@
+// DeadEnds
+//
+// deadendsd.c is the main program of the DeadEnds daemon. It loads Gedcom files into Databases
+// once and serves requests for them on a Unix domain socket, so programs that make many small
+// queries don't import the Gedcom files each time. The main thread accepts connections and puts
+// them on a queue; a pool of worker threads takes them off and handles one request each.
+//
+// usage: deadendsd [-S socket] [-t threads] gedcomfile...
+//
+// The socket defaults to DE_SOCKET or /tmp/deadendsd.socket. If DE_GEDCOM_PATH is defined it is
+// used to find the Gedcom files. SIGINT and SIGTERM stop the daemon after the running requests.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <signal.h>
+#include <sys/stat.h>
+#include "deadendsd.h"
+
+#define QUEUESIZE 64 // Accepted connections waiting for a worker.
+#define DEFAULTTHREADS 4
+
+// ConnectionQueue holds the sockets of accepted connections; a socket of -1 stops a worker.
+static struct {
+	int sockets[QUEUESIZE];
+	int first, count;
+	pthread_mutex_t lock;
+	pthread_cond_t notEmpty;
+	pthread_cond_t notFull;
+} queue = {{0}, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static volatile sig_atomic_t stopping = 0;
+
+static void usage(void);
+static void getArguments(int, char**, String*, int*, List*);
+static Served* loadDatabases(List*, int*);
+static int openSocket(String path);
+static void* worker(void*);
+static void stopHandler(int);
+
+// main is the main program of the DeadEnds daemon.
+int main(int argc, char* argv[]) {
+	String socketPath = getenv("DE_SOCKET");
+	if (!socketPath) socketPath = DEFAULTSOCKET;
+	int numThreads = DEFAULTTHREADS;
+	List* files = createList(null, null, null, false);
+	getArguments(argc, argv, &socketPath, &numThreads, files);
+	fprintf(stderr, "%s: deadendsd started.\n", getMsecondsStr());
+	int numServed = 0;
+	Served* served = loadDatabases(files, &numServed);
+	if (!served) exit(1);
+	setServedDatabases(served, numServed);
+	int listener = openSocket(socketPath);
+	if (listener < 0) exit(1);
+
+	// Workers are started with the stop signals blocked so only the main thread gets them.
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &action, null);
+	sigset_t signals, previous;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, &previous);
+	pthread_t* threads = (pthread_t*) stdalloc(numThreads*sizeof(pthread_t));
+	int numStarted = 0;
+	for (int i = 0; i < numThreads; i++)
+		if (pthread_create(threads + numStarted, null, worker, null) == 0) numStarted++;
+	if (numStarted == 0) {
+		fprintf(stderr, "deadendsd: could not start any workers.\n");
+		exit(1);
+	}
+	action.sa_handler = stopHandler; // No SA_RESTART, so accept returns when a signal comes.
+	sigaction(SIGINT, &action, null);
+	sigaction(SIGTERM, &action, null);
+	pthread_sigmask(SIG_SETMASK, &previous, null);
+	fprintf(stderr, "%s: serving %d databases on %s with %d workers.\n", getMsecondsStr(),
+			numServed, socketPath, numStarted);
+
+	// Accept connections until stopped.
+	while (!stopping) {
+		int client = accept(listener, null, null);
+		if (client < 0) continue;
+		pthread_mutex_lock(&queue.lock);
+		while (queue.count == QUEUESIZE) pthread_cond_wait(&queue.notFull, &queue.lock);
+		queue.sockets[(queue.first + queue.count++) % QUEUESIZE] = client;
+		pthread_cond_signal(&queue.notEmpty);
+		pthread_mutex_unlock(&queue.lock);
+	}
+	close(listener);
+	unlink(socketPath);
+	pthread_mutex_lock(&queue.lock); // Stop the workers after the queued requests.
+	for (int i = 0; i < numStarted; i++) {
+		while (queue.count == QUEUESIZE) pthread_cond_wait(&queue.notFull, &queue.lock);
+		queue.sockets[(queue.first + queue.count++) % QUEUESIZE] = -1;
+	}
+	pthread_cond_broadcast(&queue.notEmpty);
+	pthread_mutex_unlock(&queue.lock);
+	for (int i = 0; i < numStarted; i++) pthread_join(threads[i], null);
+	stdfree(threads);
+	fprintf(stderr, "%s: deadendsd stopped.\n", getMsecondsStr());
+	return 0;
+}
+
+// stopHandler handles SIGINT and SIGTERM.
+static void stopHandler(int signal) {
+	stopping = 1;
+}
+
+// worker handles requests from the connection queue until it takes a -1.
+static void* worker(void* unused) {
+	while (true) {
+		pthread_mutex_lock(&queue.lock);
+		while (queue.count == 0) pthread_cond_wait(&queue.notEmpty, &queue.lock);
+		int client = queue.sockets[queue.first];
+		queue.first = (queue.first + 1) % QUEUESIZE;
+		queue.count--;
+		pthread_cond_signal(&queue.notFull);
+		pthread_mutex_unlock(&queue.lock);
+		if (client < 0) return null;
+		handleRequest(client);
+		close(client);
+	}
+}
+
+// loadDatabases imports the Gedcom files in parallel and returns the array of Served Databases.
+// Returns null if any file has errors.
+static Served* loadDatabases(List* files, int* count) {
+	ErrorLog* errorLog = createErrorLog();
+	List* databases = getDatabasesFromFilesWithThreads(files, 0, 0, errorLog);
+	if (lengthList(errorLog)) {
+		showErrorLog(errorLog);
+		return null;
+	}
+	*count = lengthList(databases);
+	Served* served = (Served*) stdalloc(*count*sizeof(Served));
+	for (int i = 0; i < *count; i++) {
+		Database* database = (Database*) getListElement(databases, i);
+		prepareDatabaseForReaders(database);
+		served[i].path = strsave(database->filePath);
+		served[i].name = strsave(database->name);
+		served[i].database = database;
+		served[i].kinship = createKinship(database->lineageGraph);
+		pthread_rwlock_init(&served[i].lock, null);
+		pthread_mutex_init(&served[i].writeLock, null);
+		pthread_mutex_init(&served[i].kinshipLock, null);
+		fprintf(stderr, "%s: loaded %s: %d persons.\n", getMsecondsStr(), database->name,
+				numberPersons(database));
+	}
+	deleteErrorLog(errorLog); // MNOTE: databases is not deleted; it would delete the Databases.
+	return served;
+}
+
+// openSocket creates the listening socket. A socket file left by a daemon that is no longer
+// running is removed; if another daemon answers on it -1 is returned.
+static int openSocket(String path) {
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		fprintf(stderr, "deadendsd: socket path %s is too long.\n", path);
+		return -1;
+	}
+	strcpy(address.sun_path, path);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) return -1;
+	if (connect(fd, (struct sockaddr*) &address, sizeof(address)) == 0) {
+		fprintf(stderr, "deadendsd: another daemon is serving %s.\n", path);
+		close(fd);
+		return -1;
+	}
+	close(fd);
+	unlink(path);
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	mode_t mask = umask(077); // Only this user may connect.
+	int rc = bind(fd, (struct sockaddr*) &address, sizeof(address));
+	umask(mask);
+	if (rc < 0 || listen(fd, QUEUESIZE) < 0) {
+		fprintf(stderr, "deadendsd: could not listen on %s.\n", path);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// getArguments gets the socket path, number of workers and Gedcom files from the command line.
+static void getArguments(int argc, char* argv[], String* socketPath, int* numThreads, List* files) {
+	int ch;
+	while ((ch = getopt(argc, argv, "S:t:")) != -1) {
+		switch(ch) {
+		case 'S':
+			*socketPath = strsave(optarg);
+			break;
+		case 't':
+			*numThreads = atoi(optarg);
+			if (*numThreads < 1) *numThreads = 1;
+			break;
+		case '?':
+		default:
+			usage();
+			exit(1);
+		}
+	}
+	if (optind >= argc) {
+		usage();
+		exit(1);
+	}
+	String gedcomPath = getenv("DE_GEDCOM_PATH");
+	if (!gedcomPath) gedcomPath = ".";
+	for (int i = optind; i < argc; i++) {
+		String file = resolveFile(argv[i], gedcomPath);
+		if (!file) {
+			fprintf(stderr, "deadendsd: could not find %s.\n", argv[i]);
+			exit(1);
+		}
+		appendToList(files, file);
+	}
+}
+
+// usage prints the deadendsd usage message.
+static void usage(void) {
+	fprintf(stderr, "usage: deadendsd [-S socket] [-t threads] gedcomfile...\n");
+}
@@ -0,0 +1,65 @@
+// DeadEnds
+//
+// deadendsd.h is the header file for the DeadEnds daemon and its client.
+//
+// The daemon loads Databases once and answers requests on a Unix domain socket. A request is one
+// line of tab separated fields, the command first; the reply starts with an "OK" or "ERROR
+// message" line, and the connection is closed when the reply is done.
+//
+//   databases                             list the Databases served
+//   record<TAB>db<TAB>key                 the record with a key, as Gedcom
+//   search<TAB>db<TAB>query[<TAB>limit]   persons whose names match a query
+//   ancestors<TAB>db<TAB>key[<TAB>gens]   ancestors of a person and their generations
+//   descendants<TAB>db<TAB>key[<TAB>gens] descendants of a person and their generations
+//   inbreeding<TAB>db                     inbreeding coefficient of every person
+//   script<TAB>db<TAB>path[<TAB>write]    run a script; its output is streamed back
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef deadendsd_h
+#define deadendsd_h
+
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "standard.h"
+#include "database.h"
+#include "import.h"
+#include "kinship.h"
+#include "errors.h"
+#include "path.h"
+#include "utils.h"
+
+#define DEFAULTSOCKET "/tmp/deadendsd.socket"
+#define MAXREQUEST 4096 // Longest request line.
+#define MAXFIELDS 8 // Most fields in a request.
+
+// Served is a Database served by the daemon. Requests that read hold lock for reading. A script
+// that edits runs with writeLock held and the edited Database is then reloaded and swapped in
+// with lock held for writing, so readers are only blocked for the swap. The Kinship of the
+// Database is kept between requests so what it has found is reused; it is swapped with the
+// Database.
+typedef struct Served {
+	String path; // Gedcom file.
+	String name; // Name clients use; the last segment of path.
+	Database* database;
+	Kinship* kinship;
+	pthread_rwlock_t lock;
+	pthread_mutex_t writeLock; // Serializes scripts that edit.
+	pthread_mutex_t kinshipLock; // Serializes requests that use kinship, which they change.
+} Served;
+
+// Request is a parsed request line.
+typedef struct Request {
+	String fields[MAXFIELDS];
+	int numFields;
+} Request;
+
+// Interface to the daemon's requests.
+void setServedDatabases(Served*, int count);
+void handleRequest(int socket);
+bool parseRequest(String line, Request*);
+
+#endif // deadendsd_h
@@ -0,0 +1,347 @@
+// DeadEnds
+//
+// requests.c handles the requests made to the DeadEnds daemon. Requests that read run in the
+// worker thread that accepted them. A script runs in a child process forked from the daemon, so
+// it sees the Database as it was at the fork, its output goes straight to the client socket, and
+// the interpreter's global state is never shared between threads. A script that edits commits
+// its edits to the journal; the daemon then reloads the Database and swaps it in.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "deadendsd.h"
+#include "gedcom.h"
+#include "writenode.h"
+#include "sequence.h"
+#include "kinship.h"
+#include "interp.h"
+#include "parse.h"
+#include "pnode.h"
+
+// forkLock is held for reading while a worker uses the library and for writing while a worker
+// forks, so no lock in the library (the tag table, heap accounting) is held by another thread
+// when a child is created.
+static pthread_rwlock_t forkLock = PTHREAD_RWLOCK_INITIALIZER;
+static Served* served = null;
+static int numServed = 0;
+
+// RequestHandler handles a request to a Served Database; the Database is locked for reading. The
+// reply is written to a memory buffer and sent to the client after the locks are released, so a
+// slow client never holds up forks and reloads.
+typedef void (*RequestHandler)(Served*, Request*, FILE*);
+
+// setServedDatabases sets the Databases the daemon serves.
+void setServedDatabases(Served* array, int count) {
+	served = array;
+	numServed = count;
+}
+
+// replyError writes an error reply.
+static void replyError(FILE* out, String message, String argument) {
+	fprintf(out, "ERROR %s%s%s\n", message, argument ? ": " : "", argument ? argument : "");
+}
+
+// findServed returns the Served Database with a name, or null.
+static Served* findServed(String name) {
+	for (int i = 0; i < numServed; i++)
+		if (eqstr(served[i].name, name)) return served + i;
+	return null;
+}
+
+// fullKey returns a record key with its @'s, adding them to buffer if the client left them off.
+static String fullKey(String key, String buffer, int length) {
+	if (*key == '@') return key;
+	snprintf(buffer, length, "@%s@", key);
+	return buffer;
+}
+
+// sendRecord sends the record with a key as Gedcom.
+static void sendRecord(Served* served, Request* request, FILE* out) {
+	char buffer[MAXREQUEST + 2];
+	String key = fullKey(request->fields[2], buffer, sizeof(buffer));
+	GNode* root = getRecord(key, served->database->recordIndex);
+	if (!root) {
+		replyError(out, "no record with key", key);
+		return;
+	}
+	fprintf(out, "OK\n");
+	writeGNodeRecord(out, root, false);
+}
+
+// sendPersonLine sends the key and name of a person.
+static void sendPersonLine(FILE* out, GNode* person, String name) {
+	if (!name) {
+		GNode* node = NAME(person);
+		name = node ? node->value : null;
+	}
+	fprintf(out, "%s\t%s\n", person->key, name ? name : "");
+}
+
+// sendSearch sends the persons whose names match a query, best first.
+static void sendSearch(Served* served, Request* request, FILE* out) {
+	Database* database = served->database;
+	int limit = request->numFields > 3 ? atoi(request->fields[3]) : 0;
+	List* results = searchNameSearchIndex(database->nameSearchIndex, request->fields[2], limit);
+	fprintf(out, "OK\n");
+	FORLIST(results, element)
+		NameSearchResult* result = (NameSearchResult*) element;
+		GNode* person = keyToPerson(result->recordKey, database->recordIndex);
+		if (person) sendPersonLine(out, person, null);
+	ENDLIST
+	deleteList(results);
+}
+
+// sendRelatives sends the ancestors or descendants of a person, nearest generations first, each
+// with its generation number. An optional field limits the number of generations.
+static void sendRelatives(Served* served, Request* request, FILE* out, bool ancestors) {
+	Database* database = served->database;
+	char buffer[MAXREQUEST + 2];
+	GNode* person = keyToPerson(fullKey(request->fields[2], buffer, sizeof(buffer)),
+								database->recordIndex);
+	if (!person) {
+		replyError(out, "no person with key", request->fields[2]);
+		return;
+	}
+	int limit = request->numFields > 3 ? atoi(request->fields[3]) : 0;
+	LineageGraph* graph = database->lineageGraph; // Built by prepareDatabaseForReaders.
+	int start = lineageId(graph, person->key);
+	Closure* closure = ancestors ? ancestorClosure(graph, &start, 1, false, limit) :
+		descendentClosure(graph, &start, 1, false, limit);
+	fprintf(out, "OK\n");
+	int i = 0;
+	for (int generation = 1; generation < closure->numGenerations; generation++) {
+		for (int j = 0; j < closure->counts[generation]; j++, i++) {
+			GNode* relative = graph->persons[closure->ids[i]];
+			GNode* name = NAME(relative);
+			fprintf(out, "%s\t%s\t%d\n", relative->key, name ? name->value : "", generation);
+		}
+	}
+	deleteClosure(closure);
+}
+
+// sendAncestors sends the ancestors of a person.
+static void sendAncestors(Served* served, Request* request, FILE* out) {
+	sendRelatives(served, request, out, true);
+}
+
+// sendDescendants sends the descendants of a person.
+static void sendDescendants(Served* served, Request* request, FILE* out) {
+	sendRelatives(served, request, out, false);
+}
+
+// sendInbreeding sends the inbreeding coefficient of every person, one person per line.
+static void sendInbreeding(Served* served, Request* request, FILE* out) {
+	pthread_mutex_lock(&served->kinshipLock);
+	fprintf(out, "OK\n");
+	writeInbreedingColumn(served->kinship, out);
+	pthread_mutex_unlock(&served->kinshipLock);
+}
+
+// sendDatabases sends the name, number of persons and families, and path of each Database.
+static void sendDatabases(FILE* out) {
+	fprintf(out, "OK\n");
+	for (int i = 0; i < numServed; i++) {
+		pthread_rwlock_rdlock(&served[i].lock);
+		Database* database = served[i].database;
+		int numPersons = numberPersons(database), numFamilies = numberFamilies(database);
+		pthread_rwlock_unlock(&served[i].lock);
+		fprintf(out, "%s\t%d\t%d\t%s\n", served[i].name, numPersons, numFamilies, served[i].path);
+	}
+}
+
+// journalSize returns the size of a journal file, or -1 if there is none.
+static long journalSize(String path) {
+	struct stat info;
+	return stat(path, &info) == 0 ? (long) info.st_size : -1;
+}
+
+// runScriptInChild parses and runs a script in the child process, with standard output and error
+// sent to the client. If the script may edit its edits are committed to the journal. Does not
+// return; the exit status is 0 if the script parsed and its edits were saved.
+extern String curFileName;
+extern int curLine;
+static void runScriptInChild(Database* database, String path, bool edits, int socket) {
+	dup2(socket, STDOUT_FILENO);
+	dup2(socket, STDERR_FILENO);
+	int maxfd = (int) sysconf(_SC_OPEN_MAX); // Don't hold other clients' connections open.
+	for (int fd = STDERR_FILENO + 1; fd < maxfd && fd < 4096; fd++) close(fd);
+	String scriptPath = getenv("DE_SCRIPTS_PATH");
+	parseProgram(path, scriptPath ? scriptPath : ".");
+	if (Perrors) {
+		fflush(stdout);
+		_exit(1);
+	}
+	curFileName = "internal";
+	curLine = 1;
+	PNode* pnode = procCallPNode("main", null);
+	Context* context = createContext(createSymbolTable(), database);
+	interpret(pnode, context, null);
+	int status = 0;
+	if (edits && database->dirty) {
+		if (!commitJournal(database)) {
+			printf("Could not commit edits to %s.\n", database->journal->path);
+			status = 1;
+		}
+		finishCompaction(database, true);
+	}
+	fflush(stdout);
+	fflush(stderr);
+	_exit(status);
+}
+
+// reloadServed reloads a Database after a script committed edits to its journal and swaps it in.
+static void reloadServed(Served* served) {
+	char msecs[MSECONDSLEN];
+	ErrorLog* errorLog = createErrorLog();
+	pthread_rwlock_rdlock(&forkLock);
+	Database* database = getDatabaseFromFile(served->path, 0, errorLog);
+	if (database) prepareDatabaseForReaders(database);
+	Kinship* kinship = database ? createKinship(database->lineageGraph) : null;
+	pthread_rwlock_unlock(&forkLock);
+	if (!database) {
+		fprintf(stderr, "%s: could not reload %s.\n", getMsecondsStrInBuffer(msecs), served->path);
+		showErrorLog(errorLog);
+		deleteErrorLog(errorLog);
+		return;
+	}
+	pthread_rwlock_wrlock(&served->lock);
+	Database* old = served->database;
+	Kinship* oldKinship = served->kinship;
+	served->database = database;
+	served->kinship = kinship;
+	pthread_rwlock_unlock(&served->lock);
+	pthread_rwlock_rdlock(&forkLock);
+	deleteKinship(oldKinship);
+	deleteDatabase(old);
+	pthread_rwlock_unlock(&forkLock);
+	deleteErrorLog(errorLog);
+	fprintf(stderr, "%s: reloaded %s.\n", getMsecondsStrInBuffer(msecs), served->path);
+}
+
+// runScript runs a script on a Served Database in a child process. Scripts that edit hold the
+// Database's writeLock until the edited Database is swapped in.
+static void runScript(Served* served, Request* request, FILE* out, int socket) {
+	bool edits = request->numFields > 3 && eqstr(request->fields[3], "write");
+	if (edits) pthread_mutex_lock(&served->writeLock);
+	fprintf(out, "OK\n");
+	fflush(out);
+	pthread_rwlock_wrlock(&forkLock);
+	pthread_rwlock_rdlock(&served->lock);
+	Database* database = served->database;
+	long before = journalSize(database->journal->path);
+	String journalPath = strsave(database->journal->path);
+	fflush(stdout); // So the child doesn't send the daemon's buffered output.
+	fflush(stderr);
+	pid_t pid = fork();
+	pthread_rwlock_unlock(&served->lock);
+	pthread_rwlock_unlock(&forkLock);
+	if (pid == 0) runScriptInChild(database, request->fields[2], edits, socket);
+	int status = 0;
+	if (pid < 0) fprintf(out, "Could not start the script.\n");
+	else waitpid(pid, &status, 0);
+	if (pid > 0 && WIFSIGNALED(status))
+		fprintf(stderr, "script %s was killed by signal %d.\n", request->fields[2], WTERMSIG(status));
+	if (edits) {
+		if (pid > 0 && WIFEXITED(status) && journalSize(journalPath) != before) reloadServed(served);
+		pthread_mutex_unlock(&served->writeLock);
+	}
+	stdfree(journalPath);
+}
+
+// parseRequest splits a request line into its tab separated fields.
+bool parseRequest(String line, Request* request) {
+	String end = line + strlen(line);
+	while (end > line && (end[-1] == '\n' || end[-1] == '\r')) *--end = 0;
+	request->numFields = 0;
+	String field = line;
+	while (request->numFields < MAXFIELDS) {
+		request->fields[request->numFields++] = field;
+		String tab = strchr(field, '\t');
+		if (!tab) break;
+		*tab = 0;
+		field = tab + 1;
+	}
+	return request->numFields > 0 && *request->fields[0];
+}
+
+// readRequest reads a request line from a socket; returns false if there isn't a whole line.
+static bool readRequest(int socket, String line) {
+	int length = 0;
+	while (length < MAXREQUEST - 1) {
+		ssize_t count = read(socket, line + length, MAXREQUEST - 1 - length);
+		if (count <= 0) return false;
+		line[length + count] = 0;
+		if (strchr(line + length, '\n')) return true;
+		length += (int) count;
+	}
+	return false;
+}
+
+// Commands is the table of commands that read a Served Database.
+static struct {
+	String name;
+	int numFields; // Fewest fields, including the command and Database name.
+	RequestHandler handler;
+} commands[] = {
+	{"record", 3, sendRecord},
+	{"search", 3, sendSearch},
+	{"ancestors", 3, sendAncestors},
+	{"descendants", 3, sendDescendants},
+	{"inbreeding", 2, sendInbreeding},
+};
+
+// handleRequest reads a request from a client socket and replies to it.
+void handleRequest(int socket) {
+	char line[MAXREQUEST];
+	Request request;
+	FILE* out = fdopen(dup(socket), "w");
+	if (!out) return;
+	if (!readRequest(socket, line) || !parseRequest(line, &request)) {
+		replyError(out, "bad request", null);
+		fclose(out);
+		return;
+	}
+	String command = request.fields[0];
+	if (eqstr(command, "databases")) {
+		sendDatabases(out);
+		fclose(out);
+		return;
+	}
+	Served* served = request.numFields > 1 ? findServed(request.fields[1]) : null;
+	if (!served) {
+		replyError(out, "no database", request.numFields > 1 ? request.fields[1] : null);
+		fclose(out);
+		return;
+	}
+	if (eqstr(command, "script") && request.numFields > 2) {
+		runScript(served, &request, out, socket);
+		fclose(out);
+		return;
+	}
+	for (int i = 0; i < ARRAYSIZE(commands); i++) {
+		if (!eqstr(command, commands[i].name)) continue;
+		if (request.numFields < commands[i].numFields) break;
+		String reply = null;
+		size_t length = 0;
+		FILE* buffer = open_memstream(&reply, &length);
+		if (!buffer) {
+			replyError(out, "out of memory", null);
+			fclose(out);
+			return;
+		}
+		pthread_rwlock_rdlock(&forkLock);
+		pthread_rwlock_rdlock(&served->lock);
+		commands[i].handler(served, &request, buffer);
+		fclose(buffer);
+		pthread_rwlock_unlock(&served->lock);
+		pthread_rwlock_unlock(&forkLock);
+		fwrite(reply, 1, length, out);
+		free(reply); // Allocated by open_memstream.
+		fclose(out);
+		return;
+	}
+	replyError(out, "bad command", command);
+	fclose(out);
+}
@@ -0,0 +1,31 @@
+// DeadEnds
+//
+// unionfind.h is the header file for the UnionFind data type, a disjoint set forest over the
+// integers 0 to count - 1, used to find connected components.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef unionfind_h
+#define unionfind_h
+
+#include <stdatomic.h>
+#include "standard.h"
+
+// UnionFind is a disjoint set forest; each element points to its parent and roots to themselves.
+typedef struct UnionFind {
+	atomic_int* parent;
+	unsigned char* rank; // Bound on the height of each root's tree; used by uniteUnionFind.
+	int count;
+} UnionFind;
+
+// Interface to UnionFind.
+UnionFind* createUnionFind(int count);
+void deleteUnionFind(UnionFind*);
+int findUnionFind(UnionFind*, int);
+bool uniteUnionFind(UnionFind*, int, int);
+bool uniteUnionFindConcurrent(UnionFind*, int, int);
+void uniteEdges(UnionFind*, int* edges, int numEdges, bool parallel);
+int labelComponents(UnionFind*, int* labels);
+
+#endif // unionfind_h
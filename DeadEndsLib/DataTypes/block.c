@@ -3,7 +3,7 @@
 // block.c holds the functions that implement the Block data type.
 //
 // Created by Thomas Wetmore on 9 March 2024
-// Last changed on 12 December 2024.
+// Last changed on 18 October 2026.
 
 #include "block.h"
 #include "sort.h"
@@ -12,7 +12,7 @@ static bool blockDebugging = false;
 
 // createBlock creates an empty Block.
 Block* createBlock(void) {
-	Block* block = (Block*) malloc(sizeof(Block));
+	Block* block = (Block*) stdalloc(sizeof(Block));
 	initBlock(block);
 	return block;
 }
@@ -21,7 +21,7 @@ Block* createBlock(void) {
 void initBlock(Block* block) {
 	block->length = 0;
 	block->maxLength = INITIAL_SIZE_LIST_DATA_BLOCK;
-	block->elements = (void*) malloc(INITIAL_SIZE_LIST_DATA_BLOCK*sizeof(void*));
+	block->elements = (void*) stdalloc(INITIAL_SIZE_LIST_DATA_BLOCK*sizeof(void*));
 }
 
 // deleteBlock deallocates the elements of a Block, but not the Block itself. If the Block has
@@ -32,15 +32,15 @@ void deleteBlock(Block *block, void(*delete)(void*)) {
 			delete((block->elements)[i]);
 		}
 	}
-	free(block->elements);
+	stdfree(block->elements);
 }
 
 // growBlock increases the size of a block when it reaches its current maximum.
 static void growBlock(Block *block) {
 	int newLength = block->maxLength = (3*block->maxLength)/2;
-	void *newElements = malloc(newLength*sizeof(void*));
+	void *newElements = stdalloc(newLength*sizeof(void*));
 	memcpy(newElements, block->elements, (block->length)*sizeof(void*));
-	free(block->elements);
+	stdfree(block->elements);
 	block->elements = newElements;
 }
 
@@ -4,7 +4,7 @@
 // customiziing the compare, delete and getKey functions.
 //
 // Created by Thomas Wetmore on 29 November 2022.
-// Last changed on 5 December 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "hashtable.h"
@@ -19,25 +19,20 @@ static void* searchBucket(Bucket*, String key, String(*g)(void*), int(*c)(String
 // an element, and delete is an optional function that frees an element.
 HashTable* createHashTable(String(*getKey)(void*), int(*compare)(String, String),
 						   void(*delete)(void*), int numBuckets) {
-	HashTable *table = (HashTable*) malloc(sizeof(HashTable));
+	HashTable *table = (HashTable*) stdalloc(sizeof(HashTable));
 	table->compare = compare;
 	table->delete = delete;
 	table->getKey = getKey;
 	table->numBuckets = numBuckets;
-	table->buckets = (Bucket**) malloc(numBuckets*sizeof(Bucket));
+	table->buckets = (Bucket**) stdalloc(numBuckets*sizeof(Bucket*));
 	for (int i = 0; i < table->numBuckets; i++) table->buckets[i] = null;
 	return table;
 }
 
 // deleteBucket deletes a Bucket. If there is a delete function it is called on the elements.
 static void deleteBucket(Bucket* bucket, void(*delete)(void*)) { //PH;
-	if (delete) {
-		Block* block = &(bucket->block);
-		for (int j = 0; j < block->length; j++) {
-			delete(block->elements[j]);
-		}
-	}
-	free(bucket);
+	deleteBlock(&(bucket->block), delete);
+	stdfree(bucket);
 }
 
 // deleteHashTable deletes a HashTable. If there is a delete function it is called on the elements.
@@ -47,12 +42,13 @@ void deleteHashTable(HashTable *table) { //PH;
 		if (table->buckets[i] == null) continue;
 		deleteBucket(table->buckets[i], table->delete);
 	}
-	free(table);
+	stdfree(table->buckets);
+	stdfree(table);
 }
 
 // createBucket creates and returns an empty Bucket.
 Bucket *createBucket(void) { //PH;
-	Bucket *bucket = (Bucket*) malloc(sizeof(Bucket));
+	Bucket *bucket = (Bucket*) stdalloc(sizeof(Bucket));
 	initBlock(&(bucket->block));
 	return bucket;
 }
@@ -5,7 +5,7 @@
 // of elements.
 //
 // Created by Thomas Wetmore on 21 November 2022.
-// Last changed on 12 April 2024.
+// Last changed on 18 October 2026.
 //
 
 #include "standard.h"
@@ -13,62 +13,64 @@
 
 static bool sortDebugging = false;
 
-//  Internal quick sort functions.
-static void quickSort(int, int);
-static int getPivot(int left, int right);
-static int partition(int left, int right, void *pivot);
+// SortState is the state of one call to sortElements. It is passed down the quick sort so that
+// sorts can run in several threads at once.
+typedef struct SortState {
+	void** elements; // Array being sorted.
+	String (*getKey)(void*);
+	int (*compare)(String, String);
+} SortState;
 
-// State variables used by the sort functions.
-static void** lelements;  // lelements is the array of elements.
-static String (*lgetKey)(void*); // static getKey function.
-static int (*lcompare)(String, String); // static compare function.
+//  Internal quick sort functions.
+static void quickSort(SortState*, int, int);
+static int getPivot(SortState*, int left, int right);
+static int partition(SortState*, int left, int right, void *pivot);
 
 // sortElements is the external interface for sorting an array of elements.
 void sortElements(void** elements, int length, String(*getKey)(void*), int(*compare)(String, String))
 {
-	lelements = elements;
-	lcompare = compare;
-	lgetKey = getKey;
-	quickSort(0, length - 1);
+	SortState state = {elements, getKey, compare};
+	quickSort(&state, 0, length - 1);
 }
 
-static int magicCompare(void* a, void* b) {
-	return lcompare(lgetKey(a), lgetKey(b));
+static int magicCompare(SortState* state, void* a, void* b) {
+	return state->compare(state->getKey(a), state->getKey(b));
 }
 #define LNULL -1
 // quickSort is the recursive function that sorts a partition.
-void quickSort(int left, int right) {
-	int pivotIndex = getPivot(left, right);
+static void quickSort(SortState* state, int left, int right) {
+	int pivotIndex = getPivot(state, left, right);
 	if (sortDebugging) printf("quickSort: left=%d, right=%d, pivot=%d\n", left, right, pivotIndex);
 	if (pivotIndex != LNULL) {
-		void *pivot = lelements[pivotIndex];
-		int midIndex = partition(left, right, pivot);
-		quickSort(left, midIndex-1);
-		quickSort(midIndex, right);
+		void *pivot = state->elements[pivotIndex];
+		int midIndex = partition(state, left, right, pivot);
+		quickSort(state, left, midIndex-1);
+		quickSort(state, midIndex, right);
 	}
 }
 
 // partition partitions around a pivot.
-static int partition(int left, int right, void* pivot) {
+static int partition(SortState* state, int left, int right, void* pivot) {
+	void** elements = state->elements;
 	int i = left, j = right;
 	do {
-		void* tmp = lelements[i];
-		lelements[i] = lelements[j];
-		lelements[j] = tmp;
-		while (magicCompare(lelements[i], pivot) < 0) i++;
-		while (magicCompare(lelements[j], pivot) >= 0) j--;
+		void* tmp = elements[i];
+		elements[i] = elements[j];
+		elements[j] = tmp;
+		while (magicCompare(state, elements[i], pivot) < 0) i++;
+		while (magicCompare(state, elements[j], pivot) >= 0) j--;
 	} while (i <= j);
 	return i;
 }
 
 // getPivot chooses the pivot element.
-static int getPivot(int left, int right) {
-	void* pivot = lelements[left];
+static int getPivot(SortState* state, int left, int right) {
+	void* pivot = state->elements[left];
 	int left0 = left, rel;
 	for (++left; left <= right; left++) {
-		void* next = lelements[left];
+		void* next = state->elements[left];
 
-		if ((rel = magicCompare(next, pivot)) > 0) return left;
+		if ((rel = magicCompare(state, next, pivot)) > 0) return left;
 		if (rel < 0) return left0;
 	}
 	return LNULL;  // Elements between left and right are equal.
@@ -0,0 +1,140 @@
+// DeadEnds
+//
+// unionfind.c implements the UnionFind data type. Single threaded unions link by rank and finds
+// compress paths, so a sequence of operations takes nearly linear time. Unions may also be made by
+// several threads at once without locks: a root is linked under another with a compare and swap
+// that fails if it has stopped being a root, and the larger root is always linked under the
+// smaller, so no cycle can form. Finds made then halve paths, also with compare and swap.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include "unionfind.h"
+#include "utils.h"
+
+#define PARALLELEDGES 65536 // Fewest edges united by several threads.
+#define MAXUNIONTHREADS 8
+
+// createUnionFind creates a UnionFind of count elements, each in its own set.
+UnionFind* createUnionFind(int count) {
+	UnionFind* unionFind = (UnionFind*) stdalloc(sizeof(UnionFind));
+	unionFind->count = count;
+	unionFind->parent = (atomic_int*) stdalloc((count + 1)*sizeof(atomic_int));
+	unionFind->rank = (unsigned char*) stdalloc(count + 1);
+	memset(unionFind->rank, 0, count + 1);
+	for (int i = 0; i < count; i++) atomic_init(unionFind->parent + i, i);
+	return unionFind;
+}
+
+// deleteUnionFind deletes a UnionFind.
+void deleteUnionFind(UnionFind* unionFind) {
+	stdfree(unionFind->parent);
+	stdfree(unionFind->rank);
+	stdfree(unionFind);
+}
+
+// parentOf returns the parent of an element.
+static int parentOf(UnionFind* unionFind, int element) {
+	return atomic_load_explicit(unionFind->parent + element, memory_order_relaxed);
+}
+
+// findUnionFind returns the root of an element's set and points the elements on the way to it.
+int findUnionFind(UnionFind* unionFind, int element) {
+	int root = element;
+	while (parentOf(unionFind, root) != root) root = parentOf(unionFind, root);
+	while (element != root) {
+		int next = parentOf(unionFind, element);
+		atomic_store_explicit(unionFind->parent + element, root, memory_order_relaxed);
+		element = next;
+	}
+	return root;
+}
+
+// uniteUnionFind unites the sets of two elements, linking the lower ranked root under the other.
+// Returns true if they were in different sets.
+bool uniteUnionFind(UnionFind* unionFind, int a, int b) {
+	a = findUnionFind(unionFind, a);
+	b = findUnionFind(unionFind, b);
+	if (a == b) return false;
+	if (unionFind->rank[a] < unionFind->rank[b]) {
+		int swap = a;
+		a = b;
+		b = swap;
+	}
+	atomic_store_explicit(unionFind->parent + b, a, memory_order_relaxed);
+	if (unionFind->rank[a] == unionFind->rank[b]) unionFind->rank[a]++;
+	return true;
+}
+
+// findConcurrent returns the root of an element's set while other threads may be uniting; each
+// element on the way is pointed to its grandparent.
+static int findConcurrent(UnionFind* unionFind, int element) {
+	while (true) {
+		int parent = atomic_load(unionFind->parent + element);
+		if (parent == element) return element;
+		int grandparent = atomic_load(unionFind->parent + parent);
+		if (grandparent != parent)
+			atomic_compare_exchange_weak(unionFind->parent + element, &parent, grandparent);
+		element = grandparent;
+	}
+}
+
+// uniteUnionFindConcurrent unites the sets of two elements while other threads may be uniting.
+// Returns true if this call joined the sets.
+bool uniteUnionFindConcurrent(UnionFind* unionFind, int a, int b) {
+	while (true) {
+		a = findConcurrent(unionFind, a);
+		b = findConcurrent(unionFind, b);
+		if (a == b) return false;
+		if (a > b) {
+			int swap = a;
+			a = b;
+			b = swap;
+		}
+		int expected = b; // Fails if b has been linked under another root since it was found.
+		if (atomic_compare_exchange_strong(unionFind->parent + b, &expected, a)) return true;
+	}
+}
+
+// EdgePart is part of an array of edges united by one thread.
+typedef struct EdgePart {
+	UnionFind* unionFind;
+	int* edges;
+	int first, last; // Edges first to last - 1.
+} EdgePart;
+
+// uniteEdgePart unites the elements of the edges in an EdgePart.
+static void* uniteEdgePart(void* arg) {
+	EdgePart* part = (EdgePart*) arg;
+	for (int i = part->first; i < part->last; i++)
+		uniteUnionFindConcurrent(part->unionFind, part->edges[2*i], part->edges[2*i + 1]);
+	return null;
+}
+
+// uniteEdges unites the elements of each edge, given as pairs of elements. If parallel is true
+// and there are many edges they are split among several threads.
+void uniteEdges(UnionFind* unionFind, int* edges, int numEdges, bool parallel) {
+	int numThreads = parallel && numEdges >= PARALLELEDGES ? threadCount(0, MAXUNIONTHREADS) : 1;
+	if (numThreads == 1) {
+		for (int i = 0; i < numEdges; i++) uniteUnionFind(unionFind, edges[2*i], edges[2*i + 1]);
+		return;
+	}
+	EdgePart parts[MAXUNIONTHREADS];
+	for (int i = 0; i < numThreads; i++)
+		parts[i] = (EdgePart) {unionFind, edges, (int) ((long) numEdges*i/numThreads),
+			(int) ((long) numEdges*(i + 1)/numThreads)};
+	runThreads(uniteEdgePart, parts, sizeof(EdgePart), numThreads);
+}
+
+// labelComponents numbers the sets of a UnionFind 0, 1, ..., in the order of their first elements,
+// and sets labels[i] to the number of the set of element i. Returns the number of sets.
+int labelComponents(UnionFind* unionFind, int* labels) {
+	int count = 0;
+	for (int i = 0; i < unionFind->count; i++) labels[i] = -1;
+	for (int i = 0; i < unionFind->count; i++) {
+		int root = findUnionFind(unionFind, i);
+		if (labels[root] < 0) labels[root] = count++;
+		labels[i] = labels[root];
+	}
+	return count;
+}
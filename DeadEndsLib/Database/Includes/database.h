@@ -3,7 +3,7 @@
 // database.h is the header file for the Database type.
 //
 // Created by Thomas Wetmore on 10 November 2022.
-// Last changed on 21 February 2025.
+// Last changed on 18 October 2026.
 
 #ifndef database_h
 #define database_h
@@ -13,13 +13,27 @@
 #include "recordindex.h"
 #include "nameindex.h"
 #include "refnindex.h"
+#include "namesearch.h"
+#include "dateindex.h"
+#include "placeindex.h"
+#include "pathindex.h"
+#include "textindex.h"
+#include "lineagegraph.h"
+#include "journal.h"
+#include "versions.h"
 #include "gnode.h"
+#include "gedcom.h"
 #include "errors.h"
 #include "rootlist.h"
 
 typedef HashTable RecordIndex; // Forward references.
 typedef HashTable NameIndex;
 typedef List RootList;
+typedef struct NameSearchIndex NameSearchIndex;
+typedef struct DateIndex DateIndex;
+typedef struct PlaceIndex PlaceIndex;
+typedef struct TextIndex TextIndex;
+typedef struct LineageGraph LineageGraph;
 
 // DBaseAction is a "Database action" that customizes Database processing.
 typedef void (*DBaseAction)(Database*, ErrorLog*);
@@ -29,10 +43,19 @@ typedef struct Database {
 	String filePath;  // Path to Gedcom file this Database was built from.
 	String name; // Use last segment of the path for the name of the Database.
 	GNode* header; // Root of header record.
-	bool dirty; // Dirty flag.
+	bool dirty; // Set when a record is edited; cleared when the edits are committed to the journal.
+	long generation; // Changes on every edit; never the same for two Databases.
 	RecordIndex* recordIndex; // Index of all keyed records.
 	NameIndex *nameIndex; // Index of the names of the persons in this database.
 	RefnIndex *refnIndex; // Index of the REFN values in this database.
+	NameSearchIndex *nameSearchIndex; // Prefix and trigram index of the name parts of persons.
+	DateIndex *dateIndex; // Index of the parsed dates of person and family events.
+	PlaceIndex *placeIndex; // Trie of the places of person and family events.
+	List *pathIndexes; // PathIndexes added to this database; kept current on edits.
+	TextIndex *textIndex; // Inverted index of free-text values; built when first searched.
+	LineageGraph *lineageGraph; // Parent and child links by person id; built when first used.
+	Journal *journal; // Change journal of the Gedcom file.
+	Versions *versions; // Copy-on-write state of records shared with readers.
 	RootList *personRoots; // List of all person roots in the database.
 	RootList *familyRoots; // List of all family roots in the database.
 } Database;
@@ -56,6 +79,17 @@ GNode *keyToOther(String key, RecordIndex*); // Get an other record from the dat
 GNode *getRecord(String key, RecordIndex*);  // Get an arbitraray record from the database.
 bool storeRecord(Database*, GNode*, int lineno, ErrorLog*); // Add a record to the database.
 void summarizeDatabase(Database*);
+void recordChanged(Database*, GNode*); // Update the Database after a record is edited.
+long lastDatabaseGeneration(void); // Changes when any Database is created or edited.
+TextIndex* getDatabaseTextIndex(Database*); // Get the TextIndex, building it if needed.
+LineageGraph* getDatabaseLineageGraph(Database*); // Get the LineageGraph, building it if needed.
+void prepareDatabaseForReaders(Database*); // Build the parts built on first use.
+
+// Family edits; the edited records are published as new versions (removeops.c, addtofamily.c).
+bool addChildToFamily(GNode* child, GNode* family, int index, Database*);
+bool addSpouseToFamily(GNode* spouse, GNode* family, SexType, Database*);
+bool removeChildFromFamily(GNode* child, GNode* family, Database*);
+bool removeSpouseFromFamily(GNode* spouse, GNode* family, Database*);
 
 String generateFamilyKey(Database*);
 String generatePersonKey(Database*);
@@ -0,0 +1,65 @@
+// DeadEnds
+//
+// dateindex.h is the header file for the DateIndex data type. A DateIndex holds the parsed
+// dates of the events in a Database, grouped by event tag (BIRT, DEAT, MARR, ...), so that
+// records can be found by date interval without reparsing date Strings.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef dateindex_h
+#define dateindex_h
+
+#include "standard.h"
+#include "block.h"
+#include "list.h"
+#include "hashtable.h"
+#include "gnode.h"
+#include "date.h"
+
+typedef HashTable RecordIndex; // Forward reference.
+
+// DateIndexEl is a parsed event date with its event and record. root is set to null when the
+// record is removed; removed elements are dropped when their EventDates is next built.
+typedef struct DateIndexEl {
+	PackedDate date; // Parsed value of the event's DATE node.
+	GNode* event; // Event node; MNOTE: not freed.
+	GNode* root; // Root of the record with the event; MNOTE: not freed.
+	struct EventDates* dates; // EventDates holding the element.
+} DateIndexEl;
+
+// EventDates holds the DateIndexEls of one event tag. The elements are sorted by first day and
+// form an implicit balanced tree: the root of the range [lo, hi) is at (lo + hi)/2, and maxDays
+// holds the last day of the latest element in the range rooted at each index.
+typedef struct EventDates {
+	String tag; // Event tag.
+	Block dates; // DateIndexEls.
+	int* maxDays;
+	bool isBuilt; // dates is sorted, has no removed elements, and maxDays is current.
+} EventDates;
+
+// RecordDates holds the DateIndexEls of one record, so a record can be removed without
+// searching the EventDates.
+typedef struct RecordDates {
+	String key; // Record key; MNOTE: not saved.
+	Block dates; // DateIndexEls; MNOTE: not freed.
+} RecordDates;
+
+// DateIndex maps event tags to their EventDates and record keys to their RecordDates.
+typedef struct DateIndex {
+	HashTable* tags;
+	HashTable* records;
+} DateIndex;
+
+// Interface to DateIndex.
+DateIndex* createDateIndex(void);
+void deleteDateIndex(DateIndex*);
+void addToDateIndex(DateIndex*, GNode* root, GNode* event, PackedDate*);
+void addRecordToDateIndex(DateIndex*, GNode* root);
+void removeRecordFromDateIndex(DateIndex*, GNode* root);
+DateIndex* getDateIndex(RecordIndex*);
+void buildDateIndex(DateIndex*);
+List* searchDateIndex(DateIndex*, String tag, int minDay, int maxDay, bool within);
+void showDateIndexStats(DateIndex*);
+
+#endif // dateindex_h
@@ -0,0 +1,34 @@
+// DeadEnds
+//
+// duplicates.h is the header file for finding persons in two Databases that are likely the same
+// person, the first step in merging Databases. Candidate pairs come from blocking keys, so only
+// persons with the same name key and sex, born in nearby decades, are compared.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef duplicates_h
+#define duplicates_h
+
+#include "standard.h"
+#include "list.h"
+#include "database.h"
+
+// DuplicateMatch is a candidate pair of persons and how well they match. The scores are between
+// 0 and 1; a component is negative if either person lacks the data to compare.
+typedef struct DuplicateMatch {
+	GNode* one; // Person in the first Database; MNOTE: not freed.
+	GNode* two; // Person in the second Database; MNOTE: not freed.
+	double score; // Weighted score of the components that could be compared.
+	double nameScore;
+	double dateScore; // Birth dates.
+	double placeScore; // Birth places.
+	double parentScore; // Names of the parents.
+} DuplicateMatch;
+
+// Interface to duplicate matching.
+List* findDuplicatePersons(Database* one, Database* two, double minScore, int numThreads);
+void scoreDuplicateMatch(DuplicateMatch*, Database* one, Database* two);
+void showDuplicateMatch(DuplicateMatch*);
+
+#endif // duplicates_h
@@ -4,7 +4,7 @@
 // TODO: The string functions aren't here yet.
 //
 // Created by Thomas Wetmore on 13 November 2022.
-// Last changed on 6 December 2024.
+// Last changed on 18 October 2026.
 
 #ifndef import_h
 #define import_h
@@ -18,6 +18,7 @@
 #include "integertable.h"
 
 List *getDatabasesFromFiles(List*, int vcodes, ErrorLog*);
+List* getDatabasesFromFilesWithThreads(List*, int vcodes, int numThreads, ErrorLog*);
 Database* getDatabaseFromFile(String, int vcodes, ErrorLog*);
 RecordIndex* getRecordIndexFromFile(String, RootList*, RootList*, IntegerTable*, ErrorLog*);
 void checkKeysAndReferences(GNodeList*, String name, IntegerTable*, ErrorLog*);
@@ -0,0 +1,45 @@
+// DeadEnds
+//
+// journal.h is the header file for the Journal data type. A Journal is an append-only file of
+// record level changes to a Database, kept next to its Gedcom file. Each commit appends one
+// transaction holding the new version of every record changed since the last commit and is
+// synced to disk, so saving an edit costs the size of the records edited. On startup committed
+// transactions are replayed over the records read from the Gedcom file. Compaction rewrites the
+// Gedcom file and empties the Journal.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef journal_h
+#define journal_h
+
+#include <sys/types.h>
+#include "standard.h"
+#include "stringset.h"
+#include "errors.h"
+
+typedef struct Database Database; // Forward reference.
+
+// Journal is the change journal of a Database.
+typedef struct Journal {
+	String path; // Path of the journal file; the Gedcom path with ".journal" added.
+	String gedcomPath; // Path of the Gedcom file the journal applies to.
+	FILE* file; // Journal file open for appending; null until the first commit.
+	StringSet* pending; // Keys of the records changed since the last commit.
+	int sequence; // Number of the last transaction.
+	long size; // Size of the journal file.
+	long compactSize; // Size at which a background compaction is started.
+	long compactOffset; // Size of the journal file when the running compaction started.
+	pid_t compactor; // Process writing the compacted Gedcom file, or 0.
+} Journal;
+
+// Interface to Journal.
+Journal* createJournal(String gedcomPath);
+void deleteJournal(Journal*);
+void journalRecord(Journal*, String key);
+int replayJournal(Database*, ErrorLog*);
+bool commitJournal(Database*);
+bool compactJournal(Database*, bool background);
+bool finishCompaction(Database*, bool wait);
+
+#endif // journal_h
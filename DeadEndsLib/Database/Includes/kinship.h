@@ -0,0 +1,45 @@
+// DeadEnds
+//
+// kinship.h is the header file for the kinship calculator, which finds the kinship coefficients
+// of pairs of persons and the inbreeding coefficients of persons in a LineageGraph.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef kinship_h
+#define kinship_h
+
+#include <stdint.h>
+#include "standard.h"
+#include "lineagegraph.h"
+
+#define MAXKINSHIPCACHE (1 << 20) // Most pairs kept between queries.
+
+// KinshipCache holds the kinship coefficients of pairs of persons in an open addressed table.
+typedef struct KinshipCache {
+	uint64_t* keys; // Pair of ids, the smaller in the high half; 0 if the slot is empty.
+	double* values;
+	int capacity; // A power of 2.
+	int count;
+} KinshipCache;
+
+// Kinship holds the topological order of the persons in a LineageGraph and the kinship
+// coefficients found so far.
+typedef struct Kinship {
+	LineageGraph* graph;
+	int* rank; // Position of each person in the order; -1 if on or below a parent cycle.
+	int* ordered; // Persons in order, parents before their children.
+	int numOrdered;
+	KinshipCache cache;
+	double* inbreeding; // Inbreeding coefficients of all persons by id; null until written.
+} Kinship;
+
+// Interface to the kinship calculator.
+Kinship* createKinship(LineageGraph*);
+void deleteKinship(Kinship*);
+double kinshipCoefficient(Kinship*, int a, int b);
+double inbreedingCoefficient(Kinship*, int id);
+double* allInbreedingCoefficients(Kinship*);
+void writeInbreedingColumn(Kinship*, FILE*);
+
+#endif // kinship_h
@@ -0,0 +1,36 @@
+// DeadEnds
+//
+// lineagecounts.h is the header file for counting the distinct ancestors and descendents of every
+// person in a LineageGraph.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef lineagecounts_h
+#define lineagecounts_h
+
+#include "standard.h"
+#include "lineagegraph.h"
+
+#define EXACTCOUNTBUDGET (256 << 20) // Most bytes of bit sets for exact counts in lineageAuto mode.
+
+// LineageCountMode is how counts are found: exactly with bit sets, estimated with HyperLogLog
+// sketches, or exactly if the bit sets fit in EXACTCOUNTBUDGET and estimated otherwise.
+typedef enum LineageCountMode {
+	lineageExact, lineageEstimate, lineageAuto
+} LineageCountMode;
+
+// LineageCounts are the numbers of distinct ancestors and descendents of the persons in a
+// LineageGraph, by id.
+typedef struct LineageCounts {
+	int numPersons;
+	int* ancestors;
+	int* descendents;
+	bool estimated; // True if the counts are HyperLogLog estimates.
+} LineageCounts;
+
+// Interface to LineageCounts.
+LineageCounts* getLineageCounts(LineageGraph*, LineageCountMode);
+void deleteLineageCounts(LineageCounts*);
+
+#endif // lineagecounts_h
@@ -0,0 +1,27 @@
+// DeadEnds
+//
+// lineagecycles.h is the header file for finding persons who are their own ancestors.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef lineagecycles_h
+#define lineagecycles_h
+
+#include "standard.h"
+#include "lineagegraph.h"
+#include "integertable.h"
+#include "errors.h"
+
+// AncestryCycle is a shortest cycle of parent links: each person is a child of the next one, and
+// the last is a child of the first.
+typedef struct AncestryCycle {
+	int* persons;
+	int length;
+} AncestryCycle;
+
+// Interface to ancestry cycles.
+List* findAncestryCycles(LineageGraph*);
+int checkAncestryCycles(LineageGraph*, String name, IntegerTable* keymap, ErrorLog*);
+
+#endif // lineagecycles_h
@@ -0,0 +1,71 @@
+// DeadEnds
+//
+// lineagegraph.h is the header file for the LineageGraph data type. A LineageGraph gives each
+// person in a Database an integer id and holds the parent and child links between them as id
+// arrays, so ancestor and descendent closures can be found without looking up keys.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef lineagegraph_h
+#define lineagegraph_h
+
+#include "standard.h"
+#include "hashtable.h"
+#include "gnode.h"
+
+typedef HashTable RecordIndex; // Forward reference.
+
+// LineageId maps a person key to its id.
+typedef struct LineageId {
+	String key;
+	int id;
+} LineageId;
+
+// LineageOrder is the persons of a LineageGraph by generation. A person's generation is one more
+// than the highest generation of its parents, so passes over the persons can do a generation at
+// a time, parents first or children first, with the persons of a generation done in parallel.
+typedef struct LineageOrder {
+	int numOrdered; // Persons on parent cycles, and their descendents, are left out.
+	int* ordered; // Persons by generation, so parents are before their children.
+	int* rank; // Position of each person in ordered; -1 if left out.
+	int* generation; // Generation of each person; -1 if left out.
+	int* firstInGeneration; // Generation g is ordered[firstInGeneration[g]..firstInGeneration[g+1]-1].
+	int numGenerations;
+} LineageOrder;
+
+// LineageGraph holds the persons of a Database by id and the links between them.
+typedef struct LineageGraph {
+	int numPersons;
+	GNode** persons; // Person roots by id.
+	LineageId* lineageIds; // MNOTE: the keys are in the records.
+	HashTable* ids; // Maps person keys to LineageIds.
+	int* parents; // Father and mother of each person, two per person; -1 if none.
+	int* firstParent; // The parents of person i in all its FAMC families are
+	int* allParents; // allParents[firstParent[i]..firstParent[i+1]-1], without repeats.
+	int* firstChild; // The children of person i are children[firstChild[i]..firstChild[i+1]-1].
+	int* children; // Children of the families each person is a spouse in, in Gedcom order.
+	int* firstSpouse; // The spouses of person i are spouses[firstSpouse[i]..firstSpouse[i+1]-1].
+	int* spouses; // Other spouse of each family a person is a spouse in; -1 if none.
+	LineageOrder* order; // Built when first used.
+} LineageGraph;
+
+// Closure is the result of an ancestor or descendent closure.
+typedef struct Closure {
+	int* ids; // Persons in the order found.
+	int numIds;
+	int* counts; // counts[g] is the number of persons in generation g; 0 is the start persons kept.
+	int numGenerations;
+} Closure;
+
+// Interface to LineageGraph.
+LineageGraph* getLineageGraph(RecordIndex*);
+void deleteLineageGraph(LineageGraph*);
+int lineageId(LineageGraph*, String key);
+int orderLineageGraph(LineageGraph*, int* ordered, int* rank);
+LineageOrder* getLineageOrder(LineageGraph*);
+Closure* ancestorClosure(LineageGraph*, int* start, int numStart, bool close, int limit);
+Closure* descendentClosure(LineageGraph*, int* start, int numStart, bool close, int limit);
+void deleteClosure(Closure*);
+
+#endif // lineagegraph_h
@@ -0,0 +1,69 @@
+// DeadEnds
+//
+// namesearch.h is the header file for the NameSearchIndex data type. A NameSearchIndex holds the
+// normalized parts (surnames and given names) of the names of the persons in a Database. It is
+// indexed by sorted prefix and by trigram, so it supports partial and misspelled name searches
+// that the Soundex based NameIndex cannot.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef namesearch_h
+#define namesearch_h
+
+#include "standard.h"
+#include "block.h"
+#include "list.h"
+#include "hashtable.h"
+#include "rootlist.h"
+
+typedef List RootList; // Forward reference.
+
+// NameSearchPerson is a person in a NameSearchIndex. Its id numbers the person's scratch space
+// in a search.
+typedef struct NameSearchPerson {
+	String recordKey; // Key of the person; MNOTE: not saved.
+	int id;
+	Block entries; // The person's NameSearchEntrys.
+} NameSearchPerson;
+
+// NameSearchResult is a person found by searchNameSearchIndex.
+typedef struct NameSearchResult {
+	String recordKey; // Key of the person; MNOTE: not saved.
+	int matched; // Number of query words the person matched.
+	double score; // Sum of the best match score of each query word.
+} NameSearchResult;
+
+// NameSearchEntry is one normalized name part of one person. Its id numbers its scratch space in
+// a search.
+typedef struct NameSearchEntry {
+	String part; // Lower case name part.
+	NameSearchPerson* person; // Person with the part.
+	bool surname; // Part is from the surname.
+	int numGrams; // Number of trigrams in the part.
+	int id;
+} NameSearchEntry;
+
+// NameSearchIndex is the index of name parts. Searches keep their scratch space to themselves, so
+// an index that is not being changed can be searched by many threads at once. Ids are not reused
+// when persons are removed, so numPersons and numEntries are the numbers of ids handed out.
+typedef struct NameSearchIndex {
+	Block entries; // All NameSearchEntrys, sorted by part when isSorted is true.
+	bool isSorted;
+	HashTable* grams; // Maps trigrams to the Blocks of NameSearchEntrys that have them.
+	HashTable* persons; // Maps record keys to NameSearchPersons.
+	int numPersons;
+	int numEntries;
+} NameSearchIndex;
+
+// Interface to NameSearchIndex.
+NameSearchIndex* createNameSearchIndex(void);
+void deleteNameSearchIndex(NameSearchIndex*);
+void addToNameSearchIndex(NameSearchIndex*, String name, String recordKey);
+void removeFromNameSearchIndex(NameSearchIndex*, String recordKey);
+void updateNameSearchIndex(NameSearchIndex*, GNode* root);
+NameSearchIndex* getNameSearchIndex(RootList*);
+List* searchNameSearchIndex(NameSearchIndex*, String query, int limit);
+void showNameSearchIndexStats(NameSearchIndex*);
+
+#endif // namesearch_h
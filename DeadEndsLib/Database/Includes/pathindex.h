@@ -0,0 +1,68 @@
+// DeadEnds
+//
+// pathindex.h is the header file for the PathIndex data type. A PathIndex is a secondary index
+// on a Gedcom path. It maps the values found at the ends of the path, for example the titles
+// found by "SOUR->TITL", to the keys of the records that have them. The PathIndexes of a
+// Database are kept current as its records are edited.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef pathindex_h
+#define pathindex_h
+
+#include "standard.h"
+#include "list.h"
+#include "set.h"
+#include "hashtable.h"
+#include "gnode.h"
+#include "gedpath.h"
+
+typedef HashTable RecordIndex; // Forward references.
+typedef struct Database Database;
+typedef struct GedPath GedPath;
+
+// PathKeyFunction extracts the index key from the value of a GNode at the end of a path. It is
+// also applied to search values, so it is the normalization of the index. It returns null if the
+// value is not to be indexed. buffer has room for MAXSTRINGSIZE chars; the returned String may be
+// in it.
+typedef String (*PathKeyFunction)(String value, String buffer);
+
+// PathIndexEl is an element of a PathIndex; it holds a key and the Set of record keys with it.
+typedef struct PathIndexEl {
+	String key; // Extracted key.
+	Set* recordKeys; // Keys of the records with the value.
+} PathIndexEl;
+
+// PathRecordEl holds the keys a record is indexed under so they can be removed on edits.
+typedef struct PathRecordEl {
+	String recordKey;
+	List* keys; // Extracted keys; MNOTE: shared with the PathIndexEls.
+} PathRecordEl;
+
+// PathIndex is a secondary index on a Gedcom path.
+typedef struct PathIndex {
+	String expression; // Path expression, e.g. "SOUR->TITL".
+	GedPath* path;
+	PathKeyFunction keyFunction; // Key extraction function; null uses values as is.
+	HashTable* keys; // Maps keys to PathIndexEls.
+	HashTable* records; // Maps record keys to PathRecordEls.
+} PathIndex;
+
+// Interface to PathIndex.
+PathIndex* createPathIndex(String expression, PathKeyFunction);
+void deletePathIndex(PathIndex*);
+void addRecordToPathIndex(PathIndex*, GNode* root);
+void removeRecordFromPathIndex(PathIndex*, String recordKey);
+PathIndex* getPathIndex(RecordIndex*, String expression, PathKeyFunction);
+Set* searchPathIndex(PathIndex*, String value);
+String upperPathKey(String value, String buffer);
+void showPathIndexStats(PathIndex*);
+
+// Interface to the PathIndexes of a Database.
+PathIndex* addPathIndex(Database*, String expression, PathKeyFunction);
+PathIndex* findPathIndex(Database*, String expression, PathKeyFunction);
+void updatePathIndexes(Database*, GNode* node);
+void removeFromPathIndexes(Database*, String recordKey);
+
+#endif // pathindex_h
@@ -0,0 +1,58 @@
+// DeadEnds
+//
+// placeindex.h is the header file for the PlaceIndex data type. A PlaceIndex is a trie of the
+// places found in the PLAC values of a Database. The trie is keyed from the largest jurisdiction
+// down, so in "Bath, Sagadahoc, Maine, USA" the path from the root is USA, Maine, Sagadahoc,
+// Bath. Each event is attached to the node of its place.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef placeindex_h
+#define placeindex_h
+
+#include "standard.h"
+#include "block.h"
+#include "list.h"
+#include "hashtable.h"
+#include "stringtable.h"
+#include "gnode.h"
+
+typedef HashTable RecordIndex; // Forward reference.
+
+// PlaceEvent is an event attached to a PlaceNode.
+typedef struct PlaceEvent {
+	GNode* event; // Event node; MNOTE: not freed.
+	GNode* root; // Root of the record with the event; MNOTE: not freed.
+} PlaceEvent;
+
+// PlaceNode is a node in a PlaceIndex; it is the place named by the phrases on the path to it.
+typedef struct PlaceNode {
+	String phrase; // Interned phrase; null at the root.
+	struct PlaceNode* parent;
+	Block children; // Child PlaceNodes sorted by phrase.
+	Block events; // PlaceEvents at exactly this place.
+	int total; // Number of events at this place and its sub-places.
+} PlaceNode;
+
+// PlaceIndex is the trie of places.
+typedef struct PlaceIndex {
+	PlaceNode* root;
+	StringTable* phrases; // Interned phrases.
+	int numPlaces;
+} PlaceIndex;
+
+// Interface to PlaceIndex.
+PlaceIndex* createPlaceIndex(void);
+void deletePlaceIndex(PlaceIndex*);
+PlaceNode* addToPlaceIndex(PlaceIndex*, String place, GNode* event, GNode* root);
+void addRecordToPlaceIndex(PlaceIndex*, GNode* root);
+void removeRecordFromPlaceIndex(PlaceIndex*, GNode* root);
+PlaceIndex* getPlaceIndex(RecordIndex*);
+PlaceNode* searchPlaceIndex(PlaceIndex*, String place);
+void walkPlaceNode(PlaceNode*, void(*visit)(PlaceNode*, void*), void* data);
+List* placeNodeToEvents(PlaceNode*);
+String placeNodeToString(PlaceNode*, String buffer, int length);
+void showPlaceIndex(PlaceIndex*, int maxDepth, int minTotal);
+
+#endif // placeindex_h
@@ -0,0 +1,41 @@
+// DeadEnds
+//
+// relationship.h is the header file for the relationship calculator, which finds how two persons
+// in a LineageGraph are related and names the relationship.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef relationship_h
+#define relationship_h
+
+#include "standard.h"
+#include "lineagegraph.h"
+
+#define MAXRELATIONSHIPNAME 128
+
+// Relationship is how a person is related to another person. The first person is the name of the
+// second: if name is "uncle" the first person is the uncle of the second.
+typedef struct Relationship {
+	int from, to; // Ids of the persons.
+	int ancestor; // Nearest common ancestor; -1 if the persons are spouses.
+	int up; // Generations from the first person, or the spouse that links it, up to the ancestor.
+	int down; // Generations from the second person, or the spouse that links it, up to the ancestor.
+	bool half; // The paths go down from different families of the ancestor.
+	int spouse; // Spouse that links an in-law relationship, or the second person if they are
+				// spouses; -1 if a blood relationship.
+	int* path; // Persons from the first person up to the ancestor and down to the second.
+	int pathLength;
+	char name[MAXRELATIONSHIPNAME];
+} Relationship;
+
+typedef struct RelationshipFinder RelationshipFinder;
+
+// Interface to the relationship calculator.
+RelationshipFinder* createRelationshipFinder(LineageGraph*);
+void deleteRelationshipFinder(RelationshipFinder*);
+Relationship* findRelationship(RelationshipFinder*, int from, int to);
+void findRelationships(RelationshipFinder*, int from, int* to, int count, Relationship** results);
+void deleteRelationship(Relationship*);
+
+#endif // relationship_h
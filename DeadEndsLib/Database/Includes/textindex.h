@@ -0,0 +1,57 @@
+// DeadEnds
+//
+// textindex.h is the header file for the TextIndex data type. A TextIndex is an inverted index
+// of the words in the free-text values (NOTE, TEXT, ...) of a Database. Each word maps to a
+// posting list of the text nodes and word positions where it occurs. Queries are words and
+// "quoted phrases", combined with AND (the default), OR and - (not).
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef textindex_h
+#define textindex_h
+
+#include "standard.h"
+#include "block.h"
+#include "list.h"
+#include "hashtable.h"
+#include "gnode.h"
+
+typedef HashTable RecordIndex; // Forward reference.
+
+// TextDoc is a free-text node in a TextIndex.
+typedef struct TextDoc {
+	GNode* node; // Free-text node; its CONT and CONC children are part of the text.
+	GNode* root; // Root of the record with the node; MNOTE: GNodes are not freed.
+} TextDoc;
+
+// TextPosting is an occurrence of a word: the TextDoc and the word's position in it.
+typedef struct TextPosting {
+	int doc;
+	int position;
+} TextPosting;
+
+// TextTerm is a word and its posting list, in TextDoc then position order.
+typedef struct TextTerm {
+	String word; // Case folded word.
+	TextPosting* postings;
+	int numPostings;
+	int maxPostings;
+} TextTerm;
+
+// TextIndex is the inverted index.
+typedef struct TextIndex {
+	HashTable* terms; // Maps words to TextTerms.
+	Block docs; // TextDocs; a doc number is an index into this Block.
+	int numWords; // Total number of words indexed.
+} TextIndex;
+
+// Interface to TextIndex.
+TextIndex* createTextIndex(void);
+void deleteTextIndex(TextIndex*);
+void addRecordToTextIndex(TextIndex*, GNode* root);
+TextIndex* getTextIndex(RecordIndex*);
+List* searchTextIndex(TextIndex*, String query);
+void showTextIndexStats(TextIndex*);
+
+#endif // textindex_h
@@ -0,0 +1,32 @@
+// DeadEnds
+//
+// versions.h is the header file for copy-on-write record versions. The record operations that
+// use them edit a copy and publish the copy by swapping the record's pointer in the RecordIndex
+// and root lists. A replaced version is freed when the writer no longer holds pointers into it.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef versions_h
+#define versions_h
+
+#include "standard.h"
+#include "block.h"
+
+typedef struct GNode GNode; // Forward references.
+typedef struct Database Database;
+
+// Versions holds the replaced record versions of a Database.
+typedef struct Versions {
+	Block retired; // Replaced versions waiting to be freed; used only by the writer.
+} Versions;
+
+// Interface to Versions.
+Versions* createVersions(void);
+void deleteVersions(Versions*);
+GNode* copyRecordForEdit(GNode* root);
+void discardRecordCopy(GNode* copy);
+bool publishRecord(Database*, GNode* old, GNode* new);
+int reclaimVersions(Database*);
+
+#endif // versions_h
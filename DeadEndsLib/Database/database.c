@@ -5,7 +5,7 @@
 // and used to build an internal database.
 //
 // Created by Thomas Wetmore on 10 November 2022.
-// Last changed 21 February 2025.
+// Last changed 18 October 2026.
 
 #include "database.h"
 #include "gnode.h"
@@ -20,16 +20,28 @@
 
 extern bool importDebugging;
 bool indexNameDebugging = false;
+static _Atomic long lastGeneration = 0; // Last Database generation handed out.
 
 // createDatabase creates a database.
 Database *createDatabase(String filePath) {
+	char buffer[MAXPATHBUFFER];
 	Database *database = (Database*) stdalloc(sizeof(Database));
 	database->filePath = strsave(filePath);
-	database->name = strsave(lastPathSegment(filePath));
+	database->name = strsave(lastPathSegmentInBuffer(filePath, buffer));
+	database->header = null;
 	database->dirty = false;
+	database->generation = ++lastGeneration;
 	database->recordIndex = null;
 	database->nameIndex = null;
 	database->refnIndex = null;
+	database->nameSearchIndex = null;
+	database->dateIndex = null;
+	database->placeIndex = null;
+	database->pathIndexes = null;
+	database->textIndex = null;
+	database->lineageGraph = null;
+	database->journal = null;
+	database->versions = createVersions();
 	database->personRoots = createRootList(); // null?
 	database->familyRoots = createRootList(); // null?
 	return database;
@@ -40,6 +52,19 @@ void deleteDatabase(Database* database) {
 	if (database->recordIndex) deleteRecordIndex(database->recordIndex);
 	if (database->nameIndex) deleteNameIndex(database->nameIndex);
 	if (database->refnIndex) deleteRefnIndex(database->refnIndex);
+	if (database->nameSearchIndex) deleteNameSearchIndex(database->nameSearchIndex);
+	if (database->dateIndex) deleteDateIndex(database->dateIndex);
+	if (database->placeIndex) deletePlaceIndex(database->placeIndex);
+	if (database->pathIndexes) {
+		FORLIST(database->pathIndexes, element)
+			deletePathIndex((PathIndex*) element);
+		ENDLIST
+		deleteList(database->pathIndexes);
+	}
+	if (database->textIndex) deleteTextIndex(database->textIndex);
+	if (database->lineageGraph) deleteLineageGraph(database->lineageGraph);
+	if (database->journal) deleteJournal(database->journal);
+	if (database->versions) deleteVersions(database->versions);
 	if (database->personRoots) deleteList(database->personRoots);
 	if (database->familyRoots) deleteList(database->familyRoots);
 }
@@ -154,3 +179,52 @@ void summarizeDatabase(Database* database) {
 		printf("\tName index: %d name keys and %d record keys.\n", numNames, numRecords);
 	}
 }
+
+// recordChanged is called after the record holding node has been edited. It marks the Database
+// dirty, gives it a new generation, adds the record to the next journal commit, updates the
+// PathIndexes and NameSearchIndex, and drops the TextIndex and LineageGraph to be rebuilt when
+// next used.
+void recordChanged(Database* database, GNode* node) {
+	if (!database || !node) return;
+	while (node->parent) node = node->parent;
+	if (!node->key) return;
+	database->dirty = true;
+	database->generation = ++lastGeneration;
+	if (database->journal) journalRecord(database->journal, node->key);
+	updatePathIndexes(database, node);
+	if (database->nameSearchIndex) updateNameSearchIndex(database->nameSearchIndex, node);
+	if (database->textIndex) {
+		deleteTextIndex(database->textIndex);
+		database->textIndex = null;
+	}
+	if (database->lineageGraph) {
+		deleteLineageGraph(database->lineageGraph);
+		database->lineageGraph = null;
+	}
+}
+
+// getDatabaseTextIndex returns the TextIndex of a Database, building it on first use.
+TextIndex* getDatabaseTextIndex(Database* database) {
+	if (!database->textIndex) database->textIndex = getTextIndex(database->recordIndex);
+	return database->textIndex;
+}
+
+// lastDatabaseGeneration returns the last generation handed out; it changes whenever any Database
+// is created or edited.
+long lastDatabaseGeneration(void) {
+	return lastGeneration;
+}
+
+// getDatabaseLineageGraph returns the LineageGraph of a Database, building it on first use.
+LineageGraph* getDatabaseLineageGraph(Database* database) {
+	if (!database->lineageGraph) database->lineageGraph = getLineageGraph(database->recordIndex);
+	return database->lineageGraph;
+}
+
+// prepareDatabaseForReaders builds the parts of a Database that are otherwise built on first use.
+// Afterwards the Database can be searched from several threads as long as it is not edited.
+void prepareDatabaseForReaders(Database* database) {
+	if (database->dateIndex) buildDateIndex(database->dateIndex);
+	getDatabaseTextIndex(database);
+	getDatabaseLineageGraph(database);
+}
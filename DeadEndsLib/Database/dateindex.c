@@ -0,0 +1,228 @@
+// DeadEnds
+//
+// dateindex.c implements the DateIndex, an index of the dates of the events in a Database. Each
+// DATE value is parsed once into a PackedDate when the index is built. The dates of each event
+// tag are kept in an array sorted by first day that is searched as an implicit interval tree,
+// so a query for the events in an interval takes O(log n) plus the number of events found.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include "dateindex.h"
+#include "recordindex.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+static bool dateIndexDebugging = false;
+static int numDateIndexBuckets = 61;
+static int numRecordBuckets = 4093;
+
+// getKey returns the tag of an EventDates.
+static String getKey(void* element) {
+	return ((EventDates*) element)->tag;
+}
+
+// compare compares two event tags.
+static int compare(String a, String b) {
+	return strcmp(a, b);
+}
+
+// deleteDateIndexEl frees a DateIndexEl; its GNodes are not freed.
+static void deleteDateIndexEl(void* element) {
+	stdfree(element);
+}
+
+// delete frees an EventDates and its DateIndexEls.
+static void delete(void* element) {
+	EventDates* dates = (EventDates*) element;
+	deleteBlock(&(dates->dates), deleteDateIndexEl);
+	if (dates->maxDays) stdfree(dates->maxDays);
+	stdfree(dates->tag);
+	stdfree(dates);
+}
+
+// recordGetKey returns the record key of a RecordDates.
+static String recordGetKey(void* element) {
+	return ((RecordDates*) element)->key;
+}
+
+// recordCompare compares two record keys.
+static int recordCompare(String a, String b) {
+	return compareRecordKeys(a, b);
+}
+
+// deleteRecordDates frees a RecordDates; its DateIndexEls are not freed.
+static void deleteRecordDates(void* element) {
+	RecordDates* record = (RecordDates*) element;
+	deleteBlock(&(record->dates), null);
+	stdfree(record);
+}
+
+// createDateIndex creates an empty DateIndex.
+DateIndex* createDateIndex(void) {
+	DateIndex* index = (DateIndex*) stdalloc(sizeof(DateIndex));
+	index->tags = createHashTable(getKey, compare, delete, numDateIndexBuckets);
+	index->records = createHashTable(recordGetKey, recordCompare, deleteRecordDates,
+									 numRecordBuckets);
+	return index;
+}
+
+// deleteDateIndex deletes a DateIndex.
+void deleteDateIndex(DateIndex* index) {
+	deleteHashTable(index->records);
+	deleteHashTable(index->tags);
+	stdfree(index);
+}
+
+// addToDateIndex adds the parsed date of an event to a DateIndex.
+void addToDateIndex(DateIndex* index, GNode* root, GNode* event, PackedDate* date) {
+	EventDates* dates = (EventDates*) searchHashTable(index->tags, event->tag);
+	if (!dates) {
+		dates = (EventDates*) stdalloc(sizeof(EventDates));
+		dates->tag = strsave(event->tag);
+		initBlock(&(dates->dates));
+		dates->maxDays = null;
+		addToHashTable(index->tags, dates, false);
+	}
+	RecordDates* record = (RecordDates*) searchHashTable(index->records, root->key);
+	if (!record) {
+		record = (RecordDates*) stdalloc(sizeof(RecordDates));
+		record->key = root->key;
+		initBlock(&(record->dates));
+		addToHashTable(index->records, record, false);
+	}
+	DateIndexEl* el = (DateIndexEl*) stdalloc(sizeof(DateIndexEl));
+	el->date = *date;
+	el->event = event;
+	el->root = root;
+	el->dates = dates;
+	appendToBlock(&(dates->dates), el);
+	appendToBlock(&(record->dates), el);
+	dates->isBuilt = false;
+}
+
+// addRecordToDateIndex parses and adds the dates of the level one events of a record.
+void addRecordToDateIndex(DateIndex* index, GNode* root) {
+	PackedDate date;
+	for (GNode* event = root->child; event; event = event->sibling) {
+		GNode* node = DATE(event);
+		if (node && parseDate(node->value, &date)) addToDateIndex(index, root, event, &date);
+	}
+}
+
+// removeRecordFromDateIndex removes the dates of the events of a record from a DateIndex. The
+// record's elements are found by its key and marked removed; they are freed when their
+// EventDates are next built.
+void removeRecordFromDateIndex(DateIndex* index, GNode* root) {
+	if (!root->key) return;
+	RecordDates* record = (RecordDates*) searchHashTable(index->records, root->key);
+	if (!record) return;
+	for (int i = 0; i < record->dates.length; i++) {
+		DateIndexEl* el = (DateIndexEl*) record->dates.elements[i];
+		el->root = null;
+		el->dates->isBuilt = false;
+	}
+	removeFromHashTable(index->records, root->key);
+}
+
+// getDateIndex returns the DateIndex of the person and family events in a RecordIndex.
+DateIndex* getDateIndex(RecordIndex* recordIndex) {
+	DateIndex* index = createDateIndex();
+	FORHASHTABLE(recordIndex, element)
+		GNode* root = (GNode*) element;
+		RecordType rtype = recordType(root);
+		if (rtype == GRPerson || rtype == GRFamily) addRecordToDateIndex(index, root);
+	ENDHASHTABLE
+	if (dateIndexDebugging) showDateIndexStats(index);
+	return index;
+}
+
+// compareDateIndexEls orders DateIndexEls by first day.
+static int compareDateIndexEls(const void* a, const void* b) {
+	int left = (*(DateIndexEl**) a)->date.minDay;
+	int right = (*(DateIndexEl**) b)->date.minDay;
+	return left < right ? -1 : left > right;
+}
+
+// buildMaxDays sets maxDays for the implicit tree rooted in the range [lo, hi) and returns it.
+static int buildMaxDays(DateIndexEl** els, int* maxDays, int lo, int hi) {
+	if (lo >= hi) return minDayNumber;
+	int mid = (lo + hi)/2;
+	int max = els[mid]->date.maxDay;
+	int left = buildMaxDays(els, maxDays, lo, mid);
+	int right = buildMaxDays(els, maxDays, mid + 1, hi);
+	if (left > max) max = left;
+	if (right > max) max = right;
+	maxDays[mid] = max;
+	return max;
+}
+
+// buildEventDates frees the removed DateIndexEls of an EventDates, sorts the others, and
+// computes its maxDays.
+static void buildEventDates(EventDates* dates) {
+	Block* block = &(dates->dates);
+	int kept = 0;
+	for (int i = 0; i < block->length; i++) {
+		DateIndexEl* el = (DateIndexEl*) block->elements[i];
+		if (el->root) block->elements[kept++] = el;
+		else deleteDateIndexEl(el);
+	}
+	block->length = kept;
+	qsort(block->elements, block->length, sizeof(void*), compareDateIndexEls);
+	if (dates->maxDays) stdfree(dates->maxDays);
+	dates->maxDays = (int*) stdalloc((block->length + 1)*sizeof(int));
+	buildMaxDays((DateIndexEl**) block->elements, dates->maxDays, 0, block->length);
+	dates->isBuilt = true;
+}
+
+// buildDateIndex sorts the EventDates of a DateIndex that are not sorted. Searches only read a
+// built DateIndex, so they can run in several threads.
+void buildDateIndex(DateIndex* index) {
+	FORHASHTABLE(index->tags, element)
+		EventDates* dates = (EventDates*) element;
+		if (!dates->isBuilt) buildEventDates(dates);
+	ENDHASHTABLE
+}
+
+// searchRange adds the DateIndexEls in the range [lo, hi) that match [minDay, maxDay] to a List.
+// Ranges whose latest day is before minDay are skipped, as are elements whose first day is after
+// maxDay.
+static void searchRange(EventDates* dates, int lo, int hi, int minDay, int maxDay, bool within,
+						List* list) {
+	DateIndexEl** els = (DateIndexEl**) dates->dates.elements;
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+		if (dates->maxDays[mid] < minDay) return;
+		searchRange(dates, lo, mid, minDay, maxDay, within, list);
+		PackedDate* date = &(els[mid]->date);
+		if (date->minDay > maxDay) return;
+		if (within ? (date->minDay >= minDay && date->maxDay <= maxDay) : date->maxDay >= minDay)
+			appendToList(list, els[mid]);
+		lo = mid + 1;
+	}
+}
+
+// searchDateIndex returns a List of the DateIndexEls of an event tag whose dates match the day
+// interval [minDay, maxDay]. If within is true a date matches if it must be in the interval;
+// otherwise it matches if it could be. The List is in first day order.
+// MNOTE: the caller owns the List but not its elements.
+List* searchDateIndex(DateIndex* index, String tag, int minDay, int maxDay, bool within) {
+	List* list = createList(null, null, null, false);
+	EventDates* dates = (EventDates*) searchHashTable(index->tags, tag);
+	if (!dates) return list;
+	if (!dates->isBuilt) buildEventDates(dates);
+	searchRange(dates, 0, dates->dates.length, minDay, maxDay, within, list);
+	return list;
+}
+
+// showDateIndexStats shows the number of dates of each event tag in a DateIndex; for debugging.
+void showDateIndexStats(DateIndex* index) {
+	fprintf(stderr, "Summary of Date Index:");
+	FORHASHTABLE(index->tags, element)
+		EventDates* dates = (EventDates*) element;
+		fprintf(stderr, " %s %d;", dates->tag, dates->dates.length);
+	ENDHASHTABLE
+	fprintf(stderr, "\n");
+}
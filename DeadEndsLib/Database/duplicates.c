@@ -0,0 +1,433 @@
+// DeadEnds
+//
+// duplicates.c finds persons in two Databases that are likely the same person. Comparing every
+// pair of persons is too slow, so persons are grouped into blocks by blocking key: the name key
+// of their first name (first initial and Soundex of the surname), their sex, and the decade of
+// their birth. Only persons in the same block, or in the blocks of the decades just before and
+// after, are compared. Persons with no birth year are compared with all persons with the same
+// name key and sex.
+//
+// Each candidate pair is scored by a weighted comparison of names, birth dates, birth places and
+// the names of the parents. Scoring is done by a pool of threads, and the pairs that score well
+// enough are returned best first.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include "duplicates.h"
+#include "utils.h"
+#include "gedcom.h"
+#include "name.h"
+#include "lineage.h"
+#include "date.h"
+
+#define NODECADE INT_MIN // Decade of persons with no birth year.
+#define BLOCKKEYLEN (NAMEKEYLEN + 1)
+#define SCORECHUNK 256 // Pairs a scoring thread takes at a time.
+#define MAXPHRASES 16
+
+static bool duplicatesDebugging = false;
+static int numBlockBuckets = 4093;
+
+// Weights of the components of a score.
+static double nameWeight = 0.45;
+static double dateWeight = 0.25;
+static double placeWeight = 0.10;
+static double parentWeight = 0.20;
+
+// BlockPerson is a person of the second Database in a DuplicateBlock.
+typedef struct BlockPerson {
+	GNode* person;
+	int decade; // Decade of birth, or NODECADE.
+} BlockPerson;
+
+// DuplicateBlock holds the persons of the second Database with a name key and sex, sorted by
+// decade of birth; persons with no birth year come first.
+typedef struct DuplicateBlock {
+	char key[BLOCKKEYLEN];
+	Block persons; // BlockPersons.
+} DuplicateBlock;
+
+// blockGetKey returns the key of a DuplicateBlock.
+static String blockGetKey(void* element) {
+	return ((DuplicateBlock*) element)->key;
+}
+
+// blockCompare compares the keys of two DuplicateBlocks.
+static int blockCompare(String a, String b) {
+	return strcmp(a, b);
+}
+
+// deleteElement frees a BlockPerson or DuplicateMatch; the persons are not freed.
+static void deleteElement(void* element) {
+	stdfree(element);
+}
+
+// blockDelete frees a DuplicateBlock and its BlockPersons.
+static void blockDelete(void* element) {
+	DuplicateBlock* block = (DuplicateBlock*) element;
+	deleteBlock(&(block->persons), deleteElement);
+	stdfree(block);
+}
+
+// birthYear returns the year of a person's birth, or of the christening if the birth has no
+// year; returns 0 if neither does.
+static int birthYear(GNode* person) {
+	GNode* events[] = {BIRT(person), BAPT(person)};
+	for (int i = 0; i < 2; i++) {
+		GNode* date = events[i] ? DATE(events[i]) : null;
+		PackedDate packed;
+		if (date && date->value && parseDate(date->value, &packed) && packed.year)
+			return packed.year;
+	}
+	return 0;
+}
+
+// birthDecade returns the decade of a person's birth, or NODECADE.
+static int birthDecade(GNode* person) {
+	int year = birthYear(person);
+	if (!year) return NODECADE;
+	return year >= 0 ? year/10 : (year - 9)/10;
+}
+
+// blockKey sets buffer to the blocking key of a person, the name key of the first name followed
+// by the sex, and returns it. Returns null if the person has no name.
+static String blockKey(GNode* person, String buffer) {
+	GNode* name = NAME(person);
+	if (!name || !name->value || !nameToNameKeyInBuffer(name->value, buffer)) return null;
+	SexType sex = valueToSex(SEX(person));
+	int length = (int) strlen(buffer);
+	buffer[length] = sex == sexMale ? 'M' : sex == sexFemale ? 'F' : 'U';
+	buffer[length + 1] = 0;
+	return buffer;
+}
+
+// compareBlockPersons orders BlockPersons by decade.
+static int compareBlockPersons(const void* a, const void* b) {
+	int left = (*(BlockPerson**) a)->decade;
+	int right = (*(BlockPerson**) b)->decade;
+	return left < right ? -1 : left > right ? 1 : 0;
+}
+
+// createDuplicateBlocks puts the persons of a Database into DuplicateBlocks.
+static HashTable* createDuplicateBlocks(Database* database) {
+	HashTable* blocks = createHashTable(blockGetKey, blockCompare, blockDelete, numBlockBuckets);
+	char key[BLOCKKEYLEN];
+	FORLIST(database->personRoots, element)
+		GNode* person = (GNode*) element;
+		if (!blockKey(person, key)) continue;
+		DuplicateBlock* block = (DuplicateBlock*) searchHashTable(blocks, key);
+		if (!block) {
+			block = (DuplicateBlock*) stdalloc(sizeof(DuplicateBlock));
+			strcpy(block->key, key);
+			initBlock(&(block->persons));
+			addToHashTable(blocks, block, false);
+		}
+		BlockPerson* blockPerson = (BlockPerson*) stdalloc(sizeof(BlockPerson));
+		blockPerson->person = person;
+		blockPerson->decade = birthDecade(person);
+		appendToBlock(&(block->persons), blockPerson);
+	ENDLIST
+	FORHASHTABLE(blocks, element)
+		Block* persons = &(((DuplicateBlock*) element)->persons);
+		qsort(persons->elements, persons->length, sizeof(void*), compareBlockPersons);
+	ENDHASHTABLE
+	return blocks;
+}
+
+// addCandidates adds the pairs of a person of the first Database and the persons in a
+// DuplicateBlock born within a decade of the person to a Block of DuplicateMatches.
+static void addCandidates(GNode* person, DuplicateBlock* block, Block* pairs) {
+	BlockPerson** persons = (BlockPerson**) block->persons.elements;
+	int length = block->persons.length;
+	int decade = birthDecade(person);
+	for (int i = 0; i < length; i++) {
+		int other = persons[i]->decade;
+		if (decade != NODECADE && other != NODECADE) {
+			if (other < decade - 1) continue;
+			if (other > decade + 1) break;
+		}
+		DuplicateMatch* match = (DuplicateMatch*) stdalloc(sizeof(DuplicateMatch));
+		match->one = person;
+		match->two = persons[i]->person;
+		match->score = 0.0;
+		appendToBlock(pairs, match);
+	}
+}
+
+// normalizeWord copies the letters of a String to a buffer of MAXNAMELEN+1 chars in lower case;
+// spaces are kept between words.
+static String normalizeWord(String string, String buffer) {
+	String p = buffer;
+	bool space = false;
+	for (int c; (c = (unsigned char) *string) && p < buffer + MAXNAMELEN - 1; string++) {
+		if (isalpha(c) || c >= 0x80) {
+			if (space && p > buffer) *p++ = ' ';
+			*p++ = c < 0x80 ? tolower(c) : c;
+			space = false;
+		} else if (isspace(c)) {
+			space = true;
+		}
+	}
+	*p = 0;
+	return buffer;
+}
+
+// jaroWinkler returns the Jaro-Winkler similarity of two Strings, between 0 and 1.
+static double jaroWinkler(String a, String b) {
+	int la = (int) strlen(a), lb = (int) strlen(b);
+	if (la == 0 || lb == 0) return 0.0;
+	if (eqstr(a, b)) return 1.0;
+	bool ma[MAXNAMELEN+1] = {false}, mb[MAXNAMELEN+1] = {false};
+	int range = (la > lb ? la : lb)/2 - 1;
+	if (range < 0) range = 0;
+	int matches = 0;
+	for (int i = 0; i < la; i++) {
+		int lo = i - range > 0 ? i - range : 0;
+		int hi = i + range + 1 < lb ? i + range + 1 : lb;
+		for (int j = lo; j < hi; j++) {
+			if (mb[j] || a[i] != b[j]) continue;
+			ma[i] = mb[j] = true;
+			matches++;
+			break;
+		}
+	}
+	if (matches == 0) return 0.0;
+	int transpositions = 0;
+	for (int i = 0, j = 0; i < la; i++) {
+		if (!ma[i]) continue;
+		while (!mb[j]) j++;
+		if (a[i] != b[j]) transpositions++;
+		j++;
+	}
+	double m = matches;
+	double jaro = (m/la + m/lb + (m - transpositions/2.0)/m)/3.0;
+	int prefix = 0;
+	while (prefix < 4 && a[prefix] && a[prefix] == b[prefix]) prefix++;
+	return jaro + prefix*0.1*(1.0 - jaro);
+}
+
+// nameSimilarity compares two Gedcom names by surname and given names; a part missing from
+// either name is left out. Returns -1 if either name is missing.
+static double nameSimilarity(String one, String two) {
+	if (!one || !two) return -1.0;
+	char raw[MAXLINELEN+1], a[MAXNAMELEN+1], b[MAXNAMELEN+1];
+	double total = 0.0;
+	int count = 0;
+	normalizeWord(getSurnameInBuffer(one, raw), a);
+	normalizeWord(getSurnameInBuffer(two, raw), b);
+	if (*a && *b) {
+		total += jaroWinkler(a, b);
+		count++;
+	}
+	normalizeWord(getGivenNamesInBuffer(one, raw), a);
+	normalizeWord(getGivenNamesInBuffer(two, raw), b);
+	if (*a && *b) {
+		total += jaroWinkler(a, b);
+		count++;
+	}
+	return count ? total/count : 0.0;
+}
+
+// personName returns the value of a person's first NAME node, or null.
+static String personName(GNode* person) {
+	GNode* name = person ? NAME(person) : null;
+	return name ? name->value : null;
+}
+
+// eventValue returns the value of the DATE or PLAC node of a person's birth, or of the
+// christening if there is no birth; returns null if there isn't one.
+static String eventValue(GNode* person, String tag) {
+	GNode* events[] = {BIRT(person), BAPT(person)};
+	for (int i = 0; i < 2; i++) {
+		GNode* node = events[i] ? findTag(events[i]->child, tag) : null;
+		if (node && node->value) return node->value;
+	}
+	return null;
+}
+
+// dateSimilarity compares the birth dates of two persons. Returns -1 if either has no year.
+static double dateSimilarity(GNode* one, GNode* two) {
+	String a = eventValue(one, "DATE"), b = eventValue(two, "DATE");
+	PackedDate da, db;
+	if (!a || !b || !parseDate(a, &da) || !parseDate(b, &db) || !da.year || !db.year) return -1.0;
+	int diff = abs(da.year - db.year);
+	if (diff == 0) {
+		if (da.month && db.month && da.month != db.month) return 0.7;
+		if (da.day && db.day && da.day != db.day) return 0.8;
+		return da.month && db.month ? 1.0 : 0.9;
+	}
+	if (diff == 1) return 0.6;
+	if (diff == 2) return 0.3;
+	return 0.0;
+}
+
+// placePhrases splits a place into its comma separated phrases, normalized with normalizeWord,
+// in a buffer of MAXPHRASES rows of MAXNAMELEN+1 chars; returns the number of phrases.
+static int placePhrases(String place, char phrases[][MAXNAMELEN+1]) {
+	int count = 0;
+	char phrase[MAXNAMELEN+1];
+	while (*place && count < MAXPHRASES) {
+		int length = 0;
+		while (*place && *place != ',') {
+			if (length < MAXNAMELEN) phrase[length++] = *place;
+			place++;
+		}
+		if (*place == ',') place++;
+		phrase[length] = 0;
+		normalizeWord(phrase, phrases[count]);
+		if (*phrases[count]) count++;
+	}
+	return count;
+}
+
+// placeSimilarity compares the birth places of two persons by the fraction of phrases they
+// share. Returns -1 if either has no place.
+static double placeSimilarity(GNode* one, GNode* two) {
+	String a = eventValue(one, "PLAC"), b = eventValue(two, "PLAC");
+	if (!a || !b) return -1.0;
+	char pa[MAXPHRASES][MAXNAMELEN+1], pb[MAXPHRASES][MAXNAMELEN+1];
+	int na = placePhrases(a, pa), nb = placePhrases(b, pb);
+	if (na == 0 || nb == 0) return -1.0;
+	int common = 0;
+	for (int i = 0; i < na; i++) {
+		for (int j = 0; j < nb; j++) {
+			if (eqstr(pa[i], pb[j])) {
+				common++;
+				break;
+			}
+		}
+	}
+	return (double) common/(na > nb ? na : nb);
+}
+
+// parentSimilarity compares the names of the fathers and of the mothers of two persons. Returns
+// -1 if neither parent is known in both Databases.
+static double parentSimilarity(DuplicateMatch* match, Database* one, Database* two) {
+	double total = 0.0;
+	int count = 0;
+	double father = nameSimilarity(personName(personToFather(match->one, one->recordIndex)),
+								   personName(personToFather(match->two, two->recordIndex)));
+	if (father >= 0.0) {
+		total += father;
+		count++;
+	}
+	double mother = nameSimilarity(personName(personToMother(match->one, one->recordIndex)),
+								   personName(personToMother(match->two, two->recordIndex)));
+	if (mother >= 0.0) {
+		total += mother;
+		count++;
+	}
+	return count ? total/count : -1.0;
+}
+
+// scoreDuplicateMatch scores a candidate pair. The score is the weighted mean of the components
+// that could be compared, scaled down when few could be, so a pair that only shares a name does
+// not score as high as one that agrees on everything.
+void scoreDuplicateMatch(DuplicateMatch* match, Database* one, Database* two) {
+	match->nameScore = nameSimilarity(personName(match->one), personName(match->two));
+	match->dateScore = dateSimilarity(match->one, match->two);
+	match->placeScore = placeSimilarity(match->one, match->two);
+	match->parentScore = parentSimilarity(match, one, two);
+	double scores[] = {match->nameScore, match->dateScore, match->placeScore, match->parentScore};
+	double weights[] = {nameWeight, dateWeight, placeWeight, parentWeight};
+	double sum = 0.0, weight = 0.0, total = 0.0;
+	for (int i = 0; i < 4; i++) {
+		total += weights[i];
+		if (scores[i] < 0.0) continue;
+		sum += weights[i]*scores[i];
+		weight += weights[i];
+	}
+	match->score = weight > 0.0 ? (sum/weight)*(0.75 + 0.25*weight/total) : 0.0;
+}
+
+// ScorePool is the list of candidate pairs shared by the scoring threads.
+typedef struct ScorePool {
+	DuplicateMatch** pairs;
+	int numPairs;
+	atomic_int next; // Index of the next chunk of pairs to score.
+	Database* one;
+	Database* two;
+} ScorePool;
+
+// scoreWorker scores chunks of pairs from a ScorePool until none are left.
+static void* scoreWorker(void* arg) {
+	ScorePool* pool = (ScorePool*) arg;
+	int first;
+	while ((first = atomic_fetch_add(&pool->next, SCORECHUNK)) < pool->numPairs) {
+		int last = first + SCORECHUNK < pool->numPairs ? first + SCORECHUNK : pool->numPairs;
+		for (int i = first; i < last; i++) scoreDuplicateMatch(pool->pairs[i], pool->one, pool->two);
+	}
+	return null;
+}
+
+// scorePairs scores a Block of candidate pairs with up to numThreads threads, 0 meaning one per
+// processor.
+static void scorePairs(Block* pairs, Database* one, Database* two, int numThreads) {
+	ScorePool pool;
+	pool.pairs = (DuplicateMatch**) pairs->elements;
+	pool.numPairs = pairs->length;
+	atomic_init(&pool.next, 0);
+	pool.one = one;
+	pool.two = two;
+	int numChunks = (pairs->length + SCORECHUNK - 1)/SCORECHUNK;
+	runThreads(scoreWorker, &pool, 0, threadCount(numThreads, numChunks));
+}
+
+// compareMatches orders DuplicateMatches by descending score, then by keys.
+static int compareMatches(const void* a, const void* b) {
+	DuplicateMatch* left = *(DuplicateMatch**) a;
+	DuplicateMatch* right = *(DuplicateMatch**) b;
+	if (left->score != right->score) return left->score < right->score ? 1 : -1;
+	int rc = compareRecordKeys(left->one->key, right->one->key);
+	return rc ? rc : compareRecordKeys(left->two->key, right->two->key);
+}
+
+// findDuplicatePersons finds the persons in two Databases that may be the same person and
+// returns a List of the DuplicateMatches that score at least minScore, best first. The pairs are
+// scored by numThreads threads; 0 means one per processor. The Databases must not change while
+// this runs.
+// MNOTE: the caller owns the List and its DuplicateMatches; deleteList frees them.
+List* findDuplicatePersons(Database* one, Database* two, double minScore, int numThreads) {
+	List* matches = createList(null, null, deleteElement, false);
+	if (!one || !two || !one->personRoots || !two->personRoots) return matches;
+	HashTable* blocks = createDuplicateBlocks(two);
+	Block pairs;
+	initBlock(&pairs);
+	char key[BLOCKKEYLEN];
+	FORLIST(one->personRoots, element)
+		GNode* person = (GNode*) element;
+		if (!blockKey(person, key)) continue;
+		DuplicateBlock* block = (DuplicateBlock*) searchHashTable(blocks, key);
+		if (block) addCandidates(person, block, &pairs);
+	ENDLIST
+	if (duplicatesDebugging)
+		fprintf(stderr, "findDuplicatePersons: %d blocks, %d candidate pairs of %ld.\n",
+				sizeHashTable(blocks), pairs.length,
+				(long) lengthList(one->personRoots)*lengthList(two->personRoots));
+	scorePairs(&pairs, one, two, numThreads);
+	int kept = 0;
+	for (int i = 0; i < pairs.length; i++) {
+		DuplicateMatch* match = (DuplicateMatch*) pairs.elements[i];
+		if (match->score >= minScore) pairs.elements[kept++] = match;
+		else stdfree(match);
+	}
+	pairs.length = kept;
+	qsort(pairs.elements, kept, sizeof(void*), compareMatches);
+	for (int i = 0; i < kept; i++) appendToList(matches, pairs.elements[i]);
+	deleteBlock(&pairs, null);
+	deleteHashTable(blocks);
+	return matches;
+}
+
+// showDuplicateMatch shows a DuplicateMatch on standard output; for debugging.
+void showDuplicateMatch(DuplicateMatch* match) {
+	char one[MAXNAMELEN+1], two[MAXNAMELEN+1];
+	printf("%.3f  %s %s  %s %s  (name %.2f, date %.2f, place %.2f, parents %.2f)\n",
+		   match->score, match->one->key, personToNameInBuffer(match->one, 30, one),
+		   match->two->key, personToNameInBuffer(match->two, 30, two), match->nameScore,
+		   match->dateScore, match->placeScore, match->parentScore);
+}
@@ -3,32 +3,83 @@
 // import.c has functions that import Gedcom files into internal structures.
 //
 // Created by Thomas Wetmore on 13 November 2022.
-// Last changed on 20 December 2024.
+// Last changed on 18 October 2026.
 
+#include <stdatomic.h>
 #include "import.h"
 #include "validate.h"
+#include "lineagecycles.h"
 #include "utils.h"
+#include "heapstats.h"
 
-#define gms getMsecondsStr()
+#define gms getMsecondsStrInBuffer(msecs)
 static bool timing = true;
 bool importDebugging = false;
 
-// getDatabasesFromFiles imports a list of Gedcom files into a List of Databases, one per file.
-// If errors are found in a file its Database is not created and the errors are logged.
+// ImportJob is one Gedcom file of a parallel import and its results.
+typedef struct ImportJob {
+	String path;
+	Database* database; // Null if the file had errors.
+	ErrorLog* errorLog; // Errors found in the file.
+} ImportJob;
+
+// ImportPool is the list of ImportJobs shared by the import threads.
+typedef struct ImportPool {
+	ImportJob* jobs;
+	int numJobs;
+	atomic_int next; // Index of the next job to start.
+	int vcodes;
+} ImportPool;
+
+// importWorker imports files from an ImportPool until none are left.
+static void* importWorker(void* arg) {
+	ImportPool* pool = (ImportPool*) arg;
+	int index;
+	while ((index = atomic_fetch_add(&pool->next, 1)) < pool->numJobs) {
+		ImportJob* job = pool->jobs + index;
+		job->database = getDatabaseFromFile(job->path, pool->vcodes, job->errorLog);
+	}
+	return null;
+}
+
+// getDatabasesFromFiles imports a list of Gedcom files into a List of Databases, one per file,
+// using a thread per processor. If errors are found in a file its Database is not created and
+// the errors are logged.
 static void deletedbase(void* element) { deleteDatabase((Database*) element); }
 List* getDatabasesFromFiles(List* filePaths, int vcodes, ErrorLog* errorLog) {
+	return getDatabasesFromFilesWithThreads(filePaths, vcodes, 0, errorLog);
+}
+
+// getDatabasesFromFilesWithThreads imports a list of Gedcom files with up to numThreads files
+// read at once; 0 means one thread per processor. Each file gets its own ErrorLog. The Databases
+// are returned in the order of the files, and the errors are moved to errorLog in that order.
+List* getDatabasesFromFilesWithThreads(List* filePaths, int vcodes, int numThreads,
+									   ErrorLog* errorLog) {
 	List* databases = createList(null, null, deletedbase, false);
-	Database* database = null;
-	FORLIST(filePaths, path)
-		if ((database = getDatabaseFromFile(path, vcodes, errorLog)))
-			appendToList(databases, database);
-	ENDLIST
+	int numFiles = lengthList(filePaths);
+	if (numFiles == 0) return databases;
+	ImportPool pool;
+	pool.jobs = (ImportJob*) stdalloc(numFiles*sizeof(ImportJob));
+	pool.numJobs = numFiles;
+	atomic_init(&pool.next, 0);
+	pool.vcodes = vcodes;
+	for (int i = 0; i < numFiles; i++)
+		pool.jobs[i] = (ImportJob) {getListElement(filePaths, i), null, createErrorLog()};
+	runThreads(importWorker, &pool, 0, threadCount(numThreads, numFiles));
+	for (int i = 0; i < numFiles; i++) {
+		ImportJob* job = pool.jobs + i;
+		if (job->database) appendToList(databases, job->database);
+		moveErrorsToLog(errorLog, job->errorLog);
+		deleteErrorLog(job->errorLog);
+	}
+	stdfree(pool.jobs);
 	return databases;
 }
 
 // getDatabaseFromFile returns the Database of a single Gedcom file. Returns null if no Database
 // is created, and errorLog holds the Errors found.
 Database* getDatabaseFromFile(String path, int vcodes, ErrorLog* elog) {
+	char msecs[MSECONDSLEN];
 	if (timing) printf("%s: getDatabaseFromFile: started\n", gms);
 	RootList* personRoots = createRootList();
 	RootList* familyRoots = createRootList();
@@ -40,10 +91,25 @@ Database* getDatabaseFromFile(String path, int vcodes, ErrorLog* elog) {
 	database->recordIndex = recordIndex;
 	database->personRoots = personRoots;
 	database->familyRoots = familyRoots;
+	database->journal = createJournal(path);
+	int numReplayed = replayJournal(database, elog); // Before the indexes are built.
+	if (timing && numReplayed)
+		printf("%s: getDatabaseFromFile: replayed %d journal transactions.\n", gms, numReplayed);
+	// Persons who are their own ancestors would make passes over their pedigrees loop forever.
+	checkAncestryCycles(getDatabaseLineageGraph(database), path, keymap, elog);
+	if (timing) printf("%s: getDatabaseFromFile: checked ancestry cycles\n", gms);
 	// Create the name and REFN indexes.
+	MemoryCategory category = setMemoryCategory(memIndex);
 	database->nameIndex = getNameIndex(personRoots);
 	database->refnIndex = getReferenceIndex(recordIndex, path, keymap, elog);
 	if (timing) printf("%s: getDatabaseFromFile: indexed names and REFNs.\n", gms);
+	database->nameSearchIndex = getNameSearchIndex(personRoots);
+	if (timing) printf("%s: getDatabaseFromFile: indexed name parts.\n", gms);
+	database->dateIndex = getDateIndex(recordIndex);
+	if (timing) printf("%s: getDatabaseFromFile: indexed event dates.\n", gms);
+	database->placeIndex = getPlaceIndex(recordIndex);
+	if (timing) printf("%s: getDatabaseFromFile: indexed event places.\n", gms);
+	setMemoryCategory(category);
 	if (timing) printf("%s: getDatabaseFromFile: done.\n", gms);
 	if (lengthList(elog)) {
 		deleteDatabase(database);
@@ -106,13 +172,14 @@ void checkKeysAndReferences(RootList* records, String name, IntegerTable* keymap
 // familyRoots are not null they will be filled.
 RecordIndex* getRecordIndexFromFile(String path, RootList* personRoots, RootList* familyRoots,
 									IntegerTable* keymap, ErrorLog* elog) {
+	char msecs[MSECONDSLEN];
 	if (timing) printf("%s: getRecordIndexFromFile: started.\n", gms);
 	File* file = openFile(path, "r"); // Open the file.
-	String name = strsave(file->name);
 	if (!file) {
 		addErrorToLog(elog, createError(systemError, path, 0, "Could not open file."));
 		return null;
 	}
+	String name = strsave(file->name);
 	if (!keymap) keymap = createIntegerTable(4097); // MNOTE: HOW TO GET FREED!
 	RootList* roots = getRootListFromFile(file, keymap, elog); // Get the records from file.
 	closeFile(file);
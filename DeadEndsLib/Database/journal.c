@@ -0,0 +1,350 @@
+// DeadEnds
+//
+// journal.c implements the Journal, the append-only change journal of a Database. A journal
+// file is a sequence of transactions of this form:
+//
+//     BEGIN 7
+//     REPLACE @I12@
+//     0 @I12@ INDI
+//     1 NAME John /Smith/
+//     DELETE @F3@
+//     COMMIT 7
+//
+// REPLACE is followed by the whole new version of a record, and adds the record if it is new.
+// DELETE removes a record. Both are idempotent, so replaying a transaction that is already in
+// the Gedcom file is harmless. A transaction without its COMMIT line was cut off by a crash and
+// is ignored. Record lines start with a level digit; control lines start with a letter.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "journal.h"
+#include "database.h"
+#include "gnodelist.h"
+#include "writenode.h"
+#include "gedcom.h"
+
+static bool journalDebugging = false;
+static long minCompactSize = 1 << 20; // Don't compact journals smaller than this.
+
+// createJournal creates the Journal of a Gedcom file. The journal file is not opened or created
+// until the first commit.
+Journal* createJournal(String gedcomPath) {
+	Journal* journal = (Journal*) stdalloc(sizeof(Journal));
+	journal->gedcomPath = strsave(gedcomPath);
+	journal->path = (String) stdalloc(strlen(gedcomPath) + strlen(".journal") + 1);
+	sprintf(journal->path, "%s.journal", gedcomPath);
+	journal->file = null;
+	journal->pending = createStringSet();
+	journal->sequence = 0;
+	struct stat info;
+	journal->size = stat(journal->path, &info) == 0 ? (long) info.st_size : 0;
+	long gedcomSize = stat(gedcomPath, &info) == 0 ? (long) info.st_size : 0;
+	journal->compactSize = gedcomSize/2 > minCompactSize ? gedcomSize/2 : minCompactSize;
+	journal->compactOffset = 0;
+	journal->compactor = 0;
+	return journal;
+}
+
+// deleteJournal deletes a Journal; a running compaction is waited for. Pending changes that
+// have not been committed are lost.
+void deleteJournal(Journal* journal) {
+	if (journal->compactor) waitpid(journal->compactor, null, 0);
+	if (journal->file) fclose(journal->file);
+	deleteStringSet(journal->pending, true);
+	stdfree(journal->path);
+	stdfree(journal->gedcomPath);
+	stdfree(journal);
+}
+
+// journalRecord notes that the record with a key has changed and must be in the next commit.
+void journalRecord(Journal* journal, String key) {
+	if (!key || isInSet(journal->pending, key)) return;
+	addToSet(journal->pending, strsave(key));
+}
+
+// removeRecord removes a record from the record index, root lists, PathIndexes and
+// NameSearchIndex of a Database and frees it.
+static void removeRecord(Database* database, GNode* root) {
+	removeFromPathIndexes(database, root->key);
+	if (database->nameSearchIndex) removeFromNameSearchIndex(database->nameSearchIndex, root->key);
+	RootList* roots = null;
+	RecordType rtype = recordType(root);
+	if (rtype == GRPerson) roots = database->personRoots;
+	else if (rtype == GRFamily) roots = database->familyRoots;
+	int index = -1;
+	if (roots && findInList(roots, root->key, &index)) removeFromList(roots, index);
+	removeFromHashTable(database->recordIndex, root->key);
+	freeGNodes(root);
+}
+
+// applyRecord replaces or adds a record in a Database, or removes the record with key if root
+// is null.
+static void applyRecord(Database* database, String key, GNode* root) {
+	GNode* old = searchRecordIndex(database->recordIndex, key);
+	if (old) removeRecord(database, old);
+	if (!root) return;
+	addToRecordIndex(database->recordIndex, root);
+	RecordType rtype = recordType(root);
+	if (rtype == GRPerson) insertInRootList(database->personRoots, root);
+	else if (rtype == GRFamily) insertInRootList(database->familyRoots, root);
+	updatePathIndexes(database, root);
+	if (database->nameSearchIndex) updateNameSearchIndex(database->nameSearchIndex, root);
+}
+
+// JournalOp is a change read from the journal file; root is null for a DELETE.
+typedef struct JournalOp {
+	String key;
+	GNode* root;
+} JournalOp;
+
+// clearOps empties a List of JournalOps; the records are freed if they were not applied.
+static void clearOps(List* ops, bool applied) {
+	FORLIST(ops, element)
+		JournalOp* op = (JournalOp*) element;
+		if (!applied && op->root) freeGNodes(op->root);
+		stdfree(op->key);
+		stdfree(op);
+	ENDLIST
+	emptyList(ops);
+}
+
+// readJournalFile returns the contents of a journal file, or null if there is none.
+static String readJournalFile(String path, long* size) {
+	FILE* file = fopen(path, "r");
+	if (!file) return null;
+	fseek(file, 0, SEEK_END);
+	*size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	String contents = (String) stdalloc(*size + 1);
+	*size = (long) fread(contents, 1, *size, file);
+	contents[*size] = 0;
+	fclose(file);
+	return contents;
+}
+
+
+// replayJournal applies the committed transactions in the journal file of a Database to its
+// records. It must be called before the other indexes of the Database are built. A transaction
+// cut off by a crash is dropped from the file. Returns the number of transactions applied.
+int replayJournal(Database* database, ErrorLog* log) {
+	Journal* journal = database->journal;
+	long size = 0;
+	String contents = readJournalFile(journal->path, &size);
+	if (!contents) return 0;
+	String name = strsave(journal->path); // MNOTE: Errors keep the name, so it is not freed.
+	List* ops = createList(null, null, null, false);
+	int count = 0;
+	long committed = 0; // Offset after the last COMMIT line.
+	int lineno = 0;
+	String p = contents;
+	while (*p) {
+		lineno++;
+		String end = strchr(p, '\n');
+		if (!end) break; // A partial last line is never part of a committed transaction.
+		*end = 0;
+		char key[MAXLINELEN];
+		int sequence;
+		if (sscanf(p, "BEGIN %d", &sequence) == 1) {
+			clearOps(ops, false);
+		} else if (sscanf(p, "COMMIT %d", &sequence) == 1) {
+			FORLIST(ops, element)
+				JournalOp* op = (JournalOp*) element;
+				applyRecord(database, op->key, op->root);
+			ENDLIST
+			clearOps(ops, true);
+			journal->sequence = sequence;
+			committed = end + 1 - contents;
+			count++;
+		} else if (sscanf(p, "DELETE %s", key) == 1) {
+			JournalOp* op = (JournalOp*) stdalloc(sizeof(JournalOp));
+			op->key = strsave(key);
+			op->root = null;
+			appendToList(ops, op);
+		} else if (sscanf(p, "REPLACE %s", key) == 1) {
+			String record = end + 1; // Record lines run to the next control line.
+			String last = record;
+			while (*last >= '0' && *last <= '9') {
+				String next = strchr(last, '\n');
+				if (!next) break;
+				last = next + 1;
+				lineno++;
+			}
+			if (!*last) break; // Cut off in the middle of the record.
+			char save = *last;
+			*last = 0;
+			RootList* roots = getGNodeTreesFromString(record, name, log);
+			*last = save;
+			if (!roots || lengthList(roots) != 1) {
+				addErrorToLog(log, createError(gedcomError, name, lineno, "bad record in journal"));
+				break;
+			}
+			JournalOp* op = (JournalOp*) stdalloc(sizeof(JournalOp));
+			op->key = strsave(key);
+			op->root = (GNode*) getListElement(roots, 0);
+			appendToList(ops, op);
+			deleteList(roots);
+			end = last - 1;
+		} else {
+			addErrorToLog(log, createError(gedcomError, name, lineno, "bad journal line"));
+			break;
+		}
+		p = end + 1;
+	}
+	clearOps(ops, false);
+	deleteList(ops);
+	stdfree(contents);
+	if (committed < size && lengthList(log) == 0) truncate(journal->path, committed);
+	journal->size = committed;
+	if (journalDebugging) fprintf(stderr, "Replayed %d transactions from %s.\n", count, journal->path);
+	return count;
+}
+
+// syncFile flushes a file to disk.
+static bool syncFile(FILE* file) {
+	return fflush(file) == 0 && fsync(fileno(file)) == 0;
+}
+
+// commitJournal appends the records changed since the last commit to the journal file as one
+// transaction and syncs it. If the Database is not dirty nothing is written. A background
+// compaction is started when the journal grows large. Returns false if the write fails.
+bool commitJournal(Database* database) {
+	Journal* journal = database->journal;
+	if (!journal) return false;
+	finishCompaction(database, false);
+	if (!database->dirty || lengthSet(journal->pending) == 0) {
+		database->dirty = false;
+		return true;
+	}
+	if (!journal->file && !(journal->file = fopen(journal->path, "a"))) return false;
+	FILE* file = journal->file;
+	fprintf(file, "BEGIN %d\n", journal->sequence + 1);
+	FORSET(journal->pending, element)
+		String key = (String) element;
+		GNode* root = searchRecordIndex(database->recordIndex, key);
+		if (root) {
+			fprintf(file, "REPLACE %s\n", key);
+			writeGNodeRecord(file, root, false);
+		} else {
+			fprintf(file, "DELETE %s\n", key);
+		}
+	ENDSET
+	fprintf(file, "COMMIT %d\n", journal->sequence + 1);
+	if (!syncFile(file)) return false;
+	journal->sequence++;
+	journal->size = ftell(file);
+	deleteStringSet(journal->pending, true);
+	journal->pending = createStringSet();
+	database->dirty = false;
+	if (!journal->compactor && journal->size > journal->compactSize) compactJournal(database, true);
+	return true;
+}
+
+// copyHeader copies the header record of a Gedcom file to another file.
+static void copyHeader(String path, FILE* out) {
+	FILE* in = fopen(path, "r");
+	if (!in) return;
+	char line[MAXLINELEN];
+	bool inHeader = false;
+	while (fgets(line, MAXLINELEN, in)) {
+		if (line[0] == '0') {
+			if (inHeader) break;
+			inHeader = strncmp(line, "0 HEAD", 6) == 0;
+		}
+		if (inHeader) fputs(line, out);
+	}
+	fclose(in);
+}
+
+// writeGedcomFile writes the records of a Database to a Gedcom file and syncs it. The header is
+// copied from the current Gedcom file if the Database does not have one.
+static bool writeGedcomFile(Database* database, String path) {
+	FILE* file = fopen(path, "w");
+	if (!file) return false;
+	if (database->header) writeGNodeRecord(file, database->header, false);
+	else copyHeader(database->journal->gedcomPath, file);
+	FORHASHTABLE(database->recordIndex, element)
+		writeGNodeRecord(file, (GNode*) element, false);
+	ENDHASHTABLE
+	fprintf(file, "0 TRLR\n");
+	bool okay = syncFile(file);
+	return fclose(file) == 0 && okay;
+}
+
+// compactPath returns the path of the temporary file a compaction writes to.
+static String compactPath(Journal* journal, String buffer, int length) {
+	snprintf(buffer, length, "%s.compact", journal->gedcomPath);
+	return buffer;
+}
+
+// compactJournal rewrites the Gedcom file of a Database from its records and empties the
+// journal. If background is true the file is written by a forked process that sees the records
+// as they were at the fork, and finishCompaction completes the work; the Database can be edited
+// and committed in the meantime. Pending changes should be committed first.
+bool compactJournal(Database* database, bool background) {
+	Journal* journal = database->journal;
+	if (!journal || journal->compactor) return false;
+	char path[MAXLINELEN];
+	compactPath(journal, path, MAXLINELEN);
+	journal->compactOffset = journal->size;
+	if (!background) {
+		if (!writeGedcomFile(database, path)) return false;
+		journal->compactor = -1; // Mark a compaction as done.
+		return finishCompaction(database, true);
+	}
+	fflush(stdout); // So the child does not write buffered output again.
+	fflush(stderr);
+	pid_t pid = fork();
+	if (pid < 0) return false;
+	if (pid == 0) _exit(writeGedcomFile(database, path) ? 0 : 1);
+	journal->compactor = pid;
+	return true;
+}
+
+// finishCompaction completes a compaction whose Gedcom file has been written. The new file
+// replaces the Gedcom file, and the transactions committed after the compaction started are
+// moved to a new journal file. If wait is false and the compaction is still running, nothing
+// is done. Returns true if a compaction was completed.
+bool finishCompaction(Database* database, bool wait) {
+	Journal* journal = database->journal;
+	if (!journal || !journal->compactor) return false;
+	char path[MAXLINELEN];
+	compactPath(journal, path, MAXLINELEN);
+	if (journal->compactor > 0) {
+		int status;
+		pid_t pid = waitpid(journal->compactor, &status, wait ? 0 : WNOHANG);
+		if (pid == 0) return false; // Still running.
+		journal->compactor = 0;
+		if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			unlink(path);
+			return false;
+		}
+	}
+	journal->compactor = 0;
+	if (rename(path, journal->gedcomPath) != 0) return false;
+	// Copy the journal's tail to a new journal file. A crash before the rename below replays
+	// transactions already in the new Gedcom file, which is harmless.
+	long size = 0;
+	String contents = readJournalFile(journal->path, &size);
+	char newPath[MAXLINELEN];
+	snprintf(newPath, MAXLINELEN, "%s.new", journal->path);
+	FILE* file = fopen(newPath, "w");
+	if (!file) {
+		if (contents) stdfree(contents);
+		return false;
+	}
+	if (contents && size > journal->compactOffset)
+		fwrite(contents + journal->compactOffset, 1, size - journal->compactOffset, file);
+	if (contents) stdfree(contents);
+	bool okay = syncFile(file);
+	journal->size = ftell(file);
+	fclose(file);
+	if (!okay || rename(newPath, journal->path) != 0) return false;
+	if (journal->file) fclose(journal->file);
+	journal->file = null; // Reopened at the next commit.
+	if (journalDebugging) fprintf(stderr, "Compacted %s.\n", journal->gedcomPath);
+	return true;
+}
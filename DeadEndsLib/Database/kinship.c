@@ -0,0 +1,325 @@
+// DeadEnds
+//
+// kinship.c implements the kinship calculator. The kinship coefficient of two persons is the
+// chance that alleles taken at random from each are identical by descent; the inbreeding
+// coefficient of a person is the kinship coefficient of the parents. They are found by the
+// standard recursion: the kinship of a person with itself is (1 + F)/2, where F is the person's
+// inbreeding coefficient, and the kinship of two persons is the mean of the kinships of the earlier
+// one with the parents of the later one, where earlier and later are by a topological order of the
+// persons that puts parents before their children. Persons without parents have kinship 0 with
+// everyone else. Persons on a parent cycle, and their descendents, aren't in the order and are
+// treated as having no parents. Coefficients are kept in a sparse cache of pairs.
+//
+// Computing the coefficients of all persons is split by the connected pedigrees of the graph;
+// persons in different pedigrees have no common ancestors, so each thread takes whole pedigrees
+// and keeps its own cache.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <stdatomic.h>
+#include "kinship.h"
+#include "utils.h"
+#include "unionfind.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+#define INITIALKINSHIPCACHE 4096
+#define MAXKINSHIPTHREADS 8
+
+// initCache initializes an empty KinshipCache.
+static void initCache(KinshipCache* cache) {
+	cache->capacity = INITIALKINSHIPCACHE;
+	cache->count = 0;
+	cache->keys = (uint64_t*) stdalloc(cache->capacity*sizeof(uint64_t));
+	memset(cache->keys, 0, cache->capacity*sizeof(uint64_t));
+	cache->values = (double*) stdalloc(cache->capacity*sizeof(double));
+}
+
+// termCache frees the arrays of a KinshipCache.
+static void termCache(KinshipCache* cache) {
+	stdfree(cache->keys);
+	stdfree(cache->values);
+}
+
+// pairKey returns the cache key of a pair of persons; ids are offset by 1 so no key is 0.
+static uint64_t pairKey(int a, int b) {
+	if (a > b) {
+		int swap = a;
+		a = b;
+		b = swap;
+	}
+	return ((uint64_t) (a + 1) << 32) | (uint64_t) (b + 1);
+}
+
+// slotOf returns the slot of a key in a KinshipCache, where it is or would go.
+static int slotOf(KinshipCache* cache, uint64_t key) {
+	int mask = cache->capacity - 1;
+	int slot = (int) ((key*0x9E3779B97F4A7C15ULL) >> 40) & mask;
+	while (cache->keys[slot] && cache->keys[slot] != key) slot = (slot + 1) & mask;
+	return slot;
+}
+
+// searchCache looks up a pair in a KinshipCache; returns true and sets value if it is there.
+static bool searchCache(KinshipCache* cache, uint64_t key, double* value) {
+	int slot = slotOf(cache, key);
+	if (!cache->keys[slot]) return false;
+	*value = cache->values[slot];
+	return true;
+}
+
+// addToCache adds a pair to a KinshipCache, doubling the table when it is half full.
+static void addToCache(KinshipCache* cache, uint64_t key, double value) {
+	if (2*(cache->count + 1) > cache->capacity) {
+		uint64_t* keys = cache->keys;
+		double* values = cache->values;
+		int capacity = cache->capacity;
+		cache->capacity *= 2;
+		cache->keys = (uint64_t*) stdalloc(cache->capacity*sizeof(uint64_t));
+		memset(cache->keys, 0, cache->capacity*sizeof(uint64_t));
+		cache->values = (double*) stdalloc(cache->capacity*sizeof(double));
+		for (int i = 0; i < capacity; i++) {
+			if (!keys[i]) continue;
+			int slot = slotOf(cache, keys[i]);
+			cache->keys[slot] = keys[i];
+			cache->values[slot] = values[i];
+		}
+		stdfree(keys);
+		stdfree(values);
+	}
+	int slot = slotOf(cache, key);
+	if (!cache->keys[slot]) cache->count++;
+	cache->keys[slot] = key;
+	cache->values[slot] = value;
+}
+
+// createKinship creates a Kinship for a LineageGraph.
+Kinship* createKinship(LineageGraph* graph) {
+	Kinship* kinship = (Kinship*) stdalloc(sizeof(Kinship));
+	kinship->graph = graph;
+	kinship->rank = (int*) stdalloc((graph->numPersons + 1)*sizeof(int));
+	kinship->ordered = (int*) stdalloc((graph->numPersons + 1)*sizeof(int));
+	kinship->numOrdered = orderLineageGraph(graph, kinship->ordered, kinship->rank);
+	initCache(&kinship->cache);
+	kinship->inbreeding = null;
+	return kinship;
+}
+
+// deleteKinship deletes a Kinship.
+void deleteKinship(Kinship* kinship) {
+	stdfree(kinship->rank);
+	stdfree(kinship->ordered);
+	termCache(&kinship->cache);
+	if (kinship->inbreeding) stdfree(kinship->inbreeding);
+	stdfree(kinship);
+}
+
+// parentOf returns a parent of a person, or -1; persons not in the order have no parents.
+static int parentOf(Kinship* kinship, int id, int which) {
+	return kinship->rank[id] < 0 ? -1 : kinship->graph->parents[2*id + which];
+}
+
+// Pair is a pair of persons on the stack of a kinship computation.
+typedef struct Pair {
+	int a, b;
+} Pair;
+
+// PairStack is the stack of pairs whose kinship is being found.
+typedef struct PairStack {
+	Pair* pairs;
+	int length, room;
+} PairStack;
+
+// pushPair pushes a pair on a PairStack.
+static void pushPair(PairStack* stack, int a, int b) {
+	if (stack->length == stack->room) {
+		stack->room = stack->room ? 2*stack->room : 64;
+		Pair* pairs = (Pair*) stdalloc(stack->room*sizeof(Pair));
+		if (stack->pairs) {
+			memcpy(pairs, stack->pairs, stack->length*sizeof(Pair));
+			stdfree(stack->pairs);
+		}
+		stack->pairs = pairs;
+	}
+	stack->pairs[stack->length++] = (Pair) {a, b};
+}
+
+// knownKinship returns true and sets value if the kinship of a pair is known without recursion:
+// it is trivial or in the cache.
+static bool knownKinship(Kinship* kinship, KinshipCache* cache, int a, int b, double* value) {
+	if (a < 0 || b < 0) {
+		*value = 0.0;
+		return true;
+	}
+	if (a != b) {
+		int later = kinship->rank[a] > kinship->rank[b] ? a : b;
+		if (parentOf(kinship, later, 0) < 0 && parentOf(kinship, later, 1) < 0) {
+			*value = 0.0; // The later person has no parents, so the earlier isn't its ancestor.
+			return true;
+		}
+	} else if (parentOf(kinship, a, 0) < 0 || parentOf(kinship, a, 1) < 0) {
+		*value = 0.5;
+		return true;
+	}
+	return searchCache(cache, pairKey(a, b), value);
+}
+
+// findKinship returns the kinship coefficient of a pair, using and filling a cache. The
+// recursion uses an explicit stack since pedigrees may be deep.
+static double findKinship(Kinship* kinship, KinshipCache* cache, int a, int b) {
+	double value;
+	if (knownKinship(kinship, cache, a, b, &value)) return value;
+	PairStack stack = {null, 0, 0};
+	pushPair(&stack, a, b);
+	while (stack.length > 0) {
+		Pair pair = stack.pairs[stack.length - 1];
+		int x, y, z; // Kinship of the pair is from the kinships of (x, y) and (x, z).
+		if (pair.a == pair.b) {
+			x = parentOf(kinship, pair.a, 0);
+			y = z = parentOf(kinship, pair.a, 1);
+		} else {
+			int later = kinship->rank[pair.a] > kinship->rank[pair.b] ? pair.a : pair.b;
+			x = later == pair.a ? pair.b : pair.a;
+			y = parentOf(kinship, later, 0);
+			z = parentOf(kinship, later, 1);
+		}
+		double first, second;
+		bool knowFirst = knownKinship(kinship, cache, x, y, &first);
+		bool knowSecond = knownKinship(kinship, cache, x, z, &second);
+		if (!knowFirst) pushPair(&stack, x, y);
+		if (!knowSecond && (knowFirst || y != z)) pushPair(&stack, x, z);
+		if (!knowFirst || !knowSecond) continue;
+		stack.length--;
+		value = pair.a == pair.b ? (1.0 + first)/2.0 : (first + second)/2.0;
+		addToCache(cache, pairKey(pair.a, pair.b), value);
+	}
+	stdfree(stack.pairs);
+	return value;
+}
+
+// startQuery empties the shared cache if it has grown past its limit; it is only emptied between
+// queries since a query needs the pairs it has found.
+static void startQuery(Kinship* kinship) {
+	if (kinship->cache.count <= MAXKINSHIPCACHE) return;
+	termCache(&kinship->cache);
+	initCache(&kinship->cache);
+}
+
+// kinshipCoefficient returns the kinship coefficient of two persons.
+double kinshipCoefficient(Kinship* kinship, int a, int b) {
+	int numPersons = kinship->graph->numPersons;
+	if (a < 0 || a >= numPersons || b < 0 || b >= numPersons) return 0.0;
+	startQuery(kinship);
+	return findKinship(kinship, &kinship->cache, a, b);
+}
+
+// inbreedingCoefficient returns the inbreeding coefficient of a person.
+double inbreedingCoefficient(Kinship* kinship, int id) {
+	if (id < 0 || id >= kinship->graph->numPersons) return 0.0;
+	startQuery(kinship);
+	return findKinship(kinship, &kinship->cache, parentOf(kinship, id, 0), parentOf(kinship, id, 1));
+}
+
+// Pedigrees are the connected pedigrees of a Kinship, each with its persons in order.
+typedef struct Pedigrees {
+	Kinship* kinship;
+	int* first; // The persons of pedigree i are persons[first[i]..first[i+1]-1].
+	int* persons;
+	int count;
+	int* bySize; // Pedigrees, largest first.
+	atomic_int next; // Index in bySize of the next pedigree to compute.
+	double* coefficients; // Inbreeding coefficients by person id.
+} Pedigrees;
+
+// findPedigrees splits the persons of a Kinship into connected pedigrees.
+static void findPedigrees(Kinship* kinship, Pedigrees* pedigrees) {
+	LineageGraph* graph = kinship->graph;
+	int numPersons = graph->numPersons;
+	UnionFind* unionFind = createUnionFind(numPersons);
+	for (int i = 0; i < 2*numPersons; i++)
+		if (graph->parents[i] >= 0) uniteUnionFind(unionFind, i/2, graph->parents[i]);
+	// Number the pedigrees, and list their persons in order; unordered persons come last.
+	int* number = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	pedigrees->count = labelComponents(unionFind, number);
+	deleteUnionFind(unionFind);
+	pedigrees->first = (int*) stdalloc((pedigrees->count + 2)*sizeof(int));
+	memset(pedigrees->first, 0, (pedigrees->count + 2)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) pedigrees->first[number[i] + 1]++;
+	for (int i = 0; i < pedigrees->count; i++) pedigrees->first[i + 1] += pedigrees->first[i];
+	int* next = (int*) stdalloc((pedigrees->count + 1)*sizeof(int));
+	memcpy(next, pedigrees->first, pedigrees->count*sizeof(int));
+	pedigrees->persons = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	for (int i = 0; i < kinship->numOrdered; i++) {
+		int id = kinship->ordered[i];
+		pedigrees->persons[next[number[id]]++] = id;
+	}
+	for (int i = 0; i < numPersons; i++)
+		if (kinship->rank[i] < 0) pedigrees->persons[next[number[i]]++] = i;
+	// Sort the pedigrees by size, largest first, so the largest start first.
+	pedigrees->bySize = (int*) stdalloc((pedigrees->count + 1)*sizeof(int));
+	memset(next, 0, (pedigrees->count + 1)*sizeof(int));
+	int maxSize = 0;
+	for (int i = 0; i < pedigrees->count; i++) {
+		int size = pedigrees->first[i + 1] - pedigrees->first[i];
+		if (size > maxSize) maxSize = size;
+	}
+	int* bySize = (int*) stdalloc((maxSize + 2)*sizeof(int)); // Counting sort on size.
+	memset(bySize, 0, (maxSize + 2)*sizeof(int));
+	for (int i = 0; i < pedigrees->count; i++) bySize[pedigrees->first[i + 1] - pedigrees->first[i]]++;
+	for (int size = maxSize, position = 0; size >= 0; size--) {
+		int count = bySize[size];
+		bySize[size] = position;
+		position += count;
+	}
+	for (int i = 0; i < pedigrees->count; i++)
+		pedigrees->bySize[bySize[pedigrees->first[i + 1] - pedigrees->first[i]]++] = i;
+	stdfree(bySize);
+	stdfree(next);
+	stdfree(number);
+}
+
+// computePedigrees computes the inbreeding coefficients of the pedigrees a thread takes. The
+// persons of a pedigree are done in order, so the kinships of their parents are mostly cached.
+static void* computePedigrees(void* arg) {
+	Pedigrees* pedigrees = (Pedigrees*) arg;
+	Kinship* kinship = pedigrees->kinship;
+	int index;
+	while ((index = atomic_fetch_add(&pedigrees->next, 1)) < pedigrees->count) {
+		int pedigree = pedigrees->bySize[index];
+		KinshipCache cache;
+		initCache(&cache);
+		for (int i = pedigrees->first[pedigree]; i < pedigrees->first[pedigree + 1]; i++) {
+			int id = pedigrees->persons[i];
+			pedigrees->coefficients[id] = findKinship(kinship, &cache, parentOf(kinship, id, 0),
+													  parentOf(kinship, id, 1));
+		}
+		termCache(&cache);
+	}
+	return null;
+}
+
+// allInbreedingCoefficients returns the inbreeding coefficients of all persons, by id. Separate
+// pedigrees are computed by separate threads. The caller owns the array.
+double* allInbreedingCoefficients(Kinship* kinship) {
+	int numPersons = kinship->graph->numPersons;
+	Pedigrees pedigrees;
+	pedigrees.kinship = kinship;
+	pedigrees.coefficients = (double*) stdalloc((numPersons + 1)*sizeof(double));
+	findPedigrees(kinship, &pedigrees);
+	atomic_init(&pedigrees.next, 0);
+	int limit = pedigrees.count < MAXKINSHIPTHREADS ? pedigrees.count : MAXKINSHIPTHREADS;
+	runThreads(computePedigrees, &pedigrees, 0, threadCount(0, limit));
+	stdfree(pedigrees.first);
+	stdfree(pedigrees.persons);
+	stdfree(pedigrees.bySize);
+	return pedigrees.coefficients;
+}
+
+// writeInbreedingColumn writes the key and inbreeding coefficient of each person, one per line.
+// The coefficients are found the first time and kept in the Kinship for later columns.
+void writeInbreedingColumn(Kinship* kinship, FILE* file) {
+	if (!kinship->inbreeding) kinship->inbreeding = allInbreedingCoefficients(kinship);
+	for (int i = 0; i < kinship->graph->numPersons; i++)
+		fprintf(file, "%s\t%.8g\n", kinship->graph->persons[i]->key, kinship->inbreeding[i]);
+}
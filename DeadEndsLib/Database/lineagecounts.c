@@ -0,0 +1,322 @@
+// DeadEnds
+//
+// lineagecounts.c counts the distinct ancestors and descendents of every person in a LineageGraph.
+// A person's parents are those of all its FAMC families, so a person with adoptive and birth
+// families counts the ancestors of both. The ancestors of a person are the union of its parents
+// and their ancestors, so the sets are built in topological order, a generation at a time: a
+// person's generation is one more than the highest generation of its parents (of its children,
+// for descendents). The persons of a generation don't depend on each other and are done by
+// several threads when there are many. A person's set is freed once every person that uses it is
+// done.
+//
+// Exact counts use a bit set per person, with a bit for each person in its connected pedigree.
+// When those would be too large the counts are estimated with a HyperLogLog sketch per person;
+// the union of two sketches is the maximum of their registers. Persons on a parent cycle, and
+// their descendents, are treated as having no parents.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <stdint.h>
+#include "lineagecounts.h"
+#include "utils.h"
+#include "unionfind.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+#define HLLBITS 10 // Register index bits; the standard error is about 1.04/sqrt(1 << HLLBITS).
+#define HLLREGISTERS (1 << HLLBITS)
+#define PARALLELLEVEL 512 // Smallest generation done by several threads.
+#define MAXCOUNTTHREADS 8
+
+// CountPlan is the state of counting the ancestors or the descendents of all persons.
+typedef struct CountPlan {
+	int numPersons;
+	int* firstInput; // The inputs of person i, its parents or children, are
+	int* inputs; // inputs[firstInput[i]..firstInput[i+1]-1].
+	int* pending; // Number of persons not yet done that use each person's set.
+	int* byLevel; // Persons by generation.
+	int* levelStart; // Generation g is byLevel[levelStart[g]..levelStart[g+1]-1].
+	int numLevels;
+	bool exact;
+	int* local; // Bit of each person in its pedigree's bit sets.
+	int* words; // Words in the bit sets of each person's pedigree.
+	void** sets; // Bit set or sketch of each person; null before it is found and after it is freed.
+	int* counts;
+} CountPlan;
+
+// mix returns a 64 bit hash of a person id.
+static uint64_t mix(int id) {
+	uint64_t x = (uint64_t) id + 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30))*0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27))*0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// addToSketch adds a person to a HyperLogLog sketch.
+static void addToSketch(uint8_t* sketch, int id) {
+	uint64_t hash = mix(id);
+	int index = (int) (hash >> (64 - HLLBITS));
+	uint8_t rho = (uint8_t) (__builtin_clzll((hash << HLLBITS) | (1ULL << (HLLBITS - 1))) + 1);
+	if (rho > sketch[index]) sketch[index] = rho;
+}
+
+// estimateSketch returns the estimated number of persons in a HyperLogLog sketch, using linear
+// counting when the estimate is small.
+static int estimateSketch(uint8_t* sketch) {
+	double m = HLLREGISTERS, sum = 0.0;
+	int zeros = 0;
+	for (int i = 0; i < HLLREGISTERS; i++) {
+		sum += 1.0/(double) (1ULL << sketch[i]);
+		if (sketch[i] == 0) zeros++;
+	}
+	double estimate = 0.7213/(1.0 + 1.079/m)*m*m/sum;
+	if (estimate <= 2.5*m && zeros > 0) estimate = m*__builtin_log(m/zeros);
+	return (int) (estimate + 0.5);
+}
+
+// findSet finds the set and count of a person from its inputs' sets.
+static void findSet(CountPlan* plan, int id) {
+	int first = plan->firstInput[id], last = plan->firstInput[id + 1];
+	void* set = null;
+	plan->counts[id] = 0;
+	if (first == last) return; // The empty set is left null.
+	if (plan->exact) {
+		int words = plan->words[id];
+		uint64_t* bits = (uint64_t*) stdalloc((words + 1)*sizeof(uint64_t));
+		memset(bits, 0, (words + 1)*sizeof(uint64_t));
+		for (int i = first; i < last; i++) {
+			int input = plan->inputs[i];
+			bits[plan->local[input] >> 6] |= (uint64_t) 1 << (plan->local[input] & 63);
+			uint64_t* inputBits = (uint64_t*) plan->sets[input];
+			if (inputBits) for (int w = 0; w < words; w++) bits[w] |= inputBits[w];
+		}
+		int count = 0;
+		for (int w = 0; w < words; w++) count += __builtin_popcountll(bits[w]);
+		plan->counts[id] = count;
+		set = bits;
+	} else {
+		uint8_t* sketch = (uint8_t*) stdalloc(HLLREGISTERS);
+		memset(sketch, 0, HLLREGISTERS);
+		for (int i = first; i < last; i++) {
+			int input = plan->inputs[i];
+			addToSketch(sketch, input);
+			uint8_t* inputSketch = (uint8_t*) plan->sets[input];
+			if (inputSketch) for (int r = 0; r < HLLREGISTERS; r++)
+				if (inputSketch[r] > sketch[r]) sketch[r] = inputSketch[r];
+		}
+		plan->counts[id] = estimateSketch(sketch);
+		set = sketch;
+	}
+	if (plan->pending[id] > 0) plan->sets[id] = set;
+	else stdfree(set);
+}
+
+// LevelPart is part of a generation done by one thread.
+typedef struct LevelPart {
+	CountPlan* plan;
+	int first, last; // byLevel[first..last-1].
+} LevelPart;
+
+// findLevelPart finds the sets of the persons in part of a generation.
+static void* findLevelPart(void* arg) {
+	LevelPart* part = (LevelPart*) arg;
+	for (int i = part->first; i < part->last; i++) findSet(part->plan, part->plan->byLevel[i]);
+	return null;
+}
+
+// findLevel finds the sets of the persons in a generation, then frees the sets no longer used.
+static void findLevel(CountPlan* plan, int level) {
+	int first = plan->levelStart[level], last = plan->levelStart[level + 1];
+	int numThreads = last - first >= PARALLELLEVEL ? threadCount(0, MAXCOUNTTHREADS) : 1;
+	LevelPart parts[MAXCOUNTTHREADS];
+	for (int i = 0; i < numThreads; i++)
+		parts[i] = (LevelPart) {plan, first + (int) ((long) (last - first)*i/numThreads),
+			first + (int) ((long) (last - first)*(i + 1)/numThreads)};
+	runThreads(findLevelPart, parts, sizeof(LevelPart), numThreads);
+	for (int i = first; i < last; i++) {
+		int id = plan->byLevel[i];
+		for (int j = plan->firstInput[id]; j < plan->firstInput[id + 1]; j++) {
+			int input = plan->inputs[j];
+			if (--plan->pending[input] == 0 && plan->sets[input]) {
+				stdfree(plan->sets[input]);
+				plan->sets[input] = null;
+			}
+		}
+	}
+}
+
+// orderAllParents puts the persons of a LineageGraph in topological order over the parents of
+// all their FAMC families, as orderLineageGraph does over the parents of the first, and sets the
+// rank of each person. Persons on a cycle of these links, and their descendents, are left out and
+// have rank -1. Returns the number ordered.
+static int orderAllParents(LineageGraph* graph, int* ordered, int* rank) {
+	int numPersons = graph->numPersons;
+	int* firstChild = (int*) stdalloc((numPersons + 2)*sizeof(int));
+	int* numParents = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	memset(firstChild, 0, (numPersons + 2)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) {
+		numParents[i] = graph->firstParent[i + 1] - graph->firstParent[i];
+		for (int j = graph->firstParent[i]; j < graph->firstParent[i + 1]; j++)
+			firstChild[graph->allParents[j] + 1]++;
+	}
+	for (int i = 0; i < numPersons; i++) firstChild[i + 1] += firstChild[i];
+	int* children = (int*) stdalloc((firstChild[numPersons] + 1)*sizeof(int));
+	int* next = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	memcpy(next, firstChild, numPersons*sizeof(int));
+	for (int i = 0; i < numPersons; i++)
+		for (int j = graph->firstParent[i]; j < graph->firstParent[i + 1]; j++)
+			children[next[graph->allParents[j]]++] = i;
+
+	// Kahn's algorithm; ordered is also the queue.
+	int length = 0;
+	for (int i = 0; i < numPersons; i++) {
+		rank[i] = -1;
+		if (numParents[i] == 0) ordered[length++] = i;
+	}
+	for (int head = 0; head < length; head++) {
+		int person = ordered[head];
+		rank[person] = head;
+		for (int j = firstChild[person]; j < firstChild[person + 1]; j++)
+			if (--numParents[children[j]] == 0) ordered[length++] = children[j];
+	}
+	stdfree(firstChild);
+	stdfree(numParents);
+	stdfree(children);
+	stdfree(next);
+	return length;
+}
+
+// planCounts sets up a CountPlan. The inputs of a person are its parents if up is true, else the
+// persons it is a parent of; only persons in the topological order have inputs.
+static void planCounts(CountPlan* plan, LineageGraph* graph, int* ordered, int numOrdered,
+					   int* rank, bool up) {
+	int numPersons = graph->numPersons;
+	int* firstParent = graph->firstParent, * allParents = graph->allParents;
+	plan->numPersons = numPersons;
+	plan->firstInput = (int*) stdalloc((numPersons + 2)*sizeof(int));
+	plan->pending = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	memset(plan->firstInput, 0, (numPersons + 2)*sizeof(int));
+	memset(plan->pending, 0, (numPersons + 1)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) {
+		if (rank[i] < 0) continue;
+		for (int j = firstParent[i]; j < firstParent[i + 1]; j++) {
+			plan->firstInput[(up ? i : allParents[j]) + 1]++;
+			plan->pending[up ? allParents[j] : i]++;
+		}
+	}
+	for (int i = 0; i < numPersons; i++) plan->firstInput[i + 1] += plan->firstInput[i];
+	plan->inputs = (int*) stdalloc((plan->firstInput[numPersons] + 1)*sizeof(int));
+	int* next = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	memcpy(next, plan->firstInput, numPersons*sizeof(int));
+	for (int i = 0; i < numPersons; i++) {
+		if (rank[i] < 0) continue;
+		for (int j = firstParent[i]; j < firstParent[i + 1]; j++) {
+			if (up) plan->inputs[next[i]++] = allParents[j];
+			else plan->inputs[next[allParents[j]]++] = i;
+		}
+	}
+
+	// A person's generation is one more than the highest of its inputs; inputs come first in the
+	// topological order for ancestors and last for descendents.
+	int* level = next;
+	memset(level, 0, (numPersons + 1)*sizeof(int));
+	plan->numLevels = 1;
+	for (int k = 0; k < numOrdered; k++) {
+		int id = ordered[up ? k : numOrdered - 1 - k];
+		for (int j = plan->firstInput[id]; j < plan->firstInput[id + 1]; j++)
+			if (level[plan->inputs[j]] + 1 > level[id]) level[id] = level[plan->inputs[j]] + 1;
+		if (level[id] + 1 > plan->numLevels) plan->numLevels = level[id] + 1;
+	}
+	plan->levelStart = (int*) stdalloc((plan->numLevels + 2)*sizeof(int));
+	memset(plan->levelStart, 0, (plan->numLevels + 2)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) plan->levelStart[level[i] + 1]++;
+	for (int g = 0; g < plan->numLevels; g++) plan->levelStart[g + 1] += plan->levelStart[g];
+	int* fill = (int*) stdalloc((plan->numLevels + 1)*sizeof(int));
+	memcpy(fill, plan->levelStart, plan->numLevels*sizeof(int));
+	plan->byLevel = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) plan->byLevel[fill[level[i]]++] = i;
+	stdfree(fill);
+	stdfree(next);
+	plan->sets = (void**) stdalloc((numPersons + 1)*sizeof(void*));
+	memset(plan->sets, 0, (numPersons + 1)*sizeof(void*));
+}
+
+// termPlan frees the arrays of a CountPlan that aren't shared.
+static void termPlan(CountPlan* plan) {
+	stdfree(plan->firstInput);
+	stdfree(plan->inputs);
+	stdfree(plan->pending);
+	stdfree(plan->byLevel);
+	stdfree(plan->levelStart);
+	for (int i = 0; i < plan->numPersons; i++) if (plan->sets[i]) stdfree(plan->sets[i]);
+	stdfree(plan->sets);
+}
+
+// findPedigreeBits gives each person a bit in the bit sets of its connected pedigree, sets the
+// words in those bit sets, and returns the bytes all the bit sets would take at once.
+static double findPedigreeBits(LineageGraph* graph, int* rank, int* local, int* words) {
+	int numPersons = graph->numPersons;
+	UnionFind* unionFind = createUnionFind(numPersons);
+	for (int i = 0; i < numPersons; i++)
+		for (int j = graph->firstParent[i]; j < graph->firstParent[i + 1] && rank[i] >= 0; j++)
+			uniteUnionFind(unionFind, i, graph->allParents[j]);
+	int* pedigree = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int numPedigrees = labelComponents(unionFind, pedigree);
+	deleteUnionFind(unionFind);
+	int* sizes = (int*) stdalloc((numPedigrees + 1)*sizeof(int));
+	memset(sizes, 0, (numPedigrees + 1)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) local[i] = sizes[pedigree[i]]++;
+	double bytes = 0.0;
+	for (int i = 0; i < numPersons; i++) {
+		words[i] = (sizes[pedigree[i]] + 63)/64;
+		bytes += 8.0*words[i];
+	}
+	stdfree(sizes);
+	stdfree(pedigree);
+	return bytes;
+}
+
+// getLineageCounts counts the distinct ancestors and descendents of every person in a
+// LineageGraph.
+LineageCounts* getLineageCounts(LineageGraph* graph, LineageCountMode mode) {
+	int numPersons = graph->numPersons;
+	int* ordered = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int* rank = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int numOrdered = orderAllParents(graph, ordered, rank);
+	int* local = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int* words = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	bool exact = mode == lineageExact;
+	if (mode != lineageEstimate) {
+		double bytes = findPedigreeBits(graph, rank, local, words);
+		if (mode == lineageAuto) exact = bytes <= EXACTCOUNTBUDGET;
+	}
+	LineageCounts* counts = (LineageCounts*) stdalloc(sizeof(LineageCounts));
+	counts->numPersons = numPersons;
+	counts->estimated = !exact;
+	for (int direction = 0; direction < 2; direction++) {
+		CountPlan plan;
+		planCounts(&plan, graph, ordered, numOrdered, rank, direction == 0);
+		plan.exact = exact;
+		plan.local = local;
+		plan.words = words;
+		plan.counts = (int*) stdalloc((numPersons + 1)*sizeof(int));
+		for (int level = 0; level < plan.numLevels; level++) findLevel(&plan, level);
+		if (direction == 0) counts->ancestors = plan.counts;
+		else counts->descendents = plan.counts;
+		termPlan(&plan);
+	}
+	stdfree(ordered);
+	stdfree(rank);
+	stdfree(local);
+	stdfree(words);
+	return counts;
+}
+
+// deleteLineageCounts deletes LineageCounts.
+void deleteLineageCounts(LineageCounts* counts) {
+	stdfree(counts->ancestors);
+	stdfree(counts->descendents);
+	stdfree(counts);
+}
@@ -0,0 +1,225 @@
+// DeadEnds
+//
+// lineagecycles.c finds persons who are their own ancestors. Only persons left out of the
+// LineageOrder can be on a cycle of parent links, so when every person is ordered there is nothing
+// more to do. Otherwise the strongly connected components of the parent links among the persons
+// left out are found with Tarjan's algorithm, made iterative so deep pedigrees can't overflow the
+// stack, and a shortest cycle is found in each component with more than one person, or with a
+// person who is their own parent, by breadth first searches. Everything takes linear time except
+// the searches, which are from every person of a small component and from one of a large one.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include "lineagecycles.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+#define MINIMALCYCLESEARCH 64 // Largest component searched from every person.
+#define MAXCYCLEMESSAGE 1024
+
+// isLeftOut returns true if a person is a possible member of a cycle.
+static bool isLeftOut(LineageOrder* order, int person) {
+	return person >= 0 && order->rank[person] < 0;
+}
+
+// findComponents finds the strongly connected components of the parent links among the persons
+// left out of a LineageOrder, numbering them in component; ordered persons get -1. Returns the
+// number of components.
+static int findComponents(LineageGraph* graph, LineageOrder* order, int* component) {
+	int numPersons = graph->numPersons;
+	int* index = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int* low = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int* nextEdge = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int* stack = (int*) stdalloc((numPersons + 1)*sizeof(int)); // Persons in unfinished components.
+	int* calls = (int*) stdalloc((numPersons + 1)*sizeof(int)); // Persons being searched.
+	bool* onStack = (bool*) stdalloc(numPersons + 1);
+	for (int i = 0; i < numPersons; i++) {
+		index[i] = component[i] = -1;
+		onStack[i] = false;
+	}
+	int counter = 0, top = 0, numCalls = 0, numComponents = 0;
+	for (int root = 0; root < numPersons; root++) {
+		if (!isLeftOut(order, root) || index[root] >= 0) continue;
+		index[root] = low[root] = counter++;
+		nextEdge[root] = 0;
+		stack[top++] = root;
+		onStack[root] = true;
+		calls[numCalls++] = root;
+		while (numCalls > 0) {
+			int person = calls[numCalls - 1];
+			if (nextEdge[person] < 2) { // Follow the next parent link.
+				int parent = graph->parents[2*person + nextEdge[person]++];
+				if (!isLeftOut(order, parent)) continue;
+				if (index[parent] < 0) {
+					index[parent] = low[parent] = counter++;
+					nextEdge[parent] = 0;
+					stack[top++] = parent;
+					onStack[parent] = true;
+					calls[numCalls++] = parent;
+				} else if (onStack[parent] && index[parent] < low[person]) {
+					low[person] = index[parent];
+				}
+				continue;
+			}
+			numCalls--; // Done with person.
+			if (numCalls > 0 && low[person] < low[calls[numCalls - 1]])
+				low[calls[numCalls - 1]] = low[person];
+			if (low[person] != index[person]) continue;
+			int member;
+			do {
+				member = stack[--top];
+				onStack[member] = false;
+				component[member] = numComponents;
+			} while (member != person);
+			numComponents++;
+		}
+	}
+	stdfree(index);
+	stdfree(low);
+	stdfree(nextEdge);
+	stdfree(stack);
+	stdfree(calls);
+	stdfree(onStack);
+	return numComponents;
+}
+
+// CycleSearch holds the arrays of the breadth first searches for shortest cycles.
+typedef struct CycleSearch {
+	int* seen; // Stamp of the search that found each person.
+	int* previous; // Person each person was found from.
+	int* distance;
+	int* queue;
+	int stamp;
+} CycleSearch;
+
+// searchCycle finds a shortest cycle through a person that stays in its component. Returns its
+// length and leaves the last person of the cycle in last, or returns 0 if there is none.
+static int searchCycle(LineageGraph* graph, int* component, CycleSearch* search, int start,
+					   int* last) {
+	int stamp = ++search->stamp;
+	int head = 0, tail = 0;
+	search->seen[start] = stamp;
+	search->distance[start] = 0;
+	search->queue[tail++] = start;
+	while (head < tail) {
+		int person = search->queue[head++];
+		for (int j = 0; j < 2; j++) {
+			int parent = graph->parents[2*person + j];
+			if (parent < 0 || component[parent] != component[start]) continue;
+			if (parent == start) {
+				*last = person;
+				return search->distance[person] + 1;
+			}
+			if (search->seen[parent] == stamp) continue;
+			search->seen[parent] = stamp;
+			search->previous[parent] = person;
+			search->distance[parent] = search->distance[person] + 1;
+			search->queue[tail++] = parent;
+		}
+	}
+	return 0;
+}
+
+// deleteCycle deletes an AncestryCycle; the delete function of the List of cycles.
+static void deleteCycle(void* element) {
+	AncestryCycle* cycle = (AncestryCycle*) element;
+	stdfree(cycle->persons);
+	stdfree(cycle);
+}
+
+// findAncestryCycles returns a List of AncestryCycles, a shortest one for each group of persons
+// whose ancestors include themselves.
+List* findAncestryCycles(LineageGraph* graph) {
+	List* cycles = createList(null, null, deleteCycle, false);
+	LineageOrder* order = getLineageOrder(graph);
+	int numPersons = graph->numPersons;
+	if (order->numOrdered == numPersons) return cycles;
+	int* component = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int numComponents = findComponents(graph, order, component);
+
+	// List the members of each component.
+	int* firstMember = (int*) stdalloc((numComponents + 2)*sizeof(int));
+	memset(firstMember, 0, (numComponents + 2)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) if (component[i] >= 0) firstMember[component[i] + 1]++;
+	for (int c = 0; c < numComponents; c++) firstMember[c + 1] += firstMember[c];
+	int* members = (int*) stdalloc((firstMember[numComponents] + 1)*sizeof(int));
+	int* next = (int*) stdalloc((numComponents + 1)*sizeof(int));
+	memcpy(next, firstMember, numComponents*sizeof(int));
+	for (int i = 0; i < numPersons; i++) if (component[i] >= 0) members[next[component[i]]++] = i;
+	stdfree(next);
+
+	CycleSearch search;
+	search.seen = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	search.previous = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	search.distance = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	search.queue = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	search.stamp = 0;
+	memset(search.seen, 0, (numPersons + 1)*sizeof(int));
+	for (int c = 0; c < numComponents; c++) {
+		int first = firstMember[c], size = firstMember[c + 1] - first;
+		int person = members[first];
+		if (size == 1 && graph->parents[2*person] != person && graph->parents[2*person + 1] != person)
+			continue; // Not on a cycle.
+		int best = 0, bestStart = -1, bestLast = -1;
+		int numStarts = size <= MINIMALCYCLESEARCH ? size : 1;
+		for (int k = 0; k < numStarts; k++) {
+			int last, length = searchCycle(graph, component, &search, members[first + k], &last);
+			if (length > 0 && (best == 0 || length < best)) {
+				best = length;
+				bestStart = members[first + k];
+				bestLast = last;
+			}
+		}
+		if (best == 0) continue; // Can't happen.
+		searchCycle(graph, component, &search, bestStart, &bestLast); // Restore the path.
+		AncestryCycle* cycle = (AncestryCycle*) stdalloc(sizeof(AncestryCycle));
+		cycle->length = best;
+		cycle->persons = (int*) stdalloc(best*sizeof(int));
+		for (int i = best - 1, p = bestLast; i >= 0; i--, p = search.previous[p]) cycle->persons[i] = p;
+		appendToList(cycles, cycle);
+	}
+	stdfree(search.seen);
+	stdfree(search.previous);
+	stdfree(search.distance);
+	stdfree(search.queue);
+	stdfree(members);
+	stdfree(firstMember);
+	stdfree(component);
+	return cycles;
+}
+
+// recordLine returns the line of a record from a keymap, or 0 if it isn't known.
+static int recordLine(IntegerTable* keymap, String key) {
+	int line = keymap && key ? searchIntegerTable(keymap, key) : NAN;
+	return line == NAN ? 0 : line;
+}
+
+// checkAncestryCycles adds an error to a log for each shortest cycle of persons who are their own
+// ancestors, showing the persons and families on the cycle with their lines. Name is the file
+// name and keymap maps keys to lines. Returns the number of cycles.
+int checkAncestryCycles(LineageGraph* graph, String name, IntegerTable* keymap, ErrorLog* log) {
+	List* cycles = findAncestryCycles(graph);
+	int numCycles = lengthList(cycles);
+	FORLIST(cycles, element)
+		AncestryCycle* cycle = (AncestryCycle*) element;
+		char s[MAXCYCLEMESSAGE];
+		GNode* first = graph->persons[cycle->persons[0]];
+		int line = recordLine(keymap, first->key);
+		int n = snprintf(s, MAXCYCLEMESSAGE, "INDI %s (line %d) is their own ancestor:", first->key, line);
+		for (int i = 0; i < cycle->length && n < MAXCYCLEMESSAGE; i++) {
+			GNode* person = graph->persons[cycle->persons[i]];
+			GNode* famc = FAMC(person);
+			String family = famc ? famc->value : "";
+			n += snprintf(s + n, MAXCYCLEMESSAGE - n, " %s (line %d) FAMC %s (line %d) ->", person->key,
+						  recordLine(keymap, person->key), family, recordLine(keymap, family));
+		}
+		if (n < MAXCYCLEMESSAGE) snprintf(s + n, MAXCYCLEMESSAGE - n, " %s", first->key);
+		else strcpy(s + MAXCYCLEMESSAGE - 5, " ..."); // Long cycles are cut short.
+		addErrorToLog(log, createError(linkageError, name, line, s));
+	ENDLIST
+	deleteList(cycles);
+	return numCycles;
+}
@@ -0,0 +1,445 @@
+// DeadEnds
+//
+// lineagegraph.c implements the LineageGraph, the parent and child links of the persons in a
+// Database held as arrays of integer ids, and the ancestor and descendent closures found with it.
+// A closure is a breadth first search, one generation at a time, that marks the persons found in
+// a bit set. Large generations are expanded by several threads; each thread finds the unmarked
+// parents or children of its part of the generation, and the parts are then merged in order, so
+// the persons are found in the same order as by a single thread.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <stdint.h>
+#include "lineagegraph.h"
+#include "utils.h"
+#include "recordindex.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+#define PARALLELGENERATION 16384 // Smallest generation expanded by several threads.
+#define MAXCLOSURETHREADS 8
+
+#define ISMARKED(bits, id) (((bits)[(id) >> 6] >> ((id) & 63)) & 1)
+#define MARK(bits, id) ((bits)[(id) >> 6] |= (uint64_t) 1 << ((id) & 63))
+
+// getKey returns the key of a LineageId.
+static String getKey(void* element) {
+	return ((LineageId*) element)->key;
+}
+
+// compare compares two record keys.
+static int compare(String a, String b) {
+	return compareRecordKeys(a, b);
+}
+
+// numBuckets returns a prime number of buckets for a HashTable of count elements.
+static int numBuckets(int count) {
+	int n = count < 61 ? 61 : count | 1;
+	while (true) {
+		bool prime = true;
+		for (int d = 3; d*d <= n && prime; d += 2) prime = n % d != 0;
+		if (prime) return n;
+		n += 2;
+	}
+}
+
+// createIds gives ids to the records of a type in a RecordIndex. It sets roots to the array of
+// the records by id and ids to a HashTable that maps their keys to LineageIds. Returns the array
+// of LineageIds.
+static LineageId* createIds(RecordIndex* index, RecordType type, int* count, GNode*** roots,
+							HashTable** ids) {
+	*count = 0;
+	FORHASHTABLE(index, element)
+		if (recordType((GNode*) element) == type) (*count)++;
+	ENDHASHTABLE
+	LineageId* lineageIds = (LineageId*) stdalloc((*count + 1)*sizeof(LineageId));
+	*roots = (GNode**) stdalloc((*count + 1)*sizeof(GNode*));
+	*ids = createHashTable(getKey, compare, null, numBuckets(*count));
+	int id = 0;
+	FORHASHTABLE(index, element)
+		GNode* root = (GNode*) element;
+		if (recordType(root) != type) continue;
+		lineageIds[id] = (LineageId) {root->key, id};
+		(*roots)[id] = root;
+		addToHashTable(*ids, lineageIds + id, false);
+		id++;
+	ENDHASHTABLE
+	return lineageIds;
+}
+
+// findId returns the id of a key in a HashTable of LineageIds, or -1 if it is not there.
+static int findId(HashTable* ids, String key) {
+	LineageId* lineageId = key ? (LineageId*) searchHashTable(ids, key) : null;
+	return lineageId ? lineageId->id : -1;
+}
+
+// lineageId returns the id of the person with a key, or -1 if there is none.
+int lineageId(LineageGraph* graph, String key) {
+	return findId(graph->ids, key);
+}
+
+// FamilyLinks are the spouses and children of the families in a RecordIndex by id; they are used
+// while a LineageGraph is built.
+typedef struct FamilyLinks {
+	LineageId* lineageIds;
+	GNode** families;
+	HashTable* ids;
+	int* husbands; // First HUSB of each family, like familyToHusband; -1 if none.
+	int* wives;
+	int* firstChild; // Like LineageGraph.firstChild.
+	int* children;
+} FamilyLinks;
+
+// getFamilyLinks finds the spouses and children of the families in a RecordIndex.
+static void getFamilyLinks(RecordIndex* index, LineageGraph* graph, FamilyLinks* links) {
+	int numFamilies;
+	links->lineageIds = createIds(index, GRFamily, &numFamilies, &links->families, &links->ids);
+	links->husbands = (int*) stdalloc((numFamilies + 1)*sizeof(int));
+	links->wives = (int*) stdalloc((numFamilies + 1)*sizeof(int));
+	links->firstChild = (int*) stdalloc((numFamilies + 1)*sizeof(int));
+	int numChildren = 0;
+	for (int i = 0; i < numFamilies; i++) {
+		GNode* family = links->families[i];
+		GNode* husband = findTag(family->child, "HUSB");
+		GNode* wife = findTag(family->child, "WIFE");
+		links->husbands[i] = husband ? lineageId(graph, husband->value) : -1;
+		links->wives[i] = wife ? lineageId(graph, wife->value) : -1;
+		links->firstChild[i] = numChildren;
+		for (GNode* node = family->child; node; node = node->sibling)
+			if (eqstr(node->tag, "CHIL")) numChildren++;
+	}
+	links->firstChild[numFamilies] = numChildren;
+	links->children = (int*) stdalloc((numChildren + 1)*sizeof(int));
+	int next = 0;
+	for (int i = 0; i < numFamilies; i++) {
+		GNode* family = links->families[i];
+		for (GNode* node = family->child; node; node = node->sibling)
+			if (eqstr(node->tag, "CHIL")) links->children[next++] = lineageId(graph, node->value);
+	}
+}
+
+// deleteFamilyLinks frees the FamilyLinks.
+static void deleteFamilyLinks(FamilyLinks* links) {
+	deleteHashTable(links->ids);
+	stdfree(links->lineageIds);
+	stdfree(links->families);
+	stdfree(links->husbands);
+	stdfree(links->wives);
+	stdfree(links->firstChild);
+	stdfree(links->children);
+}
+
+// addParents adds the first HUSB and WIFE of each FAMC family of a person to allParents, if not
+// already there, and returns the next free index; allParents is null while counting.
+static int addParents(GNode* person, FamilyLinks* links, int* allParents, int next) {
+	int first = next;
+	for (GNode* node = person->child; node; node = node->sibling) {
+		if (!eqstr(node->tag, "FAMC")) continue;
+		int family = findId(links->ids, node->value);
+		if (family < 0) continue;
+		int parents[] = {links->husbands[family], links->wives[family]};
+		for (int i = 0; i < 2; i++) {
+			if (parents[i] < 0) continue;
+			bool found = false;
+			for (int j = first; j < next && allParents && !found; j++)
+				found = allParents[j] == parents[i];
+			if (found) continue;
+			if (allParents) allParents[next] = parents[i];
+			next++;
+		}
+	}
+	return next;
+}
+
+// getLineageGraph builds the LineageGraph of the persons in a RecordIndex. A person's parents
+// are the first HUSB and WIFE of the first FAMC family, as found by personToFather and
+// personToMother; allParents has the first HUSB and WIFE of every FAMC family, so adoptive and
+// birth parents are both there. A person's children are the CHILs of the FAMS families, in
+// Gedcom order, and spouses are the other spouses of those families.
+LineageGraph* getLineageGraph(RecordIndex* index) {
+	LineageGraph* graph = (LineageGraph*) stdalloc(sizeof(LineageGraph));
+	graph->order = null;
+	graph->lineageIds = createIds(index, GRPerson, &graph->numPersons, &graph->persons, &graph->ids);
+	int numPersons = graph->numPersons;
+	FamilyLinks links;
+	getFamilyLinks(index, graph, &links);
+
+	// Link the parents, and count the children and spouses to size their arrays.
+	graph->parents = (int*) stdalloc((2*numPersons + 1)*sizeof(int));
+	graph->firstChild = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	graph->firstSpouse = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	graph->firstParent = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int numChildren = 0, numSpouses = 0, numParents = 0;
+	for (int i = 0; i < numPersons; i++) {
+		GNode* person = graph->persons[i];
+		GNode* famc = FAMC(person);
+		int family = famc ? findId(links.ids, famc->value) : -1;
+		graph->parents[2*i] = family >= 0 ? links.husbands[family] : -1;
+		graph->parents[2*i + 1] = family >= 0 ? links.wives[family] : -1;
+		graph->firstChild[i] = numChildren;
+		graph->firstSpouse[i] = numSpouses;
+		numParents = addParents(person, &links, null, numParents); // Counts repeats too.
+		for (GNode* fams = FAMS(person); fams && eqstr(fams->tag, "FAMS"); fams = fams->sibling) {
+			family = findId(links.ids, fams->value);
+			if (family < 0) continue;
+			numChildren += links.firstChild[family + 1] - links.firstChild[family];
+			numSpouses++;
+		}
+	}
+	graph->firstChild[numPersons] = numChildren;
+	graph->firstSpouse[numPersons] = numSpouses;
+	graph->children = (int*) stdalloc((numChildren + 1)*sizeof(int));
+	graph->spouses = (int*) stdalloc((numSpouses + 1)*sizeof(int));
+	graph->allParents = (int*) stdalloc((numParents + 1)*sizeof(int));
+	int next = 0, nextSpouse = 0, nextParent = 0;
+	for (int i = 0; i < numPersons; i++) {
+		graph->firstParent[i] = nextParent;
+		nextParent = addParents(graph->persons[i], &links, graph->allParents, nextParent);
+		for (GNode* fams = FAMS(graph->persons[i]); fams && eqstr(fams->tag, "FAMS"); fams = fams->sibling) {
+			int family = findId(links.ids, fams->value);
+			if (family < 0) continue;
+			for (int j = links.firstChild[family]; j < links.firstChild[family + 1]; j++)
+				graph->children[next++] = links.children[j];
+			int spouse = links.husbands[family] == i ? links.wives[family] : links.husbands[family];
+			graph->spouses[nextSpouse++] = spouse;
+		}
+	}
+	graph->firstParent[numPersons] = nextParent;
+	deleteFamilyLinks(&links);
+	return graph;
+}
+
+// deleteLineageGraph deletes a LineageGraph.
+void deleteLineageGraph(LineageGraph* graph) {
+	deleteHashTable(graph->ids);
+	stdfree(graph->persons);
+	stdfree(graph->lineageIds);
+	stdfree(graph->parents);
+	stdfree(graph->firstParent);
+	stdfree(graph->allParents);
+	stdfree(graph->firstChild);
+	stdfree(graph->children);
+	stdfree(graph->firstSpouse);
+	stdfree(graph->spouses);
+	if (graph->order) {
+		stdfree(graph->order->ordered);
+		stdfree(graph->order->rank);
+		stdfree(graph->order->generation);
+		stdfree(graph->order->firstInGeneration);
+		stdfree(graph->order);
+	}
+	stdfree(graph);
+}
+
+// orderLineageGraph puts the persons of a LineageGraph in topological order, parents before their
+// children, and sets the rank of each person to its position in the order. Persons on a parent
+// cycle, and their descendents, are left out and have rank -1. Returns the number ordered.
+int orderLineageGraph(LineageGraph* graph, int* ordered, int* rank) {
+	int numPersons = graph->numPersons;
+	// The children of a person here are those it is a parent of, not the children of its families.
+	int* firstChild = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int* numParents = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	memset(firstChild, 0, (numPersons + 1)*sizeof(int));
+	memset(numParents, 0, (numPersons + 1)*sizeof(int));
+	for (int i = 0; i < 2*numPersons; i++) {
+		if (graph->parents[i] < 0) continue;
+		firstChild[graph->parents[i] + 1]++;
+		numParents[i/2]++;
+	}
+	for (int i = 0; i < numPersons; i++) firstChild[i + 1] += firstChild[i];
+	int* children = (int*) stdalloc((firstChild[numPersons] + 1)*sizeof(int));
+	int* next = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	memcpy(next, firstChild, numPersons*sizeof(int));
+	for (int i = 0; i < 2*numPersons; i++)
+		if (graph->parents[i] >= 0) children[next[graph->parents[i]]++] = i/2;
+
+	// Kahn's algorithm; ordered is also the queue.
+	int length = 0;
+	for (int i = 0; i < numPersons; i++) {
+		rank[i] = -1;
+		if (numParents[i] == 0) ordered[length++] = i;
+	}
+	for (int head = 0; head < length; head++) {
+		int person = ordered[head];
+		rank[person] = head;
+		for (int j = firstChild[person]; j < firstChild[person + 1]; j++)
+			if (--numParents[children[j]] == 0) ordered[length++] = children[j];
+	}
+	stdfree(firstChild);
+	stdfree(numParents);
+	stdfree(children);
+	stdfree(next);
+	return length;
+}
+
+// getLineageOrder returns the LineageOrder of a LineageGraph, building it on first use.
+LineageOrder* getLineageOrder(LineageGraph* graph) {
+	if (graph->order) return graph->order;
+	int numPersons = graph->numPersons;
+	LineageOrder* order = (LineageOrder*) stdalloc(sizeof(LineageOrder));
+	order->ordered = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	order->rank = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	order->generation = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	int* ordered = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	order->numOrdered = orderLineageGraph(graph, ordered, order->rank);
+
+	// Find the generations in topological order, then sort the persons by generation.
+	order->numGenerations = 0;
+	for (int i = 0; i < numPersons; i++) order->generation[i] = -1;
+	for (int k = 0; k < order->numOrdered; k++) {
+		int person = ordered[k], generation = 0;
+		for (int j = 0; j < 2; j++) {
+			int parent = graph->parents[2*person + j];
+			if (parent >= 0 && order->generation[parent] + 1 > generation)
+				generation = order->generation[parent] + 1;
+		}
+		order->generation[person] = generation;
+		if (generation + 1 > order->numGenerations) order->numGenerations = generation + 1;
+	}
+	int numGenerations = order->numGenerations;
+	order->firstInGeneration = (int*) stdalloc((numGenerations + 2)*sizeof(int));
+	memset(order->firstInGeneration, 0, (numGenerations + 2)*sizeof(int));
+	for (int k = 0; k < order->numOrdered; k++)
+		order->firstInGeneration[order->generation[ordered[k]] + 1]++;
+	for (int g = 0; g < numGenerations; g++)
+		order->firstInGeneration[g + 1] += order->firstInGeneration[g];
+	int* next = (int*) stdalloc((numGenerations + 1)*sizeof(int));
+	memcpy(next, order->firstInGeneration, numGenerations*sizeof(int));
+	for (int k = 0; k < order->numOrdered; k++) {
+		int person = ordered[k];
+		int position = next[order->generation[person]]++;
+		order->ordered[position] = person;
+		order->rank[person] = position;
+	}
+	stdfree(next);
+	stdfree(ordered);
+	graph->order = order;
+	return order;
+}
+
+// Expansion is a part of a generation expanded by one thread, and the persons it found.
+typedef struct Expansion {
+	LineageGraph* graph;
+	bool up; // Parents if true; children if false.
+	uint64_t* marks; // Read only while the threads run.
+	int* generation;
+	int first, last; // Part of the generation, first to last - 1.
+	int* found; // Unmarked parents or children in order; may repeat.
+	int numFound;
+} Expansion;
+
+// neighbors returns the parents or children of a person and sets their number.
+static int* neighbors(LineageGraph* graph, int id, bool up, int* count) {
+	if (up) {
+		*count = 2;
+		return graph->parents + 2*id;
+	}
+	*count = graph->firstChild[id + 1] - graph->firstChild[id];
+	return graph->children + graph->firstChild[id];
+}
+
+// expandPart finds the unmarked parents or children of the persons in part of a generation.
+static void* expandPart(void* arg) {
+	Expansion* part = (Expansion*) arg;
+	int room = 0, count;
+	for (int i = part->first; i < part->last; i++) {
+		neighbors(part->graph, part->generation[i], part->up, &count);
+		room += count;
+	}
+	part->found = (int*) stdalloc((room + 1)*sizeof(int));
+	part->numFound = 0;
+	for (int i = part->first; i < part->last; i++) {
+		int* ids = neighbors(part->graph, part->generation[i], part->up, &count);
+		for (int j = 0; j < count; j++)
+			if (ids[j] >= 0 && !ISMARKED(part->marks, ids[j])) part->found[part->numFound++] = ids[j];
+	}
+	return null;
+}
+
+// expandGeneration finds the unmarked parents or children of a generation, marks them, and
+// adds them to the Closure and the next generation. Returns the size of the next generation.
+static int expandGeneration(LineageGraph* graph, bool up, uint64_t* marks, int* generation,
+							int length, int* next, Closure* closure) {
+	int numThreads = length >= PARALLELGENERATION ? threadCount(0, MAXCLOSURETHREADS) : 1;
+	Expansion parts[MAXCLOSURETHREADS];
+	for (int i = 0; i < numThreads; i++)
+		parts[i] = (Expansion) {graph, up, marks, generation, (int) ((long) length*i/numThreads),
+			(int) ((long) length*(i + 1)/numThreads), null, 0};
+	runThreads(expandPart, parts, sizeof(Expansion), numThreads);
+	int numNext = 0;
+	for (int i = 0; i < numThreads; i++) {
+		for (int j = 0; j < parts[i].numFound; j++) {
+			int id = parts[i].found[j];
+			if (ISMARKED(marks, id)) continue;
+			MARK(marks, id);
+			closure->ids[closure->numIds++] = id;
+			next[numNext++] = id;
+		}
+		stdfree(parts[i].found);
+	}
+	return numNext;
+}
+
+// findClosure finds the ancestors or descendents of the persons with the start ids, a generation
+// at a time, up to limit generations if limit is positive. The start persons are only in the
+// Closure if close is true or they are ancestors or descendents of other start persons.
+static Closure* findClosure(LineageGraph* graph, int* start, int numStart, bool close, int limit,
+							bool up) {
+	int numPersons = graph->numPersons;
+	int numWords = (numPersons + 63)/64;
+	uint64_t* marks = (uint64_t*) stdalloc((numWords + 1)*sizeof(uint64_t));
+	memset(marks, 0, (numWords + 1)*sizeof(uint64_t));
+	Closure* closure = (Closure*) stdalloc(sizeof(Closure));
+	closure->ids = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	closure->numIds = 0;
+	closure->counts = (int*) stdalloc((numPersons + 1)*sizeof(int)); // Each generation has a person.
+	int size = numStart > numPersons ? numStart : numPersons;
+	int* generation = (int*) stdalloc((size + 1)*sizeof(int));
+	int* next = (int*) stdalloc((size + 1)*sizeof(int));
+
+	// Generation 0 is all the start persons; the kept ones are marked.
+	int length = 0;
+	for (int i = 0; i < numStart; i++) {
+		int id = start[i];
+		if (id < 0 || id >= numPersons) continue;
+		generation[length++] = id;
+		if (close && !ISMARKED(marks, id)) {
+			MARK(marks, id);
+			closure->ids[closure->numIds++] = id;
+		}
+	}
+	closure->counts[0] = closure->numIds;
+	closure->numGenerations = 1;
+	for (int g = 1; length > 0 && (limit <= 0 || g <= limit); g++) {
+		length = expandGeneration(graph, up, marks, generation, length, next, closure);
+		if (length == 0) break;
+		closure->counts[closure->numGenerations++] = length;
+		int* swap = generation;
+		generation = next;
+		next = swap;
+	}
+	stdfree(marks);
+	stdfree(generation);
+	stdfree(next);
+	return closure;
+}
+
+// ancestorClosure returns the ancestors of the persons with the start ids.
+Closure* ancestorClosure(LineageGraph* graph, int* start, int numStart, bool close, int limit) {
+	return findClosure(graph, start, numStart, close, limit, true);
+}
+
+// descendentClosure returns the descendents of the persons with the start ids.
+Closure* descendentClosure(LineageGraph* graph, int* start, int numStart, bool close, int limit) {
+	return findClosure(graph, start, numStart, close, limit, false);
+}
+
+// deleteClosure deletes a Closure.
+void deleteClosure(Closure* closure) {
+	stdfree(closure->ids);
+	stdfree(closure->counts);
+	stdfree(closure);
+}
@@ -4,7 +4,7 @@
 // record keys that have the names.
 //
 // Created by Thomas Wetmore on 26 November 2022.
-// Last changed on 7 December 2024.
+// Last changed on 18 October 2026.
 
 #include "nameindex.h"
 #include "name.h"
@@ -12,6 +12,9 @@
 #include "set.h"
 #include "gedcom.h"
 
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
 static NameIndexEl* createNameIndexEl(String nameKey);
 static bool nameIndexDebugging = false;
 static int numNameIndexBuckets = 2048;
@@ -57,7 +60,8 @@ NameIndex* getNameIndex(RootList* persons) {
 		for (GNode* name = NAME(root); name && eqstr(name->tag, "NAME"); name = name->sibling) {
 			if (name->value) {
 				numNamesFound++; // For debugging.
-				String nameKey = nameToNameKey(name->value); // MNOTE: points to static memory.
+				char nameKey[NAMEKEYLEN];
+				nameToNameKeyInBuffer(name->value, nameKey);
 				insertInNameIndex(nameIndex, nameKey, recordKey);
 			}
 		}
@@ -103,7 +107,8 @@ void removeNamesOfPersonFromIndex(NameIndex* index, GNode* person) {
 	String recordKey = person->key;
 	GNode* name = NAME(person);
 	while (name) {
-		String nameKey = nameToNameKey(name->value);
+		char nameKey[NAMEKEYLEN];
+		nameToNameKeyInBuffer(name->value, nameKey);
 		removeFromNameIndex(index, nameKey, recordKey);
 		name = name->sibling;
 		if (name && nestr(name->tag, "NAME")) name = null;
@@ -113,7 +118,8 @@ void removeNamesOfPersonFromIndex(NameIndex* index, GNode* person) {
 // searchNameIndex searches NameIndex for a name and returns the record keys that have the name.
 // MNOTE: The set that is returned is in the NameIndex. It cannot be changed.
 Set* searchNameIndex(NameIndex* index, String name) {
-	String nameKey = nameToNameKey(name);
+	char nameKey[NAMEKEYLEN];
+	nameToNameKeyInBuffer(name, nameKey);
 	NameIndexEl* element = searchHashTable(index, nameKey);
 	return element == null ? null : element->recordKeys;
 }
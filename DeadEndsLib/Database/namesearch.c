@@ -0,0 +1,471 @@
+// DeadEnds
+//
+// namesearch.c implements the NameSearchIndex, an index of the normalized parts of the names of
+// persons. Each part (a surname or given name, lower cased, with punctuation removed) is an entry.
+// The entries are kept in a Block sorted by part, for prefix (typeahead) searches, and each
+// entry is posted under its trigrams, for substring and misspelling tolerant searches. Searches
+// return persons ranked by how well their names match the words of the query. The index is kept
+// up to date as persons are edited, so it never has to be rebuilt.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <ctype.h>
+#include "namesearch.h"
+#include "gedcom.h"
+
+#define MAXPARTLEN 64
+
+static bool nameSearchDebugging = false;
+static int numGramBuckets = 4093;
+static int numPersonBuckets = 4093;
+static double trigramThreshold = 0.45; // Minimum similarity of a trigram match.
+
+// GramEl is an element in the trigram table; it holds the entries that contain the trigram.
+typedef struct GramEl {
+	char gram[4];
+	Block entries;
+} GramEl;
+
+// gramGetKey returns the trigram of a GramEl.
+static String gramGetKey(void* element) {
+	return ((GramEl*) element)->gram;
+}
+
+// gramCompare compares two trigrams.
+static int gramCompare(String a, String b) {
+	return strcmp(a, b);
+}
+
+// gramDelete frees a GramEl; the entries in its Block are not freed.
+static void gramDelete(void* element) {
+	GramEl* el = (GramEl*) element;
+	deleteBlock(&(el->entries), null);
+	stdfree(el);
+}
+
+// deleteEntry frees a NameSearchEntry; the record key is not freed.
+static void deleteEntry(void* element) {
+	NameSearchEntry* entry = (NameSearchEntry*) element;
+	stdfree(entry->part);
+	stdfree(entry);
+}
+
+// entryGetKey returns the part of a NameSearchEntry; used to sort the entries.
+static String entryGetKey(void* element) {
+	return ((NameSearchEntry*) element)->part;
+}
+
+// entryCompare compares the parts of two NameSearchEntrys.
+static int entryCompare(String a, String b) {
+	return strcmp(a, b);
+}
+
+// personGetKey returns the record key of a NameSearchPerson.
+static String personGetKey(void* element) {
+	return ((NameSearchPerson*) element)->recordKey;
+}
+
+// personCompare compares the record keys of two NameSearchPersons.
+static int personCompare(String a, String b) {
+	return compareRecordKeys(a, b);
+}
+
+// deleteResult frees a NameSearchResult; the record key is not freed.
+static void deleteResult(void* element) {
+	stdfree(element);
+}
+
+// deletePerson frees a NameSearchPerson; its entries and record key are not freed.
+static void deletePerson(void* element) {
+	NameSearchPerson* person = (NameSearchPerson*) element;
+	deleteBlock(&(person->entries), null);
+	stdfree(person);
+}
+
+// createNameSearchIndex creates an empty NameSearchIndex.
+NameSearchIndex* createNameSearchIndex(void) {
+	NameSearchIndex* index = (NameSearchIndex*) stdalloc(sizeof(NameSearchIndex));
+	initBlock(&(index->entries));
+	index->isSorted = true;
+	index->grams = createHashTable(gramGetKey, gramCompare, gramDelete, numGramBuckets);
+	index->persons = createHashTable(personGetKey, personCompare, deletePerson, numPersonBuckets);
+	index->numPersons = 0;
+	index->numEntries = 0;
+	return index;
+}
+
+// deleteNameSearchIndex deletes a NameSearchIndex.
+void deleteNameSearchIndex(NameSearchIndex* index) {
+	deleteBlock(&(index->entries), deleteEntry);
+	deleteHashTable(index->grams);
+	deleteHashTable(index->persons);
+	stdfree(index);
+}
+
+// nextPart copies the next normalized part of a name to part and returns the position after it,
+// or null if there are no more parts. Slashes toggle inSlashes; surname is set if the part is
+// between slashes. Letters are lower cased, non-ASCII bytes are kept, and everything else is
+// removed; part may be empty.
+static String nextPart(String p, String part, bool* inSlashes, bool* surname) {
+	while (*p && (isspace((unsigned char) *p) || *p == '/')) {
+		if (*p == '/') *inSlashes = !*inSlashes;
+		p++;
+	}
+	if (*p == 0) return null;
+	*surname = *inSlashes;
+	int length = 0;
+	while (*p && !isspace((unsigned char) *p) && *p != '/') {
+		int c = (unsigned char) *p++;
+		if (length >= MAXPARTLEN) continue;
+		if (c >= 0x80) part[length++] = c;
+		else if (isalpha(c)) part[length++] = tolower(c);
+	}
+	part[length] = 0;
+	return p;
+}
+
+// getGram sets gram to the i-th trigram of a part; the part is padded with a '$' on each end.
+static void getGram(String part, int length, int i, String gram) {
+	for (int j = 0; j < 3; j++) {
+		int k = i + j - 1;
+		gram[j] = (k < 0 || k >= length) ? '$' : part[k];
+	}
+	gram[3] = 0;
+}
+
+// lowerBound returns the index of the first entry whose part is not less than part.
+static int lowerBound(NameSearchIndex* index, String part) {
+	NameSearchEntry** entries = (NameSearchEntry**) index->entries.elements;
+	int lo = 0, hi = index->entries.length;
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+		if (strcmp(entries[mid]->part, part) < 0) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+// addGrams posts an entry under each of its trigrams.
+static void addGrams(NameSearchIndex* index, NameSearchEntry* entry) {
+	char gram[4];
+	for (int i = 0; i < entry->numGrams; i++) {
+		getGram(entry->part, entry->numGrams, i, gram);
+		GramEl* el = (GramEl*) searchHashTable(index->grams, gram);
+		if (!el) {
+			el = (GramEl*) stdalloc(sizeof(GramEl));
+			strcpy(el->gram, gram);
+			initBlock(&(el->entries));
+			addToHashTable(index->grams, el, false);
+		}
+		if (getLastBlockElement(&(el->entries)) != entry) appendToBlock(&(el->entries), entry);
+	}
+}
+
+// isNewPart returns true if a person does not already have a part.
+static bool isNewPart(String part, NameSearchPerson* person) {
+	NameSearchEntry** entries = (NameSearchEntry**) person->entries.elements;
+	for (int i = 0; i < person->entries.length; i++) {
+		if (eqstr(entries[i]->part, part)) return false;
+	}
+	return true;
+}
+
+// getPerson returns the NameSearchPerson of a person, creating it if needed.
+static NameSearchPerson* getPerson(NameSearchIndex* index, String recordKey) {
+	NameSearchPerson* person = (NameSearchPerson*) searchHashTable(index->persons, recordKey);
+	if (person) return person;
+	person = (NameSearchPerson*) stdalloc(sizeof(NameSearchPerson));
+	person->recordKey = recordKey;
+	person->id = index->numPersons++;
+	initBlock(&(person->entries));
+	addToHashTable(index->persons, person, false);
+	return person;
+}
+
+// addToNameSearchIndex adds the parts of a Gedcom name of a person to a NameSearchIndex.
+// MNOTE: recordKey is the record key from the database; it is not saved.
+void addToNameSearchIndex(NameSearchIndex* index, String name, String recordKey) {
+	if (!name || !recordKey) return;
+	NameSearchPerson* person = getPerson(index, recordKey);
+	char part[MAXPARTLEN + 1];
+	bool inSlashes = false, surname = false;
+	String p = name;
+	while ((p = nextPart(p, part, &inSlashes, &surname))) {
+		if (*part == 0 || !isNewPart(part, person)) continue;
+		NameSearchEntry* entry = (NameSearchEntry*) stdalloc(sizeof(NameSearchEntry));
+		entry->part = strsave(part);
+		entry->person = person;
+		entry->surname = surname;
+		entry->numGrams = (int) strlen(part);
+		entry->id = index->numEntries++;
+		if (index->isSorted)
+			insertInBlock(&(index->entries), entry, lowerBound(index, part));
+		else
+			appendToBlock(&(index->entries), entry);
+		appendToBlock(&(person->entries), entry);
+		addGrams(index, entry);
+	}
+}
+
+// removeEntry removes an entry from the sorted entries and the trigram Blocks of an index and
+// frees it.
+static void removeEntry(NameSearchIndex* index, NameSearchEntry* entry) {
+	NameSearchEntry** entries = (NameSearchEntry**) index->entries.elements;
+	for (int i = lowerBound(index, entry->part); i < index->entries.length; i++) {
+		if (entries[i] != entry) continue;
+		removeFromBlock(&(index->entries), i, null);
+		break;
+	}
+	char gram[4];
+	for (int i = 0; i < entry->numGrams; i++) {
+		getGram(entry->part, entry->numGrams, i, gram);
+		GramEl* el = (GramEl*) searchHashTable(index->grams, gram);
+		if (!el) continue;
+		for (int j = el->entries.length - 1; j >= 0; j--)
+			if (el->entries.elements[j] == entry) removeFromBlock(&(el->entries), j, null);
+	}
+	deleteEntry(entry);
+}
+
+// removeFromNameSearchIndex removes the name parts of a person from a sorted NameSearchIndex.
+// It must be called before the person's record is freed.
+void removeFromNameSearchIndex(NameSearchIndex* index, String recordKey) {
+	if (!recordKey) return;
+	NameSearchPerson* person = (NameSearchPerson*) searchHashTable(index->persons, recordKey);
+	if (!person) return;
+	for (int i = 0; i < person->entries.length; i++)
+		removeEntry(index, (NameSearchEntry*) person->entries.elements[i]);
+	removeFromHashTable(index->persons, recordKey); // Frees person.
+}
+
+// updateNameSearchIndex brings a sorted NameSearchIndex up to date after the record with root has
+// been added or edited: the parts of its old names are removed, and if it is a person the parts
+// of its names are added.
+void updateNameSearchIndex(NameSearchIndex* index, GNode* root) {
+	if (!root || !root->key) return;
+	removeFromNameSearchIndex(index, root->key);
+	if (recordType(root) != GRPerson) return;
+	for (GNode* name = NAME(root); name && eqstr(name->tag, "NAME"); name = name->sibling)
+		addToNameSearchIndex(index, name->value, root->key);
+}
+
+// getNameSearchIndex returns the NameSearchIndex of all persons in a RootList. The entries are
+// appended unsorted and then sorted once.
+NameSearchIndex* getNameSearchIndex(RootList* persons) {
+	NameSearchIndex* index = createNameSearchIndex();
+	index->isSorted = false;
+	FORLIST(persons, element)
+		GNode* root = (GNode*) element;
+		for (GNode* name = NAME(root); name && eqstr(name->tag, "NAME"); name = name->sibling) {
+			addToNameSearchIndex(index, name->value, root->key);
+		}
+	ENDLIST
+	sortBlock(&(index->entries), entryGetKey, entryCompare);
+	index->isSorted = true;
+	if (nameSearchDebugging) showNameSearchIndexStats(index);
+	return index;
+}
+
+// Candidate is the scratch space of a search for one person.
+typedef struct Candidate {
+	String recordKey;
+	int matched; // Number of query words matched.
+	double score; // Sum of the best scores of the words before word.
+	int word; // Last query word matched; -1 if none.
+	double wordScore; // Best score of that word.
+} Candidate;
+
+// Search is the scratch space of one search. Candidates and hits are numbered by the ids of
+// persons and entries; a Candidate is in use if its word is not -1. hits counts the trigrams an
+// entry shares with the current query word, and is -1 for entries that matched the word as a
+// prefix. Entries with hits are kept in touched so they can be cleared for the next word.
+typedef struct Search {
+	Candidate* candidates;
+	int* hits;
+	Block matched; // Candidates in use.
+	Block touched; // NameSearchEntrys with hits.
+} Search;
+
+// The candidates and hits of the searches of a thread are kept from search to search. Each search
+// clears only those it used, so a search costs no more than the entries its words touch.
+static _Thread_local Candidate* scratchCandidates = null;
+static _Thread_local int numScratchCandidates = 0;
+static _Thread_local int* scratchHits = null;
+static _Thread_local int numScratchHits = 0;
+
+// initSearch makes the scratch space of a search of an index, growing the scratch space of the
+// thread if the index has more persons or entries than it has room for.
+static void initSearch(Search* search, NameSearchIndex* index) {
+	if (index->numPersons > numScratchCandidates) {
+		if (scratchCandidates) stdfree(scratchCandidates);
+		numScratchCandidates = 2*index->numPersons;
+		scratchCandidates = (Candidate*) stdalloc(numScratchCandidates*sizeof(Candidate));
+		for (int i = 0; i < numScratchCandidates; i++) scratchCandidates[i].word = -1;
+	}
+	if (index->numEntries > numScratchHits) {
+		if (scratchHits) stdfree(scratchHits);
+		numScratchHits = 2*index->numEntries;
+		scratchHits = (int*) stdalloc(numScratchHits*sizeof(int));
+		memset(scratchHits, 0, numScratchHits*sizeof(int));
+	}
+	search->candidates = scratchCandidates;
+	search->hits = scratchHits;
+	initBlock(&(search->matched));
+	initBlock(&(search->touched));
+}
+
+// termSearch clears the Candidates a search used and frees the rest of its scratch space. The
+// hits are cleared after each word.
+static void termSearch(Search* search) {
+	Candidate** matched = (Candidate**) search->matched.elements;
+	for (int i = 0; i < search->matched.length; i++) matched[i]->word = -1;
+	deleteBlock(&(search->matched), null);
+	deleteBlock(&(search->touched), null);
+}
+
+// noteMatch records that a person matched query word number word with a score. Only the best
+// score for each word counts; it is added to the total when the person matches a later word or
+// when the search ends. Persons are added to matched the first time they match in a search.
+static void noteMatch(Search* search, NameSearchPerson* person, int word, double score) {
+	Candidate* candidate = search->candidates + person->id;
+	if (candidate->word < 0) {
+		candidate->recordKey = person->recordKey;
+		candidate->matched = 0;
+		candidate->score = 0.0;
+		candidate->wordScore = score;
+		candidate->word = word;
+		appendToBlock(&(search->matched), candidate);
+	} else if (candidate->word != word) {
+		candidate->score += candidate->wordScore;
+		candidate->matched++;
+		candidate->word = word;
+		candidate->wordScore = score;
+	} else if (score > candidate->wordScore) {
+		candidate->wordScore = score;
+	}
+}
+
+// searchWord matches one query word against the index. Parts that start with the word score
+// from 0.75 to 1.0 (exact). Other parts that share enough trigrams with the word score up to 0.7;
+// their similarity is the average of the Jaccard similarity of the trigram sets, which favors
+// misspellings, and the fraction of the word's trigrams in the part, which favors substrings.
+// If surname is true only surname parts are matched.
+static void searchWord(NameSearchIndex* index, Search* search, String word, bool surname,
+					   int wordnum) {
+	int length = (int) strlen(word);
+	int* hits = search->hits;
+	Block* touched = &(search->touched);
+	NameSearchEntry** entries = (NameSearchEntry**) index->entries.elements;
+	int numEntries = index->entries.length;
+	for (int i = lowerBound(index, word); i < numEntries; i++) {
+		NameSearchEntry* entry = entries[i];
+		if (strncmp(entry->part, word, length)) break;
+		if (surname && !entry->surname) continue;
+		hits[entry->id] = -1; // Keeps prefix matches out of the trigram candidates.
+		appendToBlock(touched, entry);
+		noteMatch(search, entry->person, wordnum, 0.75 + 0.25*length/entry->numGrams);
+	}
+	char gram[4];
+	for (int i = 0; length >= 3 && i < length; i++) { // Short words are matched by prefix alone.
+		getGram(word, length, i, gram);
+		GramEl* el = (GramEl*) searchHashTable(index->grams, gram);
+		if (!el) continue;
+		NameSearchEntry** posted = (NameSearchEntry**) el->entries.elements;
+		for (int j = 0; j < el->entries.length; j++) {
+			NameSearchEntry* entry = posted[j];
+			if (hits[entry->id] < 0) continue;
+			if (hits[entry->id]++ == 0) appendToBlock(touched, entry);
+		}
+	}
+	NameSearchEntry** candidates = (NameSearchEntry**) touched->elements;
+	for (int i = 0; i < touched->length; i++) {
+		NameSearchEntry* entry = candidates[i];
+		int entryHits = hits[entry->id];
+		hits[entry->id] = 0;
+		if (entryHits < 0 || (surname && !entry->surname)) continue;
+		if (entryHits > entry->numGrams) entryHits = entry->numGrams;
+		double jaccard = (double) entryHits/(length + entry->numGrams - entryHits);
+		double containment = (double) entryHits/length;
+		double similarity = (jaccard + containment)/2.0;
+		if (similarity >= trigramThreshold)
+			noteMatch(search, entry->person, wordnum, 0.7*similarity);
+	}
+	emptyBlock(touched, null);
+}
+
+// compareCandidates orders Candidates by words matched, then score, then record key.
+static int compareCandidates(const void* a, const void* b) {
+	Candidate* left = *(Candidate**) a;
+	Candidate* right = *(Candidate**) b;
+	if (left->matched != right->matched) return right->matched - left->matched;
+	if (left->score != right->score) return left->score < right->score ? 1 : -1;
+	return compareRecordKeys(left->recordKey, right->recordKey);
+}
+
+// selectBest moves the best limit Candidates of an array to its front, in order; the others are
+// left after them in no order. Typeahead searches want a few of many Candidates, so only those
+// are sorted.
+static void selectBest(Candidate** candidates, int length, int limit) {
+	qsort(candidates, limit, sizeof(Candidate*), compareCandidates);
+	for (int i = limit; i < length; i++) {
+		Candidate* candidate = candidates[i];
+		if (compareCandidates(&candidate, &candidates[limit - 1]) >= 0) continue;
+		candidates[i] = candidates[limit - 1];
+		int j = limit - 1;
+		for (; j > 0 && compareCandidates(&candidate, &candidates[j - 1]) < 0; j--)
+			candidates[j] = candidates[j - 1];
+		candidates[j] = candidate;
+	}
+}
+
+// searchNameSearchIndex searches a NameSearchIndex for the persons whose names match a query and
+// returns a List of NameSearchResults, best first. The query is one or more words, each a whole
+// or partial name part; words between slashes only match surnames. If limit is positive no more
+// than limit results are returned. The index is only read, so threads may search it at once.
+// MNOTE: the caller owns the List and its results; deleteList frees them.
+List* searchNameSearchIndex(NameSearchIndex* index, String query, int limit) {
+	List* list = createList(null, null, deleteResult, false);
+	if (!index || !query) return list;
+	Search search;
+	initSearch(&search, index);
+	char word[MAXPARTLEN + 1];
+	bool inSlashes = false, surname = false;
+	int wordnum = 0;
+	String p = query;
+	while ((p = nextPart(p, word, &inSlashes, &surname))) {
+		if (*word == 0) continue;
+		searchWord(index, &search, word, surname, wordnum++);
+	}
+	Candidate** matched = (Candidate**) search.matched.elements;
+	int numMatched = search.matched.length;
+	for (int i = 0; i < numMatched; i++) {
+		matched[i]->score += matched[i]->wordScore; // Add in the last word matched.
+		matched[i]->matched++;
+	}
+	if (limit > 0 && limit < numMatched) {
+		selectBest(matched, numMatched, limit);
+		numMatched = limit;
+	} else {
+		qsort(matched, numMatched, sizeof(Candidate*), compareCandidates);
+	}
+	for (int i = 0; i < numMatched; i++) {
+		NameSearchResult* result = (NameSearchResult*) stdalloc(sizeof(NameSearchResult));
+		result->recordKey = matched[i]->recordKey;
+		result->matched = matched[i]->matched;
+		result->score = matched[i]->score;
+		appendToList(list, result);
+	}
+	termSearch(&search);
+	return list;
+}
+
+// showNameSearchIndexStats shows statistics about a NameSearchIndex; for debugging.
+void showNameSearchIndexStats(NameSearchIndex* index) {
+	int numPostings = 0;
+	FORHASHTABLE(index->grams, element)
+		numPostings += ((GramEl*) element)->entries.length;
+	ENDHASHTABLE
+	fprintf(stderr, "Summary of Name Search Index: %d name parts, %d trigrams, %d postings.\n",
+			index->entries.length, sizeHashTable(index->grams), numPostings);
+}
@@ -0,0 +1,218 @@
+// DeadEnds
+//
+// pathindex.c implements the PathIndex, a secondary index on a Gedcom path. The path is run over
+// every record in a Database once, and the keys extracted from the values at the ends of the
+// path are mapped to the keys of the records they came from. Each PathIndex also remembers the
+// keys each record was indexed under, so when a record is edited its old entries are removed
+// and the record is indexed again.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <ctype.h>
+#include "pathindex.h"
+#include "recordindex.h"
+#include "database.h"
+#include "gnodelist.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+static bool pathIndexDebugging = false;
+static int numPathIndexBuckets = 1021;
+
+// getKey returns the key of a PathIndexEl.
+static String getKey(void* element) {
+	return ((PathIndexEl*) element)->key;
+}
+
+// getRecordKey returns the record key of a PathRecordEl.
+static String getRecordKey(void* element) {
+	return ((PathRecordEl*) element)->recordKey;
+}
+
+// compare compares two keys.
+static int compare(String a, String b) {
+	return strcmp(a, b);
+}
+
+// getSetKey gets the key of a Set element.
+static String getSetKey(void* element) {
+	return (String) element;
+}
+
+// compareSetKeys compares two record keys.
+static int compareSetKeys(String a, String b) {
+	return compareRecordKeys(a, b);
+}
+
+// deletePathIndexEl frees a PathIndexEl.
+// MNOTE: the key is freed; the record keys in the Set are not.
+static void deletePathIndexEl(void* element) {
+	PathIndexEl* el = (PathIndexEl*) element;
+	stdfree(el->key);
+	deleteSet(el->recordKeys);
+	stdfree(el);
+}
+
+// deletePathRecordEl frees a PathRecordEl.
+// MNOTE: the record key and the keys in the List are not freed.
+static void deletePathRecordEl(void* element) {
+	PathRecordEl* el = (PathRecordEl*) element;
+	deleteList(el->keys);
+	stdfree(el);
+}
+
+// createPathIndex creates an empty PathIndex for a Gedcom path expression. If keyFunction is
+// null, values are indexed as is.
+PathIndex* createPathIndex(String expression, PathKeyFunction keyFunction) {
+	PathIndex* index = (PathIndex*) stdalloc(sizeof(PathIndex));
+	index->expression = strsave(expression);
+	index->path = buildGedPath(expression);
+	index->keyFunction = keyFunction;
+	index->keys = createHashTable(getKey, compare, deletePathIndexEl, numPathIndexBuckets);
+	index->records = createHashTable(getRecordKey, compare, deletePathRecordEl, numPathIndexBuckets);
+	return index;
+}
+
+// deletePathIndex deletes a PathIndex.
+void deletePathIndex(PathIndex* index) {
+	deleteHashTable(index->records);
+	deleteHashTable(index->keys);
+	deleteGedPath(index->path);
+	stdfree(index->expression);
+	stdfree(index);
+}
+
+// extractKey returns the index key of a value, or null if the value is not indexed. buffer must
+// have room for MAXSTRINGSIZE chars.
+static String extractKey(PathIndex* index, String value, String buffer) {
+	if (!value || *value == 0) return null;
+	return index->keyFunction ? (*index->keyFunction)(value, buffer) : value;
+}
+
+// addRecordToPathIndex runs the path over a record and adds the keys found at its ends.
+void addRecordToPathIndex(PathIndex* index, GNode* root) {
+	if (!root->key || !index->path) return;
+	int count = 0;
+	GNodeList* matches = createGNodeList();
+	traverseGedPath(root, index->path, matches, &count);
+	PathRecordEl* record = null;
+	char buffer[MAXSTRINGSIZE];
+	FORLIST(matches, element)
+		String key = extractKey(index, ((GNode*) element)->value, buffer);
+		if (!key) continue;
+		PathIndexEl* el = (PathIndexEl*) searchHashTable(index->keys, key);
+		if (!el) {
+			el = (PathIndexEl*) stdalloc(sizeof(PathIndexEl));
+			el->key = strsave(key); // MNOTE: key may be in buffer.
+			el->recordKeys = createSet(getSetKey, compareSetKeys, null);
+			addToHashTable(index->keys, el, false);
+		}
+		if (isInSet(el->recordKeys, root->key)) continue;
+		addToSet(el->recordKeys, root->key); // MNOTE: record key stored as is.
+		if (!record) {
+			record = (PathRecordEl*) stdalloc(sizeof(PathRecordEl));
+			record->recordKey = root->key;
+			record->keys = createList(null, null, null, false);
+			addToHashTable(index->records, record, false);
+		}
+		appendToList(record->keys, el->key);
+	ENDLIST
+	deleteList(matches);
+}
+
+// removeRecordFromPathIndex removes the entries of a record from a PathIndex. Keys that no
+// longer have records are removed.
+void removeRecordFromPathIndex(PathIndex* index, String recordKey) {
+	PathRecordEl* record = (PathRecordEl*) searchHashTable(index->records, recordKey);
+	if (!record) return;
+	FORLIST(record->keys, element)
+		String key = (String) element;
+		PathIndexEl* el = (PathIndexEl*) searchHashTable(index->keys, key);
+		if (!el) continue;
+		removeFromSet(el->recordKeys, recordKey);
+		if (lengthSet(el->recordKeys) == 0) removeFromHashTable(index->keys, key); // Frees key.
+	ENDLIST
+	removeFromHashTable(index->records, recordKey);
+}
+
+// getPathIndex returns the PathIndex of a Gedcom path over all records in a RecordIndex.
+PathIndex* getPathIndex(RecordIndex* recordIndex, String expression, PathKeyFunction keyFunction) {
+	PathIndex* index = createPathIndex(expression, keyFunction);
+	FORHASHTABLE(recordIndex, element)
+		addRecordToPathIndex(index, (GNode*) element);
+	ENDHASHTABLE
+	if (pathIndexDebugging) showPathIndexStats(index);
+	return index;
+}
+
+// searchPathIndex returns the Set of keys of the records with a value at the end of the path,
+// or null if there are none. The value is passed through the key extraction function first.
+// MNOTE: the Set is in the PathIndex; it must not be changed.
+Set* searchPathIndex(PathIndex* index, String value) {
+	char buffer[MAXSTRINGSIZE];
+	String key = extractKey(index, value, buffer);
+	if (!key) return null;
+	PathIndexEl* el = (PathIndexEl*) searchHashTable(index->keys, key);
+	return el ? el->recordKeys : null;
+}
+
+// upperPathKey is a key extraction function that makes a PathIndex case insensitive.
+// Long values are truncated.
+String upperPathKey(String value, String buffer) {
+	String p = buffer;
+	while (*value && p < buffer + MAXSTRINGSIZE - 1) *p++ = toupper((unsigned char) *value++);
+	*p = 0;
+	return buffer;
+}
+
+// showPathIndexStats shows the numbers of keys and records in a PathIndex; for debugging.
+void showPathIndexStats(PathIndex* index) {
+	fprintf(stderr, "Summary of Path Index %s: %d keys from %d records.\n", index->expression,
+			sizeHashTable(index->keys), sizeHashTable(index->records));
+}
+
+// addPathIndex adds a PathIndex to a Database and returns it. If the Database already has an
+// index on the path with the same key function it is returned.
+PathIndex* addPathIndex(Database* database, String expression, PathKeyFunction keyFunction) {
+	PathIndex* index = findPathIndex(database, expression, keyFunction);
+	if (index) return index;
+	index = getPathIndex(database->recordIndex, expression, keyFunction);
+	if (!database->pathIndexes) database->pathIndexes = createList(null, null, null, false);
+	appendToList(database->pathIndexes, index);
+	return index;
+}
+
+// findPathIndex returns the PathIndex of a Database on a path with a key function, or null.
+PathIndex* findPathIndex(Database* database, String expression, PathKeyFunction keyFunction) {
+	if (!database->pathIndexes) return null;
+	FORLIST(database->pathIndexes, element)
+		PathIndex* index = (PathIndex*) element;
+		if (index->keyFunction == keyFunction && eqstr(index->expression, expression)) return index;
+	ENDLIST
+	return null;
+}
+
+// updatePathIndexes brings the PathIndexes of a Database up to date after an edit to the
+// record holding node. Nodes not in a record of the Database are ignored.
+void updatePathIndexes(Database* database, GNode* node) {
+	if (!database->pathIndexes || !node) return;
+	while (node->parent) node = node->parent;
+	if (!node->key || searchRecordIndex(database->recordIndex, node->key) != node) return;
+	FORLIST(database->pathIndexes, element)
+		PathIndex* index = (PathIndex*) element;
+		removeRecordFromPathIndex(index, node->key);
+		addRecordToPathIndex(index, node);
+	ENDLIST
+}
+
+// removeFromPathIndexes removes a record from the PathIndexes of a Database; it must be called
+// before the record is freed.
+void removeFromPathIndexes(Database* database, String recordKey) {
+	if (!database->pathIndexes) return;
+	FORLIST(database->pathIndexes, element)
+		removeRecordFromPathIndex((PathIndex*) element, recordKey);
+	ENDLIST
+}
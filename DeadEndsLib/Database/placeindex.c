@@ -0,0 +1,230 @@
+// DeadEnds
+//
+// placeindex.c implements the PlaceIndex, a trie of the places in the PLAC values of the events
+// in a Database. Each PLAC value is split into phrases once, when the index is built, and the
+// phrases are interned so each distinct phrase is stored once. All events in a place and its
+// sub-places are found by walking the subtree of the place's node, and each node keeps the
+// total number of events below it for place frequency reports.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <ctype.h>
+#include "placeindex.h"
+#include "recordindex.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+#define MAXPLACEPHRASES 32
+
+static bool placeIndexDebugging = false;
+static int numPhraseBuckets = 2047;
+
+// getKey returns the phrase of a PlaceNode.
+static String getKey(void* element) {
+	return ((PlaceNode*) element)->phrase;
+}
+
+// compare compares two place phrases.
+static int compare(String a, String b) {
+	return strcmp(a, b);
+}
+
+// deletePlaceEvent frees a PlaceEvent; its GNodes are not freed.
+static void deletePlaceEvent(void* element) {
+	stdfree(element);
+}
+
+// createPlaceNode creates a PlaceNode; phrase must be interned.
+static PlaceNode* createPlaceNode(String phrase, PlaceNode* parent) {
+	PlaceNode* node = (PlaceNode*) stdalloc(sizeof(PlaceNode));
+	node->phrase = phrase;
+	node->parent = parent;
+	initBlock(&(node->children));
+	initBlock(&(node->events));
+	node->total = 0;
+	return node;
+}
+
+// deletePlaceNode frees a PlaceNode and its subtree; the interned phrases are not freed.
+static void deletePlaceNode(void* element) {
+	PlaceNode* node = (PlaceNode*) element;
+	deleteBlock(&(node->children), deletePlaceNode);
+	deleteBlock(&(node->events), deletePlaceEvent);
+	stdfree(node);
+}
+
+// createPlaceIndex creates an empty PlaceIndex.
+PlaceIndex* createPlaceIndex(void) {
+	PlaceIndex* index = (PlaceIndex*) stdalloc(sizeof(PlaceIndex));
+	index->root = createPlaceNode(null, null);
+	index->phrases = createStringTable(numPhraseBuckets);
+	index->numPlaces = 0;
+	return index;
+}
+
+// deletePlaceIndex deletes a PlaceIndex.
+void deletePlaceIndex(PlaceIndex* index) {
+	deletePlaceNode(index->root);
+	deleteHashTable(index->phrases);
+	stdfree(index);
+}
+
+// splitPlace copies a PLAC value to buffer and splits it at its commas into phrases with white
+// space trimmed. Returns the number of phrases; empty phrases are included.
+static int splitPlace(String place, String buffer, int length, String* phrases) {
+	strncpy(buffer, place, length - 1);
+	buffer[length - 1] = 0;
+	int count = 0;
+	String p = buffer;
+	while (count < MAXPLACEPHRASES) {
+		String comma = strchr(p, ',');
+		if (comma) *comma = 0;
+		while (isspace((unsigned char) *p)) p++;
+		String end = p + strlen(p);
+		while (end > p && isspace((unsigned char) end[-1])) *--end = 0;
+		phrases[count++] = p;
+		if (!comma) break;
+		p = comma + 1;
+	}
+	return count;
+}
+
+// findPlaceNode returns the PlaceNode of a place, starting from the largest jurisdiction. Empty
+// phrases are skipped. If create is true missing nodes are added; otherwise null is returned.
+static PlaceNode* findPlaceNode(PlaceIndex* index, String place, bool create) {
+	char buffer[MAXLINELEN];
+	String phrases[MAXPLACEPHRASES];
+	int count = splitPlace(place, buffer, MAXLINELEN, phrases);
+	PlaceNode* node = index->root;
+	for (int i = count - 1; i >= 0; i--) {
+		if (*phrases[i] == 0) continue;
+		int location;
+		PlaceNode* child = findInSortedBlock(&(node->children), phrases[i], getKey, compare, &location);
+		if (!child) {
+			if (!create) return null;
+			child = createPlaceNode(fixString(index->phrases, phrases[i]), node);
+			insertInBlock(&(node->children), child, location);
+			index->numPlaces++;
+		}
+		node = child;
+	}
+	return node;
+}
+
+// addToPlaceIndex attaches an event to the node of its place, adding nodes as needed, and
+// returns the node.
+PlaceNode* addToPlaceIndex(PlaceIndex* index, String place, GNode* event, GNode* root) {
+	if (!place || *place == 0) return null;
+	PlaceNode* node = findPlaceNode(index, place, true);
+	PlaceEvent* placeEvent = (PlaceEvent*) stdalloc(sizeof(PlaceEvent));
+	placeEvent->event = event;
+	placeEvent->root = root;
+	appendToBlock(&(node->events), placeEvent);
+	for (PlaceNode* up = node; up; up = up->parent) up->total++;
+	return node;
+}
+
+// addRecordToPlaceIndex adds the places of the level one events of a record.
+void addRecordToPlaceIndex(PlaceIndex* index, GNode* root) {
+	for (GNode* event = root->child; event; event = event->sibling) {
+		GNode* place = PLAC(event);
+		if (place && place->value) addToPlaceIndex(index, place->value, event, root);
+	}
+}
+
+// removeRecordFromPlaceIndex removes the events of a record from a PlaceIndex. Places left with
+// no events are kept.
+void removeRecordFromPlaceIndex(PlaceIndex* index, GNode* root) {
+	for (GNode* event = root->child; event; event = event->sibling) {
+		GNode* place = PLAC(event);
+		if (!place || !place->value) continue;
+		PlaceNode* node = findPlaceNode(index, place->value, false);
+		if (!node) continue;
+		Block* block = &(node->events);
+		for (int i = 0; i < block->length; i++) {
+			PlaceEvent* placeEvent = (PlaceEvent*) block->elements[i];
+			if (placeEvent->event != event) continue;
+			removeFromBlock(block, i, deletePlaceEvent);
+			for (PlaceNode* up = node; up; up = up->parent) up->total--;
+			break;
+		}
+	}
+}
+
+// getPlaceIndex returns the PlaceIndex of the person and family events in a RecordIndex.
+PlaceIndex* getPlaceIndex(RecordIndex* recordIndex) {
+	PlaceIndex* index = createPlaceIndex();
+	FORHASHTABLE(recordIndex, element)
+		GNode* root = (GNode*) element;
+		RecordType rtype = recordType(root);
+		if (rtype == GRPerson || rtype == GRFamily) addRecordToPlaceIndex(index, root);
+	ENDHASHTABLE
+	if (placeIndexDebugging)
+		fprintf(stderr, "Place index has %d places and %d events.\n", index->numPlaces, index->root->total);
+	return index;
+}
+
+// searchPlaceIndex returns the PlaceNode of a place, or null if the place is not in the index.
+// The place is written as in a PLAC value, smallest jurisdiction first; an empty place returns
+// the root.
+PlaceNode* searchPlaceIndex(PlaceIndex* index, String place) {
+	if (!place) return null;
+	return findPlaceNode(index, place, false);
+}
+
+// walkPlaceNode calls visit on a PlaceNode and all its sub-places, parents before children.
+void walkPlaceNode(PlaceNode* node, void(*visit)(PlaceNode*, void*), void* data) {
+	(*visit)(node, data);
+	PlaceNode** children = (PlaceNode**) node->children.elements;
+	for (int i = 0; i < node->children.length; i++) walkPlaceNode(children[i], visit, data);
+}
+
+// appendEvents is the visit function used by placeNodeToEvents.
+static void appendEvents(PlaceNode* node, void* data) {
+	List* list = (List*) data;
+	PlaceEvent** events = (PlaceEvent**) node->events.elements;
+	for (int i = 0; i < node->events.length; i++) appendToList(list, events[i]);
+}
+
+// placeNodeToEvents returns a List of the PlaceEvents in a place and its sub-places.
+// MNOTE: the caller owns the List but not its elements.
+List* placeNodeToEvents(PlaceNode* node) {
+	List* list = createList(null, null, null, false);
+	if (node) walkPlaceNode(node, appendEvents, list);
+	return list;
+}
+
+// placeNodeToString writes the full place name of a PlaceNode, smallest jurisdiction first, to
+// buffer and returns it.
+String placeNodeToString(PlaceNode* node, String buffer, int length) {
+	String p = buffer;
+	String end = buffer + length - 1;
+	for (; node && node->phrase; node = node->parent) {
+		if (p != buffer && p + 2 < end) {
+			*p++ = ',';
+			*p++ = ' ';
+		}
+		for (String q = node->phrase; *q && p < end; q++) *p++ = *q;
+	}
+	*p = 0;
+	return buffer;
+}
+
+// showPlaceNode shows a PlaceNode and its sub-places to a maximum depth.
+static void showPlaceNode(PlaceNode* node, int depth, int maxDepth, int minTotal) {
+	if (depth > maxDepth || node->total < minTotal) return;
+	if (node->phrase) printf("%*s%s: %d\n", 2*(depth - 1), "", node->phrase, node->total);
+	PlaceNode** children = (PlaceNode**) node->children.elements;
+	for (int i = 0; i < node->children.length; i++)
+		showPlaceNode(children[i], depth + 1, maxDepth, minTotal);
+}
+
+// showPlaceIndex shows the places in a PlaceIndex with their event counts, to a maximum depth
+// and omitting places with fewer than minTotal events.
+void showPlaceIndex(PlaceIndex* index, int maxDepth, int minTotal) {
+	printf("Places: %d places, %d events\n", index->numPlaces, index->root->total);
+	showPlaceNode(index->root, 0, maxDepth, minTotal);
+}
@@ -4,13 +4,16 @@
 // record keys to the roots of the GNode trees with those keys.
 //
 // Created by Thomas Wetmore on 29 November 2022.
-// Last changed on 11 December 2024.
+// Last changed on 18 October 2026.
 
 #include "recordindex.h"
 #include "list.h"
 #include "sort.h"
 #include "gedcom.h"
 
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
 #define numRecordIndexBuckets 2047
 #define brownnose false
 
@@ -4,11 +4,14 @@
 // 1 REFN nodes whose values give records unique identifiers.
 //
 // Created by Thomas Wetmore on 16 December 2023.
-// Last changed on 7 July 2024.
+// Last changed on 18 October 2026.
 
 #include "refnindex.h"
 #include "gedcom.h"
 
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
 static int numRefnIndexBuckets = 1024;
 
 // searchRefnIndex searches a RefnIndex for a 1 REFN value and returns the key of the record with
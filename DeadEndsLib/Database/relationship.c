@@ -0,0 +1,429 @@
+// DeadEnds
+//
+// relationship.c implements the relationship calculator. Two persons are related by blood if they
+// have a common ancestor; the nearest common ancestors are those with the fewest generations up
+// from both. They are found by a bidirectional breadth first search over the parent links of a
+// LineageGraph: each side searches up from one person, a generation at a time, and a person found
+// by both sides is a common ancestor. The search stops when no person not yet found by both sides
+// can be nearer. Each side marks the persons it finds with a stamp that changes with each search,
+// so the arrays are never cleared. Persons not related by blood may be related by marriage, when
+// one is a spouse or is related by blood to a spouse of the other.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <limits.h>
+#include "relationship.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+#define MAXINLAWPREFIX 12 // Room for the longest prefix of an in-law name, "husband of ".
+
+// SearchSide is one side of a bidirectional search.
+typedef struct SearchSide {
+	int* stamp; // stamp[id] is current if the side has found the person.
+	int current;
+	int* distance; // Generations up from the start person.
+	int* via; // Person one generation nearer the start person; -1 for the start person.
+	int* frontier; // Persons found in the last generation.
+	int length;
+	int* next;
+	int level; // Generation of the frontier.
+} SearchSide;
+
+// RelationshipFinder holds the state of the searches on a LineageGraph.
+struct RelationshipFinder {
+	LineageGraph* graph;
+	SearchSide sides[2]; // Searches up from the first and second persons.
+	int* meets; // Common ancestors found with the fewest generations.
+	int numMeets;
+	int best; // Generations from both persons to the meets; INT_MAX if none.
+};
+
+// initSide allocates the arrays of a SearchSide.
+static void initSide(SearchSide* side, int numPersons) {
+	side->stamp = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	memset(side->stamp, 0, (numPersons + 1)*sizeof(int));
+	side->current = 0;
+	side->distance = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	side->via = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	side->frontier = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	side->next = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	side->length = side->level = 0;
+}
+
+// termSide frees the arrays of a SearchSide.
+static void termSide(SearchSide* side) {
+	stdfree(side->stamp);
+	stdfree(side->distance);
+	stdfree(side->via);
+	stdfree(side->frontier);
+	stdfree(side->next);
+}
+
+// createRelationshipFinder creates a RelationshipFinder for a LineageGraph.
+RelationshipFinder* createRelationshipFinder(LineageGraph* graph) {
+	RelationshipFinder* finder = (RelationshipFinder*) stdalloc(sizeof(RelationshipFinder));
+	finder->graph = graph;
+	initSide(finder->sides, graph->numPersons);
+	initSide(finder->sides + 1, graph->numPersons);
+	finder->meets = (int*) stdalloc((graph->numPersons + 1)*sizeof(int));
+	finder->numMeets = 0;
+	finder->best = INT_MAX;
+	return finder;
+}
+
+// deleteRelationshipFinder deletes a RelationshipFinder.
+void deleteRelationshipFinder(RelationshipFinder* finder) {
+	termSide(finder->sides);
+	termSide(finder->sides + 1);
+	stdfree(finder->meets);
+	stdfree(finder);
+}
+
+// clearSide starts a new search on a side, with no start person.
+static void clearSide(SearchSide* side, int numPersons) {
+	if (++side->current == INT_MAX) {
+		memset(side->stamp, 0, (numPersons + 1)*sizeof(int));
+		side->current = 1;
+	}
+	side->length = side->level = 0;
+}
+
+// startSide starts a new search on a side from a person.
+static void startSide(SearchSide* side, int numPersons, int start) {
+	clearSide(side, numPersons);
+	side->stamp[start] = side->current;
+	side->distance[start] = 0;
+	side->via[start] = -1;
+	side->frontier[0] = start;
+	side->length = 1;
+}
+
+// found returns true if a side has found a person in its current search.
+static bool found(SearchSide* side, int id) {
+	return side->stamp[id] == side->current;
+}
+
+// meet records a person found by both sides.
+static void meet(RelationshipFinder* finder, int id) {
+	int sum = finder->sides[0].distance[id] + finder->sides[1].distance[id];
+	if (sum < finder->best) {
+		finder->best = sum;
+		finder->numMeets = 0;
+	}
+	if (sum == finder->best) finder->meets[finder->numMeets++] = id;
+}
+
+// expandSide finds the parents of a side's frontier, the side's next generation.
+static void expandSide(RelationshipFinder* finder, int s) {
+	SearchSide* side = finder->sides + s;
+	SearchSide* other = finder->sides + 1 - s;
+	int* parents = finder->graph->parents;
+	int numNext = 0;
+	for (int i = 0; i < side->length; i++) {
+		int id = side->frontier[i];
+		for (int j = 2*id; j < 2*id + 2; j++) {
+			int parent = parents[j];
+			if (parent < 0 || found(side, parent)) continue;
+			side->stamp[parent] = side->current;
+			side->distance[parent] = side->level + 1;
+			side->via[parent] = id;
+			side->next[numNext++] = parent;
+			if (found(other, parent)) meet(finder, parent);
+		}
+	}
+	int* swap = side->frontier;
+	side->frontier = side->next;
+	side->next = swap;
+	side->length = numNext;
+	side->level++;
+}
+
+// lowerBound returns the fewest generations to a common ancestor not yet found by both sides, while
+// a side has a frontier. A person not yet found by a side is more generations up than its frontier.
+static int lowerBound(RelationshipFinder* finder) {
+	SearchSide* a = finder->sides;
+	SearchSide* b = finder->sides + 1;
+	if (a->length == 0) return b->level + 1;
+	if (b->length == 0) return a->level + 1;
+	return (a->level < b->level ? a->level : b->level) + 1;
+}
+
+// searchBlood searches for the nearest common ancestors of two persons.
+static bool searchBlood(RelationshipFinder* finder, int from, int to) {
+	int numPersons = finder->graph->numPersons;
+	SearchSide* a = finder->sides;
+	SearchSide* b = finder->sides + 1;
+	startSide(a, numPersons, from);
+	startSide(b, numPersons, to);
+	finder->numMeets = 0;
+	finder->best = INT_MAX;
+	if (from == to) meet(finder, from);
+	while ((a->length > 0 || b->length > 0) && lowerBound(finder) <= finder->best) {
+		// Expand the side with the nearer frontier, or the smaller frontier.
+		int s = 0;
+		if (a->length == 0) s = 1;
+		else if (b->length > 0 && (b->level < a->level || (b->level == a->level && b->length < a->length))) s = 1;
+		expandSide(finder, s);
+	}
+	return finder->numMeets > 0;
+}
+
+// sameParents returns true if two persons have the same parents.
+static bool sameParents(LineageGraph* graph, int a, int b) {
+	return graph->parents[2*a] == graph->parents[2*b] && graph->parents[2*a + 1] == graph->parents[2*b + 1];
+}
+
+// bloodRelationship returns the Relationship found by the last search; of the nearest common
+// ancestors it uses the one with the most even number of generations up from each person.
+static Relationship* bloodRelationship(RelationshipFinder* finder, int from, int to) {
+	SearchSide* a = finder->sides;
+	SearchSide* b = finder->sides + 1;
+	int ancestor = finder->meets[0];
+	for (int i = 1; i < finder->numMeets; i++) {
+		int id = finder->meets[i];
+		if (abs(a->distance[id] - b->distance[id]) < abs(a->distance[ancestor] - b->distance[ancestor]))
+			ancestor = id;
+	}
+	Relationship* relationship = (Relationship*) stdalloc(sizeof(Relationship));
+	relationship->from = from;
+	relationship->to = to;
+	relationship->ancestor = ancestor;
+	relationship->up = a->distance[ancestor];
+	relationship->down = b->distance[ancestor];
+	relationship->half = relationship->up > 0 && relationship->down > 0 &&
+		!sameParents(finder->graph, a->via[ancestor], b->via[ancestor]);
+	relationship->spouse = -1;
+	relationship->pathLength = relationship->up + relationship->down + 1;
+	relationship->path = (int*) stdalloc((relationship->pathLength + 2)*sizeof(int));
+	int i = relationship->up;
+	for (int id = ancestor; id >= 0; id = a->via[id]) relationship->path[i--] = id;
+	i = relationship->up + 1;
+	for (int id = b->via[ancestor]; id >= 0; id = b->via[id]) relationship->path[i++] = id;
+	relationship->name[0] = 0;
+	return relationship;
+}
+
+// deleteRelationship deletes a Relationship.
+void deleteRelationship(Relationship* relationship) {
+	if (!relationship) return;
+	stdfree(relationship->path);
+	stdfree(relationship);
+}
+
+// sexOf returns the sex of a person in a LineageGraph.
+static SexType sexOf(LineageGraph* graph, int id) {
+	return SEXV(graph->persons[id]);
+}
+
+// sexWord returns the word for a sex.
+static String sexWord(SexType sex, String male, String female, String unknown) {
+	return sex == sexMale ? male : sex == sexFemale ? female : unknown;
+}
+
+// numberOrdinal writes an ordinal number, 1st, 2nd, 3rd, 4th, ..., to a buffer.
+static String numberOrdinal(int n, String buffer, int length) {
+	String suffix = "th";
+	if (n % 100 < 11 || n % 100 > 13) {
+		if (n % 10 == 1) suffix = "st";
+		else if (n % 10 == 2) suffix = "nd";
+		else if (n % 10 == 3) suffix = "rd";
+	}
+	snprintf(buffer, length, "%d%s", n, suffix);
+	return buffer;
+}
+
+// greats writes the great- prefix of n generations to a buffer: "", "great-", "2nd great-", ...
+static String greats(int n, String buffer, int length) {
+	char number[16];
+	if (n <= 0) buffer[0] = 0;
+	else if (n == 1) snprintf(buffer, length, "great-");
+	else snprintf(buffer, length, "%s great-", numberOrdinal(n, number, sizeof(number)));
+	return buffer;
+}
+
+static String cousinOrdinals[] = {"", "first", "second", "third", "fourth", "fifth", "sixth",
+	"seventh", "eighth", "ninth", "tenth"};
+
+// nameBlood writes the name of a blood relationship to a buffer; up and down are the generations
+// from the two persons up to their nearest common ancestor, and sex is the first person's.
+static void nameBlood(int up, int down, bool half, SexType sex, String buffer, int length) {
+	char prefix[32];
+	String halfWord = half ? "half-" : "";
+	if (up == 0 && down == 0)
+		snprintf(buffer, length, "self");
+	else if (up == 0 && down == 1)
+		snprintf(buffer, length, "%s", sexWord(sex, "father", "mother", "parent"));
+	else if (up == 0)
+		snprintf(buffer, length, "%sgrand%s", greats(down - 2, prefix, sizeof(prefix)),
+				 sexWord(sex, "father", "mother", "parent"));
+	else if (down == 0 && up == 1)
+		snprintf(buffer, length, "%s", sexWord(sex, "son", "daughter", "child"));
+	else if (down == 0)
+		snprintf(buffer, length, "%sgrand%s", greats(up - 2, prefix, sizeof(prefix)),
+				 sexWord(sex, "son", "daughter", "child"));
+	else if (up == 1 && down == 1)
+		snprintf(buffer, length, "%s%s", halfWord, sexWord(sex, "brother", "sister", "sibling"));
+	else if (up == 1)
+		snprintf(buffer, length, "%s%s%s", greats(down - 2, prefix, sizeof(prefix)), halfWord,
+				 sexWord(sex, "uncle", "aunt", "uncle or aunt"));
+	else if (down == 1)
+		snprintf(buffer, length, "%s%s%s", greats(up - 2, prefix, sizeof(prefix)), halfWord,
+				 sexWord(sex, "nephew", "niece", "nephew or niece"));
+	else {
+		int degree = (up < down ? up : down) - 1;
+		int removed = abs(up - down);
+		char number[16], times[32];
+		String ordinal = degree < ARRAYSIZE(cousinOrdinals) ? cousinOrdinals[degree] :
+			numberOrdinal(degree, number, sizeof(number));
+		if (removed == 0) times[0] = 0;
+		else if (removed == 1) snprintf(times, sizeof(times), " once removed");
+		else if (removed == 2) snprintf(times, sizeof(times), " twice removed");
+		else snprintf(times, sizeof(times), " %d times removed", removed);
+		snprintf(buffer, length, "%s%s cousin%s", half ? "half " : "", ordinal, times);
+	}
+}
+
+// nameRelationship names a blood relationship.
+static void nameRelationship(LineageGraph* graph, Relationship* relationship) {
+	nameBlood(relationship->up, relationship->down, relationship->half,
+			  sexOf(graph, relationship->from), relationship->name, MAXRELATIONSHIPNAME);
+}
+
+// isRelationship returns true if a Relationship is up and down generations.
+static bool isRelationship(Relationship* relationship, int up, int down) {
+	return relationship->up == up && relationship->down == down;
+}
+
+// spouseRelationship returns the Relationship of two spouses.
+static Relationship* spouseRelationship(LineageGraph* graph, int from, int to) {
+	Relationship* relationship = (Relationship*) stdalloc(sizeof(Relationship));
+	*relationship = (Relationship) {from, to, -1, 0, 0, false, to, null, 2};
+	relationship->path = (int*) stdalloc(2*sizeof(int));
+	relationship->path[0] = from;
+	relationship->path[1] = to;
+	snprintf(relationship->name, MAXRELATIONSHIPNAME, "%s",
+			 sexWord(sexOf(graph, from), "husband", "wife", "spouse"));
+	return relationship;
+}
+
+// addToPath adds the first or second person to the path of a relationship found from or to a
+// spouse, making it an in-law relationship.
+static void addToPath(Relationship* relationship, int from, int to, int spouse) {
+	int* path = relationship->path;
+	if (relationship->from == spouse) {
+		memmove(path + 1, path, relationship->pathLength*sizeof(int));
+		path[0] = from;
+	} else path[relationship->pathLength] = to;
+	relationship->pathLength++;
+	relationship->from = from;
+	relationship->to = to;
+	relationship->spouse = spouse;
+}
+
+// nameInLaw names an in-law relationship. If the spouse is the second person's the first person is
+// related by blood to the spouse; otherwise the spouse is related by blood to the second person.
+static void nameInLaw(LineageGraph* graph, Relationship* relationship, bool toSpouse) {
+	SexType sex = sexOf(graph, relationship->from);
+	String name = relationship->name;
+	char blood[MAXRELATIONSHIPNAME - MAXINLAWPREFIX];
+	if (toSpouse) {
+		if (isRelationship(relationship, 0, 1))
+			snprintf(name, MAXRELATIONSHIPNAME, "%s-in-law", sexWord(sex, "father", "mother", "parent"));
+		else if (isRelationship(relationship, 1, 1))
+			snprintf(name, MAXRELATIONSHIPNAME, "%s-in-law", sexWord(sex, "brother", "sister", "sibling"));
+		else if (isRelationship(relationship, 1, 0))
+			snprintf(name, MAXRELATIONSHIPNAME, "%s", sexWord(sex, "stepson", "stepdaughter", "stepchild"));
+		else {
+			nameBlood(relationship->up, relationship->down, relationship->half, sex, blood, sizeof(blood));
+			snprintf(name, MAXRELATIONSHIPNAME, "spouse's %s", blood);
+		}
+		return;
+	}
+	if (isRelationship(relationship, 0, 1))
+		snprintf(name, MAXRELATIONSHIPNAME, "%s", sexWord(sex, "stepfather", "stepmother", "stepparent"));
+	else if (isRelationship(relationship, 1, 0))
+		snprintf(name, MAXRELATIONSHIPNAME, "%s-in-law", sexWord(sex, "son", "daughter", "child"));
+	else if (isRelationship(relationship, 1, 1))
+		snprintf(name, MAXRELATIONSHIPNAME, "%s-in-law", sexWord(sex, "brother", "sister", "sibling"));
+	else {
+		nameBlood(relationship->up, relationship->down, relationship->half,
+				  sexOf(graph, relationship->spouse), blood, sizeof(blood));
+		snprintf(name, MAXRELATIONSHIPNAME, "%s of %s", sexWord(sex, "husband", "wife", "spouse"), blood);
+	}
+}
+
+// findInLaw finds the nearest relationship by marriage between two persons not related by blood:
+// the first person is a spouse of the second, related by blood to a spouse of the second, or
+// has a spouse related by blood to the second.
+static Relationship* findInLaw(RelationshipFinder* finder, int from, int to) {
+	LineageGraph* graph = finder->graph;
+	int* spouses = graph->spouses;
+	for (int i = graph->firstSpouse[to]; i < graph->firstSpouse[to + 1]; i++)
+		if (spouses[i] == from) return spouseRelationship(graph, from, to);
+	Relationship* best = null;
+	bool bestToSpouse = false;
+	for (int pass = 0; pass < 2; pass++) {
+		int person = pass == 0 ? to : from;
+		for (int i = graph->firstSpouse[person]; i < graph->firstSpouse[person + 1]; i++) {
+			int spouse = spouses[i];
+			if (spouse < 0 || spouse == from || spouse == to) continue;
+			bool found = pass == 0 ? searchBlood(finder, from, spouse) : searchBlood(finder, spouse, to);
+			if (!found || (best && finder->best + 2 >= best->pathLength)) continue;
+			deleteRelationship(best);
+			best = pass == 0 ? bloodRelationship(finder, from, spouse) : bloodRelationship(finder, spouse, to);
+			addToPath(best, from, to, spouse);
+			bestToSpouse = pass == 0;
+		}
+	}
+	if (best) nameInLaw(graph, best, bestToSpouse);
+	return best;
+}
+
+// findRelationship returns how the first person is related to the second, by blood if they are,
+// else by marriage; returns null if they are not related.
+Relationship* findRelationship(RelationshipFinder* finder, int from, int to) {
+	int numPersons = finder->graph->numPersons;
+	if (from < 0 || from >= numPersons || to < 0 || to >= numPersons) return null;
+	if (searchBlood(finder, from, to)) {
+		Relationship* relationship = bloodRelationship(finder, from, to);
+		nameRelationship(finder->graph, relationship);
+		return relationship;
+	}
+	return findInLaw(finder, from, to);
+}
+
+// findRelationships finds how a person is related to each of count persons, setting results[i]
+// to the Relationship with to[i] or null. The ancestors of the first person are found once; each
+// search from another person stops when its frontier is as far up as the nearest common ancestor.
+void findRelationships(RelationshipFinder* finder, int from, int* to, int count, Relationship** results) {
+	int numPersons = finder->graph->numPersons;
+	SearchSide* a = finder->sides;
+	SearchSide* b = finder->sides + 1;
+	for (int i = 0; i < count; i++) results[i] = null;
+	if (from < 0 || from >= numPersons) return;
+	startSide(a, numPersons, from);
+	clearSide(b, numPersons);
+	while (a->length > 0) expandSide(finder, 0);
+	int numInLaws = 0;
+	for (int i = 0; i < count; i++) {
+		if (to[i] < 0 || to[i] >= numPersons) continue;
+		startSide(b, numPersons, to[i]);
+		finder->numMeets = 0;
+		finder->best = INT_MAX;
+		if (found(a, to[i])) meet(finder, to[i]);
+		while (b->length > 0 && b->level < finder->best) expandSide(finder, 1);
+		if (finder->numMeets == 0) {
+			numInLaws++;
+			continue;
+		}
+		results[i] = bloodRelationship(finder, from, to[i]);
+		nameRelationship(finder->graph, results[i]);
+	}
+	if (numInLaws == 0) return;
+	for (int i = 0; i < count; i++) // The searches for in-laws replace the first person's ancestors.
+		if (!results[i] && to[i] >= 0 && to[i] < numPersons) results[i] = findInLaw(finder, from, to[i]);
+}
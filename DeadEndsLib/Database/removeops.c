@@ -3,7 +3,7 @@
 // removeops.c has functions that perform remove operations on records in Databases.
 //
 // Created by Thomas Wetmore on 2 January 2024.
-// Last changed on 24 October 2024.
+// Last changed on 18 October 2026.
 //
 
 #include "stdlib.h"
@@ -11,8 +11,12 @@
 #include "gnode.h"
 #include "gedcom.h"
 
-// removeChildFromFamily removes an existing child from an existing family in a Database.
+// removeChildFromFamily removes an existing child from an existing family in a Database. Copies
+// of the records are edited and published, so child and family are replaced by new versions.
 bool removeChildFromFamily(GNode* child, GNode* family, Database* database) {
+    GNode *oldChild = child, *oldFamily = family;
+    child = copyRecordForEdit(oldChild);
+    family = copyRecordForEdit(oldFamily);
     // Find the CHIL node in the family that links to the person.
     GNode *frefn, *husb, *wife, *chil, *rest;
     splitFamily(family, &frefn, &husb, &wife, &chil, &rest);
@@ -25,6 +29,8 @@ bool removeChildFromFamily(GNode* child, GNode* family, Database* database) {
     // If there is no CHIL link to the person, there is nothing to do.
     if (!fnode) {
         joinFamily(family, frefn, husb, wife, chil, rest);
+        discardRecordCopy(family);
+        discardRecordCopy(child);
         return false;  // Person is not a child in this family.
     }
     // Find the FAMC node in the child that links to the family.
@@ -40,86 +46,86 @@ bool removeChildFromFamily(GNode* child, GNode* family, Database* database) {
     if (!pnode) {
         joinFamily(family, frefn, husb, wife, chil, rest);
         joinPerson(child, names, irefns, sex, body, famcs, famss);
+        discardRecordCopy(family);
+        discardRecordCopy(child);
         return false;  // Family is not family as child for the person.
     }
     // Remove the CHIL link from the family.
     if (fprev) {
         fprev->sibling = fnode->sibling;
     } else {
-        chil = fnode;
+        chil = fnode->sibling;
     }
     // Remove the FAMC line from child.
     if (pprev) {
         pprev->sibling = pnode->sibling;
     } else {
-        famcs = pnode;
+        famcs = pnode->sibling;
     }
     freeGNode(fnode);
     freeGNode(pnode);
     joinFamily(family, frefn, husb, wife, chil, rest);
     joinPerson(child, names, irefns, sex, body, famcs, famss);
+    publishRecord(database, oldFamily, family);
+    publishRecord(database, oldChild, child);
     return true;
 }
 
-// removeSpouseFromFamily removes an existing spouse from an existing family.
-bool removeSpouseFromFamily(GNode* spouse, GNode* family, Error* error) {
-	// Split the person and get its sex type.
-	GNode *names, *irefns, *sex, *body, *famcs, *famss;
-	splitPerson(spouse, &names, &irefns, &sex, &body, &famcs, &famss);
+// removeSpouseFromFamily removes an existing spouse from an existing family in a Database. Copies
+// of the records are edited and published, so spouse and family are replaced by new versions.
+bool removeSpouseFromFamily(GNode* spouse, GNode* family, Database* database) {
+	// Get the sex type of the spouse.
+	GNode* sex = SEX(spouse);
 	SexType sext = sex ? valueToSex(sex) : sexUnknown;
-	if (sext != sexMale && sext != sexFemale) {
-		// CREATE AN ERROR
-		return false;
-	}
+	if (sext != sexMale && sext != sexFemale) return false;
+	GNode *oldSpouse = spouse, *oldFamily = family;
+	spouse = copyRecordForEdit(oldSpouse);
+	family = copyRecordForEdit(oldFamily);
 	// Find the FAMS node to remove from the spouse.
+	GNode *names, *irefns, *body, *famcs, *famss;
+	splitPerson(spouse, &names, &irefns, &sex, &body, &famcs, &famss);
 	GNode *pprev = null;
 	GNode *pnode = famss;
 	while (pnode && nestr(pnode->value, family->key)) {
 		pprev = pnode;
 		pnode = pnode->sibling;
 	}
-	// If the FAMS node is not found report an error.
-	if (!pnode) {
-		// Create error here.
-		joinPerson(spouse, names, irefns, sex, body, famcs, famss);
-		return false;
-	}
-	// pnode is the FAMS node to remove.
-
 	// Split the family and find the HUSB or WIFE link to remove.
 	GNode *frefn, *husb, *wife, *chil, *rest;
 	splitFamily(family, &frefn, &husb, &wife, &chil, &rest);
 	GNode *fprev = null;
 	GNode *fnode = sext == sexMale ? husb : wife;
-	GNode *fnode0 = fnode;
 	while (fnode && nestr(fnode->value, spouse->key)) {
 		fprev = fnode;
 		fnode = fnode->sibling;
 	}
-	if (!fnode) {
-		// Create error here.
+	// If either link is missing there is nothing to do.
+	if (!pnode || !fnode) {
 		joinFamily(family, frefn, husb, wife, chil, rest);
 		joinPerson(spouse, names, irefns, sex, body, famcs, famss);
+		discardRecordCopy(family);
+		discardRecordCopy(spouse);
 		return false;
 	}
-	// Now snode is the HUSB or WIFE node to remove.
 	// Remove the FAMS node from the spouse.
 	if (!pprev) {
 		famss = pnode->sibling;
 	} else {
 		pprev->sibling = pnode->sibling;
 	}
-	joinPerson(spouse, names, irefns, sex, body, famcs, famss);
-	freeGNode(pnode);
+	// Remove the HUSB or WIFE node from the family.
 	if (!fprev) {
-		fnode0 = fnode->sibling;
+		if (sext == sexMale) husb = fnode->sibling;
+		else wife = fnode->sibling;
 	} else {
 		fprev->sibling = fnode->sibling;
 	}
-	// Put the spouse and family back together and free the two removed nodes.
+	// Put the spouse and family back together, free the two removed nodes, and publish.
 	joinPerson(spouse, names, irefns, sex, body, famcs, famss);
 	joinFamily(family, frefn, husb, wife, chil, rest);
 	freeGNode(pnode);
 	freeGNode(fnode);
+	publishRecord(database, oldFamily, family);
+	publishRecord(database, oldSpouse, spouse);
 	return true;
 }
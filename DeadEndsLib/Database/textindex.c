@@ -0,0 +1,341 @@
+// DeadEnds
+//
+// textindex.c implements the TextIndex, an inverted index of the words in the free-text values
+// of a Database. A free-text value is the value of a NOTE or TEXT node joined with its CONT and
+// CONC children; it is split into words of letters and digits that are case folded, so "Smith's"
+// gives the words "smith" and "s". Bytes above 127 are kept as letters so UTF-8 words are whole.
+// Each word has a posting list of (doc, position) pairs in the order the text was read, which
+// lets phrases be checked with binary searches.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <ctype.h>
+#include "textindex.h"
+#include "recordindex.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+#define MAXWORDLEN 64
+#define MAXQUERYWORDS 32
+
+static bool textIndexDebugging = false;
+static int numTextIndexBuckets = 8191;
+static String freeTextTags[] = {"NOTE", "TEXT", null};
+
+// getKey returns the word of a TextTerm.
+static String getKey(void* element) {
+	return ((TextTerm*) element)->word;
+}
+
+// compare compares two words.
+static int compare(String a, String b) {
+	return strcmp(a, b);
+}
+
+// delete frees a TextTerm and its postings.
+static void delete(void* element) {
+	TextTerm* term = (TextTerm*) element;
+	stdfree(term->word);
+	stdfree(term->postings);
+	stdfree(term);
+}
+
+// deleteTextDoc frees a TextDoc; its GNodes are not freed.
+static void deleteTextDoc(void* element) {
+	stdfree(element);
+}
+
+// createTextIndex creates an empty TextIndex.
+TextIndex* createTextIndex(void) {
+	TextIndex* index = (TextIndex*) stdalloc(sizeof(TextIndex));
+	index->terms = createHashTable(getKey, compare, delete, numTextIndexBuckets);
+	initBlock(&(index->docs));
+	index->numWords = 0;
+	return index;
+}
+
+// deleteTextIndex deletes a TextIndex.
+void deleteTextIndex(TextIndex* index) {
+	deleteHashTable(index->terms);
+	deleteBlock(&(index->docs), deleteTextDoc);
+	stdfree(index);
+}
+
+// Tokenizer splits text into case folded words. Text can be fed in pieces; a word is only ended
+// by a non-word character or an explicit call to endWord, so CONC pieces join words.
+typedef struct Tokenizer {
+	char word[MAXWORDLEN];
+	int length;
+	int position; // Position of the next word.
+	void (*emit)(String word, int position, void* data);
+	void* data;
+} Tokenizer;
+
+// endWord emits the word being built, if any.
+static void endWord(Tokenizer* tokenizer) {
+	if (tokenizer->length == 0) return;
+	tokenizer->word[tokenizer->length] = 0;
+	(*tokenizer->emit)(tokenizer->word, tokenizer->position++, tokenizer->data);
+	tokenizer->length = 0;
+}
+
+// tokenize feeds a piece of text to a Tokenizer. Long words are truncated.
+static void tokenize(Tokenizer* tokenizer, String text) {
+	if (!text) return;
+	for (unsigned char* p = (unsigned char*) text; *p; p++) {
+		if (isalnum(*p) || *p >= 0x80) {
+			if (tokenizer->length < MAXWORDLEN - 1) tokenizer->word[tokenizer->length++] = tolower(*p);
+		} else {
+			endWord(tokenizer);
+		}
+	}
+}
+
+// addPosting is the emit function used when indexing; data is the TextIndex.
+static void addPosting(String word, int position, void* data) {
+	TextIndex* index = (TextIndex*) data;
+	TextTerm* term = (TextTerm*) searchHashTable(index->terms, word);
+	if (!term) {
+		term = (TextTerm*) stdalloc(sizeof(TextTerm));
+		term->word = strsave(word);
+		term->maxPostings = 4;
+		term->numPostings = 0;
+		term->postings = (TextPosting*) stdalloc(term->maxPostings*sizeof(TextPosting));
+		addToHashTable(index->terms, term, false);
+	}
+	if (term->numPostings == term->maxPostings) { // Grow as Blocks do.
+		term->maxPostings = (3*term->maxPostings)/2;
+		TextPosting* postings = (TextPosting*) stdalloc(term->maxPostings*sizeof(TextPosting));
+		memcpy(postings, term->postings, term->numPostings*sizeof(TextPosting));
+		stdfree(term->postings);
+		term->postings = postings;
+	}
+	TextPosting* posting = term->postings + term->numPostings++;
+	posting->doc = index->docs.length - 1;
+	posting->position = position;
+	index->numWords++;
+}
+
+// isFreeTextTag returns true if a tag has a free-text value.
+static bool isFreeTextTag(String tag) {
+	for (String* p = freeTextTags; *p; p++)
+		if (eqstr(*p, tag)) return true;
+	return false;
+}
+
+// addNodeToTextIndex adds the free-text nodes in a tree to a TextIndex. Values that are keys,
+// as in "1 NOTE @N1@", are not text and are skipped.
+static void addNodeToTextIndex(TextIndex* index, GNode* node, GNode* root) {
+	for (; node; node = node->sibling) {
+		if (isFreeTextTag(node->tag) && !isKey(node->value)) {
+			TextDoc* doc = (TextDoc*) stdalloc(sizeof(TextDoc));
+			doc->node = node;
+			doc->root = root;
+			appendToBlock(&(index->docs), doc);
+			Tokenizer tokenizer = {.length = 0, .position = 0, .emit = addPosting, .data = index};
+			tokenize(&tokenizer, node->value);
+			for (GNode* child = node->child; child; child = child->sibling) {
+				if (eqstr(child->tag, "CONT")) endWord(&tokenizer);
+				else if (!eqstr(child->tag, "CONC")) continue;
+				tokenize(&tokenizer, child->value);
+			}
+			endWord(&tokenizer);
+		}
+		addNodeToTextIndex(index, node->child, root);
+	}
+}
+
+// addRecordToTextIndex adds the free-text nodes of a record to a TextIndex.
+void addRecordToTextIndex(TextIndex* index, GNode* root) {
+	if (isFreeTextTag(root->tag) && !isKey(root->value)) { // Note record.
+		addNodeToTextIndex(index, root, root);
+		return;
+	}
+	addNodeToTextIndex(index, root->child, root);
+}
+
+// getTextIndex returns the TextIndex of the free-text values of the records in a RecordIndex.
+TextIndex* getTextIndex(RecordIndex* recordIndex) {
+	TextIndex* index = createTextIndex();
+	FORHASHTABLE(recordIndex, element)
+		addRecordToTextIndex(index, (GNode*) element);
+	ENDHASHTABLE
+	if (textIndexDebugging) showTextIndexStats(index);
+	return index;
+}
+
+// DocSet is a sorted array of doc numbers; it holds intermediate query results.
+typedef struct DocSet {
+	int* docs;
+	int count;
+} DocSet;
+
+// createDocSet creates an empty DocSet with room for max docs.
+static DocSet* createDocSet(int max) {
+	DocSet* set = (DocSet*) stdalloc(sizeof(DocSet));
+	set->docs = (int*) stdalloc((max + 1)*sizeof(int));
+	set->count = 0;
+	return set;
+}
+
+// deleteDocSet frees a DocSet.
+static void deleteDocSet(DocSet* set) {
+	stdfree(set->docs);
+	stdfree(set);
+}
+
+// allDocs returns the DocSet of all docs in a TextIndex.
+static DocSet* allDocs(TextIndex* index) {
+	DocSet* set = createDocSet(index->docs.length);
+	for (int i = 0; i < index->docs.length; i++) set->docs[set->count++] = i;
+	return set;
+}
+
+// termDocs returns the DocSet of the docs with a word.
+static DocSet* termDocs(TextTerm* term) {
+	DocSet* set = createDocSet(term ? term->numPostings : 0);
+	if (!term) return set;
+	for (int i = 0; i < term->numPostings; i++) {
+		int doc = term->postings[i].doc;
+		if (set->count == 0 || set->docs[set->count - 1] != doc) set->docs[set->count++] = doc;
+	}
+	return set;
+}
+
+// hasPosting returns true if a TextTerm has a posting at a doc and position.
+static bool hasPosting(TextTerm* term, int doc, int position) {
+	int lo = 0, hi = term->numPostings - 1;
+	while (lo <= hi) {
+		int mid = (lo + hi)/2;
+		TextPosting* posting = term->postings + mid;
+		int rel = posting->doc != doc ? posting->doc - doc : posting->position - position;
+		if (rel == 0) return true;
+		if (rel < 0) lo = mid + 1;
+		else hi = mid - 1;
+	}
+	return false;
+}
+
+// phraseDocs returns the DocSet of the docs with a phrase. Each occurrence of the first word is
+// checked for the other words at the following positions.
+static DocSet* phraseDocs(TextTerm** terms, int numTerms) {
+	for (int i = 0; i < numTerms; i++)
+		if (!terms[i]) return createDocSet(0);
+	TextTerm* first = terms[0];
+	DocSet* set = createDocSet(first->numPostings);
+	for (int i = 0; i < first->numPostings; i++) {
+		TextPosting* posting = first->postings + i;
+		if (set->count && set->docs[set->count - 1] == posting->doc) continue;
+		int j = 1;
+		while (j < numTerms && hasPosting(terms[j], posting->doc, posting->position + j)) j++;
+		if (j == numTerms) set->docs[set->count++] = posting->doc;
+	}
+	return set;
+}
+
+// combineDocSets returns the intersection (op '&'), union (op '|') or difference (op '-') of two
+// DocSets; the DocSets are freed.
+static DocSet* combineDocSets(DocSet* a, DocSet* b, char op) {
+	DocSet* set = createDocSet(a->count + b->count);
+	int i = 0, j = 0;
+	while (i < a->count || j < b->count) {
+		int rel = i == a->count ? 1 : j == b->count ? -1 : a->docs[i] - b->docs[j];
+		if (rel < 0) {
+			if (op != '&') set->docs[set->count++] = a->docs[i];
+			i++;
+		} else if (rel > 0) {
+			if (op == '|') set->docs[set->count++] = b->docs[j];
+			j++;
+		} else {
+			if (op != '-') set->docs[set->count++] = a->docs[i];
+			i++; j++;
+		}
+	}
+	deleteDocSet(a);
+	deleteDocSet(b);
+	return set;
+}
+
+// QueryWords holds the words of one query item.
+typedef struct QueryWords {
+	TextIndex* index;
+	TextTerm* terms[MAXQUERYWORDS];
+	int count;
+} QueryWords;
+
+// addQueryWord is the emit function used for queries; data is the QueryWords.
+static void addQueryWord(String word, int position, void* data) {
+	QueryWords* words = (QueryWords*) data;
+	if (words->count < MAXQUERYWORDS)
+		words->terms[words->count++] = (TextTerm*) searchHashTable(words->index->terms, word);
+}
+
+// endClause applies the negated items of a clause and adds the clause to the result. A clause
+// with only negated items starts from all docs.
+static DocSet* endClause(TextIndex* index, DocSet* result, DocSet* clause, DocSet* negated) {
+	if (!clause && !negated) return result;
+	if (!clause) clause = allDocs(index);
+	if (negated) clause = combineDocSets(clause, negated, '-');
+	return result ? combineDocSets(result, clause, '|') : clause;
+}
+
+// searchTextIndex returns a List of the TextDocs that match a query. A query is a sequence of
+// items, each a word or a "quoted phrase", optionally preceded by - to exclude it. Items are
+// ANDed together; OR separates alternatives and binds more loosely than AND. An item that
+// splits into several words, like St.John, is treated as a phrase. The List is in doc order.
+// MNOTE: the caller owns the List but not its elements.
+List* searchTextIndex(TextIndex* index, String query) {
+	List* list = createList(null, null, null, false);
+	DocSet *result = null, *clause = null, *negated = null;
+	char buffer[MAXLINELEN];
+	String p = query;
+	while (p && *p) {
+		while (isspace((unsigned char) *p)) p++;
+		if (*p == 0) break;
+		bool negate = *p == '-';
+		if (negate) p++;
+		bool quoted = *p == '"';
+		String start = p, end;
+		if (quoted) {
+			start = ++p;
+			while (*p && *p != '"') p++;
+			end = p;
+			if (*p) p++;
+		} else {
+			while (*p && !isspace((unsigned char) *p)) p++;
+			end = p;
+		}
+		int length = (int) (end - start) < MAXLINELEN - 1 ? (int) (end - start) : MAXLINELEN - 1;
+		strncpy(buffer, start, length);
+		buffer[length] = 0;
+		if (!negate && !quoted && eqstr(buffer, "OR")) {
+			result = endClause(index, result, clause, negated);
+			clause = negated = null;
+			continue;
+		}
+		QueryWords words = {.index = index, .count = 0};
+		Tokenizer tokenizer = {.length = 0, .position = 0, .emit = addQueryWord, .data = &words};
+		tokenize(&tokenizer, buffer);
+		endWord(&tokenizer);
+		if (words.count == 0) continue;
+		DocSet* set = words.count == 1 ? termDocs(words.terms[0])
+									   : phraseDocs(words.terms, words.count);
+		if (negate) negated = negated ? combineDocSets(negated, set, '|') : set;
+		else clause = clause ? combineDocSets(clause, set, '&') : set;
+	}
+	result = endClause(index, result, clause, negated);
+	if (!result) return list;
+	for (int i = 0; i < result->count; i++)
+		appendToList(list, index->docs.elements[result->docs[i]]);
+	deleteDocSet(result);
+	return list;
+}
+
+// showTextIndexStats shows the numbers of docs, words and distinct words in a TextIndex.
+void showTextIndexStats(TextIndex* index) {
+	fprintf(stderr, "Summary of Text Index: %d docs, %d words, %d distinct words.\n",
+			index->docs.length, index->numWords, sizeHashTable(index->terms));
+}
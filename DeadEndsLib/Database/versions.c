@@ -0,0 +1,114 @@
+// DeadEnds
+//
+// versions.c implements copy-on-write record versions. The writer edits a private copy of a
+// record made by copyRecordForEdit and calls publishRecord, which swaps the copy into the
+// RecordIndex and root lists with atomic stores and retires the old version, so a record is
+// never found half edited.
+//
+// Publishing never frees; the writer may still hold pointers into the versions it replaced (a
+// script's variables, Sequences), so it calls reclaimVersions to free them when it holds none,
+// such as after a script has run. All versions of a record share the key String of the first
+// version, so the keys held by the name, path and other indexes stay valid.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include "versions.h"
+#include "database.h"
+#include "gedcom.h"
+
+static bool versionsDebugging = false;
+
+// freeVersion frees a retired version; its key belongs to the newer versions and is not freed.
+static void freeVersion(void* element) {
+	GNode* root = (GNode*) element;
+	root->key = null;
+	freeGNodes(root);
+}
+
+// createVersions creates the Versions of a Database.
+Versions* createVersions(void) {
+	Versions* versions = (Versions*) stdalloc(sizeof(Versions));
+	initBlock(&(versions->retired));
+	return versions;
+}
+
+// deleteVersions deletes Versions and frees the retired versions.
+void deleteVersions(Versions* versions) {
+	deleteBlock(&(versions->retired), freeVersion);
+	stdfree(versions);
+}
+
+// copyRecordForEdit returns a private copy of a record for the writer to edit. The copy shares
+// the key String of the record.
+GNode* copyRecordForEdit(GNode* root) {
+	GNode* copy = copyNodes(root, true, false);
+	stdfree(copy->key);
+	copy->key = root->key;
+	return copy;
+}
+
+// discardRecordCopy frees a copy made by copyRecordForEdit that will not be published.
+void discardRecordCopy(GNode* copy) {
+	copy->key = null;
+	freeGNodes(copy);
+}
+
+// swapElement replaces an element of a Block with an atomic store, so a lookup finds either the
+// old or the new element.
+static void swapElement(Block* block, int index, void* element) {
+	__atomic_store_n(&(block->elements[index]), element, __ATOMIC_RELEASE);
+}
+
+// swapInHashTable replaces the element with key in a HashTable.
+static bool swapInHashTable(HashTable* table, String key, void* element) {
+	Bucket* bucket = table->buckets[getHash(key, table->numBuckets)];
+	if (!bucket) return false;
+	int index = -1;
+	if (!searchBlock(&(bucket->block), key, table->getKey, &index) || index < 0) return false;
+	swapElement(&(bucket->block), index, element);
+	return true;
+}
+
+// swapInRootList replaces a root in a RootList.
+static void swapInRootList(RootList* roots, GNode* old, GNode* new) {
+	int index = -1;
+	if (roots && findInList(roots, old->key, &index)) swapElement(&(roots->block), index, new);
+}
+
+// publishRecord replaces the version old of a record with new, which must come from
+// copyRecordForEdit(old) and not have been published. The secondary indexes that point
+// into records are updated and old is retired. If old is not in the Database, new is discarded
+// and false is returned.
+// MNOTE: old stays valid until the writer calls reclaimVersions.
+bool publishRecord(Database* database, GNode* old, GNode* new) {
+	ASSERT(old && new && old->key == new->key);
+	if (!swapInHashTable(database->recordIndex, old->key, new)) {
+		discardRecordCopy(new);
+		return false;
+	}
+	RecordType rtype = recordType(new);
+	if (rtype == GRPerson) swapInRootList(database->personRoots, old, new);
+	else if (rtype == GRFamily) swapInRootList(database->familyRoots, old, new);
+	if (database->dateIndex) {
+		removeRecordFromDateIndex(database->dateIndex, old);
+		addRecordToDateIndex(database->dateIndex, new);
+	}
+	if (database->placeIndex) {
+		removeRecordFromPlaceIndex(database->placeIndex, old);
+		addRecordToPlaceIndex(database->placeIndex, new);
+	}
+	recordChanged(database, new);
+	appendToBlock(&(database->versions->retired), old);
+	return true;
+}
+
+// reclaimVersions frees the retired versions and returns how many were freed. Only the writer
+// calls it, when it holds no pointers into retired versions.
+int reclaimVersions(Database* database) {
+	Block* block = &(database->versions->retired);
+	int freed = block->length;
+	emptyBlock(block, freeVersion);
+	if (versionsDebugging && freed) fprintf(stderr, "Freed %d record versions.\n", freed);
+	return freed;
+}
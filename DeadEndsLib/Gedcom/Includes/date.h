@@ -3,7 +3,7 @@
 // date.h is the header file for the functions that manipulate Gedcom date Strings.
 //
 // Created by Thomas Wetmore on 22 February 2023.
-// Last changed on 19 August 2024.
+// Last changed on 18 October 2026.
 
 #ifndef date_h
 #define date_h
@@ -20,9 +20,38 @@ typedef enum DateToken {
 	atEndToken = 0
 } DateToken;
 
+#define MAXDATETOKEN 256
+
+// DateExtractor is the state of extracting tokens and dates from a String. Threads that extract
+// dates use their own DateExtractors; setExtractString, getDateToken and extractDate share one.
+typedef struct DateExtractor {
+	String cursor; // Next character to extract; null at the end.
+	char token[MAXDATETOKEN]; // Last token extracted.
+	char yearString[10]; // Year as it appears in the String.
+} DateExtractor;
+
 /* static */ void setExtractString(String);
 /*static*/ DateToken getDateToken(int *pInt, String *pString);
+void initDateExtractor(DateExtractor*, String);
+DateToken nextDateToken(DateExtractor*, int *pInt, String *pString);
+
+// PackedDate is a Gedcom date parsed into normalized form. minDay and maxDay are the day numbers
+// of the first and last days the date could refer to; open ended dates use the limits below.
+typedef struct PackedDate {
+	short year; // Year; negative for BC; 0 if no year.
+	char month; // Month 1-12; 0 if none.
+	char day; // Day 1-31; 0 if none.
+	char modifier; // Modifier code from extractDate without the BC offset; 0 if none.
+	int minDay; // First possible day number.
+	int maxDay; // Last possible day number.
+} PackedDate;
+
+#define minDayNumber (-10000000)
+#define maxDayNumber 10000000
 
 void extractDate(String, int*, int*, int*, int*, String*);
+void extractDateWith(DateExtractor*, String, int*, int*, int*, int*, String*);
+bool parseDate(String, PackedDate*);
+int dayNumber(int year, int month, int day);
 
 #endif // date_h
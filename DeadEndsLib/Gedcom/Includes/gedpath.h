@@ -3,7 +3,7 @@
 // gedpath.h is the header file for the GedPath feature.
 //
 // Created by Thomas Wetmore on 13 October 2024.
-// Last changed on 22 October 2024.
+// Last changed on 18 October 2026.
 
 #ifndef gedpath_h
 #define gedpath_h
@@ -23,6 +23,7 @@ struct GedPath {
 GedPath* createGedPath(void); // Create empty GedPath.
 GedPath* buildGedPath(String); // Build GedPath from an expression.
 void traverseGedPath(GNode*, GedPath*, GNodeList*, int*); // Search a GNode tree with GedPath.
+void deleteGedPath(GedPath*); // Free a GedPath list.
 
 void showGedPath(GedPath*); // Debug function to show GedPath.
 int showGNodePath(GNode*, int level); // Debug function to show path from root to node.
@@ -4,7 +4,7 @@
 // objects.
 //
 // Created by Thomas Wetmore on 4 November 2022.
-// Last changed on 30 November 2024.
+// Last changed on 18 October 2026.
 
 #ifndef gnode_h
 #define gnode_h
@@ -43,7 +43,9 @@ int treeStringLength(int, GNode*);
 GNode* personToFamilyAsChild(GNode *person, RecordIndex*);
 
 String personToEvent(GNode*, String, String, int, bool);
+String personToEventInBuffer(GNode*, String tag, String head, int len, bool shorten, String buffer);
 String eventToString(GNode*, bool);
+String eventToStringInBuffer(GNode*, bool shorten, String buffer);
 String eventToDate(GNode*, bool);
 String eventToPlace(GNode*, bool);
 void showGNodeTree(GNode*);
@@ -51,6 +53,7 @@ void showGNodes(int, GNode*);
 void showGNode(int level, GNode*);
 int gNodesLength(GNode*);
 String shortenDate(String);
+String shortenDateInBuffer(String date, String buffer);
 String shortenPlace(String);
 //static bool allDigits(String)
 GNode* copyNode(GNode*);
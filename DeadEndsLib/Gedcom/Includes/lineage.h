@@ -4,7 +4,7 @@
 // and properties
 //
 // Created by Thomas Wetmore on 17 February 2023.
-// Last changed on 30 November 2024.
+// Last changed on 18 October 2026.
 
 #ifndef lineage_h
 #define lineage_h
@@ -21,6 +21,7 @@ GNode *familyToSpouse(GNode*, SexType, RecordIndex* index); // Return first spou
 GNode* familyToFirstChild(GNode*, RecordIndex*); // Return first child of family.
 GNode* familyToLastChild(GNode*, RecordIndex*); // Return the last child of family.
 String personToName(GNode*, int); // Return the first name of a person.
+String personToNameInBuffer(GNode*, int, String buffer); // Same in a caller's buffer.
 String personToTitle(GNode*, int); // Return the first title of a person.
 int numberOfSpouses(GNode*, Database*); // Return the number of spouses of a person.
 int numberOfFamilies(GNode*); // Return the number of families a person is a spouse in.
@@ -3,7 +3,7 @@
 // name.h is the header file for the Gedcom name functions.
 //
 // Created by Thomas Wetmore on 7 November 2022.
-// Last changed on 13 December 2024.
+// Last changed on 18 October 2026.
 
 #ifndef name_h
 #define name_h
@@ -15,6 +15,10 @@ typedef struct Database Database;
 
 // Some functions use static dataspace to construct names. MAXNAMELEN is the maximum length.
 #define MAXNAMELEN 512
+#define NAMEKEYLEN 6 // Size of a name key buffer.
+#define SOUNDEXLEN 5 // Size of a Soundex code buffer.
+#define COLLATIONKEYLEN (2*MAXLINELEN + 4) // Size of a name collation key buffer.
+#define COLLATIONSEPARATOR '\x01' // Ends each name in a collation key.
 
 // User interface to name functions.
 String manipulateName(String, bool caps, bool reg, int maxlen); // Manipulate a name.
@@ -24,7 +28,20 @@ int getFirstInitial(String name); // Get the first initial of a Gedcom name.
 String soundex(String surname); // Get the Soundex code of a Gedcom surname.
 String nameToNameKey(String name); // Convert a partial or full Gedcom name to a name key.
 int compareNames(String name1, String name2); // Compare two Gedcom names.
+String nameCollationKey(String name, bool fold); // Get a key that sorts like compareNames.
 String* personKeysFromName(String name, RecordIndex*, NameIndex*, int* pcount);
+String upsurname(String name); // Make the surname of a name upper case.
+// Reentrant versions of the above that use caller memory.
+String manipulateNameInBuffer(String, bool caps, bool reg, int maxlen, String buffer); // MAXNAMELEN+1 chars.
+String getSurnameInBuffer(String name, String buffer); // MAXLINELEN+1 chars.
+String getGivenNamesInBuffer(String name, String buffer); // MAXNAMELEN+1 chars.
+String soundexInBuffer(String surname, String buffer); // SOUNDEXLEN chars.
+String nameToNameKeyInBuffer(String name, String buffer); // NAMEKEYLEN chars.
+String nameCollationKeyInBuffer(String name, bool fold, String buffer); // COLLATIONKEYLEN chars.
+int personKeysFromNameInBlock(String name, RecordIndex*, NameIndex*, Block* keys);
+String nameStringInBuffer(String name, String buffer); // MAXNAMELEN+1 chars.
+String trimNameInBuffer(String name, int len, String buffer); // MAXNAMELEN+1 chars.
+String upsurnameInBuffer(String name, String buffer); // MAXNAMELEN+1 chars.
 String nameString(String name); // Remove slashes from a name.
 String trimName (String name, int len); // Trim name to specific length.
 bool nameToList(String name, List*, int *len, int *sind);
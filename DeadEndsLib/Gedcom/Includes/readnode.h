@@ -3,7 +3,7 @@
 // readnode.h is the header file for functions that read GNodes from Gedcom files and Strings.
 //
 // Created by Thomas Wetmore on 17 December 2022.
-// Last changed on 3 September 2024.
+// Last changed on 18 October 2026.
 
 #ifndef readnode_h
 #define readnode_h
@@ -19,6 +19,8 @@ typedef enum ReadReturn {
 } ReadReturn;
 
 ReadReturn fileToLine(FILE*, int* line, int* lev, String* key, String* tag, String* val, String* err);
+ReadReturn fileToLineInBuffer(FILE*, String buffer, int* line, int* lev, String* key, String* tag,
+							  String* val, String* err);
 ReadReturn stringToLine(String* ps, int* line, int* lev, String* key, String* tag, String *val, String* err);
 
 #endif
@@ -3,9 +3,10 @@
 // date.c has the functions that deal with Gedcom-based dates.
 //
 // Created by Thomas Wetmore on 22 February 2023.
-// Last changed on 13 September 2024.
+// Last changed on 18 October 2026.
 
 #include <time.h>
+#include <pthread.h>
 #include "standard.h"
 #include "date.h"
 #include "stringtable.h"
@@ -50,9 +51,9 @@ static struct {
 	{ "cmp", "CMP", "computed", "COMPUTED" }, // 10
 };
 
-static String extractString = null;
-static String extractCursor = null;
+static DateExtractor extractor; // Used by setExtractString, getDateToken and extractDate.
 static StringTable *monthTable = null; // Maps month Strings to integers.
+static pthread_once_t monthTableOnce = PTHREAD_ONCE_INIT;
 
 /*==========================================
  * formatDate -- Do general date formatting
@@ -386,15 +387,23 @@ static String formatYear (int year, int format) {
     return (String) scratch;
 }
 
-// extractDate attempts to extract a date from any String.
+// extractDate attempts to extract a date from any String. If string is null extraction continues
+// where the last call stopped.
+// MNOTE: uses a static DateExtractor; the year string is in it.
 void extractDate(String string, int *pmod, int *pday, int *pmonth, int *pyear, String *pyrstr) {
+    extractDateWith(&extractor, string, pmod, pday, pmonth, pyear, pyrstr);
+}
+
+// extractDateWith attempts to extract a date from any String using a DateExtractor. If string is
+// null extraction continues where the last call with the DateExtractor stopped.
+void extractDateWith(DateExtractor* extractor, String string, int *pmod, int *pday, int *pmonth,
+					 int *pyear, String *pyrstr) {
     int tok, ival, era = 0;
     String sval;
-    static unsigned char yrstr[10];  // Year string?
     *pyrstr = "";
     *pmod = *pday = *pmonth = *pyear = 0;
-    if (string) setExtractString(string);
-    while ((tok = getDateToken(&ival, &sval))) {
+    if (string) initDateExtractor(extractor, string);
+    while ((tok = nextDateToken(extractor, &ival, &sval))) {
         switch (tok) {
             case monthToken: // Month string
                 if (*pmonth == 0) *pmonth = ival;
@@ -413,8 +422,8 @@ void extractDate(String string, int *pmod, int *pday, int *pmonth, int *pyear, S
                 if (ival >= 100 ||
                     (ival > 0 && sval[0] == '0' && sval[1] == '0')) {
                     if (eqstr(*pyrstr,"")) {
-                        strcpy((char*) yrstr, sval);
-                        *pyrstr = (char*) yrstr;
+                        snprintf(extractor->yearString, sizeof(extractor->yearString), "%s", sval);
+                        *pyrstr = extractor->yearString;
                         *pyear = ival;
                     }
                 }
@@ -430,67 +439,146 @@ combine:
     *pmod += era;
 }
 
-// setExtractString initializes the file static date extraction string.
+// dayNumber returns the number of days from 1 January 1970 to a date in the proleptic Gregorian
+// calendar. Year is astronomical (1 BC is year 0); month is 1-12.
+int dayNumber(int year, int month, int day) {
+	year -= month <= 2;
+	int era = (year >= 0 ? year : year - 399)/400;
+	int yoe = year - era*400;
+	int doy = (153*(month > 2 ? month - 3 : month + 9) + 2)/5 + day - 1;
+	int doe = yoe*365 + yoe/4 - yoe/100 + doy;
+	return era*146097 + doe - 719468;
+}
+
+// approximateDays is how far an ABT, EST or CAL date is widened on each side.
+static int approximateDays = 2*365;
+
+// dateRange sets the first and last day numbers of a year, month and day; month and day may
+// be zero. Era is 100 for BC dates.
+static void dateRange(int year, int month, int day, int era, int* pmin, int* pmax) {
+	if (era >= 100) year = 1 - year;
+	if (month < 1 || month > 12) {
+		*pmin = dayNumber(year, 1, 1);
+		*pmax = dayNumber(year + 1, 1, 1) - 1;
+	} else if (day < 1) {
+		*pmin = dayNumber(year, month, 1);
+		*pmax = (month == 12 ? dayNumber(year + 1, 1, 1) : dayNumber(year, month + 1, 1)) - 1;
+	} else {
+		*pmin = *pmax = dayNumber(year, month, day);
+	}
+}
+
+// parseDate parses a Gedcom date String into a PackedDate. The extraction is done once here so
+// that users of the PackedDate do not tokenize the String again. Returns false if the String has
+// no year.
+bool parseDate(String string, PackedDate* date) {
+	int mod, day, month, year, min, max, endMin;
+	String yrstr;
+	DateExtractor extractor;
+	memset(date, 0, sizeof(PackedDate));
+	if (!string) return false;
+	extractDateWith(&extractor, string, &mod, &day, &month, &year, &yrstr);
+	int era = mod >= 100 ? 100 : 0;
+	mod %= 100;
+	if (year == 0) return false;
+	date->year = era ? -year : year;
+	date->month = month;
+	date->day = day;
+	date->modifier = mod;
+	dateRange(year, month, day, era, &min, &max);
+	switch (mod) {
+		case 1: case 8: case 9: // ABT, EST, CAL.
+			min -= approximateDays;
+			max += approximateDays;
+			break;
+		case 2: case 7: // BEF, TO.
+			min = minDayNumber;
+			break;
+		case 3: // AFT.
+			max = maxDayNumber;
+			break;
+		case 4: case 6: // BET ... AND, FROM ... TO.
+			extractDateWith(&extractor, null, &mod, &day, &month, &year, &yrstr);
+			if (year) dateRange(year, month, day, mod >= 100 ? 100 : 0, &endMin, &max);
+			else if (date->modifier == 6) max = maxDayNumber;
+			break;
+	}
+	date->minDay = min;
+	date->maxDay = max;
+	return true;
+}
+
+// setExtractString initializes the static DateExtractor with a String.
 /*static*/ void setExtractString (String str) {
-    extractString = str;
-	extractCursor = str;
-    if (!monthTable) initMonthTable();
+    initDateExtractor(&extractor, str);
 }
 
-// getDateToken returns the next token from the date extraction string.
+// getDateToken returns the next token from the static DateExtractor.
 /*static*/ DateToken getDateToken(int *pInt, String *pString) {
-    static unsigned char scratch[256]; // Where tokens are built.
-    String p = (String) scratch;
-	*pInt = 0;
-	*pString = (String) scratch;
+    return nextDateToken(&extractor, pInt, pString);
+}
+
+// initDateExtractor initializes a DateExtractor to extract from a String.
+void initDateExtractor(DateExtractor* extractor, String str) {
+    extractor->cursor = str;
+    extractor->token[0] = 0;
+    pthread_once(&monthTableOnce, initMonthTable);
+}
+
+// nextDateToken returns the next token from a DateExtractor. Tokens longer than MAXDATETOKEN-1
+// chars are truncated.
+DateToken nextDateToken(DateExtractor* extractor, int *pInt, String *pString) {
+    String p = extractor->token;
+    String end = extractor->token + MAXDATETOKEN - 1;
+    String cursor = extractor->cursor;
+    *pInt = 0;
+    *pString = extractor->token;
     int i, c;
-    if (!extractString) return atEndToken; // Must exist.
-    while (iswhite(*extractString++)) ; // Skip white.
-    extractString--;
+    if (!cursor) return atEndToken; // Must exist.
+    while (iswhite(*cursor)) cursor++; // Skip white.
 	// Found a letter so look for a word.
-    if (isLetter(*extractString)) {
-		while (isLetter(*p++ = *extractString++)) // Load word into scratch.
-			;
-        *--p = 0;
-        extractString--;
-		*pString = (String) scratch;
-		if (strlen((const char*) scratch) == 1) return charToken;
+    if (isLetter(*cursor)) {
+        char upperWord[MAXDATETOKEN];
+        String q = upperWord;
+        for (; isLetter(c = *cursor); cursor++) { // Load word into token.
+            if (p == end) continue;
+            *p++ = c;
+            *q++ = toupper(c);
+        }
+        *p = *q = 0;
+        extractor->cursor = cursor;
+		if (strlen(extractor->token) == 1) return charToken;
 		// If the word is in the month table, return the month's integer.
-        if ((i = searchIntegerTable(monthTable, upper((String)scratch))) > 0 && i <= 12) {
+        if ((i = searchIntegerTable(monthTable, upperWord)) > 0 && i <= 12) {
             *pInt = i;
             return monthToken;
         }
 		// If word is one of the known date words return its index.
-        *pInt = 0;
 		if (i > 12 && i <= 22) {
 			*pInt = i - 12;
 			return wordToken;
 		}
-        *pInt = 0;
         return unknownToken;
     }
-    if (chartype(*extractString) == DIGIT) {
+    if (chartype(*cursor) == DIGIT) {
         i = 0;
-		while (chartype(c = *p++ = *extractString++) == DIGIT) {
-			i = i*10 + c - '0';
-		}
-        //if (c == '/') { // Intended to handle double year dates.
-            //while (chartype(*p++ = *extractString++) == DIGIT) ;
-        //}
-        *--p = 0;
-        extractString--;
-        *pString = (String) scratch;
+        for (; chartype(c = *cursor) == DIGIT; cursor++) {
+            if (p < end) *p++ = c;
+            i = i*10 + c - '0';
+        }
+        *p = 0;
+        extractor->cursor = cursor;
         *pInt = i;
         return intToken;
     }
-    if (*extractString == 0)  {
-        extractString = null;
+    if (*cursor == 0)  {
+        extractor->cursor = null;
         return atEndToken;
     }
-	*p++ = *extractString++;
+	*p++ = *cursor++;
 	*p = 0;
-	*pString = (String) scratch;
-	*pInt = (int) scratch[0];
+	extractor->cursor = cursor;
+	*pInt = (unsigned char) extractor->token[0];
 	return charToken;
 }
 
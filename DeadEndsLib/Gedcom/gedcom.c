@@ -3,14 +3,18 @@
 // gedcom.c has basic Gedcom functions.
 //
 // Created by Thomas Wetmore on 29 November 2022.
-// Last changed on 22 October 2024.
+// Last changed on 18 October 2026.
 
 #include "gedcom.h"
 
 // recordType returns the type of a Gedcom record.
 RecordType recordType(GNode* root) {
     ASSERT(root);
-    String tag = root->tag;
+    return tagToRecordType(root->tag);
+}
+
+// tagToRecordType returns the type of a Gedcom record with a level 0 tag.
+RecordType tagToRecordType(String tag) {
     if (eqstr(tag, "INDI")) return GRPerson;
     if (eqstr(tag, "FAM"))  return GRFamily;
     if (eqstr(tag, "SOUR")) return GRSource;
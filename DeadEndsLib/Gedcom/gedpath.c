@@ -4,13 +4,13 @@
 // structs that represents a path from a GNode to one or more GNodes in the tree below.
 //
 // Created by Thomas Wetmore on 13 October 2024.
-// Last changed on 22 October 2024.
+// Last changed on 18 October 2026.
 
 #include "gedpath.h"
 #include "gnode.h"
 #include "gnodelist.h"
 
-static bool traverseDebug = true;
+static bool traverseDebug = false;
 
 // buildPath parses a Gedcom path expression to a GedPath. For example the string
 // "INDI->ANY*->DATE*" / is converted to a linked list of three GedPath structs.
@@ -3,8 +3,10 @@
 //  gnode.c has many functions for the GNode data type.
 //
 //  Created by Thomas Wetmore on 12 November 2022.
-//  Last changed on 22 October 2024.
+//  Last changed on 18 October 2026.
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include "standard.h"
 #include "gnode.h"
 #include "nodeutils.h"
@@ -16,27 +18,39 @@
 #include "readnode.h"
 #include "database.h"
 
-// tagTable is the StringTable that holds a single copy of all tags used in the GNodes.
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memGNode
+
+// tagTable is the StringTable that holds a single copy of all tags used in the GNodes. It is
+// shared by all Databases, so it is locked for Databases read by several threads.
 static StringTable *tagTable = null;
+static pthread_rwlock_t tagTableLock = PTHREAD_RWLOCK_INITIALIZER;
 
 // numNodeAllocs returns the number of GNodes that have been allocatedp. Debugging.
-static int nodeAllocs = 0;
+static atomic_int nodeAllocs = 0;
 int numNodeAllocs(void) {
 	return nodeAllocs;
 }
 
 // numNodeFrees returns the number of GNodes that have been freed. Debugging.
-static int nodeFrees = 0;
+static atomic_int nodeFrees = 0;
 int numNodeFrees(void) {
 	return nodeFrees;
 }
 
-// getFromTagTable returns the persistent tag value from the tag table.
+// getFromTagTable returns the persistent tag value from the tag table. Most tags are found with
+// the read lock; the write lock is taken only to add a new tag.
 static int numBucketsInTagTable = 67;
 static String getFromTagTable(String tag) {
-	if (tagTable) return fixString(tagTable, tag);
-	tagTable = createStringTable(numBucketsInTagTable);
-	return fixString(tagTable, tag);
+	pthread_rwlock_rdlock(&tagTableLock);
+	String saved = tagTable ? searchStringTable(tagTable, tag) : null;
+	pthread_rwlock_unlock(&tagTableLock);
+	if (saved) return saved;
+	pthread_rwlock_wrlock(&tagTableLock);
+	if (!tagTable) tagTable = createStringTable(numBucketsInTagTable);
+	saved = fixString(tagTable, tag);
+	pthread_rwlock_unlock(&tagTableLock);
+	return saved;
 }
 
 // freeGNode frees a GNode.
@@ -52,7 +66,7 @@ void freeGNode(GNode* node) {
 // from the tag table. This is the only time that memory for these fields is handled.
 GNode* createGNode(String key, String tag, String value, GNode* parent) {
 	nodeAllocs++;
-	GNode* node = (GNode*) malloc(sizeof(GNode));;
+	GNode* node = (GNode*) stdalloc(sizeof(GNode));
 	node->key = strsave(key);
 	node->tag = getFromTagTable(tag);
 	node->value = strsave(value);
@@ -85,27 +99,39 @@ int gnodeLevel(GNode* node) {
 
 // personToEvent converta an event tree to a string; returns static memory.
 String personToEvent(GNode* person, String tag, String head, int len, bool shorten) {
-	static char scratch[200];
-	String event;
-	size_t n;
+	static char scratch[MAXLINELEN+1];
+	return personToEventInBuffer(person, tag, head, len, shorten, scratch);
+}
+
+// personToEventInBuffer converts the first event of a person with a tag to a string in a buffer
+// of MAXLINELEN+1 chars.
+String personToEventInBuffer(GNode* person, String tag, String head, int len, bool shorten,
+							 String buffer) {
+	char event[MAXLINELEN+1];
 	if (!person) return null;
 	if (!(person = findTag(person->child, tag))) return null;
-	event = eventToString(person, shorten);
-	if (!event) return null;
-	sprintf(scratch, "%s%s", head, event);
-	n = strlen(scratch);
-	if (scratch[n-1] != '.') {
-		scratch[n] = '.';
-		scratch[++n] = 0;
+	if (!eventToStringInBuffer(person, shorten, event)) return null;
+	int n = snprintf(buffer, MAXLINELEN, "%s%s", head, event);
+	if (n > MAXLINELEN - 1) n = MAXLINELEN - 1;
+	if (n > 0 && buffer[n-1] != '.') {
+		buffer[n] = '.';
+		buffer[++n] = 0;
 	}
-	if (n > len) scratch[len] = 0;
-	return scratch;
+	if (n > len) buffer[len] = 0;
+	return buffer;
 }
 
 // eventToString converts an event to a string; returns static memory.
 String eventToString(GNode* node, bool shorten) {
 	static char scratch[MAXLINELEN+1];
-	String date, plac, p;
+	return eventToStringInBuffer(node, shorten, scratch);
+}
+
+// eventToStringInBuffer converts an event to a string in a buffer of MAXLINELEN+1 chars. Returns
+// null if the event has no date or place.
+String eventToStringInBuffer(GNode* node, bool shorten, String buffer) {
+	char shortDate[MAXLINELEN+1];
+	String date, plac;
 	date = plac = null;
 	if (!node) return null;
 	node = node->child;
@@ -116,29 +142,15 @@ String eventToString(GNode* node, bool shorten) {
 	}
 	if (!date && !plac) return null;
 	if (shorten) {
-		date = shortenDate(date);
+		date = shortenDateInBuffer(date, shortDate);
 		plac = shortenPlace(plac);
 		if (!date && !plac) return null;
 	}
-	p = scratch;
-	if (date && !plac) {
-		strcpy(p, date);
-		p += strlen(p);
-	}
-	if (date && plac) {
-		strcpy(p, date);
-		p += strlen(p);
-		strcpy(p, ", ");
-		p += 2;
-		strcpy(p, plac);
-		p += strlen(p);
-	}
-	if (!date && plac) {
-		strcpy(p, plac);
-		p += strlen(p);
-	}
-	*p = 0;
-	return scratch;
+	if (date && plac)
+		snprintf(buffer, MAXLINELEN+1, "%s, %s", date, plac);
+	else
+		snprintf(buffer, MAXLINELEN+1, "%s", date ? date : plac);
+	return buffer;
 }
 
 // eventToDate returns the date of an event as a string.
@@ -196,23 +208,28 @@ int gNodesLength(GNode* node) {
 	return len;
 }
 
-// shortenDate returns the short form of a date value.
+// shortenDate returns the short form of a date value; returns one of three static buffers.
 String shortenDate(String date) {
 	static char buffer[3][MAXLINELEN+1];
 	static int dex = 0;
+	if (++dex > 2) dex = 0;
+	return shortenDateInBuffer(date, buffer[dex]);
+}
+
+// shortenDateInBuffer returns the short form of a date value, its year, in a buffer of at least
+// 7 chars.
+String shortenDateInBuffer(String date, String buffer) {
 	String p = date, q;
 	int c, len;
 	/* Allow 3 or 4 digit years. The previous test for strlen(date) < 4
 	 * prevented dates consisting of only 3 digit years from being
 	 * returned. - pbm 12 oct 99 */
 	if (!date || (int) strlen(date) < 3) return null;
-	if (++dex > 2) dex = 0;
-	q = buffer[dex];
 	while (true) {
 		while ((c = *p++) && chartype(c) != DIGIT)
 			;
 		if (c == 0) return null;
-		q = buffer[dex];
+		q = buffer;
 		*q++ = c;
 		len = 1;
 		while ((c = *p++) && chartype(c) == DIGIT) {
@@ -222,8 +239,8 @@ String shortenDate(String date) {
 			}
 		}
 		*q = 0;
-		if (strlen(buffer[dex]) == 3 || strlen(buffer[dex]) == 4)
-			return buffer[dex];
+		if (strlen(buffer) == 3 || strlen(buffer) == 4)
+			return buffer;
 		if (c == 0) return null;
 	}
 }
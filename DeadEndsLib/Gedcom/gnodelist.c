@@ -3,7 +3,7 @@
 // gnodelist.c implements the GNodeList data type.
 //
 // Created by Thomas Wetmore on 27 May 2024.
-// Last changed on 12 December 2024.
+// Last changed on 18 October 2026.
 
 #include "gnodelist.h"
 #include "readnode.h"
@@ -50,7 +50,7 @@ void deleteGNodeList(GNodeList* list, void (*delete)(void*)) {
 	deleteList(list);
 }
 
-// getGNodeListFromFile uses fileToLine to get the GNodeList of all GNodes in a Gedcom file. If
+// getGNodeListFromFile uses fileToLineInBuffer to get the GNodeList of all GNodes in a Gedcom file. If
 // the keymap is not null it is used to map record keys to the lines where defined. Syntax errors
 // are added to the ErrorLog. The file is fully processed regardless of errors. If errors are
 // found the list is deleted and null is returned. The data field in the GNodeListEl holds the
@@ -64,9 +64,10 @@ GNodeList* getGNodeListFromFile(File* file, IntegerTable* keymap, ErrorLog* elog
 	int line = 0;
 	String key, tag, value;
 	String errstr;
+	char buffer[MAXLINELEN];
 
 	// Read lines and create nodes.
-	ReadReturn rc = fileToLine(fp, &line, &level, &key, &tag, &value, &errstr);
+	ReadReturn rc = fileToLineInBuffer(fp, buffer, &line, &level, &key, &tag, &value, &errstr);
 	while (rc != ReadAtEnd) {
 		if (rc == ReadOkay) {
 			GNode* gnode = createGNode(key, tag, value, null);
@@ -77,7 +78,7 @@ GNodeList* getGNodeListFromFile(File* file, IntegerTable* keymap, ErrorLog* elog
 			Error* error = createError(gedcomError, file->name, line, errstr);
 			addErrorToLog(elog, error);
 		}
-		rc = fileToLine(fp, &line, &level, &key, &tag, &value, &errstr);
+		rc = fileToLineInBuffer(fp, buffer, &line, &level, &key, &tag, &value, &errstr);
 	}
 	if (lengthList(nodeList) > 0) return nodeList;
 	deleteList(nodeList);
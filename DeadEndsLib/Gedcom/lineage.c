@@ -3,7 +3,7 @@
 // lineage.c holds perations on GNodes based on genealogical relationsips and properties.
 //
 // Created by Thomas Wetmore on 17 February 2023.
-// Last changed on 12 May 2024.
+// Last changed on 18 October 2026.
 
 #include "lineage.h"
 #include "gnode.h"
@@ -153,6 +153,14 @@ String personToName(GNode* person, int length) {
 	return manipulateName(person->value, true, true, length);
 }
 
+// personToNameInBuffer returns the name of a person like personToName in a buffer of
+// MAXNAMELEN+1 chars.
+String personToNameInBuffer(GNode* person, int length, String buffer) {
+	if (!person) return "";
+	if (!(person = findTag(person->child, "NAME"))) return "";
+	return manipulateNameInBuffer(person->value, true, true, length, buffer);
+}
+
 // personToTitle returns the title of a person, the value of the first TITL node in the person.
 String personToTitle(GNode* indi, int len) {
 	if (!indi) return null;
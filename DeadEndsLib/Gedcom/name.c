@@ -1,60 +1,68 @@
 // DeadEnds
 //
 // name.c has the functions that deal with Gedcom names. Several functions return pointers to
-// static memory. Callers beware.
+// static memory. Callers beware. The functions ending in InBuffer use memory passed by the
+// caller and can be called from several threads.
 //
 // Created by Thomas Wetmore on 7 November 2022.
-// Last changed on 8 May 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "name.h"
 #include "gnode.h"
 #include "nameindex.h"
 
-static int old = 0;
-
 // Static functions used in this file.
-static int codeOf(int letter);
-static String partsToName(String* parts);
+static int codeOf(int letter, int* old);
+static String partsToName(String* parts, String buffer);
 static bool pieceMatch(String partial, String complete);
-static void nameToParts(String name, String *parts);
+static void nameToParts(String name, String *parts, String buffer);
 static void squeeze(String string, String super);
 static String nextPiece(String name);
 static void cmpsqueeze (String in, String out);
 //static String nameString (String);
-static String nameSurnameFirst(String);
+static String nameSurnameFirst(String, String buffer);
 
 // nameToNameKey converts a Gedcom name or partial name to a name key.
+// MNOTE: returns static memory.
 String nameToNameKey(String name) {
-    static char key[6];
-    char finitial = getFirstInitial(name);
-    String sdex = soundex(getSurname(name));
-    key[0] = finitial;
-    key[1] = *sdex++;
-    key[2] = *sdex++;
-    key[3] = *sdex++;
-    key[4] = *sdex;
-    key[5] = 0;
+    static char key[NAMEKEYLEN];
+    return nameToNameKeyInBuffer(name, key);
+}
+
+// nameToNameKeyInBuffer converts a Gedcom name or partial name to a name key in a buffer of
+// NAMEKEYLEN chars.
+String nameToNameKeyInBuffer(String name, String key) {
+    char surname[MAXLINELEN+1];
+    char sdex[SOUNDEXLEN];
+    key[0] = getFirstInitial(name);
+    strcpy(key + 1, soundexInBuffer(getSurnameInBuffer(name, surname), sdex));
     return key;
 }
 
 // getSurname returns the surname part of a Gedcom name.
+// MNOTE: returns one of NBUFFERS static buffers.
 #define NBUFFERS (4)
 String getSurname(String name) {
-    int c;
     static char buffer[NBUFFERS][MAXLINELEN+1];
     static int dex = 0;
-    String p, surname;
     if (++dex > NBUFFERS-1) dex = 0;
-    p = surname = buffer[dex];
+    return getSurnameInBuffer(name, buffer[dex]);
+}
+
+// getSurnameInBuffer returns the surname part of a Gedcom name in a buffer of MAXLINELEN+1 chars.
+// If the name has no surname "____" is returned.
+String getSurnameInBuffer(String name, String surname) {
+    int c;
+    String p = surname;
     while ((c = *name++) && c != '/')
         ;
-    if (c == 0) return "____";
+    if (c == 0) return strcpy(surname, "____");
     while (iswhite(c = *name++))
         ;
-    if (c == 0 || c == '/' || !isLetter(c)) return "____";
+    if (c == 0 || c == '/' || !isLetter(c)) return strcpy(surname, "____");
     *p++ = c;
-    while ((c = *name++) && c != '/')
+    while ((c = *name++) && c != '/' && p < surname + MAXLINELEN)
         *p++ = c;
     *p = 0;
     striptrail(surname);
@@ -75,34 +83,33 @@ int getFirstInitial(String name) {
 }
 
 // soundex returns the Soundex code of a surname.
+// MNOTE: returns static memory.
 String soundex(String name) {
-    static char scratch[MAXNAMELEN];
+    static char scratch[SOUNDEXLEN];
+    return soundexInBuffer(name, scratch);
+}
+
+// soundexInBuffer returns the Soundex code of a surname in a buffer of SOUNDEXLEN chars.
+String soundexInBuffer(String name, String code) {
     int c, j;
-    if (!name || strlen(name) > MAXNAMELEN || !strcmp(name, "____"))
-        return "Z999";
-    String p = name;
-    String q = scratch;
-    while ((c = *p++))
-        *q++ = toupper(c);
-    *q = 0;
-    p = q = &scratch[1];
+    if (!name || *name == 0 || strlen(name) > MAXNAMELEN || !strcmp(name, "____"))
+        return strcpy(code, "Z999");
+    code[0] = toupper(*name);
+    String p = name + 1;
     int i = 1;
-    old = 0;
+    int old = 0; // Code of the previous letter.
     while ((c = *p++) && i < 4) {
-        if ((j = codeOf(c)) == 0) continue;
-        *q++ = j;
-        i++;
+        if ((j = codeOf(toupper(c), &old)) == 0) continue;
+        code[i++] = j;
     }
-    while (i < 4) {
-        *q++ = '0';
-        i++;
-    }
-    *q = 0;
-    return scratch;
+    while (i < 4)
+        code[i++] = '0';
+    code[i] = 0;
+    return code;
 }
 
-// codeof returns a letter's Soundex code.
-static int codeOf(int letter) {
+// codeof returns a letter's Soundex code; old is the code of the previous letter.
+static int codeOf(int letter, int* old) {
     int new = 0;
     switch (letter) {
     case 'B': case 'P': case 'F': case 'V':
@@ -122,11 +129,11 @@ static int codeOf(int letter) {
 		break;
     }
     if (new == 0) {
-        old = 0;
+        *old = 0;
         return 0;
     }
-    if (new == old) return 0;
-    old = new;
+    if (new == *old) return 0;
+    *old = new;
     return new;
 }
 
@@ -200,32 +207,39 @@ String* personKeysFromName(String name, RecordIndex* rindex, NameIndex* nindex,
 		initBlock(&recordKeys);
         first = false;
     }
-	*pcount = 0;
+    emptyBlock(&recordKeys, null);
+	*pcount = personKeysFromNameInBlock(name, rindex, nindex, &recordKeys);
+    return *pcount ? (String*) recordKeys.elements : null;
+}
+
+// personKeysFromNameInBlock appends the keys of the persons with a name that matches a given
+// name pattern to a caller's Block and returns how many were appended.
+// MNOTE: The keys are those in the RecordIndex; they are not copied.
+int personKeysFromNameInBlock(String name, RecordIndex* rindex, NameIndex* nindex, Block* recordKeys) {
 	// Get Set of person keys with names that match the pattern.
     Set *keySet = searchNameIndex(nindex, name);
-    if (!keySet || lengthSet(keySet) == 0) return null;
-	// Copy person keys with matching names to a Block.
-    emptyBlock(&recordKeys, null);
+    if (!keySet || lengthSet(keySet) == 0) return 0;
+	// Copy person keys with matching names to the Block.
 	int count = 0;
 	List* list = listOfSet(keySet);
 	FORLIST(list, recordKey)
 		GNode* person = keyToPerson((String) recordKey, rindex);
 		for (GNode* node = NAME(person); node && eqstr(node->tag, "NAME"); node = node->sibling) {
 			if (!exactMatch(name, node->value)) continue; // exactMatch doesn't mean 'exact.'
-			appendToBlock(&recordKeys, recordKey);
+			appendToBlock(recordKeys, recordKey);
 			count++;
 			break;
 		}
 	ENDLIST
-	*pcount = count;
-    return (String*) recordKeys.elements;
+    return count;
 }
 
 // compareNames compares two Gedcom names and returns their relationship.
 int compareNames(String name1, String name2) {
     char sqz1[MAXNAMELEN], sqz2[MAXNAMELEN];
+    char surname1[MAXLINELEN+1], surname2[MAXLINELEN+1];
     String p1 = sqz1,  p2 = sqz2;
-    int r = strcmp(getSurname(name1), getSurname(name2));
+    int r = strcmp(getSurnameInBuffer(name1, surname1), getSurnameInBuffer(name2, surname2));
     if (r) return r;
     r = getFirstInitial(name1) - getFirstInitial(name2);
     if (r) return r;
@@ -259,16 +273,85 @@ static void cmpsqueeze(String in, String out) {
     *out = 0;
 }
 
+// latinFolds are the folded forms of the Latin-1 letters U+00C0 through U+00FF, whose UTF-8
+// encodings are 0xC3 followed by 0x80 through 0xBF; null for the two signs that aren't letters.
+static String latinFolds[64] = {
+    "A", "A", "A", "A", "A", "A", "AE", "C", "E", "E", "E", "E", "I", "I", "I", "I",
+    "D", "N", "O", "O", "O", "O", "O", null, "O", "U", "U", "U", "U", "Y", "TH", "SS",
+    "A", "A", "A", "A", "A", "A", "AE", "C", "E", "E", "E", "E", "I", "I", "I", "I",
+    "D", "N", "O", "O", "O", "O", "O", null, "O", "U", "U", "U", "U", "Y", "TH", "Y"
+};
+
+// foldNameInBuffer upper cases the letters of a Gedcom name and removes the diacritics from its
+// Latin-1 letters, in a buffer of MAXLINELEN+1 chars. The folded name is never longer.
+static String foldNameInBuffer(String name, String buffer) {
+    String p = buffer;
+    for (int c; (c = (unsigned char) *name) && p < buffer + MAXLINELEN; name++) {
+        unsigned char next = (unsigned char) name[1];
+        if (c == 0xC3 && next >= 0x80 && next <= 0xBF && latinFolds[next - 0x80]) {
+            for (String f = latinFolds[next - 0x80]; *f && p < buffer + MAXLINELEN; f++) *p++ = *f;
+            name++;
+        } else {
+            *p++ = c < 0x80 ? toupper(c) : c;
+        }
+    }
+    *p = 0;
+    return buffer;
+}
+
+// nameCollationKeyInBuffer returns the collation key of a Gedcom name in a buffer of
+// COLLATIONKEYLEN chars. Keys compare with strcmp as their names do with compareNames, so a sort
+// makes each key once rather than taking names apart on every comparison. A key is the surname,
+// the first initial, and the given names in order, each name followed by COLLATIONSEPARATOR,
+// which is below all characters in names. If fold is true case and Latin-1 diacritics are ignored.
+String nameCollationKeyInBuffer(String name, bool fold, String key) {
+    char folded[MAXLINELEN+1];
+    char surname[MAXLINELEN+1];
+    if (!name) {
+        *key = 0;
+        return key;
+    }
+    if (fold) name = foldNameInBuffer(name, folded);
+    String p = key;
+    for (String s = getSurnameInBuffer(name, surname); *s; s++) *p++ = *s;
+    *p++ = COLLATIONSEPARATOR;
+    *p++ = getFirstInitial(name);
+    String end = key + COLLATIONKEYLEN - 2;
+    for (String in = name; (in = nextPiece(in)) && p < end;) { // As in cmpsqueeze.
+        int c;
+        while ((c = *in) && !iswhite(c) && c != '/' && p < end) {
+            *p++ = c;
+            in++;
+        }
+        *p++ = COLLATIONSEPARATOR;
+    }
+    *p = 0;
+    return key;
+}
+
+// nameCollationKey returns the collation key of a Gedcom name in the heap.
+String nameCollationKey(String name, bool fold) {
+    char key[COLLATIONKEYLEN];
+    return strsave(nameCollationKeyInBuffer(name, fold, key));
+}
+
 // getGivenNames returns the given names of a Gedcom format name.
-// TODO: I don't see how this ignores the surname.
+// MNOTE: returns static memory.
 String getGivenNames(String name) {
-    int c;
     static char scratch[MAXNAMELEN+1];
+    return getGivenNamesInBuffer(name, scratch);
+}
+
+// getGivenNamesInBuffer returns the given names of a Gedcom format name in a buffer of
+// MAXNAMELEN+1 chars.
+// TODO: I don't see how this ignores the surname.
+String getGivenNamesInBuffer(String name, String scratch) {
+    int c;
     String out = scratch;
     while ((name = nextPiece(name))) { // Next piece.
         while (true) {
             if ((c = *name++) == 0) { // At end.
-                if (*(out - 1) == ' ') --out;
+                if (out > scratch && *(out - 1) == ' ') --out;
                 *out = 0;
                 return scratch;
             }
@@ -280,7 +363,7 @@ String getGivenNames(String name) {
             *out++ = c; // Add and continue.
         }
     }
-    if (*(out - 1) == ' ') --out;
+    if (out > scratch && *(out - 1) == ' ') --out;
     *out = 0;
     return scratch;
 }
@@ -299,12 +382,20 @@ static String nextPiece(String in) {
 
 // trimName trims a Gedcom name to be less or equal to a given length but not shorter than
 // the first initial and surname.
+// MNOTE: returns static memory.
 #define MAXPARTS 100
 String trimName(String name, int len) {
+    static char scratch[MAXNAMELEN+1];
+    return trimNameInBuffer(name, len, scratch);
+}
+
+// trimNameInBuffer trims a Gedcom name like trimName into a buffer of MAXNAMELEN+1 chars.
+String trimNameInBuffer(String name, int len, String buffer) {
+    char scratch[MAXNAMELEN+1];
     String parts[MAXPARTS];
     int i, sdex = -1, nparts;
-    nameToParts(name, parts);
-    name = partsToName(parts);
+    nameToParts(name, parts, scratch);
+    name = partsToName(parts, buffer);
     if (strlen(name) <= len + 2) return name;
     for (i = 0; i < MAXPARTS; i++) {
         if (!parts[i]) break;
@@ -314,25 +405,25 @@ String trimName(String name, int len) {
     ASSERT(sdex != -1);
     for (i = sdex-1; i >= 0; --i) {
         *(parts[i] + 1) = 0;
-        name = partsToName(parts);
+        name = partsToName(parts, buffer);
         if (strlen(name) <= len + 2) return name;
     }
     for (i = sdex-1; i >= 1; --i) {
         parts[i] = null;
-        name = partsToName(parts);
+        name = partsToName(parts, buffer);
         if (strlen(name) <= len + 2) return name;
     }
     for (i = nparts-1; i > sdex; --i) {
         parts[i] = null;
-        name = partsToName(parts);
+        name = partsToName(parts, buffer);
         if (strlen(name) <= len + 2) return name;
     }
     return name;
 }
 
-// nameToParts converts a Gedcom name to its parts; keep slashes.
-static void nameToParts(String name, String* parts) {
-    static char scratch[MAXNAMELEN+1];
+// nameToParts converts a Gedcom name to its parts; keep slashes. The parts are in scratch, a
+// buffer of MAXNAMELEN+1 chars.
+static void nameToParts(String name, String* parts, String scratch) {
     String p = scratch;
     int c, i = 0;
     ASSERT(strlen(name) <= MAXNAMELEN);
@@ -361,16 +452,17 @@ static void nameToParts(String name, String* parts) {
     }
 }
 
-// nameToList converts a name to a List of Strings; List must exist; uses static memory. plen
-// is the number of strings; psind is the index relative one of the surname.
+// nameToList converts a name to a List of Strings; List must exist. plen is the number of
+// strings; psind is the index relative one of the surname.
 bool nameToList(String name, List* list, int* plen, int* psind) {
 	int i;
 	String str;
 	String parts[MAXPARTS];
+	char scratch[MAXNAMELEN+1];
 	if (!name || *name == 0 || !list) return false;
 	emptyList(list);
 	*psind = 0;
-	nameToParts(name, parts);
+	nameToParts(name, parts, scratch);
 	for (i = 0; i < MAXPARTS; i++) {
 		if (!parts[i]) break;
 		if (*parts[i] == '/') {
@@ -387,10 +479,9 @@ bool nameToList(String name, List* list, int* plen, int* psind) {
 	return true;
 }
 
-// partsToName converts a list of name parts to a single String; uses static memeory.
-static String partsToName(String* parts) {
+// partsToName converts a list of name parts to a single String in a buffer of MAXNAMELEN+1 chars.
+static String partsToName(String* parts, String scratch) {
     int i;
-    static char scratch[MAXNAMELEN+1];
     String p = scratch;
     for (i = 0; i < MAXPARTS; i++) {
         if (!parts[i]) continue;
@@ -398,7 +489,7 @@ static String partsToName(String* parts) {
         p += strlen(parts[i]);
         *p++ = ' ';
     }
-    if (*(p - 1) == ' ')
+    if (p > scratch && *(p - 1) == ' ')
         *(p - 1) = 0;
     else
         *p = 0;
@@ -408,6 +499,12 @@ static String partsToName(String* parts) {
 // upsurname makes a Gedcom name have an all uppercase surname. Static memory returned.
 String upsurname(String name) {
     static char scratch[MAXNAMELEN+1];
+    return upsurnameInBuffer(name, scratch);
+}
+
+// upsurnameInBuffer makes a Gedcom name have an all uppercase surname in a buffer of
+// MAXNAMELEN+1 chars.
+String upsurnameInBuffer(String name, String scratch) {
     String p = scratch;
     int c;
     while ((c = *p++ = *name++) && c != '/') ;
@@ -421,17 +518,33 @@ String upsurname(String name) {
 
 // manipulateName converts a Gedcom name to various formats. caps specifies the surname to upper
 // case. If reg is false surname comes first followed by comma. len specifies the max length.
+// MNOTE: returns static memory.
 String manipulateName(String name, bool caps, bool reg, int len) {
+    static char scratch[MAXNAMELEN+1];
+    return manipulateNameInBuffer(name, caps, reg, len, scratch);
+}
+
+// manipulateNameInBuffer converts a Gedcom name like manipulateName into a buffer of
+// MAXNAMELEN+1 chars.
+String manipulateNameInBuffer(String name, bool caps, bool reg, int len, String buffer) {
+    char upperName[MAXNAMELEN+1], trimmed[MAXNAMELEN+1], formatted[MAXNAMELEN+1];
     if (!name || *name == 0) return null;
-    if (caps) name = upsurname(name);
-    name = trimName(name, reg ? len: len-1);
-    if (reg) return trim(nameString(name), len);
-    return trim(nameSurnameFirst(name), len);
+    if (caps) name = upsurnameInBuffer(name, upperName);
+    name = trimNameInBuffer(name, reg ? len: len-1, trimmed);
+    name = reg ? nameStringInBuffer(name, formatted) : nameSurnameFirst(name, formatted);
+    if (len < 0) len = 0;
+    snprintf(buffer, MAXNAMELEN+1, "%.*s", len, name);
+    return buffer;
 }
 
 // nameString removes the slashes from a Gedcom name; uses static memory.
 String nameString(String name) {
     static char scratch[MAXNAMELEN+1];
+    return nameStringInBuffer(name, scratch);
+}
+
+// nameStringInBuffer removes the slashes from a Gedcom name into a buffer of MAXNAMELEN+1 chars.
+String nameStringInBuffer(String name, String scratch) {
     String p = scratch;
     ASSERT(strlen(name) <= MAXNAMELEN);
     while (*name) {
@@ -443,15 +556,12 @@ String nameString(String name) {
     return scratch;
 }
 
-// nameSurnameFirst converts a Gedcom name to surname first form.
-static String nameSurnameFirst(String name) {
-    static char scratch[MAXNAMELEN+1];
-    String p = scratch;
+// nameSurnameFirst converts a Gedcom name to surname first form in a buffer of MAXNAMELEN+1
+// chars.
+static String nameSurnameFirst(String name, String scratch) {
+    char surname[MAXLINELEN+1], given[MAXNAMELEN+1];
     ASSERT(strlen(name) <= MAXNAMELEN);
-    strcpy(p, getSurname(name));
-    p += strlen(p);
-    strcpy(p, ", ");
-    p += strlen(p);
-    strcpy(p, getGivenNames(name));
+    snprintf(scratch, MAXNAMELEN+1, "%s, %s", getSurnameInBuffer(name, surname),
+             getGivenNamesInBuffer(name, given));
     return scratch;
 }
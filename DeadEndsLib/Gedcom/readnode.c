@@ -3,7 +3,7 @@
 // readnode.c has the functions that read GNodes and GNode trees from files and Strings.
 //
 // Created by Thomas Wetmore on 17 December 2022.
-// Last changed on 1 January 2025.
+// Last changed on 18 October 2026.
 
 #include "readnode.h"
 #include "stringtable.h"
@@ -22,7 +22,6 @@ int xlevel;
 String xkey;
 String xtag;
 String xvalue;
-static bool ateof = false;
 
 // extractFields processes a String with a Gedcom line into its fields.
 // MNOTE: pkey, ptag and pvalue point into the original String.
@@ -81,11 +80,9 @@ static ReadReturn extractFields(String p, int* plevel, String* pkey, String *pta
 	*ptag = p++;
 
 	while (!iswhite(*p) && *p != 0) p++;
-	if (*p == 0) {
-		if (extractDebugging) {
-			printf("%s\n", *ptag);
-			return ReadOkay;
-		}
+	if (*p == 0) { // No value.
+		if (extractDebugging) printf("%s\n", *ptag);
+		return ReadOkay;
 	}
 	*p++ = 0;
 	if (extractDebugging) printf("%s ", *ptag);
@@ -96,16 +93,21 @@ static ReadReturn extractFields(String p, int* plevel, String* pkey, String *pta
 }
 
 // fileToLine reads the next Gedcom line from a file. Empty lines are okay.
+// MNOTE: key, tag and value point into a static buffer.
 ReadReturn fileToLine(FILE* fp, int* pline, int* plevel, String* pkey, String* ptag,
 					  String* pvalue, String* err) {
 	static char buffer[MAXLINELEN];
+	return fileToLineInBuffer(fp, buffer, pline, plevel, pkey, ptag, pvalue, err);
+}
+
+// fileToLineInBuffer reads the next Gedcom line from a file into a buffer of MAXLINELEN chars.
+// MNOTE: key, tag and value point into the buffer.
+ReadReturn fileToLineInBuffer(FILE* fp, String buffer, int* pline, int* plevel, String* pkey,
+							  String* ptag, String* pvalue, String* err) {
 	char *p = buffer;
 	*err = null;
 	while (true) {
-		if (!(p = fgets(buffer, MAXLINELEN, fp))) { // Read line.
-			ateof = true;
-			return ReadAtEnd;
-		}
+		if (!(p = fgets(buffer, MAXLINELEN, fp))) return ReadAtEnd; // Read line.
 		(*pline)++;
 		if (!allwhite(p)) break;
 	}
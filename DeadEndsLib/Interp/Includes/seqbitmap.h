@@ -0,0 +1,70 @@
+// DeadEnds
+//
+// seqbitmap.h is the header file for SequenceBitmaps, compressed bitmaps of records that let
+// large Sequences be joined, intersected and searched a word at a time, and for RecordRanks, the
+// numbering of records in key order that the bits stand for.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef seqbitmap_h
+#define seqbitmap_h
+
+#include <stdint.h>
+#include "standard.h"
+#include "hashtable.h"
+#include "gnode.h"
+
+typedef HashTable RecordIndex; // Forward reference.
+
+#define BITMAPCHUNKARRAY 4096 // Most ids in a chunk kept as an array.
+
+// BitmapChunk holds the ids of a SequenceBitmap that share their high 16 bits, as a sorted array
+// of their low 16 bits when there are few, or as a bit set of 1024 words when there are many.
+typedef struct BitmapChunk {
+	int high;
+	int count;
+	uint16_t* array; // Null if bits are used.
+	uint64_t* bits; // Null if array is used.
+	int room; // Size of array.
+} BitmapChunk;
+
+// SequenceBitmap is a set of non-negative ids kept as BitmapChunks in the manner of a roaring
+// bitmap.
+typedef struct SequenceBitmap {
+	BitmapChunk* chunks; // In order of high.
+	int numChunks;
+	int room;
+} SequenceBitmap;
+
+// RecordRanks numbers the records of a RecordIndex in key order, so a SequenceBitmap of ranks
+// lists its records in key order. Ranks are only used while no Database has been edited since
+// they were found; they are shared by the SequenceBitmaps that use them.
+typedef struct RecordRanks {
+	RecordIndex* index;
+	long generation; // Database generation when made.
+	int numRecords;
+	GNode** records; // By rank.
+	HashTable* ranks; // Maps keys to RecordRanks.
+	int references;
+} RecordRanks;
+
+// Interface to SequenceBitmap.
+SequenceBitmap* createSequenceBitmap(void);
+void deleteSequenceBitmap(SequenceBitmap*);
+SequenceBitmap* copySequenceBitmap(SequenceBitmap*);
+void addToSequenceBitmap(SequenceBitmap*, int id);
+bool isInSequenceBitmap(SequenceBitmap*, int id);
+int lengthSequenceBitmap(SequenceBitmap*);
+SequenceBitmap* unionSequenceBitmap(SequenceBitmap*, SequenceBitmap*);
+SequenceBitmap* intersectSequenceBitmap(SequenceBitmap*, SequenceBitmap*);
+SequenceBitmap* differenceSequenceBitmap(SequenceBitmap*, SequenceBitmap*);
+int sequenceBitmapToArray(SequenceBitmap*, int* ids);
+
+// Interface to RecordRanks.
+RecordRanks* getRecordRanks(RecordIndex*);
+void releaseRecordRanks(RecordRanks*);
+bool isCurrentRecordRanks(RecordRanks*);
+int recordRank(RecordRanks*, String key);
+
+#endif // seqbitmap_h
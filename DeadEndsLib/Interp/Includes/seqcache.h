@@ -0,0 +1,43 @@
+// DeadEnds
+//
+// seqcache.h is the header file for the Sequence cache, which remembers the results of Sequence
+// operations that scripts repeat on the same inputs.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef seqcache_h
+#define seqcache_h
+
+#include "standard.h"
+#include "sequence.h"
+#include "database.h"
+
+#define DEFAULTSEQUENCECACHEBUDGET (16 << 20) // Bytes.
+
+// SequenceOp is an operation on Sequences; the results of all but seqParents and seqChildren
+// are cached.
+typedef enum SequenceOp {
+	seqAncestors, seqDescendents, seqSpouses, seqName, seqParents, seqChildren
+} SequenceOp;
+
+// SequenceCacheStats are the counters of the Sequence cache.
+typedef struct SequenceCacheStats {
+	long hits;
+	long misses;
+	long evictions; // Entries removed to stay in the budget.
+	long invalidations; // Entries removed because their Database was edited.
+	int entries;
+	size_t bytes; // Estimated bytes held by the entries.
+	size_t budget;
+} SequenceCacheStats;
+
+// Interface to the Sequence cache.
+Sequence* cachedSequenceOp(SequenceOp, Sequence*, int limit, Database*);
+Sequence* cachedNameToSequence(String name, Database*);
+void setSequenceCacheBudget(size_t bytes);
+void clearSequenceCache(void);
+void getSequenceCacheStats(SequenceCacheStats*);
+void showSequenceCacheStats(FILE*);
+
+#endif // seqcache_h
@@ -0,0 +1,28 @@
+// DeadEnds
+//
+// seqexport.h is the header file for subset exports, which write the records of a Sequence, with
+// the families that join them and the records they refer to, to a Gedcom file.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef seqexport_h
+#define seqexport_h
+
+#include <stdio.h>
+#include "standard.h"
+#include "gnode.h"
+#include "sequence.h"
+
+// ExportCounts are the numbers of records a subset export wrote and of the lines it left out.
+typedef struct ExportCounts {
+	int persons;
+	int families;
+	int others; // Sources, media objects, notes and other records.
+	int pruned; // Lines left out, with their subordinate lines, for pointing to unwritten records.
+} ExportCounts;
+
+// Interface to subset exports.
+bool exportSequenceToGedcom(Sequence*, GNode* header, FILE*, int numThreads, ExportCounts*);
+
+#endif // seqexport_h
@@ -0,0 +1,44 @@
+// DeadEnds
+//
+// seqpipeline.h is the header file for Sequence pipelines, the pending parent, child, spouse,
+// ancestor and descendent operations of lazy Sequences.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef seqpipeline_h
+#define seqpipeline_h
+
+#include "standard.h"
+#include "sequence.h"
+#include "seqcache.h"
+#include "database.h"
+
+#define MAXPIPELINESTEPS 16 // Most operations in a pipeline.
+
+// SequencePipeline is the operations a lazy Sequence is the result of: the steps applied in
+// order to a private copy of the Sequence it started from. When only its length is needed its
+// persons are found as LineageGraph ids and kept until its elements are needed.
+typedef struct SequencePipeline {
+	Sequence* base; // Copy of the starting Sequence.
+	Database* database;
+	int numSteps;
+	SequenceOp ops[MAXPIPELINESTEPS];
+	int limits[MAXPIPELINESTEPS]; // Generation limits of ancestor and descendent steps.
+	int numIds; // Result if found; -1 if not.
+	int* ids;
+	void** values;
+	long generation; // Of the Database when the ids were found.
+	Sequence* owner;
+	struct SequencePipeline *prev, *next; // List of pending pipelines.
+} SequencePipeline;
+
+// Interface to Sequence pipelines.
+Sequence* lazySequenceOp(SequenceOp, Sequence*, int limit, Database*);
+SequencePipeline* copySequencePipeline(SequencePipeline*, Sequence* owner);
+void deleteSequencePipeline(SequencePipeline*);
+int lengthSequencePipeline(SequencePipeline*);
+void runSequencePipeline(Sequence*);
+void runPendingSequences(void);
+
+#endif // seqpipeline_h
@@ -6,7 +6,7 @@
 // used as a more general purpose data structure.
 //
 // Created by Thomas Wetmore on 1 March 2023.
-// Last changed on 13 December 2024.
+// Last changed on 18 October 2026.
 
 #ifndef sequence_h
 #define sequence_h
@@ -17,6 +17,7 @@
 #include "recordindex.h"
 #include "nameindex.h"
 #include "refnindex.h"
+#include "database.h"
 
 // SortType holds the possible sorted states of a Sequence.
 typedef enum {
@@ -25,33 +26,49 @@ typedef enum {
 	SequenceNameSorted,
 } SortType;
 
-// SequenceEl is the type of Sequence elements.
+// SequenceEl is an element of a Sequence as FORSEQUENCE shows it; changing it doesn't change the
+// Sequence.
 typedef struct SequenceEl {
 	GNode* root; // Root of record. MNOTE: do not free on delete.
 	String name; // If element is a person. MNOTE: do not free on delete.
 	void* value; // MNOTE: what do we do with this? Scenarios exists for do or not do free.
 } SequenceEl;
 
-// Sequence is a data type that holds sequences/sets/arrays of records.
+// Sequence is a data type that holds sequences/sets/arrays of records. Its elements are in parallel
+// arrays of roots, names and values. Large Sequences may also have a bitmap of the key ranks of
+// their records, which set operations and searches use; the results of set operations may be held
+// only in a bitmap until their elements are needed. A lazy Sequence has a pipeline of pending
+// operations instead of elements.
 typedef struct Sequence {
-	Block block;
+	GNode** roots; // Roots of the records. MNOTE: do not free on delete.
+	String* names; // Names of persons; null for other records. MNOTE: do not free on delete.
+	void** values;
+	int length; // Zero while inBitmap is true or pipeline is set.
+	int room; // Size of the arrays.
 	SortType sortType;
 	bool unique;
 	RecordIndex* index;
+	struct SequenceBitmap* bitmap; // Ranks of the records, or null.
+	struct RecordRanks* ranks; // Ranks used by bitmap.
+	bool inBitmap; // True if the elements are only in the bitmap.
+	struct SequencePipeline* pipeline; // Pending operations, or null.
 } Sequence;
 
-SequenceEl* createSequenceEl(RecordIndex*, String key, void* value);
 Sequence* createSequence(RecordIndex*);
 void deleteSequence(Sequence*);
 Sequence* copySequence(Sequence*);
 int lengthSequence(Sequence*);
+Sequence* materializeSequence(Sequence*);
 void emptySequence(Sequence*);
 
 void appendToSequence(Sequence*, String key, void*);
+void appendRootToSequence(Sequence*, GNode* root, void*);
 void appendSequenceToSequence(Sequence* dst, Sequence* src);
+void moveSequenceElements(Sequence* dst, Sequence* src);
 bool isInSequence(Sequence*, String key);
 bool removeFromSequence(Sequence*, String key);
 void nameSortSequence(Sequence*);
+void foldedNameSortSequence(Sequence*);
 void keySortSequence(Sequence*);
 Sequence* uniqueSequence(Sequence*);
 void uniqueSequenceInPlace(Sequence*);
@@ -73,8 +90,8 @@ Sequence* differenceSequence(Sequence*, Sequence*);
 Sequence* childSequence(Sequence*);
 Sequence* parentSequence(Sequence*);
 Sequence* spouseSequence(Sequence*);
-Sequence* ancestorSequence(Sequence*, bool close);
-Sequence* descendentSequence(Sequence*, bool close);
+Sequence* ancestorSequence(Sequence*, Database*, bool close, int limit);
+Sequence* descendentSequence(Sequence*, Database*, bool close, int limit);
 Sequence* siblingSequence(Sequence*, bool close);
 bool elementFromSequence(Sequence*, int index, String* key, String* name);
 void renameElementInSequence(Sequence* sequence, String key);
@@ -83,12 +100,14 @@ void showSequence(Sequence*, String title);
 
 // FORSEQUENCE and ENDSEQUENCE iterate a Sequence.
 #define FORSEQUENCE(sequence, element, count) {\
-	SequenceEl* element;\
+	Sequence* ___sequence = materializeSequence(sequence);\
+	SequenceEl ___element;\
+	SequenceEl* element = &___element;\
 	int count;\
-	Block* ___block = &(sequence->block);\
-	SequenceEl** __elements = (SequenceEl**) ___block->elements;\
-	for (int __i = 0; __i < ___block->length; __i++){\
-		element = __elements[__i];\
+	for (int __i = 0; __i < ___sequence->length; __i++){\
+		___element.root = ___sequence->roots[__i];\
+		___element.name = ___sequence->names[__i];\
+		___element.value = ___sequence->values[__i];\
 		count = __i + 1;
 
 #define ENDSEQUENCE }}
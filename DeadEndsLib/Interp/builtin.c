@@ -3,7 +3,7 @@
 // builtin.c contains many built-in functions of the DeadEnds script language.
 //
 // Created by Thomas Wetmore on 14 December 2022.
-// Last changed on 13 December 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "gnode.h"    // GNode.
@@ -18,8 +18,10 @@
 #include "evaluate.h"  // evaluate.
 #include "path.h"      // fopenPath.
 #include "symboltable.h"
+#include "heapstats.h"
 #include "date.h"
 #include "place.h"
+#include "seqpipeline.h" // runPendingSequences.
 
 // Global constants for useful PValues.
 const PValue nullPValue = {PVNull, PV()};
@@ -623,6 +625,15 @@ PValue __version(PNode*vpnode, Context* context, bool* errflg) {
 	return PVALUE(PVString, uString, version);
 }
 
+// __memoryreport writes the heap counters by category and the Sequence cache counters to
+// standard output.
+// usage: memoryreport() -> VOID
+PValue __memoryreport(PNode* pnode, Context* context, bool* errflg) {
+	showMemoryReport(stdout);
+	showSequenceCacheStats(stdout);
+	return nullPValue;
+}
+
 // __noop is used for builtins that have been removed (e.g., lock, unlock).
 PValue __noop(PNode *pnode, Context *context, bool* errflg) { return nullPValue; }
 
@@ -683,6 +694,7 @@ PValue __addnode(PNode* node, Context* context, bool* eflg) {
 		}
 		prevNode = prev.value.uGNode;
 	}
+	runPendingSequences(); // Lazy Sequences must see the Database before the edit.
 	thisNode->parent = parentNode;
 	GNode *nextNode = null;
 	if (prevNode == null) {
@@ -693,6 +705,7 @@ PValue __addnode(PNode* node, Context* context, bool* eflg) {
 		prevNode->sibling = thisNode;
 	}
 	thisNode->sibling = nextNode;
+	recordChanged(context->database, parentNode);
 	return nullPValue;
 }
 
@@ -721,6 +734,7 @@ PValue __deletenode(PNode *node, Context *context, bool *eflg) {
 		curs = curs->sibling;
 	}
 	if (curs == null) return nullPValue;
+	runPendingSequences(); // Lazy Sequences must see the Database before the edit.
 	GNode *next = this->sibling;
 	if (prev == null)
 		parent->child = next;
@@ -728,6 +742,7 @@ PValue __deletenode(PNode *node, Context *context, bool *eflg) {
 		prev->sibling = next;
 	this->parent = null;
 	this->sibling = null;
+	recordChanged(context->database, parent);
 	return nullPValue;
 }
 
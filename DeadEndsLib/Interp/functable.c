@@ -3,7 +3,7 @@
 // functable.c has the table of built-in functions in the DeadEnds scripting language.
 //
 // Created by Thomas Wetmore on 10 January 2023.
-// Last changed on 23 October 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "symboltable.h"
@@ -37,6 +37,7 @@ extern PValue __d(PNode*, Context*, bool*);
 extern PValue __database(PNode*, Context*, bool*);
 extern PValue __date(PNode*, Context*, bool*);
 extern PValue __dateformat(PNode*, Context*, bool*);
+extern PValue __datesearch(PNode*, Context*, bool*);
 extern PValue __dayformat(PNode*, Context*, bool*);
 extern PValue __death(PNode*, Context*, bool*);
 extern PValue __decr(PNode*, Context*, bool*);
@@ -77,15 +78,18 @@ extern PValue __gettoday(PNode*, Context*, bool*);
 extern PValue __givens(PNode*, Context*, bool*);
 extern PValue __gt(PNode*, Context*, bool*);
 extern PValue __husband(PNode*, Context*, bool*);
+extern PValue __inbreeding(PNode*, Context*, bool*);
 extern PValue __incr(PNode*, Context*, bool*);
 extern PValue __index(PNode*, Context*, bool*);
 extern PValue __indi(PNode*, Context*, bool*);
 extern PValue __indiset(PNode*, Context*, bool*);
 extern PValue __inode(PNode*, Context*, bool*);
 extern PValue __insert(PNode*, Context*, bool*);
+extern PValue __inset(PNode*, Context*, bool*);
 extern PValue __intersect(PNode*, Context*, bool*);
 extern PValue __key(PNode*, Context*, bool*);
 extern PValue __keysort(PNode*, Context*, bool*);
+extern PValue __kinship(PNode*, Context*, bool*);
 extern PValue __lastchild(PNode*, Context*, bool*);
 extern PValue __lastindi(PNode*, Context*, bool*);
 extern PValue __lastfam(PNode*, Context*, bool*);
@@ -101,12 +105,14 @@ extern PValue __lower(PNode*, Context*, bool*);
 extern PValue __lt(PNode*, Context*, bool*);
 extern PValue __male(PNode*, Context*, bool*);
 extern PValue __marriage(PNode*, Context*, bool*);
+extern PValue __memoryreport(PNode*, Context*, bool*);
 extern PValue __menuchoose(PNode*, Context*, bool*);
 extern PValue __mod(PNode*, Context*, bool*);
 extern PValue __monthformat(PNode*, Context*, bool*);
 extern PValue __mother(PNode*, Context*, bool*);
 extern PValue __mul(PNode*, Context*, bool*);
 extern PValue __name(PNode*, Context*, bool*);
+extern PValue __namesearch(PNode*, Context*, bool*);
 extern PValue __namesort(PNode*, Context*, bool*);
 extern PValue __nchildren(PNode*, Context*, bool*);
 extern PValue __ne(PNode*, Context*, bool*);
@@ -127,7 +133,10 @@ extern PValue __pageout(PNode*, Context*, bool*);
 extern PValue __parent(PNode*, Context*, bool*);
 extern PValue __parents(PNode*, Context*, bool*);
 extern PValue __parentset(PNode*, Context*, bool*);
+extern PValue __pathsearch(PNode*, Context*, bool*);
 extern PValue __place(PNode*, Context*, bool*);
+extern PValue __placecount(PNode*, Context*, bool*);
+extern PValue __placesearch(PNode*, Context*, bool*);
 extern PValue __pn(PNode*, Context*, bool*);
 extern PValue __pop(PNode*, Context*, bool*);
 extern PValue __pos(PNode*, Context*, bool*);
@@ -138,6 +147,8 @@ extern PValue __print(PNode*, Context*, bool*);
 extern PValue __push(PNode*, Context*, bool*);
 extern PValue __qt(PNode*, Context*, bool*);
 extern PValue __reference(PNode*, Context*, bool*);
+extern PValue __relationship(PNode*, Context*, bool*);
+extern PValue __relationships(PNode*, Context*, bool*);
 extern PValue __requeue(PNode*, Context*, bool*);
 extern PValue __rjustify(PNode*, Context*, bool*);
 extern PValue __roman(PNode*, Context*, bool*);
@@ -165,6 +176,7 @@ extern PValue __surname(PNode*, Context*, bool*);
 extern PValue __system(PNode*, Context*, bool*);
 extern PValue __table(PNode*, Context*, bool*);
 extern PValue __tag(PNode*, Context*, bool*);
+extern PValue __textsearch(PNode*, Context*, bool*);
 extern PValue __title(PNode*, Context*, bool*);
 extern PValue __trim(PNode*, Context*, bool*);
 extern PValue __trimname(PNode*, Context*, bool*);
@@ -186,7 +198,7 @@ BuiltIn builtIns[] = {
 	"addnode",      2,   3,    __addnode,
     "addtoset",     3,   3,    __addtoset,
     "alpha",        1,   1,    __alpha,
-    "ancestorset",  1,   1,    __ancestorset,
+    "ancestorset",  1,   2,    __ancestorset,
     "and",          2,  32,    __and,
     "baptism",      1,   1,    __baptism,
     "birth",        1,   1,    __birth,
@@ -209,6 +221,7 @@ BuiltIn builtIns[] = {
     "database",     0,   1,    __noop,
 	"date",         1,   1,    __date,
     "dateformat",   1,   1,    __dateformat,
+    "datesearch",   3,   3,    __datesearch,
     "dayformat",    1,    1,    __dayformat,
     "death",        1,    1,    __death,
     "decr",         1,    1,    __decr,
@@ -216,8 +229,8 @@ BuiltIn builtIns[] = {
 	"deletenode",   1,    1,    __deletenode,
     "dequeue",      1,    1,    __dequeue,
 	"dereference",  1,    1,    __getrecord,
-    "descendantset",1,    1,    __descendentset,
-    "descendentset",1,    1,    __descendentset,
+    "descendantset",1,    2,    __descendentset,
+    "descendentset",1,    2,    __descendentset,
 	"detachnode",   1,    1,    __deletenode,
     "difference",   2,    2,    __difference,
 	"div",          2,    2,    __div,
@@ -240,7 +253,7 @@ BuiltIn builtIns[] = {
 	"fnode",        1,    1,    __fnode,
     "fullname",     4,    4,    __fullname,
     "ge",           2,    2,    __ge,
-    "gengedcom",    1,    1,    __gengedcom,
+    "gengedcom",    1,    2,    __gengedcom,
 //  "genindiset",   2,    2,    __genindiset,
     "getel",        2,    2,    __getel,
 //  "getfam",       1,    1,    __getfam,
@@ -256,15 +269,18 @@ BuiltIn builtIns[] = {
     "givens",       1,    1,    __givens,
     "gt",           2,    2,    __gt,
     "husband",      1,    1,    __husband,
+	"inbreeding",   1,    1,    __inbreeding,
     "incr",         1,    1,    __incr,
 //  "index",        3,    3,    __index,
     "indi",         1,    1,    __indi,
     "indiset",      1,    1,    __indiset,
     "inode",        1,    1,    __inode,
     "insert",       3,    3,    __insert,
+    "inset",        2,    2,    __inset,
     "intersect",    2,    2,    __intersect,
     "key",          1,    2,    __key,
     "keysort",      1,    1,    __keysort,
+	"kinship",      2,    2,    __kinship,
     "lastchild",    1,    1,    __lastchild,
 	"lastfam",      0,    0,    __lastfam,
 	"lastindi",     0,    0,    __lastindi,
@@ -280,13 +296,15 @@ BuiltIn builtIns[] = {
     "lt",           2,    2,    __lt,
     "male",         1,    1,    __male,
     "marriage",     1,    1,    __marriage,
+    "memoryreport", 0,    0,    __memoryreport,
 //  "menuchoose",   1,    2,    __menuchoose,
     "mod",          2,    2,    __mod,
     "monthformat",  1,    1,    __monthformat,
     "mother",       1,    1,    __mother,
     "mul",          2,   32,    __mul,
     "name",         1,    2,    __name,
-    "namesort",     1,    1,    __namesort,
+    "namesearch",   1,    2,    __namesearch,
+    "namesort",     1,    2,    __namesort,
     "nchildren",    1,    1,    __nchildren,
     "ne",           2,    2,    __ne,
     "neg",          1,    1,    __neg,
@@ -307,7 +325,10 @@ BuiltIn builtIns[] = {
     "parent",       1,    1,    __parent,
 	"parents",      1,    1,    __parents,
     "parentset",    1,    1,    __parentset,
+    "pathsearch",   2,    2,    __pathsearch,
     "place",        1,    1,    __place,
+    "placecount",   1,    1,    __placecount,
+    "placesearch",  1,    1,    __placesearch,
     "pn",           2,    2,    __pn,  // Outputs pronouns
     "pop",          1,    1,    __pop,
 	"pos",          2,    2,    __pos,
@@ -318,6 +339,8 @@ BuiltIn builtIns[] = {
     "push",         2,    2,    __push,
     "qt",           0,    0,    __qt,
 	"reference",    1,    1,    __reference,
+	"relationship", 2,    3,    __relationship,
+	"relationships",3,    3,    __relationships,
 	"requeue",      2,    2,    __requeue,
 	"rjustify",     2,    2,    __rjustify,
     "roman",        1,    1,    __roman,
@@ -347,6 +370,7 @@ BuiltIn builtIns[] = {
 //  "system",       1,    1,    __system,
     "table",        1,    1,    __table,
     "tag",          1,    1,    __tag,
+    "textsearch",   1,    1,    __textsearch,
     "title",        1,    1,    __title,
 	"trim",         2,    2,    __trim,
     "trimname",     2,    2,    __trimname,
@@ -3,12 +3,13 @@
 // intrpevent.c has the built-in functions for events, dates and places.
 //
 // Created by Thomas Wetmore on 17 March 2023.
-// Last changed on 31 August 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "pnode.h"
 #include "pvalue.h"
 #include "evaluate.h"
+#include "database.h"
 
 static int daycode = 0;
 static int monthcode = 3;
@@ -34,6 +35,19 @@ PValue __place(PNode *pnode, Context *context, bool *errflg) {
     return nullPValue;
 }
 
+// __placecount returns the number of events in a place and its sub-places.
+// usage: placecount(STRING) -> INT
+PValue __placecount(PNode* pnode, Context* context, bool* eflg) {
+	ASSERT(pnode && pnode->arguments && context);
+	String place = evaluateString(pnode->arguments, context, eflg);
+	if (*eflg) {
+		scriptError(pnode, "the argument to placecount must be a string.");
+		return nullPValue;
+	}
+	PlaceNode* node = searchPlaceIndex(context->database->placeIndex, place);
+	return PVALUE(PVInt, uInt, node ? node->total : 0);
+}
+
 // __year return the year of a Gedcom event as a string.
 // usage: year(EVENT) -> STRING
 PValue __year(PNode *pnode, Context *context, bool* errflg) {
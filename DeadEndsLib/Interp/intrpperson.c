@@ -3,7 +3,7 @@
 // intrpperson.c has the built-in script functions that deal with persons.
 //
 // Created by Thomas Wetmore on 17 March 2023.
-// Last changed on 23 October 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "pnode.h"
@@ -14,6 +14,9 @@
 #include "interp.h"
 #include "recordindex.h"
 #include "database.h"
+#include "sequence.h"
+#include "relationship.h"
+#include "kinship.h"
 
 // __name gets a person's name.
 // usage: name(INDI [,BOOL]) -> STRING
@@ -434,3 +437,166 @@ PValue __lastindi(PNode* pnode, Context* context, bool* eflg) {
 	sortList(personRoots);
 	return PVALUE(PVPerson, uGNode, (GNode*) getListElement(personRoots, lengthList(personRoots) - 1));
 }
+
+static RelationshipFinder* finder = null;
+static Database* finderDatabase = null;
+static long finderGeneration = 0;
+
+// getFinder returns a RelationshipFinder for the LineageGraph of a Database; a new one is made
+// when the Database or its generation changes.
+static RelationshipFinder* getFinder(Database* database) {
+	if (finder && (finderDatabase != database || finderGeneration != database->generation)) {
+		deleteRelationshipFinder(finder);
+		finder = null;
+	}
+	if (!finder) {
+		finder = createRelationshipFinder(getDatabaseLineageGraph(database));
+		finderDatabase = database;
+		finderGeneration = database->generation;
+	}
+	return finder;
+}
+
+// __relationship returns how a person is related to another, as in "second cousin once removed"
+// or "sister-in-law"; null if they are not related. If a list is given the persons on
+// the path from the first person through the nearest common ancestor to the second are put in it.
+// usage: relationship(INDI, INDI [, LIST]) -> STRING
+PValue __relationship(PNode* pnode, Context* context, bool* errflg) {
+	PNode* arg = pnode->arguments;
+	GNode* from = evaluatePerson(arg, context, errflg);
+	if (*errflg || !from) {
+		*errflg = true;
+		scriptError(pnode, "the first argument to relationship must be a person");
+		return nullPValue;
+	}
+	GNode* to = evaluatePerson(arg = arg->next, context, errflg);
+	if (*errflg || !to) {
+		*errflg = true;
+		scriptError(pnode, "the second argument to relationship must be a person");
+		return nullPValue;
+	}
+	List* list = null;
+	if ((arg = arg->next)) {
+		PValue pvalue = evaluate(arg, context, errflg);
+		if (*errflg || pvalue.type != PVList) {
+			*errflg = true;
+			scriptError(pnode, "the third argument to relationship must be a list");
+			return nullPValue;
+		}
+		list = pvalue.value.uList;
+	}
+	RelationshipFinder* finder = getFinder(context->database);
+	LineageGraph* graph = getDatabaseLineageGraph(context->database);
+	Relationship* relationship = findRelationship(finder, lineageId(graph, from->key),
+												  lineageId(graph, to->key));
+	if (!relationship) return nullPValue;
+	for (int i = 0; list && i < relationship->pathLength; i++) {
+		PValue* ppvalue = (PValue*) stdalloc(sizeof(PValue));
+		*ppvalue = PVALUE(PVPerson, uGNode, graph->persons[relationship->path[i]]);
+		appendToList(list, ppvalue);
+	}
+	String name = strsave(relationship->name);
+	deleteRelationship(relationship);
+	return PVALUE(PVString, uString, name);
+}
+
+// __relationships finds how a person is related to each person in a set and appends the names of
+// the relationships to a list, in the order of the set, with null for the persons not related.
+// The first person's ancestors are only found once.
+// usage: relationships(INDI, SET, LIST) -> VOID
+PValue __relationships(PNode* pnode, Context* context, bool* errflg) {
+	PNode* arg = pnode->arguments;
+	GNode* from = evaluatePerson(arg, context, errflg);
+	if (*errflg || !from) {
+		*errflg = true;
+		scriptError(pnode, "the first argument to relationships must be a person");
+		return nullPValue;
+	}
+	PValue pvalue = evaluate(arg = arg->next, context, errflg);
+	if (*errflg || pvalue.type != PVSequence) {
+		*errflg = true;
+		scriptError(pnode, "the second argument to relationships must be a set");
+		return nullPValue;
+	}
+	Sequence* sequence = pvalue.value.uSequence;
+	pvalue = evaluate(arg->next, context, errflg);
+	if (*errflg || pvalue.type != PVList) {
+		*errflg = true;
+		scriptError(pnode, "the third argument to relationships must be a list");
+		return nullPValue;
+	}
+	List* list = pvalue.value.uList;
+	RelationshipFinder* finder = getFinder(context->database);
+	LineageGraph* graph = getDatabaseLineageGraph(context->database);
+	int count = lengthSequence(sequence);
+	int* ids = (int*) stdalloc((count + 1)*sizeof(int));
+	Relationship** results = (Relationship**) stdalloc((count + 1)*sizeof(Relationship*));
+	FORSEQUENCE(sequence, element, i)
+		ids[i - 1] = lineageId(graph, element->root->key);
+	ENDSEQUENCE
+	findRelationships(finder, lineageId(graph, from->key), ids, count, results);
+	for (int i = 0; i < count; i++) {
+		PValue* ppvalue = (PValue*) stdalloc(sizeof(PValue));
+		*ppvalue = results[i] ? PVALUE(PVString, uString, strsave(results[i]->name)) : nullPValue;
+		appendToList(list, ppvalue);
+		deleteRelationship(results[i]);
+	}
+	stdfree(ids);
+	stdfree(results);
+	return nullPValue;
+}
+
+static Kinship* kinship = null;
+static Database* kinshipDatabase = null;
+static long kinshipGeneration = 0;
+
+// getKinship returns a Kinship for the LineageGraph of a Database; a new one is made when the
+// Database or its generation changes. Its cache is kept between calls.
+static Kinship* getKinship(Database* database) {
+	if (kinship && (kinshipDatabase != database || kinshipGeneration != database->generation)) {
+		deleteKinship(kinship);
+		kinship = null;
+	}
+	if (!kinship) {
+		kinship = createKinship(getDatabaseLineageGraph(database));
+		kinshipDatabase = database;
+		kinshipGeneration = database->generation;
+	}
+	return kinship;
+}
+
+// __kinship returns the kinship coefficient of two persons, the chance that alleles taken at
+// random from each are identical by descent.
+// usage: kinship(INDI, INDI) -> FLOAT
+PValue __kinship(PNode* pnode, Context* context, bool* errflg) {
+	GNode* a = evaluatePerson(pnode->arguments, context, errflg);
+	if (*errflg || !a) {
+		*errflg = true;
+		scriptError(pnode, "the first argument to kinship must be a person");
+		return nullPValue;
+	}
+	GNode* b = evaluatePerson(pnode->arguments->next, context, errflg);
+	if (*errflg || !b) {
+		*errflg = true;
+		scriptError(pnode, "the second argument to kinship must be a person");
+		return nullPValue;
+	}
+	Kinship* kinship = getKinship(context->database);
+	LineageGraph* graph = kinship->graph;
+	return PVALUE(PVFloat, uFloat, kinshipCoefficient(kinship, lineageId(graph, a->key),
+													  lineageId(graph, b->key)));
+}
+
+// __inbreeding returns the inbreeding coefficient of a person, the kinship coefficient of the
+// person's parents.
+// usage: inbreeding(INDI) -> FLOAT
+PValue __inbreeding(PNode* pnode, Context* context, bool* errflg) {
+	GNode* indi = evaluatePerson(pnode->arguments, context, errflg);
+	if (*errflg || !indi) {
+		*errflg = true;
+		scriptError(pnode, "the argument to inbreeding must be a person");
+		return nullPValue;
+	}
+	Kinship* kinship = getKinship(context->database);
+	return PVALUE(PVFloat, uFloat, inbreedingCoefficient(kinship, lineageId(kinship->graph, indi->key)));
+}
@@ -4,15 +4,18 @@
 // language this datatype is called an indiset. Each builtin calls one of the Sequence functions.
 //
 // Created by Thomas Wetmore on 4 March 2023.
-// Last changed on 3 May 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "symboltable.h"
 #include "gedcom.h"
 #include "interp.h"
 #include "sequence.h"
+#include "seqpipeline.h"
+#include "seqexport.h"
 #include "pvalue.h"
 #include "evaluate.h"
+#include "date.h"
 
 // __indiset creates a sequence and assigns it to an identifier in a symbol table.
 // usage: indiset(IDEN) -> VOID
@@ -63,7 +66,7 @@ PValue __addtoset(PNode *pnode, Context *context, bool *errflg) {
     }
     PValue *ppvalue = allocPValue(value.type, value.value); // Sequence PValues are in the heap.
     if (ppvalue->type == PVString) ppvalue->value.uString = strsave(value.value.uString);
-    appendToSequence(sequence, key, ppvalue);
+    appendRootToSequence(sequence, indi, ppvalue);
     return nullPValue;
 }
 
@@ -142,8 +145,9 @@ PValue __deletefromset(PNode* pnode, Context* context, bool* eflg) {
     return value1;
 }
 
-// __namesort sorts a sequence by name.
-// usage: namesort(SET) -> VOID
+// __namesort sorts a sequence by name; if the optional second argument is true case and Latin-1
+// diacritics are ignored.
+// usage: namesort(SET [, BOOL]) -> VOID
 PValue __namesort(PNode* pnode, Context* context, bool* errflg) {
     PValue value = evaluate(pnode->arguments, context, errflg);
     if (*errflg || value.type != PVSequence) {
@@ -151,7 +155,14 @@ PValue __namesort(PNode* pnode, Context* context, bool* errflg) {
         return nullPValue;
     }
     Sequence *sequence = value.value.uSequence;
-    nameSortSequence(sequence);
+    bool fold = false;
+    if (pnode->arguments->next) {
+        PValue pfold = evaluateBoolean(pnode->arguments->next, context, errflg);
+        if (*errflg) return nullPValue;
+        fold = pfold.value.uBool;
+    }
+    if (fold) foldedNameSortSequence(sequence);
+    else nameSortSequence(sequence);
     return nullPValue;
 }
 
@@ -263,7 +274,7 @@ PValue __parentset(PNode* pnode, Context* context, bool* eflg) {
         return nullPValue;
     }
     Sequence* seq = val.value.uSequence;
-    return PVALUE(PVSequence, uSequence, parentSequence(seq));
+    return PVALUE(PVSequence, uSequence, lazySequenceOp(seqParents, seq, 0, context->database));
 }
 
 // __childset create the children sequence of a sequence.
@@ -275,7 +286,7 @@ PValue __childset(PNode* pnode, Context* context, bool* eflg) {
         return nullPValue;
     }
     Sequence *seq = val.value.uSequence;
-    return PVALUE(PVSequence, uSequence, childSequence(seq));
+    return PVALUE(PVSequence, uSequence, lazySequenceOp(seqChildren, seq, 0, context->database));
 }
 
 // __siblingset creates the sibling sequence of a sequence.
@@ -299,11 +310,26 @@ PValue __spouseset(PNode* pnode, Context* context, bool* eflg) {
         return nullPValue;
     }
     Sequence *seq = val.value.uSequence;
-    return PVALUE(PVSequence, uSequence, spouseSequence(seq));
+    return PVALUE(PVSequence, uSequence, lazySequenceOp(seqSpouses, seq, 0, context->database));
 }
 
-// __ancestorset creates the ancestor sequence of a sequence.
-// usage: ancestorset(SET) -> SET
+// generationLimit evaluates the optional generation limit argument of ancestorset and
+// descendentset; 0 means no limit.
+static int generationLimit(PNode* pnode, Context* context, bool* eflg, String name) {
+    PNode* arg = pnode->arguments->next;
+    if (!arg) return 0;
+    int limit = evaluateInteger(arg, context, eflg);
+    if (*eflg || limit < 0) {
+        *eflg = true;
+        scriptError(pnode, "the second argument to %s must be a non-negative integer.", name);
+        return 0;
+    }
+    return limit;
+}
+
+// __ancestorset creates the ancestor sequence of a sequence, optionally limited to a number of
+// generations.
+// usage: ancestorset(SET [, INT]) -> SET
 PValue __ancestorset(PNode* pnode, Context* context, bool* errflag) {
     PValue programValue = evaluate(pnode->arguments, context, errflag);
     if (*errflag || programValue.type != PVSequence) {
@@ -311,27 +337,190 @@ PValue __ancestorset(PNode* pnode, Context* context, bool* errflag) {
         scriptError(pnode, "the argument to ancestorset must be a set.");
         return nullPValue;
     }
-    return PVALUE(PVSequence, uSequence, ancestorSequence(programValue.value.uSequence, false));
+    int limit = generationLimit(pnode, context, errflag, "ancestorset");
+    if (*errflag) return nullPValue;
+    return PVALUE(PVSequence, uSequence, lazySequenceOp(seqAncestors, programValue.value.uSequence,
+                                                        limit, context->database));
 }
 
-// __descendentset creates the descendent sequence of a sequence; two spellings allowed.
-// usage: descendentset(SET) -> SET or descendantset(SET) -> SET
+// __descendentset creates the descendent sequence of a sequence, optionally limited to a number
+// of generations; two spellings allowed.
+// usage: descendentset(SET [, INT]) -> SET or descendantset(SET [, INT]) -> SET
 PValue __descendentset(PNode* pnode, Context* context, bool* eflg) {
-    ASSERT(pnode && pnode->arguments && !pnode->arguments->next && context);
+    ASSERT(pnode && pnode->arguments && context);
     PValue val = evaluate(pnode->arguments, context, eflg); // Sequence.
     if (*eflg || val.type != PVSequence) {
         scriptError(pnode, "the arg to descendentset must be a set.");
         return nullPValue;
     }
-    return PVALUE(PVSequence, uSequence, descendentSequence(val.value.uSequence, false));
+    int limit = generationLimit(pnode, context, eflg, "descendentset");
+    if (*eflg) return nullPValue;
+    return PVALUE(PVSequence, uSequence, lazySequenceOp(seqDescendents, val.value.uSequence,
+                                                        limit, context->database));
 }
-//  __gengedcom -- Generate Gedcom output from a sequence.
-//    usage: gengedcom(SET) -> VOID
-//--------------------------------------------------------------------------------------------------
+
+// __namesearch returns the persons whose names best match a partial name, best match first. The
+// words of the query can be partial or misspelled name parts; words between slashes only match
+// surnames. The optional second argument limits the number of persons returned.
+// usage: namesearch(STRING [, INT]) -> SET
+PValue __namesearch(PNode* pnode, Context* context, bool* eflg) {
+    ASSERT(pnode && pnode->arguments && context);
+    PNode* arg = pnode->arguments;
+    String query = evaluateString(arg, context, eflg);
+    if (*eflg) {
+        scriptError(pnode, "the first argument to namesearch must be a string.");
+        return nullPValue;
+    }
+    int limit = 0;
+    if (arg->next) {
+        limit = evaluateInteger(arg->next, context, eflg);
+        if (*eflg) {
+            scriptError(pnode, "the second argument to namesearch must be an integer.");
+            return nullPValue;
+        }
+    }
+    Database* database = context->database;
+    Sequence* sequence = createSequence(database->recordIndex);
+    List* results = searchNameSearchIndex(database->nameSearchIndex, query, limit);
+    FORLIST(results, element)
+        appendToSequence(sequence, ((NameSearchResult*) element)->recordKey, null);
+    ENDLIST
+    deleteList(results);
+    return PVALUE(PVSequence, uSequence, sequence);
+}
+
+// appendEventPersons appends the persons an event record belongs to to a Sequence: the person
+// itself or the spouses of a family.
+static void appendEventPersons(Sequence* sequence, GNode* root, RecordIndex* index) {
+    if (recordType(root) == GRPerson) {
+        appendRootToSequence(sequence, root, null);
+    } else if (recordType(root) == GRFamily) {
+        FORHUSBS(root, husband, key, index)
+            if (husband) appendRootToSequence(sequence, husband, null);
+        ENDHUSBS
+        FORWIFES(root, wife, key, index)
+            if (wife) appendRootToSequence(sequence, wife, null);
+        ENDWIFES
+    }
+}
+
+// __datesearch returns the persons with an event of a given tag whose date could fall in a range
+// of years. For family events, such as MARR, the spouses of the family are returned.
+// usage: datesearch(STRING, INT, INT) -> SET
+PValue __datesearch(PNode* pnode, Context* context, bool* eflg) {
+    ASSERT(pnode && pnode->arguments && context);
+    PNode *arg1 = pnode->arguments, *arg2 = arg1->next, *arg3 = arg2->next;
+    String tag = evaluateString(arg1, context, eflg);
+    if (*eflg) {
+        scriptError(pnode, "the first argument to datesearch must be an event tag.");
+        return nullPValue;
+    }
+    int fromYear = evaluateInteger(arg2, context, eflg);
+    if (*eflg) {
+        scriptError(pnode, "the second argument to datesearch must be a year.");
+        return nullPValue;
+    }
+    int toYear = evaluateInteger(arg3, context, eflg);
+    if (*eflg) {
+        scriptError(pnode, "the third argument to datesearch must be a year.");
+        return nullPValue;
+    }
+    Database* database = context->database;
+    RecordIndex* index = database->recordIndex;
+    Sequence* sequence = createSequence(index);
+    List* results = searchDateIndex(database->dateIndex, tag, dayNumber(fromYear, 1, 1),
+                                    dayNumber(toYear + 1, 1, 1) - 1, false);
+    FORLIST(results, element)
+        GNode* root = ((DateIndexEl*) element)->root;
+        appendEventPersons(sequence, root, index);
+    ENDLIST
+    deleteList(results);
+    uniqueSequenceInPlace(sequence);
+    return PVALUE(PVSequence, uSequence, sequence);
+}
+
+// __placesearch returns the persons with an event in a place or any of its sub-places. The place
+// is written as in a PLAC value, smallest jurisdiction first. For family events the spouses of
+// the family are returned.
+// usage: placesearch(STRING) -> SET
+PValue __placesearch(PNode* pnode, Context* context, bool* eflg) {
+    ASSERT(pnode && pnode->arguments && context);
+    String place = evaluateString(pnode->arguments, context, eflg);
+    if (*eflg) {
+        scriptError(pnode, "the argument to placesearch must be a string.");
+        return nullPValue;
+    }
+    Database* database = context->database;
+    RecordIndex* index = database->recordIndex;
+    Sequence* sequence = createSequence(index);
+    List* events = placeNodeToEvents(searchPlaceIndex(database->placeIndex, place));
+    FORLIST(events, element)
+        GNode* root = ((PlaceEvent*) element)->root;
+        appendEventPersons(sequence, root, index);
+    ENDLIST
+    deleteList(events);
+    uniqueSequenceInPlace(sequence);
+    return PVALUE(PVSequence, uSequence, sequence);
+}
+
+// __pathsearch returns the records with a value at the end of a Gedcom path, for example the
+// sources whose title is a given string with pathsearch("SOUR->TITL", title). The PathIndex of
+// the path is built the first time the path is searched and is kept current on edits.
+// usage: pathsearch(STRING, STRING) -> SET
+PValue __pathsearch(PNode* pnode, Context* context, bool* eflg) {
+    ASSERT(pnode && pnode->arguments && context);
+    String path = evaluateString(pnode->arguments, context, eflg);
+    if (*eflg || !path || *path == 0) {
+        *eflg = true;
+        scriptError(pnode, "the first argument to pathsearch must be a Gedcom path.");
+        return nullPValue;
+    }
+    String value = evaluateString(pnode->arguments->next, context, eflg);
+    if (*eflg || !value) {
+        *eflg = true;
+        scriptError(pnode, "the second argument to pathsearch must be a string.");
+        return nullPValue;
+    }
+    Database* database = context->database;
+    Sequence* sequence = createSequence(database->recordIndex);
+    Set* recordKeys = searchPathIndex(addPathIndex(database, path, null), value);
+    if (recordKeys) {
+        FORSET(recordKeys, element)
+            appendToSequence(sequence, (String) element, null);
+        ENDSET
+    }
+    return PVALUE(PVSequence, uSequence, sequence);
+}
+
+// __textsearch returns the records with NOTE or TEXT values that match a text query, for
+// example textsearch("\"New Haven\" -Hamden"). See searchTextIndex for the query syntax.
+// usage: textsearch(STRING) -> SET
+PValue __textsearch(PNode* pnode, Context* context, bool* eflg) {
+    ASSERT(pnode && pnode->arguments && context);
+    String query = evaluateString(pnode->arguments, context, eflg);
+    if (*eflg || !query) {
+        *eflg = true;
+        scriptError(pnode, "the argument to textsearch must be a string.");
+        return nullPValue;
+    }
+    Database* database = context->database;
+    Sequence* sequence = createSequence(database->recordIndex);
+    List* docs = searchTextIndex(getDatabaseTextIndex(database), query);
+    FORLIST(docs, element)
+        appendRootToSequence(sequence, ((TextDoc*) element)->root, null);
+    ENDLIST
+    deleteList(docs);
+    uniqueSequenceInPlace(sequence);
+    return PVALUE(PVSequence, uSequence, sequence);
+}
+
+// __gengedcom writes a Gedcom file with the persons in a sequence, the families that join them,
+// and the sources, media objects and notes they refer to. It writes to stdout if there is no file
+// name.
+// usage: gengedcom(SET [, STRING]) -> VOID
 PValue __gengedcom(PNode *programNode, Context *context, bool *eflg)
 {
-    printf("Inside __gengedcom\n");
-    ASSERT(programNode && programNode->arguments && !programNode->arguments->next && context);
+    ASSERT(programNode && programNode->arguments && context);
 
     //  The argument must evaluate to a sequence.
     PValue val = evaluate(programNode->arguments, context, eflg);
@@ -339,8 +528,27 @@ PValue __gengedcom(PNode *programNode, Context *context, bool *eflg)
         scriptError(programNode, "the argument to gengedcom must be a set");
         return nullPValue;
     }
+    FILE* fp = stdout;
+    if (programNode->arguments->next) {
+        String fileName = evaluateString(programNode->arguments->next, context, eflg);
+        if (*eflg || !fileName) {
+            *eflg = true;
+            scriptError(programNode, "the second argument to gengedcom must be a file name");
+            return nullPValue;
+        }
+        if (!(fp = fopen(fileName, "w"))) {
+            *eflg = true;
+            scriptError(programNode, "could not open gengedcom file %s", fileName);
+            return nullPValue;
+        }
+    }
 
-    //  Generate a Gedcom file from the persons in the sequence.
-    sequenceToGedcom(val.value.uSequence, null);  // Null sends to stdout.
+    //  Generate a Gedcom file from the records in the sequence.
+    bool okay = exportSequenceToGedcom(val.value.uSequence, context->database->header, fp, 0, null);
+    if (fp != stdout && fclose(fp) != 0) okay = false;
+    if (!okay) {
+        *eflg = true;
+        scriptError(programNode, "could not write the gengedcom file");
+    }
     return nullPValue;
 }
@@ -3,7 +3,7 @@
 // pnode.c holds the functions that manage PNodes (program nodes).
 //
 // Created by Thomas Wetmore on 14 December 2022.
-// Last changed on 21 October 2024.
+// Last changed on 18 October 2026.
 
 #include "pnode.h"
 #include "standard.h"
@@ -12,6 +12,9 @@
 #include "gedcom.h"
 #include "interp.h"
 
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memInterp
+
 static bool debugging = false;
 
 // pnodeTypes are String names for the program node types useful for debugging.
@@ -69,6 +72,7 @@ static void setParents(PNode* list, PNode* parent); // Set the parents of a PNod
 // allocPNode allocates a PNode and sets the pType, pFileName and pLineNum fields.
 static PNode* allocPNode(int type) {
     PNode* node = (PNode*) stdalloc(sizeof(*node));
+    memset(node, 0, sizeof(*node)); // The parser relies on null links.
     if (debugging) {
         printf("allocPNode(%d) %s, %d\n", type, curFileName, curLine);
     }
@@ -4,12 +4,15 @@
 // DeadEnds scripts.
 //
 // Created by Thomas Wetmore on 15 December 2022.
-// Last changed on 21 October 2024.
+// Last changed on 18 October 2026.
 
 #include "pvalue.h"
 #include "standard.h"
 #include "gedcom.h"
 
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memPValue
+
 extern const PValue nullPValue;  // Defined in builtin.c
 
 // isPVGNodeType return true if a PVType is one of the GNode types.
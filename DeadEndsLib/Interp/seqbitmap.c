@@ -0,0 +1,443 @@
+// DeadEnds
+//
+// seqbitmap.c implements SequenceBitmaps and RecordRanks. A SequenceBitmap splits its ids into
+// chunks of 65536 by their high 16 bits. A chunk with at most BITMAPCHUNKARRAY ids is a sorted
+// array of their low bits; a fuller chunk is a bit set, so unions, intersections and differences
+// of full chunks are done a word at a time, and of sparse chunks by merging arrays.
+//
+// RecordRanks give the records of a RecordIndex their positions in key order. The ranks of the
+// last RecordIndex used are kept until a Database is created or edited.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include "seqbitmap.h"
+#include "recordindex.h"
+#include "database.h"
+#include "sort.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memSequence
+
+#define CHUNKWORDS 1024 // Words in a bit set chunk.
+
+// initChunk initializes an empty array chunk.
+static void initChunk(BitmapChunk* chunk, int high) {
+	chunk->high = high;
+	chunk->count = 0;
+	chunk->array = null;
+	chunk->bits = null;
+	chunk->room = 0;
+}
+
+// termChunk frees the ids of a chunk.
+static void termChunk(BitmapChunk* chunk) {
+	if (chunk->array) stdfree(chunk->array);
+	if (chunk->bits) stdfree(chunk->bits);
+}
+
+// allocBits returns a zeroed bit set chunk.
+static uint64_t* allocBits(void) {
+	uint64_t* bits = (uint64_t*) stdalloc(CHUNKWORDS*sizeof(uint64_t));
+	memset(bits, 0, CHUNKWORDS*sizeof(uint64_t));
+	return bits;
+}
+
+// countBits returns the number of bits set in a bit set chunk.
+static int countBits(uint64_t* bits) {
+	int count = 0;
+	for (int w = 0; w < CHUNKWORDS; w++) count += __builtin_popcountll(bits[w]);
+	return count;
+}
+
+// toBits changes an array chunk to a bit set chunk.
+static void toBits(BitmapChunk* chunk) {
+	uint64_t* bits = allocBits();
+	for (int i = 0; i < chunk->count; i++) bits[chunk->array[i] >> 6] |= (uint64_t) 1 << (chunk->array[i] & 63);
+	if (chunk->array) stdfree(chunk->array);
+	chunk->array = null;
+	chunk->room = 0;
+	chunk->bits = bits;
+}
+
+// settleChunk sets the count of a bit set chunk and changes it to an array chunk if it has few ids.
+static void settleChunk(BitmapChunk* chunk) {
+	chunk->count = countBits(chunk->bits);
+	if (chunk->count > BITMAPCHUNKARRAY) return;
+	uint16_t* array = (uint16_t*) stdalloc((chunk->count + 1)*sizeof(uint16_t));
+	int n = 0;
+	for (int w = 0; w < CHUNKWORDS; w++)
+		for (uint64_t word = chunk->bits[w]; word; word &= word - 1)
+			array[n++] = (uint16_t) (w*64 + __builtin_ctzll(word));
+	stdfree(chunk->bits);
+	chunk->bits = null;
+	chunk->array = array;
+	chunk->room = chunk->count + 1;
+}
+
+// chunkBits returns the bits of a chunk, making them from its array into scratch if needed.
+static uint64_t* chunkBits(BitmapChunk* chunk, uint64_t* scratch) {
+	if (chunk->bits) return chunk->bits;
+	memset(scratch, 0, CHUNKWORDS*sizeof(uint64_t));
+	for (int i = 0; i < chunk->count; i++)
+		scratch[chunk->array[i] >> 6] |= (uint64_t) 1 << (chunk->array[i] & 63);
+	return scratch;
+}
+
+// chunkHas returns true if a chunk has the id with given low bits.
+static bool chunkHas(BitmapChunk* chunk, int low) {
+	if (chunk->bits) return (chunk->bits[low >> 6] >> (low & 63)) & 1;
+	int lo = 0, hi = chunk->count - 1;
+	while (lo <= hi) {
+		int mid = (lo + hi)/2;
+		if (chunk->array[mid] == low) return true;
+		if (chunk->array[mid] < low) lo = mid + 1;
+		else hi = mid - 1;
+	}
+	return false;
+}
+
+// findChunk returns the index of the chunk with given high bits, or -(insertion point) - 1.
+static int findChunk(SequenceBitmap* bitmap, int high) {
+	int lo = 0, hi = bitmap->numChunks - 1;
+	while (lo <= hi) {
+		int mid = (lo + hi)/2;
+		if (bitmap->chunks[mid].high == high) return mid;
+		if (bitmap->chunks[mid].high < high) lo = mid + 1;
+		else hi = mid - 1;
+	}
+	return -lo - 1;
+}
+
+// appendChunk adds an empty chunk to the end of a SequenceBitmap and returns it.
+static BitmapChunk* appendChunk(SequenceBitmap* bitmap, int high) {
+	if (bitmap->numChunks == bitmap->room) {
+		int room = bitmap->room ? 2*bitmap->room : 4;
+		BitmapChunk* chunks = (BitmapChunk*) stdalloc(room*sizeof(BitmapChunk));
+		if (bitmap->numChunks) memcpy(chunks, bitmap->chunks, bitmap->numChunks*sizeof(BitmapChunk));
+		if (bitmap->chunks) stdfree(bitmap->chunks);
+		bitmap->chunks = chunks;
+		bitmap->room = room;
+	}
+	BitmapChunk* chunk = bitmap->chunks + bitmap->numChunks++;
+	initChunk(chunk, high);
+	return chunk;
+}
+
+// copyChunk copies the ids of a chunk to an empty chunk.
+static void copyChunk(BitmapChunk* from, BitmapChunk* to) {
+	to->count = from->count;
+	if (from->bits) {
+		to->bits = allocBits();
+		memcpy(to->bits, from->bits, CHUNKWORDS*sizeof(uint64_t));
+	} else {
+		to->room = from->count + 1;
+		to->array = (uint16_t*) stdalloc(to->room*sizeof(uint16_t));
+		if (from->count) memcpy(to->array, from->array, from->count*sizeof(uint16_t));
+	}
+}
+
+// createSequenceBitmap creates an empty SequenceBitmap.
+SequenceBitmap* createSequenceBitmap(void) {
+	SequenceBitmap* bitmap = (SequenceBitmap*) stdalloc(sizeof(SequenceBitmap));
+	bitmap->chunks = null;
+	bitmap->numChunks = bitmap->room = 0;
+	return bitmap;
+}
+
+// deleteSequenceBitmap deletes a SequenceBitmap.
+void deleteSequenceBitmap(SequenceBitmap* bitmap) {
+	if (!bitmap) return;
+	for (int i = 0; i < bitmap->numChunks; i++) termChunk(bitmap->chunks + i);
+	if (bitmap->chunks) stdfree(bitmap->chunks);
+	stdfree(bitmap);
+}
+
+// copySequenceBitmap returns a copy of a SequenceBitmap.
+SequenceBitmap* copySequenceBitmap(SequenceBitmap* bitmap) {
+	SequenceBitmap* copy = createSequenceBitmap();
+	for (int i = 0; i < bitmap->numChunks; i++) {
+		copyChunk(bitmap->chunks + i, appendChunk(copy, bitmap->chunks[i].high));
+	}
+	return copy;
+}
+
+// addToSequenceBitmap adds an id to a SequenceBitmap.
+void addToSequenceBitmap(SequenceBitmap* bitmap, int id) {
+	int high = id >> 16, low = id & 0xffff;
+	int index = findChunk(bitmap, high);
+	if (index < 0) { // Add a chunk in order.
+		index = -index - 1;
+		appendChunk(bitmap, high);
+		memmove(bitmap->chunks + index + 1, bitmap->chunks + index,
+				(bitmap->numChunks - 1 - index)*sizeof(BitmapChunk));
+		initChunk(bitmap->chunks + index, high);
+	}
+	BitmapChunk* chunk = bitmap->chunks + index;
+	if (chunkHas(chunk, low)) return;
+	if (chunk->bits) {
+		chunk->bits[low >> 6] |= (uint64_t) 1 << (low & 63);
+		chunk->count++;
+		return;
+	}
+	if (chunk->count == BITMAPCHUNKARRAY) {
+		toBits(chunk);
+		chunk->bits[low >> 6] |= (uint64_t) 1 << (low & 63);
+		chunk->count++;
+		return;
+	}
+	if (chunk->count == chunk->room) {
+		int room = chunk->room ? 2*chunk->room : 8;
+		uint16_t* array = (uint16_t*) stdalloc(room*sizeof(uint16_t));
+		if (chunk->count) memcpy(array, chunk->array, chunk->count*sizeof(uint16_t));
+		if (chunk->array) stdfree(chunk->array);
+		chunk->array = array;
+		chunk->room = room;
+	}
+	int i = chunk->count;
+	while (i > 0 && chunk->array[i - 1] > low) { // Usually ids come in order.
+		chunk->array[i] = chunk->array[i - 1];
+		i--;
+	}
+	chunk->array[i] = (uint16_t) low;
+	chunk->count++;
+}
+
+// isInSequenceBitmap returns true if an id is in a SequenceBitmap.
+bool isInSequenceBitmap(SequenceBitmap* bitmap, int id) {
+	if (id < 0) return false;
+	int index = findChunk(bitmap, id >> 16);
+	return index >= 0 && chunkHas(bitmap->chunks + index, id & 0xffff);
+}
+
+// lengthSequenceBitmap returns the number of ids in a SequenceBitmap.
+int lengthSequenceBitmap(SequenceBitmap* bitmap) {
+	int length = 0;
+	for (int i = 0; i < bitmap->numChunks; i++) length += bitmap->chunks[i].count;
+	return length;
+}
+
+// ChunkOp is an operation on two chunks.
+typedef enum ChunkOp {
+	chunkUnion, chunkIntersect, chunkDifference
+} ChunkOp;
+
+// combineArrays does an operation on two array chunks by merging them.
+static void combineArrays(ChunkOp op, BitmapChunk* a, BitmapChunk* b, BitmapChunk* to) {
+	int room = op == chunkUnion ? a->count + b->count : a->count;
+	uint16_t* array = (uint16_t*) stdalloc((room + 1)*sizeof(uint16_t));
+	int i = 0, j = 0, n = 0;
+	while (i < a->count && j < b->count) {
+		if (a->array[i] < b->array[j]) {
+			if (op != chunkIntersect) array[n++] = a->array[i];
+			i++;
+		} else if (a->array[i] > b->array[j]) {
+			if (op == chunkUnion) array[n++] = b->array[j];
+			j++;
+		} else {
+			if (op != chunkDifference) array[n++] = a->array[i];
+			i++; j++;
+		}
+	}
+	if (op != chunkIntersect) while (i < a->count) array[n++] = a->array[i++];
+	if (op == chunkUnion) while (j < b->count) array[n++] = b->array[j++];
+	to->array = array;
+	to->count = n;
+	to->room = room + 1;
+	if (n > BITMAPCHUNKARRAY) toBits(to);
+}
+
+// combineChunks does an operation on two chunks with the same high bits.
+static void combineChunks(ChunkOp op, BitmapChunk* a, BitmapChunk* b, BitmapChunk* to) {
+	if (a->count == 0 || b->count == 0) { // Only the union and difference get here.
+		copyChunk(a->count ? a : b, to);
+		return;
+	}
+	if (!a->bits && !b->bits) {
+		combineArrays(op, a, b, to);
+		return;
+	}
+	if (op != chunkUnion && a->array) { // Keep the ids of a's array that pass.
+		to->array = (uint16_t*) stdalloc((a->count + 1)*sizeof(uint16_t));
+		to->room = a->count + 1;
+		for (int i = 0; i < a->count; i++)
+			if (chunkHas(b, a->array[i]) == (op == chunkIntersect)) to->array[to->count++] = a->array[i];
+		return;
+	}
+	uint64_t scratch[CHUNKWORDS];
+	uint64_t* bitsA = chunkBits(a, scratch);
+	to->bits = allocBits();
+	memcpy(to->bits, bitsA, CHUNKWORDS*sizeof(uint64_t));
+	if (b->array) { // a has bits.
+		for (int i = 0; i < b->count; i++) {
+			uint64_t bit = (uint64_t) 1 << (b->array[i] & 63);
+			if (op == chunkUnion) to->bits[b->array[i] >> 6] |= bit;
+			else if (op == chunkDifference) to->bits[b->array[i] >> 6] &= ~bit;
+		}
+		if (op == chunkIntersect) {
+			memset(to->bits, 0, CHUNKWORDS*sizeof(uint64_t));
+			for (int i = 0; i < b->count; i++)
+				if (chunkHas(a, b->array[i])) to->bits[b->array[i] >> 6] |= (uint64_t) 1 << (b->array[i] & 63);
+		}
+	} else {
+		for (int w = 0; w < CHUNKWORDS; w++) {
+			if (op == chunkUnion) to->bits[w] |= b->bits[w];
+			else if (op == chunkIntersect) to->bits[w] &= b->bits[w];
+			else to->bits[w] &= ~b->bits[w];
+		}
+	}
+	settleChunk(to);
+}
+
+// combineBitmaps does an operation on two SequenceBitmaps and returns the result.
+static SequenceBitmap* combineBitmaps(ChunkOp op, SequenceBitmap* a, SequenceBitmap* b) {
+	SequenceBitmap* result = createSequenceBitmap();
+	BitmapChunk empty;
+	initChunk(&empty, 0);
+	int i = 0, j = 0;
+	while (i < a->numChunks || j < b->numChunks) {
+		BitmapChunk* chunkA = i < a->numChunks ? a->chunks + i : null;
+		BitmapChunk* chunkB = j < b->numChunks ? b->chunks + j : null;
+		int high;
+		if (chunkA && (!chunkB || chunkA->high < chunkB->high)) {
+			high = chunkA->high;
+			chunkB = &empty;
+			i++;
+		} else if (chunkB && (!chunkA || chunkB->high < chunkA->high)) {
+			high = chunkB->high;
+			chunkA = &empty;
+			j++;
+		} else {
+			high = chunkA->high;
+			i++; j++;
+		}
+		if (op == chunkIntersect && (chunkA == &empty || chunkB == &empty)) continue;
+		if (op == chunkDifference && chunkA == &empty) continue;
+		BitmapChunk* to = appendChunk(result, high);
+		combineChunks(op, chunkA, chunkB, to);
+		if (to->count == 0) {
+			termChunk(to);
+			result->numChunks--;
+		}
+	}
+	return result;
+}
+
+// unionSequenceBitmap returns the union of two SequenceBitmaps.
+SequenceBitmap* unionSequenceBitmap(SequenceBitmap* a, SequenceBitmap* b) {
+	return combineBitmaps(chunkUnion, a, b);
+}
+
+// intersectSequenceBitmap returns the intersection of two SequenceBitmaps.
+SequenceBitmap* intersectSequenceBitmap(SequenceBitmap* a, SequenceBitmap* b) {
+	return combineBitmaps(chunkIntersect, a, b);
+}
+
+// differenceSequenceBitmap returns the ids in a SequenceBitmap that are not in another.
+SequenceBitmap* differenceSequenceBitmap(SequenceBitmap* a, SequenceBitmap* b) {
+	return combineBitmaps(chunkDifference, a, b);
+}
+
+// sequenceBitmapToArray puts the ids of a SequenceBitmap in an array in increasing order and
+// returns their number.
+int sequenceBitmapToArray(SequenceBitmap* bitmap, int* ids) {
+	int n = 0;
+	for (int i = 0; i < bitmap->numChunks; i++) {
+		BitmapChunk* chunk = bitmap->chunks + i;
+		int base = chunk->high << 16;
+		if (chunk->array) {
+			for (int k = 0; k < chunk->count; k++) ids[n++] = base + chunk->array[k];
+			continue;
+		}
+		for (int w = 0; w < CHUNKWORDS; w++)
+			for (uint64_t word = chunk->bits[w]; word; word &= word - 1)
+				ids[n++] = base + w*64 + __builtin_ctzll(word);
+	}
+	return n;
+}
+
+// RecordRank maps a record key to its rank.
+typedef struct RecordRank {
+	String key;
+	int rank;
+} RecordRank;
+
+static RecordRanks* lastRanks = null; // Ranks of the last RecordIndex used.
+
+// rankGetKey returns the key of a RecordRank.
+static String rankGetKey(void* element) {
+	return ((RecordRank*) element)->key;
+}
+
+// deleteRank deletes a RecordRank.
+static void deleteRank(void* element) {
+	stdfree(element);
+}
+
+// rootGetKey returns the key of a record; for sorting the records.
+static String rootGetKey(void* element) {
+	return ((GNode*) element)->key;
+}
+
+// compareKeys compares two record keys.
+static int compareKeys(String a, String b) {
+	return compareRecordKeys(a, b);
+}
+
+// numBuckets returns an odd number of buckets for a HashTable of count elements.
+static int numBuckets(int count) {
+	return count < 359 ? 359 : count | 1;
+}
+
+// createRecordRanks numbers the records of a RecordIndex in key order.
+static RecordRanks* createRecordRanks(RecordIndex* index) {
+	RecordRanks* ranks = (RecordRanks*) stdalloc(sizeof(RecordRanks));
+	ranks->index = index;
+	ranks->generation = lastDatabaseGeneration();
+	ranks->numRecords = sizeHashTable(index);
+	ranks->references = 1;
+	ranks->records = (GNode**) stdalloc((ranks->numRecords + 1)*sizeof(GNode*));
+	int n = 0;
+	FORHASHTABLE(index, element)
+		ranks->records[n++] = (GNode*) element;
+	ENDHASHTABLE
+	sortElements((void**) ranks->records, n, rootGetKey, compareKeys);
+	ranks->ranks = createHashTable(rankGetKey, compareKeys, deleteRank, numBuckets(n));
+	for (int i = 0; i < n; i++) {
+		RecordRank* rank = (RecordRank*) stdalloc(sizeof(RecordRank));
+		*rank = (RecordRank) {ranks->records[i]->key, i};
+		addToHashTable(ranks->ranks, rank, false);
+	}
+	return ranks;
+}
+
+// isCurrentRecordRanks returns true if no Database has been created or edited since RecordRanks
+// were made.
+bool isCurrentRecordRanks(RecordRanks* ranks) {
+	return ranks && ranks->generation == lastDatabaseGeneration();
+}
+
+// getRecordRanks returns the current RecordRanks of a RecordIndex, making them if needed. The
+// caller holds a reference to them and must release it.
+RecordRanks* getRecordRanks(RecordIndex* index) {
+	if (!lastRanks || lastRanks->index != index || !isCurrentRecordRanks(lastRanks)) {
+		if (lastRanks) releaseRecordRanks(lastRanks);
+		lastRanks = createRecordRanks(index);
+	}
+	lastRanks->references++;
+	return lastRanks;
+}
+
+// releaseRecordRanks releases a reference to RecordRanks, deleting them after the last.
+void releaseRecordRanks(RecordRanks* ranks) {
+	if (!ranks || --ranks->references > 0) return;
+	deleteHashTable(ranks->ranks);
+	stdfree(ranks->records);
+	stdfree(ranks);
+}
+
+// recordRank returns the rank of the record with a key, or -1 if it has none.
+int recordRank(RecordRanks* ranks, String key) {
+	RecordRank* rank = key ? (RecordRank*) searchHashTable(ranks->ranks, key) : null;
+	return rank ? rank->rank : -1;
+}
@@ -0,0 +1,292 @@
+// DeadEnds
+//
+// seqcache.c holds the Sequence cache. Scripts often compute the ancestors, descendents or
+// spouses of the same persons many times, sometimes in a loop. The cache keeps the results of
+// these operations, keyed by the operation and its input keys, and returns copies of them when
+// the same operation is done on the same input. An entry is only used while its Database has the
+// generation it had when the entry was made; any edit gives the Database a new generation. The
+// least recently used entries are evicted to keep the cache within its byte budget.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include "seqcache.h"
+#include "hashtable.h"
+#include "stringtable.h"
+#include "gedcom.h"
+#include "lineage.h"
+#include "integertable.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memSequence
+
+#define NUMCACHEBUCKETS 1021
+#define NUMELEMENTBUCKETS 359
+
+// CacheEntry is an entry in the Sequence cache; entries are in a list from most to least
+// recently used.
+typedef struct CacheEntry {
+	String key; // Operation and input keys.
+	Database* database;
+	long generation; // Of the Database when the entry was made.
+	Sequence* result; // Private copy of the result; null if the operation returned null.
+	size_t bytes; // Estimated size of the entry.
+	struct CacheEntry *newer, *older;
+} CacheEntry;
+
+static HashTable* entries = null;
+static CacheEntry* newest = null;
+static CacheEntry* oldest = null;
+static SequenceCacheStats stats = {0, 0, 0, 0, 0, 0, DEFAULTSEQUENCECACHEBUDGET};
+static char opCodes[] = "ADSNPC";
+
+// entryGetKey is the getKey function for CacheEntries.
+static String entryGetKey(void* entry) {
+	return ((CacheEntry*) entry)->key;
+}
+
+// compareKeys is the compare function for the cache's HashTables.
+static int compareKeys(String a, String b) {
+	return strcmp(a, b);
+}
+
+// sequenceBytes returns the estimated size of a Sequence.
+static size_t sequenceBytes(Sequence* sequence) {
+	if (!sequence) return 0;
+	return sizeof(Sequence) + sequence->room*(sizeof(GNode*) + sizeof(String) + sizeof(void*));
+}
+
+// cloneSequence copies a Sequence.
+static Sequence* cloneSequence(Sequence* sequence) {
+	return sequence ? copySequence(sequence) : null;
+}
+
+// firstPlaces returns an IntegerTable of the place of the first element in a Sequence with each
+// key.
+static IntegerTable* firstPlaces(Sequence* sequence) {
+	IntegerTable* table = createIntegerTable(NUMELEMENTBUCKETS);
+	materializeSequence(sequence);
+	for (int i = 0; i < sequence->length; i++) {
+		String key = sequence->roots[i]->key;
+		if (searchIntegerTable(table, key) == NAN) insertInIntegerTable(table, key, i);
+	}
+	return table;
+}
+
+// inputKey returns the cache key of an operation on a Sequence: the operation's code and its
+// generation limit, followed by the keys of the Sequence in order without duplicates. The order
+// is kept since the order of the results depends on it; duplicates don't change the results.
+static String inputKey(SequenceOp op, Sequence* input, int limit) {
+	StringTable* seen = createStringTable(NUMELEMENTBUCKETS);
+	Block keys;
+	initBlock(&keys);
+	char code[24];
+	snprintf(code, sizeof(code), "%c%d", opCodes[op], limit);
+	size_t length = strlen(code) + 1;
+	FORSEQUENCE(input, element, count)
+		String key = element->root->key;
+		if (isInHashTable(seen, key)) continue;
+		addToStringTable(seen, key, null);
+		appendToBlock(&keys, key);
+		length += strlen(key) + 1;
+	ENDSEQUENCE
+	String cacheKey = (String) stdalloc(length);
+	strcpy(cacheKey, code);
+	String p = cacheKey + strlen(code);
+	for (int i = 0; i < keys.length; i++) {
+		*p++ = ' ';
+		strcpy(p, keys.elements[i]);
+		p += strlen(p);
+	}
+	*p = 0;
+	deleteBlock(&keys, null);
+	deleteHashTable(seen);
+	return cacheKey;
+}
+
+// unlinkEntry removes an entry from the recently used list.
+static void unlinkEntry(CacheEntry* entry) {
+	if (entry->newer) entry->newer->older = entry->older;
+	else newest = entry->older;
+	if (entry->older) entry->older->newer = entry->newer;
+	else oldest = entry->newer;
+	entry->newer = entry->older = null;
+}
+
+// pushEntry makes an entry the most recently used.
+static void pushEntry(CacheEntry* entry) {
+	entry->older = newest;
+	entry->newer = null;
+	if (newest) newest->newer = entry;
+	newest = entry;
+	if (!oldest) oldest = entry;
+}
+
+// removeEntry removes an entry from the cache and frees it.
+static void removeEntry(CacheEntry* entry) {
+	unlinkEntry(entry);
+	removeFromHashTable(entries, entry->key);
+	stats.entries--;
+	stats.bytes -= entry->bytes;
+	if (entry->result) deleteSequence(entry->result);
+	stdfree(entry->key);
+	stdfree(entry);
+}
+
+// evictTo evicts the least recently used entries until the cache holds at most bytes.
+static void evictTo(size_t bytes) {
+	while (oldest && stats.bytes > bytes) {
+		removeEntry(oldest);
+		stats.evictions++;
+	}
+}
+
+// findEntry returns the entry with a key if it is current for a Database; an entry made before
+// the Database was last edited is removed.
+static CacheEntry* findEntry(String key, Database* database) {
+	if (!entries) return null;
+	CacheEntry* entry = (CacheEntry*) searchHashTable(entries, key);
+	if (!entry) return null;
+	if (entry->database != database || entry->generation != database->generation) {
+		removeEntry(entry);
+		stats.invalidations++;
+		return null;
+	}
+	unlinkEntry(entry);
+	pushEntry(entry);
+	return entry;
+}
+
+// addEntry adds a result to the cache; the cache takes over key and result. Results too large
+// for a quarter of the budget are not kept.
+static void addEntry(String key, Database* database, Sequence* result) {
+	size_t bytes = sizeof(CacheEntry) + strlen(key) + 1 + sequenceBytes(result);
+	if (bytes > stats.budget/4) {
+		stdfree(key);
+		if (result) deleteSequence(result);
+		return;
+	}
+	if (!entries) entries = createHashTable(entryGetKey, compareKeys, null, NUMCACHEBUCKETS);
+	evictTo(stats.budget - bytes);
+	CacheEntry* entry = (CacheEntry*) stdalloc(sizeof(CacheEntry));
+	entry->key = key;
+	entry->database = database;
+	entry->generation = database->generation;
+	entry->result = result;
+	entry->bytes = bytes;
+	addToHashTable(entries, entry, false);
+	pushEntry(entry);
+	stats.entries++;
+	stats.bytes += bytes;
+}
+
+// spouseSources replaces the values in a cached spouse Sequence with the keys of the input
+// persons the spouses were found from; spouseSequence gives each spouse the value of that person.
+static void spouseSources(Sequence* spouses, Sequence* input) {
+	RecordIndex* index = input->index;
+	IntegerTable* table = firstPlaces(spouses);
+	void** values = spouses->values;
+	for (int i = 0; i < spouses->length; i++) values[i] = null;
+	FORSEQUENCE(input, element, count)
+		GNode* person = keyToPerson(element->root->key, index);
+		FORSPOUSES(person, spouse, family, num, index)
+			int place = searchIntegerTable(table, personToKey(spouse));
+			if (place != NAN && !values[place]) values[place] = element->root->key;
+		ENDSPOUSES
+	ENDSEQUENCE
+	deleteHashTable(table);
+}
+
+// spouseValues gives the spouses in a copy of a cached spouse Sequence the values of the input
+// persons they were found from.
+static void spouseValues(Sequence* spouses, Sequence* input) {
+	IntegerTable* table = firstPlaces(input);
+	materializeSequence(spouses);
+	for (int i = 0; i < spouses->length; i++) {
+		int place = spouses->values[i] ? searchIntegerTable(table, (String) spouses->values[i]) : NAN;
+		spouses->values[i] = place != NAN ? input->values[place] : null;
+	}
+	deleteHashTable(table);
+}
+
+// runSequenceOp runs an operation without the cache.
+static Sequence* runSequenceOp(SequenceOp op, Sequence* input, int limit, Database* database) {
+	switch (op) {
+	case seqAncestors: return ancestorSequence(input, database, false, limit);
+	case seqDescendents: return descendentSequence(input, database, false, limit);
+	case seqSpouses: return spouseSequence(input);
+	case seqParents: return parentSequence(input);
+	case seqChildren: return childSequence(input);
+	default: return null;
+	}
+}
+
+// cachedSequenceOp returns the result of an operation on a Sequence, from the cache if the
+// operation was done on the same input since the Database was last edited. limit is the most
+// generations of ancestors or descendents; 0 means all. The caller owns the result.
+Sequence* cachedSequenceOp(SequenceOp op, Sequence* input, int limit, Database* database) {
+	if (!input || !database || op == seqName || op == seqParents || op == seqChildren ||
+		stats.budget == 0)
+		return runSequenceOp(op, input, limit, database);
+	String key = inputKey(op, input, limit);
+	CacheEntry* entry = findEntry(key, database);
+	if (entry) {
+		stats.hits++;
+		stdfree(key);
+		Sequence* result = cloneSequence(entry->result);
+		if (op == seqSpouses && result) spouseValues(result, input);
+		return result;
+	}
+	stats.misses++;
+	Sequence* result = runSequenceOp(op, input, limit, database);
+	Sequence* copy = cloneSequence(result);
+	if (op == seqSpouses && copy) spouseSources(copy, input);
+	addEntry(key, database, copy);
+	return result;
+}
+
+// cachedNameToSequence returns the persons who match a Gedcom name, from the cache if the name
+// was looked up since the Database was last edited. The caller owns the result.
+Sequence* cachedNameToSequence(String name, Database* database) {
+	if (!name || !*name) return null;
+	if (stats.budget == 0) return nameToSequence(name, database->recordIndex, database->nameIndex);
+	String key = (String) stdalloc(strlen(name) + 2);
+	key[0] = opCodes[seqName];
+	strcpy(key + 1, name);
+	CacheEntry* entry = findEntry(key, database);
+	if (entry) {
+		stats.hits++;
+		stdfree(key);
+		return cloneSequence(entry->result);
+	}
+	stats.misses++;
+	Sequence* result = nameToSequence(name, database->recordIndex, database->nameIndex);
+	addEntry(key, database, cloneSequence(result));
+	return result;
+}
+
+// setSequenceCacheBudget sets the most bytes the cache may hold; 0 turns the cache off.
+void setSequenceCacheBudget(size_t bytes) {
+	stats.budget = bytes;
+	evictTo(bytes);
+}
+
+// clearSequenceCache removes all entries from the cache.
+void clearSequenceCache(void) {
+	while (oldest) removeEntry(oldest);
+}
+
+// getSequenceCacheStats returns the counters of the cache.
+void getSequenceCacheStats(SequenceCacheStats* result) {
+	*result = stats;
+}
+
+// showSequenceCacheStats writes the counters of the cache to a file.
+void showSequenceCacheStats(FILE* file) {
+	long lookups = stats.hits + stats.misses;
+	fprintf(file, "Sequence cache: %ld hits, %ld misses (%.1f%% hits), %ld evictions, %ld invalidations\n",
+			stats.hits, stats.misses, lookups ? 100.0*stats.hits/lookups : 0.0, stats.evictions,
+			stats.invalidations);
+	fprintf(file, "Sequence cache: %d entries, %zu of %zu bytes\n", stats.entries, stats.bytes,
+			stats.budget);
+}
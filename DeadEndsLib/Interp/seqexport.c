@@ -0,0 +1,284 @@
+// DeadEnds
+//
+// seqexport.c writes a subset of a Database to a Gedcom file: the records of a Sequence, the
+// families that join at least two of its persons, and the sources, media objects, notes and other
+// records that these refer to, directly or through each other. Records are numbered by their
+// RecordRanks, so the subset is found with bit sets of ranks instead of tables of keys. Lines that
+// point to records not in the subset are left out with their subordinate lines.
+//
+// The records are written persons first, then families, then the others, each in key order.
+// Several threads format chunks of records into buffers that are written in order, so the file is
+// the same however many threads are used.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "seqexport.h"
+#include "utils.h"
+#include "seqbitmap.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memSequence
+
+#define EXPORTCHUNK 256 // Records formatted at a time by a thread.
+#define MINEXPORTBUFFER 4096
+
+// Subset is the records chosen for an export, as a bit set of their ranks.
+typedef struct Subset {
+	RecordRanks* ranks;
+	uint64_t* chosen;
+	int* order; // Ranks of the chosen records in the order they are written.
+	int numChosen;
+} Subset;
+
+// isChosen returns true if the record with a rank is in a Subset.
+static bool isChosen(Subset* subset, int rank) {
+	return rank >= 0 && (subset->chosen[rank >> 6] >> (rank & 63)) & 1;
+}
+
+// choose adds the record with a rank to a Subset.
+static void choose(Subset* subset, int rank) {
+	subset->chosen[rank >> 6] |= (uint64_t) 1 << (rank & 63);
+}
+
+// pointerRank returns the rank of the record a line points to, or -1 if it doesn't point to one.
+static int pointerRank(Subset* subset, GNode* node) {
+	return isKey(node->value) ? recordRank(subset->ranks, node->value) : -1;
+}
+
+// isLineage returns true if a record is a person or a family.
+static bool isLineage(GNode* root) {
+	RecordType type = recordType(root);
+	return type == GRPerson || type == GRFamily;
+}
+
+// numChosenMembers returns the number of the spouses and children of a family in a Subset.
+static int numChosenMembers(Subset* subset, GNode* family) {
+	int count = 0;
+	for (GNode* node = family->child; node; node = node->sibling) {
+		if (nestr(node->tag, "HUSB") && nestr(node->tag, "WIFE") && nestr(node->tag, "CHIL")) continue;
+		if (isChosen(subset, pointerRank(subset, node))) count++;
+	}
+	return count;
+}
+
+// chooseFamilies adds the families of the persons in a Subset that join at least two of them.
+static void chooseFamilies(Subset* subset) {
+	RecordRanks* ranks = subset->ranks;
+	int numWords = ranks->numRecords/64 + 1;
+	uint64_t* persons = (uint64_t*) stdalloc(numWords*sizeof(uint64_t));
+	memcpy(persons, subset->chosen, numWords*sizeof(uint64_t)); // Families are added as found.
+	for (int w = 0; w < numWords; w++) {
+		for (uint64_t word = persons[w]; word; word &= word - 1) {
+			GNode* person = ranks->records[w*64 + __builtin_ctzll(word)];
+			if (recordType(person) != GRPerson) continue;
+			for (GNode* node = person->child; node; node = node->sibling) {
+				if (nestr(node->tag, "FAMS") && nestr(node->tag, "FAMC")) continue;
+				int rank = pointerRank(subset, node);
+				if (rank < 0 || isChosen(subset, rank)) continue;
+				GNode* family = ranks->records[rank];
+				if (recordType(family) == GRFamily && numChosenMembers(subset, family) >= 2)
+					choose(subset, rank);
+			}
+		}
+	}
+	stdfree(persons);
+}
+
+// chooseReferences adds the records other than persons and families that lines refer to, and
+// puts their ranks on a stack.
+static void chooseReferences(Subset* subset, GNode* node, int* stack, int* top) {
+	for (; node; node = node->sibling) {
+		int rank = pointerRank(subset, node);
+		if (rank >= 0 && !isChosen(subset, rank) && !isLineage(subset->ranks->records[rank])) {
+			choose(subset, rank);
+			stack[(*top)++] = rank;
+		}
+		chooseReferences(subset, node->child, stack, top);
+	}
+}
+
+// chooseOthers adds the records that the records in a Subset and the header refer to, directly or
+// through each other, other than persons and families.
+static void chooseOthers(Subset* subset, GNode* header) {
+	RecordRanks* ranks = subset->ranks;
+	int* stack = (int*) stdalloc((ranks->numRecords + 1)*sizeof(int)); // Each rank is pushed once.
+	int top = 0;
+	for (int rank = 0; rank < ranks->numRecords; rank++)
+		if (isChosen(subset, rank)) stack[top++] = rank;
+	if (header) chooseReferences(subset, header->child, stack, &top);
+	while (top > 0) chooseReferences(subset, ranks->records[stack[--top]]->child, stack, &top);
+	stdfree(stack);
+}
+
+// orderSubset lists the ranks of the records in a Subset in the order they are written and
+// counts them.
+static void orderSubset(Subset* subset, ExportCounts* counts) {
+	RecordRanks* ranks = subset->ranks;
+	subset->order = (int*) stdalloc((ranks->numRecords + 1)*sizeof(int));
+	int n = 0;
+	for (int pass = 0; pass < 3; pass++) {
+		for (int rank = 0; rank < ranks->numRecords; rank++) {
+			if (!isChosen(subset, rank)) continue;
+			RecordType type = recordType(ranks->records[rank]);
+			int group = type == GRPerson ? 0 : type == GRFamily ? 1 : 2;
+			if (group == pass) subset->order[n++] = rank;
+		}
+		if (pass == 0) counts->persons = n;
+		else if (pass == 1) counts->families = n - counts->persons;
+		else counts->others = n - counts->persons - counts->families;
+	}
+	subset->numChosen = n;
+}
+
+// ExportBuffer holds the text of the records a thread formats.
+typedef struct ExportBuffer {
+	char* chars;
+	size_t length;
+	size_t room;
+	int pruned;
+} ExportBuffer;
+
+// appendToBuffer appends text to an ExportBuffer, doubling its room as needed.
+static void appendToBuffer(ExportBuffer* buffer, String text, size_t length) {
+	if (buffer->length + length > buffer->room) {
+		size_t room = buffer->room ? 2*buffer->room : MINEXPORTBUFFER;
+		while (room < buffer->length + length) room *= 2;
+		char* chars = (char*) stdalloc(room);
+		if (buffer->length) memcpy(chars, buffer->chars, buffer->length);
+		if (buffer->chars) stdfree(buffer->chars);
+		buffer->chars = chars;
+		buffer->room = room;
+	}
+	memcpy(buffer->chars + buffer->length, text, length);
+	buffer->length += length;
+}
+
+// formatLine appends a Gedcom line to an ExportBuffer.
+static void formatLine(ExportBuffer* buffer, int level, GNode* node) {
+	char number[16];
+	appendToBuffer(buffer, number, snprintf(number, sizeof(number), "%d", level));
+	if (node->key) {
+		appendToBuffer(buffer, " ", 1);
+		appendToBuffer(buffer, node->key, strlen(node->key));
+	}
+	appendToBuffer(buffer, " ", 1);
+	appendToBuffer(buffer, node->tag, strlen(node->tag));
+	if (node->value) {
+		appendToBuffer(buffer, " ", 1);
+		appendToBuffer(buffer, node->value, strlen(node->value));
+	}
+	appendToBuffer(buffer, "\n", 1);
+}
+
+// formatLines appends lines and their subordinate lines to an ExportBuffer, leaving out those that
+// point to records not in a Subset.
+static void formatLines(ExportBuffer* buffer, Subset* subset, int level, GNode* node) {
+	for (; node; node = node->sibling) {
+		if (isKey(node->value) && !isChosen(subset, recordRank(subset->ranks, node->value))) {
+			buffer->pruned++;
+			continue;
+		}
+		formatLine(buffer, level, node);
+		formatLines(buffer, subset, level + 1, node->child);
+	}
+}
+
+// formatRecord appends a record to an ExportBuffer.
+static void formatRecord(ExportBuffer* buffer, Subset* subset, GNode* root) {
+	formatLine(buffer, 0, root);
+	formatLines(buffer, subset, 1, root->child);
+}
+
+// ExportPool is the chunks of records shared by the formatting threads; each chunk has its own
+// ExportBuffer.
+typedef struct ExportPool {
+	Subset* subset;
+	ExportBuffer* buffers;
+	int numChunks;
+	atomic_int next; // Index of the next chunk to format.
+} ExportPool;
+
+// exportWorker formats chunks of records from an ExportPool until none are left.
+static void* exportWorker(void* arg) {
+	ExportPool* pool = (ExportPool*) arg;
+	Subset* subset = pool->subset;
+	int chunk;
+	while ((chunk = atomic_fetch_add(&pool->next, 1)) < pool->numChunks) {
+		int first = chunk*EXPORTCHUNK;
+		int last = first + EXPORTCHUNK < subset->numChosen ? first + EXPORTCHUNK : subset->numChosen;
+		for (int i = first; i < last; i++)
+			formatRecord(pool->buffers + chunk, subset, subset->ranks->records[subset->order[i]]);
+	}
+	return null;
+}
+
+// formatSubset formats the records of a Subset with up to numThreads threads, 0 meaning one per
+// processor, and returns the ExportBuffers of its chunks.
+static ExportBuffer* formatSubset(Subset* subset, int numChunks, int numThreads) {
+	ExportPool pool;
+	pool.subset = subset;
+	pool.buffers = (ExportBuffer*) stdalloc((numChunks + 1)*sizeof(ExportBuffer));
+	memset(pool.buffers, 0, (numChunks + 1)*sizeof(ExportBuffer));
+	pool.numChunks = numChunks;
+	atomic_init(&pool.next, 0);
+	runThreads(exportWorker, &pool, 0, threadCount(numThreads, numChunks));
+	return pool.buffers;
+}
+
+// writeBuffer writes and frees the text of an ExportBuffer. Returns false if the write fails.
+static bool writeBuffer(ExportBuffer* buffer, FILE* fp) {
+	bool okay = fwrite(buffer->chars, 1, buffer->length, fp) == buffer->length;
+	if (buffer->chars) stdfree(buffer->chars);
+	buffer->chars = null;
+	buffer->length = buffer->room = 0;
+	return okay;
+}
+
+// exportSequenceToGedcom writes the records of a Sequence to a Gedcom file with the families that
+// join at least two of its persons and the records these refer to. Lines that point to records
+// not written are left out. The header, or a plain one if it is null, comes first. The records
+// are formatted by numThreads threads; 0 means one per processor. counts, if not null, gets the
+// numbers of records written and lines left out. Returns false if a write fails.
+bool exportSequenceToGedcom(Sequence* sequence, GNode* header, FILE* fp, int numThreads,
+							ExportCounts* counts) {
+	if (!sequence || !fp) return false;
+	ExportCounts scratch;
+	if (!counts) counts = &scratch;
+	Subset subset;
+	subset.ranks = getRecordRanks(sequence->index);
+	int numWords = subset.ranks->numRecords/64 + 1;
+	subset.chosen = (uint64_t*) stdalloc(numWords*sizeof(uint64_t));
+	memset(subset.chosen, 0, numWords*sizeof(uint64_t));
+	FORSEQUENCE(sequence, element, count)
+		int rank = recordRank(subset.ranks, element->root->key);
+		if (rank >= 0) choose(&subset, rank);
+	ENDSEQUENCE
+	chooseFamilies(&subset);
+	chooseOthers(&subset, header);
+	orderSubset(&subset, counts);
+
+	ExportBuffer head = {null, 0, 0, 0};
+	if (header) formatRecord(&head, &subset, header);
+	else {
+		String plain = "0 HEAD\n1 GEDC\n2 VERS 5.5\n2 FORM LINEAGE-LINKED\n1 CHAR UTF-8\n";
+		appendToBuffer(&head, plain, strlen(plain));
+	}
+	counts->pruned = head.pruned;
+	bool okay = writeBuffer(&head, fp);
+	int numChunks = (subset.numChosen + EXPORTCHUNK - 1)/EXPORTCHUNK;
+	ExportBuffer* buffers = formatSubset(&subset, numChunks, numThreads);
+	for (int i = 0; i < numChunks; i++) {
+		counts->pruned += buffers[i].pruned;
+		if (!writeBuffer(buffers + i, fp)) okay = false;
+	}
+	if (fputs("0 TRLR\n", fp) == EOF) okay = false;
+	stdfree(buffers);
+	stdfree(subset.order);
+	stdfree(subset.chosen);
+	releaseRecordRanks(subset.ranks);
+	return okay;
+}
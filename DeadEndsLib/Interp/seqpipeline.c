@@ -0,0 +1,281 @@
+// DeadEnds
+//
+// seqpipeline.c holds Sequence pipelines. Script expressions like
+// childset(spouseset(ancestorset(s))) would otherwise build a Sequence at every step, each with
+// its own elements and its own table of the keys it has seen. Instead parentset, childset, spouseset, ancestorset and descendentset
+// return lazy Sequences that only remember their steps; a step on a lazy Sequence adds to its
+// steps. The steps are done together when the Sequence is iterated or counted, on LineageGraph
+// ids with one visited array, and elements are only made for the final persons. Counting stops
+// early when a step finds no one. A lazy Sequence with one step on a Sequence the Sequence cache
+// handles uses the cache.
+//
+// Pending pipelines are run before a script edits a Database, so lazy Sequences have the
+// persons they would have had if they had been found right away.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <limits.h>
+#include "seqpipeline.h"
+#include "lineagegraph.h"
+#include "gedcom.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memSequence
+
+static SequencePipeline* pending = null; // Pipelines not yet run.
+
+// linkPipeline adds a pipeline to the pending list.
+static void linkPipeline(SequencePipeline* pipeline) {
+	pipeline->prev = null;
+	pipeline->next = pending;
+	if (pending) pending->prev = pipeline;
+	pending = pipeline;
+}
+
+// unlinkPipeline removes a pipeline from the pending list.
+static void unlinkPipeline(SequencePipeline* pipeline) {
+	if (pipeline->prev) pipeline->prev->next = pipeline->next;
+	else if (pending == pipeline) pending = pipeline->next;
+	if (pipeline->next) pipeline->next->prev = pipeline->prev;
+	pipeline->prev = pipeline->next = null;
+}
+
+// copyBase returns a copy of the elements of a Sequence.
+static Sequence* copyBase(Sequence* sequence) {
+	return copySequence(materializeSequence(sequence));
+}
+
+// forgetIds frees the persons found by a pipeline.
+static void forgetIds(SequencePipeline* pipeline) {
+	if (pipeline->ids) stdfree(pipeline->ids);
+	if (pipeline->values) stdfree(pipeline->values);
+	pipeline->ids = null;
+	pipeline->values = null;
+	pipeline->numIds = -1;
+}
+
+// createPipeline creates an empty pending pipeline that starts from a copy of a Sequence.
+static SequencePipeline* createPipeline(Sequence* base, Database* database, Sequence* owner) {
+	SequencePipeline* pipeline = (SequencePipeline*) stdalloc(sizeof(SequencePipeline));
+	pipeline->base = base;
+	pipeline->database = database;
+	pipeline->numSteps = 0;
+	pipeline->numIds = -1;
+	pipeline->ids = null;
+	pipeline->values = null;
+	pipeline->generation = 0;
+	pipeline->owner = owner;
+	linkPipeline(pipeline);
+	return pipeline;
+}
+
+// copySequencePipeline returns a pending copy of a pipeline for another Sequence.
+SequencePipeline* copySequencePipeline(SequencePipeline* pipeline, Sequence* owner) {
+	SequencePipeline* copy = createPipeline(copyBase(pipeline->base), pipeline->database, owner);
+	copy->numSteps = pipeline->numSteps;
+	memcpy(copy->ops, pipeline->ops, pipeline->numSteps*sizeof(SequenceOp));
+	memcpy(copy->limits, pipeline->limits, pipeline->numSteps*sizeof(int));
+	if (pipeline->numIds >= 0) {
+		copy->numIds = pipeline->numIds;
+		copy->ids = (int*) stdalloc((pipeline->numIds + 1)*sizeof(int));
+		copy->values = (void**) stdalloc((pipeline->numIds + 1)*sizeof(void*));
+		memcpy(copy->ids, pipeline->ids, pipeline->numIds*sizeof(int));
+		memcpy(copy->values, pipeline->values, pipeline->numIds*sizeof(void*));
+		copy->generation = pipeline->generation;
+	}
+	return copy;
+}
+
+// deleteSequencePipeline deletes a pipeline.
+void deleteSequencePipeline(SequencePipeline* pipeline) {
+	unlinkPipeline(pipeline);
+	forgetIds(pipeline);
+	deleteSequence(pipeline->base);
+	stdfree(pipeline);
+}
+
+// lazySequenceOp returns a lazy Sequence that is the result of an operation on a Sequence. If the
+// Sequence is lazy the operation is added to a copy of its steps. limit is the most generations
+// of ancestors or descendents; 0 means all.
+Sequence* lazySequenceOp(SequenceOp op, Sequence* input, int limit, Database* database) {
+	if (!input) return null;
+	Sequence* sequence = createSequence(input->index);
+	SequencePipeline* from = input->pipeline;
+	SequencePipeline* pipeline;
+	if (from && from->database == database && from->numSteps < MAXPIPELINESTEPS) {
+		pipeline = copySequencePipeline(from, sequence);
+		forgetIds(pipeline);
+	} else {
+		pipeline = createPipeline(copyBase(input), database, sequence);
+	}
+	pipeline->ops[pipeline->numSteps] = op;
+	pipeline->limits[pipeline->numSteps++] = limit;
+	sequence->pipeline = pipeline;
+	return sequence;
+}
+
+// isCachedStep returns true if a pipeline is one step the Sequence cache handles.
+static bool isCachedStep(SequencePipeline* pipeline) {
+	if (pipeline->numSteps != 1) return false;
+	SequenceOp op = pipeline->ops[0];
+	return op == seqAncestors || op == seqDescendents || op == seqSpouses;
+}
+
+// Frontier is the persons found by a step of a pipeline, with their values.
+typedef struct Frontier {
+	int* ids;
+	void** values;
+	int length;
+	int room;
+} Frontier;
+
+// initFrontier makes a Frontier with room for some persons.
+static void initFrontier(Frontier* frontier, int room) {
+	frontier->ids = (int*) stdalloc((room + 1)*sizeof(int));
+	frontier->values = (void**) stdalloc((room + 1)*sizeof(void*));
+	frontier->length = 0;
+	frontier->room = room;
+}
+
+// growFrontier makes sure a Frontier has room for more persons.
+static void growFrontier(Frontier* frontier, int more) {
+	int needed = frontier->length + more;
+	if (needed <= frontier->room) return;
+	int room = 2*frontier->room > needed ? 2*frontier->room : needed;
+	int* ids = (int*) stdalloc((room + 1)*sizeof(int));
+	void** values = (void**) stdalloc((room + 1)*sizeof(void*));
+	memcpy(ids, frontier->ids, frontier->length*sizeof(int));
+	memcpy(values, frontier->values, frontier->length*sizeof(void*));
+	stdfree(frontier->ids);
+	stdfree(frontier->values);
+	frontier->ids = ids;
+	frontier->values = values;
+	frontier->room = room;
+}
+
+static int* visited = null; // Stamp of the last step that found each person.
+static int numVisited = 0;
+static int visitStamp = 0;
+
+// newVisitStamp returns the stamp of a new step, making the visited array big enough for a
+// LineageGraph. The array is kept between pipelines so a step costs no more than its persons.
+static int newVisitStamp(int numPersons) {
+	if (numPersons > numVisited || visitStamp == INT_MAX) {
+		if (visited) stdfree(visited);
+		visited = (int*) stdalloc((numPersons + 1)*sizeof(int));
+		memset(visited, 0, (numPersons + 1)*sizeof(int));
+		numVisited = numPersons;
+		visitStamp = 0;
+	}
+	return ++visitStamp;
+}
+
+// findIds does the steps of a pipeline on LineageGraph ids. Each step is a pass over the persons
+// found by the step before; one visited array, stamped anew for each step, keeps the persons of
+// a step unique.
+static void findIds(SequencePipeline* pipeline) {
+	forgetIds(pipeline);
+	LineageGraph* graph = getDatabaseLineageGraph(pipeline->database);
+	Frontier this, next;
+	initFrontier(&this, lengthSequence(pipeline->base));
+	initFrontier(&next, this.room);
+	FORSEQUENCE(pipeline->base, element, count)
+		int id = lineageId(graph, element->root->key);
+		if (id < 0) continue;
+		this.ids[this.length] = id;
+		this.values[this.length++] = element->value;
+	ENDSEQUENCE
+	for (int step = 0; step < pipeline->numSteps && this.length > 0; step++) {
+		SequenceOp op = pipeline->ops[step];
+		next.length = 0;
+		if (op == seqAncestors || op == seqDescendents) {
+			Closure* closure = op == seqAncestors
+				? ancestorClosure(graph, this.ids, this.length, false, pipeline->limits[step])
+				: descendentClosure(graph, this.ids, this.length, false, pipeline->limits[step]);
+			growFrontier(&next, closure->numIds);
+			memcpy(next.ids, closure->ids, closure->numIds*sizeof(int));
+			memset(next.values, 0, closure->numIds*sizeof(void*));
+			next.length = closure->numIds;
+			deleteClosure(closure);
+		} else {
+			int stamp = newVisitStamp(graph->numPersons);
+			for (int i = 0; i < this.length; i++) {
+				int person = this.ids[i], numFound;
+				int* found;
+				if (op == seqParents) {
+					found = graph->parents + 2*person;
+					numFound = 2;
+				} else if (op == seqChildren) {
+					found = graph->children + graph->firstChild[person];
+					numFound = graph->firstChild[person + 1] - graph->firstChild[person];
+				} else {
+					found = graph->spouses + graph->firstSpouse[person];
+					numFound = graph->firstSpouse[person + 1] - graph->firstSpouse[person];
+				}
+				growFrontier(&next, numFound);
+				for (int j = 0; j < numFound; j++) {
+					int other = found[j];
+					if (other < 0 || visited[other] == stamp) continue;
+					visited[other] = stamp;
+					next.ids[next.length] = other;
+					next.values[next.length++] = op == seqChildren ? null : this.values[i];
+				}
+			}
+		}
+		Frontier swap = this; this = next; next = swap;
+	}
+	stdfree(next.ids);
+	stdfree(next.values);
+	pipeline->ids = this.ids;
+	pipeline->values = this.values;
+	pipeline->numIds = this.length;
+	pipeline->generation = pipeline->database->generation;
+}
+
+// hasCurrentIds returns true if the persons of a pipeline were found since its Database was last
+// edited.
+static bool hasCurrentIds(SequencePipeline* pipeline) {
+	return pipeline->numIds >= 0 && pipeline->generation == pipeline->database->generation;
+}
+
+// lengthSequencePipeline returns the length of the Sequence a pipeline is pending for, finding
+// its persons but not making its elements.
+int lengthSequencePipeline(SequencePipeline* pipeline) {
+	if (lengthSequence(pipeline->base) == 0) return 0;
+	if (isCachedStep(pipeline)) {
+		Sequence* owner = pipeline->owner;
+		runSequencePipeline(owner);
+		return lengthSequence(owner);
+	}
+	if (!hasCurrentIds(pipeline)) findIds(pipeline);
+	return pipeline->numIds;
+}
+
+// runSequencePipeline makes the elements of a lazy Sequence and deletes its pipeline.
+void runSequencePipeline(Sequence* sequence) {
+	SequencePipeline* pipeline = sequence->pipeline;
+	if (!pipeline) return;
+	sequence->pipeline = null;
+	unlinkPipeline(pipeline);
+	if (isCachedStep(pipeline) && !hasCurrentIds(pipeline)) {
+		Sequence* result = cachedSequenceOp(pipeline->ops[0], pipeline->base, pipeline->limits[0],
+											pipeline->database);
+		if (result) {
+			moveSequenceElements(sequence, result);
+			deleteSequence(result);
+		}
+	} else {
+		if (!hasCurrentIds(pipeline)) findIds(pipeline);
+		LineageGraph* graph = getDatabaseLineageGraph(pipeline->database);
+		for (int i = 0; i < pipeline->numIds; i++)
+			appendRootToSequence(sequence, graph->persons[pipeline->ids[i]], pipeline->values[i]);
+	}
+	deleteSequencePipeline(pipeline);
+}
+
+// runPendingSequences makes the elements of all lazy Sequences; it is called before a Database
+// is edited.
+void runPendingSequences(void) {
+	while (pending) runSequencePipeline(pending->owner);
+}
@@ -3,11 +3,22 @@
 // sequence.c holds the functions that implement the Sequence data type that handles sets of
 // persons and other record types. It underlies the indiseq data type of DeadEnds Script.
 //
+// The elements of a Sequence are kept in three parallel arrays, of record roots, of the names of
+// persons, and of values, that grow by doubling. Sorting, copying and the set operations move
+// whole arrays, and records whose roots are known are appended without looking up their keys.
+//
+// The union, intersection and difference of large Sequences without values are found with
+// SequenceBitmaps of the key ranks of their records, rather than by sorting and merging keys. A
+// Sequence keeps its bitmap while its records don't change, so it is also used by isInSequence.
+// The result of such an operation is held in its bitmap, and its arrays, which are in key order,
+// are made from the bitmap when its elements are first needed.
+//
 // Created by Thomas Wetmore on 1 March 2023.
-// Last changed on 13 December 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "sequence.h"
+#include "seqcache.h"
 #include "gnode.h"
 #include "lineage.h"
 #include "gedcom.h"
@@ -17,177 +28,415 @@
 #include "splitjoin.h"
 #include "stringtable.h"
 #include "sort.h"
-#include "writenode.h"
+#include "seqbitmap.h"
+#include "seqpipeline.h"
+#include "seqexport.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memSequence
 
 //static bool debugging = false;
 static int numBucketsInSequenceTables = 359;
 
-// keyGetKey is the getKey function that returns the key of a SequenceEl.
-static String keyGetKey(void* element) {
-	SequenceEl* el = (SequenceEl*) element;
-	return el->root->key;
-}
+#define BITMAPSEQUENCE 256 // Fewest elements for which set operations and searches use bitmaps.
 
-// nameGetKey is the getKey function that returns the name of a SequenceEl.
-static String nameGetKey(void* element) {
-	SequenceEl* el = (SequenceEl*) element;
-	return el->name;
-}
+void baseFree(void *word) { free(word); }
 
-// keyCompare is the compare function that compares SequenceEl's by key.
-static int keyCompare(String a, String b) {
-	return compareRecordKeys(a, b);
-}
+#define key_to_name(key, database)  (NAME(keyToPerson(key, database))->value)
 
-// nameCompare is the compare function that compares SequenceEl's by name.
-static int nameCompare(String a, String b) {
-	return compareNames(a, b);
+// dropBitmap removes the bitmap of a Sequence whose elements are in its arrays.
+static void dropBitmap(Sequence* sequence) {
+	if (!sequence->bitmap) return;
+	deleteSequenceBitmap(sequence->bitmap);
+	releaseRecordRanks(sequence->ranks);
+	sequence->bitmap = null;
+	sequence->ranks = null;
+}
+
+// freeElements frees the element arrays of a Sequence.
+static void freeElements(Sequence* sequence) {
+	if (!sequence->roots) return;
+	stdfree(sequence->roots);
+	stdfree(sequence->names);
+	stdfree(sequence->values);
+	sequence->roots = null;
+	sequence->names = null;
+	sequence->values = null;
+	sequence->length = sequence->room = 0;
+}
+
+// growSequence makes room for length elements in a Sequence, doubling its arrays as needed.
+static void growSequence(Sequence* sequence, int length) {
+	if (length <= sequence->room) return;
+	int room = sequence->room ? 2*sequence->room : 8;
+	while (room < length) room *= 2;
+	GNode** roots = (GNode**) stdalloc(room*sizeof(GNode*));
+	String* names = (String*) stdalloc(room*sizeof(String));
+	void** values = (void**) stdalloc(room*sizeof(void*));
+	int count = sequence->length;
+	if (count) {
+		memcpy(roots, sequence->roots, count*sizeof(GNode*));
+		memcpy(names, sequence->names, count*sizeof(String));
+		memcpy(values, sequence->values, count*sizeof(void*));
+	}
+	freeElements(sequence);
+	sequence->roots = roots;
+	sequence->names = names;
+	sequence->values = values;
+	sequence->length = count;
+	sequence->room = room;
+}
+
+// rootName returns the name of a person record; other records have no name.
+static String rootName(GNode* root) {
+	GNode* name = recordType(root) == GRPerson ? NAME(root) : null;
+	return name ? name->value : null;
+}
+
+// materializeSequence makes the elements of a Sequence from its pipeline or its bitmap if they are
+// not there yet, and returns the Sequence.
+Sequence* materializeSequence(Sequence* sequence) {
+	if (sequence->pipeline) runSequencePipeline(sequence);
+	if (!sequence->inBitmap) return sequence;
+	sequence->inBitmap = false;
+	int* ranks = (int*) stdalloc((lengthSequenceBitmap(sequence->bitmap) + 1)*sizeof(int));
+	int count = sequenceBitmapToArray(sequence->bitmap, ranks);
+	growSequence(sequence, count);
+	for (int i = 0; i < count; i++) {
+		GNode* root = sequence->ranks->records[ranks[i]];
+		sequence->roots[i] = root;
+		sequence->names[i] = rootName(root);
+		sequence->values[i] = null;
+	}
+	sequence->length = count;
+	stdfree(ranks);
+	return sequence;
 }
 
-// delete is the function that deletes a SequenceEl.
-static void delete(void* element) {
-	free(element);
+// sequenceBitmap returns the bitmap of a Sequence, making it if needed. Returns null if a record
+// of the Sequence isn't in its RecordIndex.
+static SequenceBitmap* sequenceBitmap(Sequence* sequence) {
+	if (sequence->bitmap && isCurrentRecordRanks(sequence->ranks)) return sequence->bitmap;
+	materializeSequence(sequence);
+	dropBitmap(sequence);
+	RecordRanks* ranks = getRecordRanks(sequence->index);
+	SequenceBitmap* bitmap = createSequenceBitmap();
+	for (int i = 0; i < sequence->length; i++) {
+		GNode* root = sequence->roots[i];
+		int rank = recordRank(ranks, root->key);
+		if (rank < 0 || ranks->records[rank] != root) {
+			deleteSequenceBitmap(bitmap);
+			releaseRecordRanks(ranks);
+			return null;
+		}
+		addToSequenceBitmap(bitmap, rank);
+	}
+	sequence->bitmap = bitmap;
+	sequence->ranks = ranks;
+	return bitmap;
 }
 
-void baseFree(void *word) { free(word); }
-
-#define key_to_name(key, database)  (NAME(keyToPerson(key, database))->value)
+// hasValues returns true if an element of a Sequence has a value.
+static bool hasValues(Sequence* sequence) {
+	if (sequence->inBitmap) return false;
+	materializeSequence(sequence);
+	for (int i = 0; i < sequence->length; i++)
+		if (sequence->values[i]) return true;
+	return false;
+}
 
-// sequenceElements returns the array of elments in a Sequence.
-static SequenceEl** sequenceElements(Sequence *sequence) {
-	return (SequenceEl**) (&(sequence->block))->elements;
+// useBitmaps returns true if a set operation on two Sequences can be done with their bitmaps:
+// they are large, and have no values that would have to be kept in the result.
+static bool useBitmaps(Sequence* one, Sequence* two) {
+	if (lengthSequence(one) + lengthSequence(two) < BITMAPSEQUENCE) return false;
+	if (hasValues(one) || hasValues(two)) return false;
+	return sequenceBitmap(one) && sequenceBitmap(two) && one->ranks == two->ranks;
 }
 
-// createSequenceEl creates a SequenceEl.
-//SequenceEl* createSequenceEl(Database* database, String key, void* value) {
-SequenceEl* createSequenceEl(RecordIndex* index, String key, void* value) {
-	SequenceEl* element = (SequenceEl*) malloc(sizeof(SequenceEl));
-	GNode* root = getRecord(key, index);
-	ASSERT(root);
-	element->root = root;
-	if (recordType(root) == GRPerson) element->name = (NAME(root))->value;
-	element->value = value;
-	return element;
+// bitmapToSequence returns a Sequence whose elements are held in a bitmap of record ranks.
+static Sequence* bitmapToSequence(SequenceBitmap* bitmap, Sequence* from) {
+	Sequence* sequence = createSequence(from->index);
+	sequence->bitmap = bitmap;
+	sequence->ranks = getRecordRanks(from->index); // The same as from's.
+	sequence->inBitmap = true;
+	sequence->sortType = SequenceKeySorted;
+	sequence->unique = true;
+	return sequence;
 }
 
 // createSequence creates a Sequence.
-//Sequence* createSequence(Database* database) {
 Sequence* createSequence(RecordIndex* index) {
-	Sequence* sequence = (Sequence*) malloc(sizeof(Sequence));
-	initBlock(&(sequence->block));
-	//sequence->database  = database;
+	Sequence* sequence = (Sequence*) stdalloc(sizeof(Sequence));
+	sequence->roots = null;
+	sequence->names = null;
+	sequence->values = null;
+	sequence->length = 0;
+	sequence->room = 0;
 	sequence->index  = index;
 	sequence->unique = false;
 	sequence->sortType = SequenceNotSorted;
+	sequence->bitmap = null;
+	sequence->ranks = null;
+	sequence->inBitmap = false;
+	sequence->pipeline = null;
 	return sequence;
 }
 
 // lengthSequence returns the length of a Sequence.
 int lengthSequence(Sequence* sequence) {
-	return (&(sequence->block))->length;
+	if (sequence->inBitmap) return lengthSequenceBitmap(sequence->bitmap);
+	if (sequence->pipeline) return lengthSequencePipeline(sequence->pipeline);
+	return sequence->length;
 }
 
 // deleteSequence deletes a Sequence.
 void deleteSequence(Sequence* sequence) {
-	Block* block = &(sequence->block);
-	deleteBlock(block, delete);
-	free(sequence);
+	freeElements(sequence);
+	dropBitmap(sequence);
+	if (sequence->pipeline) deleteSequencePipeline(sequence->pipeline);
+	stdfree(sequence);
 }
 
 // emptySequence removes the elements from a Sequence.
 void emptySequence(Sequence *sequence) {
-	Block* block = &(sequence->block);
-	emptyBlock(block, delete);
-}
-
-// appendToSequence creates and appends a SequenceEl to a Sequence.
+	sequence->length = 0;
+	dropBitmap(sequence);
+	sequence->inBitmap = false;
+	if (sequence->pipeline) deleteSequencePipeline(sequence->pipeline);
+	sequence->pipeline = null;
+}
+
+// appendRootToSequence appends the record with a root to a Sequence; callers that have the root
+// use it so the key isn't looked up.
+void appendRootToSequence(Sequence* sequence, GNode* root, void* value) {
+	if (!sequence || !root) return;
+	materializeSequence(sequence);
+	dropBitmap(sequence);
+	growSequence(sequence, sequence->length + 1);
+	int i = sequence->length++;
+	sequence->roots[i] = root;
+	sequence->names[i] = rootName(root);
+	sequence->values[i] = value;
+}
+
+// appendToSequence appends the record with a key to a Sequence.
 void appendToSequence(Sequence* sequence, String key, void* value) {
 	if (!sequence || !key) return;
-	//SequenceEl* element = createSequenceEl(sequence->database, key, value);
-	SequenceEl* element = createSequenceEl(sequence->index, key, value);
-	appendToBlock(&(sequence->block), element);
+	GNode* root = getRecord(key, sequence->index);
+	ASSERT(root);
+	appendRootToSequence(sequence, root, value);
+}
+
+// copyElements appends the elements of one Sequence to another.
+static void copyElements(Sequence* destination, Sequence* source) {
+	materializeSequence(source);
+	materializeSequence(destination);
+	dropBitmap(destination);
+	int count = destination->length, n = source->length;
+	if (n == 0) return;
+	growSequence(destination, count + n);
+	memcpy(destination->roots + count, source->roots, n*sizeof(GNode*));
+	memcpy(destination->names + count, source->names, n*sizeof(String));
+	memcpy(destination->values + count, source->values, n*sizeof(void*));
+	destination->length = count + n;
 }
 
 // appendSequenceToSequence appends a Sequence to another Sequence. The Sequences must be distinct.
 // destination changes; source does not.
 void appendSequenceToSequence(Sequence* destination, Sequence* source) {
-	FORSEQUENCE(source, element, count)
-		appendToSequence(destination, element->root->key, element->value);
-	ENDSEQUENCE
+	copyElements(destination, source);
+}
+
+// moveSequenceElements gives the elements of source to destination, which must be empty; source
+// is left empty.
+void moveSequenceElements(Sequence* destination, Sequence* source) {
+	materializeSequence(source);
+	freeElements(destination);
+	destination->roots = source->roots;
+	destination->names = source->names;
+	destination->values = source->values;
+	destination->length = source->length;
+	destination->room = source->room;
+	destination->sortType = source->sortType;
+	destination->unique = source->unique;
+	source->roots = null;
+	source->names = null;
+	source->values = null;
+	source->length = source->room = 0;
 }
 
 // renameElementInSequence updates an element in a Sequence with a new name.
 void renameElementInSequence(Sequence* sequence, String key) {
 	if (!sequence || !key) return;
-	Block *block = &(sequence->block);
-	SequenceEl** elements = (SequenceEl**) block->elements;
-	for (int i = 0; i < block->length; i++) {
-		GNode* root = elements[i]->root;
-		if (eqstr(key, root->key)) {
-			(elements[i])->name = NAME(root)->value;
+	materializeSequence(sequence);
+	for (int i = 0; i < sequence->length; i++) {
+		GNode* root = sequence->roots[i];
+		if (eqstr(key, root->key)) sequence->names[i] = NAME(root)->value;
+	}
+}
+
+// findInSequence returns the place of an element with a key in a Sequence, or -1 if there is
+// none. Key sorted Sequences are searched by bisection.
+static int findInSequence(Sequence* sequence, String key) {
+	materializeSequence(sequence);
+	GNode** roots = sequence->roots;
+	if (sequence->sortType == SequenceKeySorted) {
+		int low = 0, high = sequence->length - 1;
+		while (low <= high) {
+			int middle = (low + high)/2;
+			int rel = compareRecordKeys(key, roots[middle]->key);
+			if (rel == 0) return middle;
+			if (rel < 0) high = middle - 1;
+			else low = middle + 1;
 		}
+		return -1;
 	}
+	for (int i = 0; i < sequence->length; i++)
+		if (eqstr(key, roots[i]->key)) return i;
+	return -1;
 }
 
-// isInSequence checks if a SequenceEl with given key is in a Sequence. NOTE: Consider
-// what could be done if the sequence were sorted.
+// isInSequence checks if an element with given key is in a Sequence. Large Sequences are
+// checked with their bitmaps.
 bool isInSequence(Sequence *seq, String key) {
 	if (!seq || !key) return false;
-	Block *block = &(seq->block);
-	SequenceEl **elements = (SequenceEl**) block->elements;
-	for (int i = 0; i < block->length; i++) {
-		if (eqstr(key, (elements[i])->root->key)) return true;
+	if (seq->bitmap || lengthSequence(seq) >= BITMAPSEQUENCE) {
+		SequenceBitmap* bitmap = sequenceBitmap(seq);
+		if (bitmap) return isInSequenceBitmap(bitmap, recordRank(seq->ranks, key));
 	}
-	return false;
+	return findInSequence(seq, key) >= 0;
 }
 
-// removeFromSequence removes the SequenceEl with the given key from the Sequence.
+// removeFromSequence removes the element with the given key from the Sequence, keeping the
+// order of the others.
 bool removeFromSequence(Sequence* sequence, String key) {
 	ASSERT(sequence && key);
 	if (!sequence || !key) return false;
-	Block *block = &(sequence->block);
-	if (sequence->sortType == SequenceNotSorted) {
-		return removeFromUnsortedBlock(block, key, keyGetKey, delete);
-	} else if (sequence->sortType == SequenceKeySorted) {
-		return removeFromSortedBlock(block, key, keyGetKey, keyCompare, delete);
-	} else if (sequence->sortType == SequenceNameSorted) {
-		return removeFromSortedBlock(block, key, nameGetKey, nameCompare, delete);
-	} else {
-		printf("NO OTHER SORT TYPE SUPPORTED YET\n");
-	}
-	return false;
+	if (sequence->bitmap && isCurrentRecordRanks(sequence->ranks) &&
+		!isInSequenceBitmap(sequence->bitmap, recordRank(sequence->ranks, key))) return false;
+	int i = findInSequence(sequence, key);
+	dropBitmap(sequence);
+	if (i < 0) return false;
+	int n = --sequence->length - i;
+	memmove(sequence->roots + i, sequence->roots + i + 1, n*sizeof(GNode*));
+	memmove(sequence->names + i, sequence->names + i + 1, n*sizeof(String));
+	memmove(sequence->values + i, sequence->values + i + 1, n*sizeof(void*));
+	return true;
 }
 
 // elementFromSequence returns the key and name values of an indexed Sequence element.
 bool elementFromSequence (Sequence* sequence, int index, String* pkey, String* pname) {
 	ASSERT(sequence);
-	Block *block = &(sequence->block);
-	if (index < 0 || index >= block->length) return false;
-	if (pkey) *pkey = keyGetKey((block->elements)[index]);
-	if (pname) *pname = nameGetKey((block->elements)[index]);
+	materializeSequence(sequence);
+	if (index < 0 || index >= sequence->length) return false;
+	if (pkey) *pkey = sequence->roots[index]->key;
+	if (pname) *pname = sequence->names[index];
 	return true;
 }
 
+// SortItem is an element of a Sequence being sorted: its sort key and its place.
+typedef struct SortItem {
+	String key;
+	int place;
+} SortItem;
+
+// sortItemGetKey is the getKey function for SortItems.
+static String sortItemGetKey(void* item) {
+	return ((SortItem*) item)->key;
+}
+
+// collationCompare is the compare function for collation keys.
+static int collationCompare(String a, String b) {
+	return strcmp(a, b);
+}
+
+// sortSequence sorts the elements of a Sequence by the keys of an array of SortItems, one for
+// each element, and then puts the elements in their new places.
+static void sortSequence(Sequence* sequence, SortItem* items, int(*compare)(String, String)) {
+	int n = sequence->length;
+	void** order = (void**) stdalloc(n*sizeof(void*));
+	for (int i = 0; i < n; i++) order[i] = items + i;
+	sortElements(order, n, sortItemGetKey, compare);
+	GNode** roots = (GNode**) stdalloc(sequence->room*sizeof(GNode*));
+	String* names = (String*) stdalloc(sequence->room*sizeof(String));
+	void** values = (void**) stdalloc(sequence->room*sizeof(void*));
+	for (int i = 0; i < n; i++) {
+		int place = ((SortItem*) order[i])->place;
+		roots[i] = sequence->roots[place];
+		names[i] = sequence->names[place];
+		values[i] = sequence->values[place];
+	}
+	int room = sequence->room;
+	freeElements(sequence);
+	sequence->roots = roots;
+	sequence->names = names;
+	sequence->values = values;
+	sequence->length = n;
+	sequence->room = room;
+	stdfree(order);
+}
+
+// collationSort sorts the elements of a Sequence by their names. The collation key of each name
+// is made once, in a side array, so comparisons are strcmps.
+static void collationSort(Sequence* sequence, bool fold) {
+	materializeSequence(sequence);
+	int n = sequence->length;
+	if (n < 2) return;
+	SortItem* items = (SortItem*) stdalloc(n*sizeof(SortItem));
+	char key[COLLATIONKEYLEN];
+	for (int i = 0; i < n; i++) {
+		nameCollationKeyInBuffer(sequence->names[i], fold, key);
+		items[i].key = (String) stdalloc(strlen(key) + 1);
+		strcpy(items[i].key, key);
+		items[i].place = i;
+	}
+	sortSequence(sequence, items, collationCompare);
+	for (int i = 0; i < n; i++) stdfree(items[i].key);
+	stdfree(items);
+}
+
 // nameSortSequence sorts a sequence by the names of the persons. Assumes person Sequence.
 void nameSortSequence(Sequence* sequence) {
 	if (sequence->sortType == SequenceNameSorted) return;
-	sortBlock(&(sequence->block), nameGetKey, nameCompare);
+	collationSort(sequence, false);
 	sequence->sortType = SequenceNameSorted;
 }
 
+// foldedNameSortSequence sorts a Sequence by the names of the persons ignoring case and Latin-1
+// diacritics. Since removeFromSequence can't search this order the Sequence is left NotSorted.
+void foldedNameSortSequence(Sequence* sequence) {
+	collationSort(sequence, true);
+	sequence->sortType = SequenceNotSorted;
+}
+
 // keySortSequence sorts a Sequence by key.
 void keySortSequence(Sequence* sequence) {
 	if (sequence->sortType == SequenceKeySorted) return;
-	sortBlock(&(sequence->block), keyGetKey, keyCompare);
+	materializeSequence(sequence);
+	int n = sequence->length;
+	if (n > 1) {
+		SortItem* items = (SortItem*) stdalloc(n*sizeof(SortItem));
+		for (int i = 0; i < n; i++) {
+			items[i].key = sequence->roots[i]->key;
+			items[i].place = i;
+		}
+		sortSequence(sequence, items, compareRecordKeys);
+		stdfree(items);
+	}
 	sequence->sortType = SequenceKeySorted;
 }
 
 // copySequence creates a copy of the given Sequence.
 Sequence* copySequence(Sequence* sequence) {
+	if (sequence->inBitmap) return bitmapToSequence(copySequenceBitmap(sequence->bitmap), sequence);
 	Sequence* copy = createSequence(sequence->index);
-	FORSEQUENCE(sequence, element, count)
-		appendToSequence(copy, element->root->key, element->value);
-	ENDSEQUENCE
+	if (sequence->pipeline) {
+		copy->pipeline = copySequencePipeline(sequence->pipeline, copy);
+		return copy;
+	}
+	copyElements(copy, sequence);
+	copy->sortType = sequence->sortType;
+	copy->unique = sequence->unique;
 	return copy;
 }
 
@@ -195,20 +444,18 @@ Sequence* copySequence(Sequence* sequence) {
 // MNOTE: creates a new Sequence, so caller may need to free the original.
 Sequence* uniqueSequence(Sequence* sequence) {
 	ASSERT(sequence);
-	Block* block = &(sequence->block);
+	if (sequence->inBitmap) return copySequence(sequence);
+	materializeSequence(sequence);
 	Sequence* unique = createSequence(sequence->index);
-	if (block->length == 0) return unique;
-	int n = block->length;
-	Block *uBlock = &(unique->block);
+	int n = sequence->length;
+	if (n == 0) return unique;
 	if (sequence->sortType != SequenceKeySorted) keySortSequence(sequence);
-	SequenceEl** els = (SequenceEl**) block->elements;
-	SequenceEl* el = els[0];
-	RecordIndex* index = sequence->index;
-	appendToBlock(uBlock, createSequenceEl(index, el->root->key, el->value));
-	int i, j;
-	for (j = 0, i = 1; i < n; i++) {
-		if (nestr(els[i]->root->key, els[j]->root->key)) {
-			appendToBlock(uBlock, createSequenceEl(index, els[i]->root->key, els[i]->value));
+	GNode** roots = sequence->roots;
+	growSequence(unique, n);
+	appendRootToSequence(unique, roots[0], sequence->values[0]);
+	for (int j = 0, i = 1; i < n; i++) {
+		if (nestr(roots[i]->key, roots[j]->key)) {
+			appendRootToSequence(unique, roots[i], sequence->values[i]);
 			j = i;
 		}
 	}
@@ -217,21 +464,29 @@ Sequence* uniqueSequence(Sequence* sequence) {
 
 // uniqueSequenceInPlace removes duplicate (have the same key) elements from a Sequence.
 void uniqueSequenceInPlace(Sequence* sequence) {
-	if (!sequence) return;
-	Block* block = &(sequence->block);
-	int n = block->length;
+	if (!sequence || sequence->inBitmap) return;
+	materializeSequence(sequence);
+	int n = sequence->length;
 	if (n <= 1) return;
 	if (sequence->sortType != SequenceKeySorted) keySortSequence(sequence);
-	SequenceEl** els = (SequenceEl**) block->elements;
+	GNode** roots = sequence->roots;
 	int i, j;
-	for (j = 0, i = 1; i < n; i++)
-		if (nestr(els[i]->root->key, els[j]->root->key)) els[++j] = els[i];
-	block->length = j + 1;
+	for (j = 0, i = 1; i < n; i++) {
+		if (nestr(roots[i]->key, roots[j]->key)) {
+			j++;
+			roots[j] = roots[i];
+			sequence->names[j] = sequence->names[i];
+			sequence->values[j] = sequence->values[i];
+		}
+	}
+	sequence->length = j + 1;
 }
 
 // unionSequence returns the union of two Sequences.
 Sequence* unionSequence(Sequence* one, Sequence* two) {
 	if (!one || !two || one->index != two->index) return null;
+	if (useBitmaps(one, two))
+		return bitmapToSequence(unionSequenceBitmap(one->bitmap, two->bitmap), one);
 	if (one->sortType != SequenceKeySorted) keySortSequence(one);
 	if (two->sortType != SequenceKeySorted) keySortSequence(two);
 	if (!one->unique) uniqueSequenceInPlace(one);
@@ -239,27 +494,28 @@ Sequence* unionSequence(Sequence* one, Sequence* two) {
 	int n = lengthSequence(one);
 	int m = lengthSequence(two);
 	Sequence* three = createSequence(one->index);
-	SequenceEl** u = sequenceElements(one);
-	SequenceEl** v = sequenceElements(two);
+	growSequence(three, n + m);
+	GNode** u = materializeSequence(one)->roots;
+	GNode** v = materializeSequence(two)->roots;
 	int i = 0, j = 0, rel;
 	while (i < n && j < m) {
-		if ((rel = keyCompare(u[i]->root->key, v[j]->root->key)) < 0) {
-			appendToSequence(three, u[i]->root->key, u[i]->value);
+		if ((rel = compareRecordKeys(u[i]->key, v[j]->key)) < 0) {
+			appendRootToSequence(three, u[i], one->values[i]);
 			i++;
 		} else if (rel > 0) {
-			appendToSequence(three, v[j]->root->key, v[j]->value);
+			appendRootToSequence(three, v[j], two->values[j]);
 			j++;
 		} else {
-			appendToSequence(three, u[i]->root->key, u[i]->value);
+			appendRootToSequence(three, u[i], one->values[i]);
 			i++; j++;
 		}
 	}
 	while (i < n) {
-		appendToSequence(three, u[i]->root->key, u[i]->value);
+		appendRootToSequence(three, u[i], one->values[i]);
 		i++;
 	}
 	while (j < m) {
-		appendToSequence(three, v[j]->root->key, v[j]->value);
+		appendRootToSequence(three, v[j], two->values[j]);
 		j++;
 	}
 	three->sortType = SequenceKeySorted;
@@ -272,6 +528,8 @@ Sequence* intersectSequence(Sequence* one, Sequence* two) {
 	ASSERT(one && two);
 	ASSERT(one->index == two->index);
 	if (!one || !two || one->index != two->index) return null;
+	if (useBitmaps(one, two))
+		return bitmapToSequence(intersectSequenceBitmap(one->bitmap, two->bitmap), one);
 	int rel;
 	if (one->sortType != SequenceKeySorted) keySortSequence(one);
 	if (two->sortType != SequenceKeySorted) keySortSequence(two);
@@ -280,16 +538,17 @@ Sequence* intersectSequence(Sequence* one, Sequence* two) {
 	int n = lengthSequence(one);
 	int m = lengthSequence(two);
 	Sequence* three = createSequence(one->index);
+	growSequence(three, n < m ? n : m);
 	int i = 0, j = 0;
-	SequenceEl** u = sequenceElements(one);
-	SequenceEl** v = sequenceElements(two);
+	GNode** u = materializeSequence(one)->roots;
+	GNode** v = materializeSequence(two)->roots;
 	while (i < n && j < m) {
-		if ((rel = compareRecordKeys(u[i]->root->key, v[j]->root->key)) < 0) {
+		if ((rel = compareRecordKeys(u[i]->key, v[j]->key)) < 0) {
 			i++;
 		} else if (rel > 0) {
 			j++;
 		} else {
-			appendToSequence(three, (u[i])->root->key, u[i]->value);
+			appendRootToSequence(three, u[i], one->values[i]);
 			i++; j++;
 		}
 	}
@@ -303,6 +562,8 @@ Sequence* differenceSequence(Sequence* one, Sequence* two) {
 	ASSERT(one && two);
 	ASSERT(one->index == two->index);
 	if (!one || !two) return null;
+	if (useBitmaps(one, two))
+		return bitmapToSequence(differenceSequenceBitmap(one->bitmap, two->bitmap), one);
 	if (one->sortType != SequenceKeySorted) keySortSequence(one);
 	if (two->sortType != SequenceKeySorted) keySortSequence(two);
 	if (!one->unique) uniqueSequenceInPlace(one);
@@ -310,13 +571,14 @@ Sequence* differenceSequence(Sequence* one, Sequence* two) {
 	int n = lengthSequence(one);
 	int m = lengthSequence(two);
 	Sequence* three = createSequence(one->index);
+	growSequence(three, n);
 	int i = 0, j = 0;
-	SequenceEl** u = sequenceElements(one);
-	SequenceEl** v = sequenceElements(two);
+	GNode** u = materializeSequence(one)->roots;
+	GNode** v = materializeSequence(two)->roots;
 	int rel;
 	while (i < n && j < m) {
-		if ((rel = compareRecordKeys(u[i]->root->key, v[j]->root->key)) < 0) {
-			appendToSequence(three, u[i]->root->key, u[i]->value);
+		if ((rel = compareRecordKeys(u[i]->key, v[j]->key)) < 0) {
+			appendRootToSequence(three, u[i], one->values[i]);
 			i++;
 		} else if (rel > 0) {
 			j++;
@@ -325,7 +587,7 @@ Sequence* differenceSequence(Sequence* one, Sequence* two) {
 		}
 	}
 	while (i < n) {
-		appendToSequence(three, u[i]->root->key, u[i]->value);
+		appendRootToSequence(three, u[i], one->values[i]);
 		i++;
 	}
 	three->sortType = SequenceKeySorted;
@@ -346,11 +608,11 @@ Sequence* parentSequence(Sequence* sequence) {
 		GNode* fath = personToFather(indi, index);
 		GNode* moth = personToMother(indi, index);
 		if (fath && !isInHashTable(table, key = personToKey(fath))) {
-			appendToSequence(parents, key, el->value);
+			appendRootToSequence(parents, fath, el->value);
 			addToStringTable(table, key, null);
 		}
 		if (moth && !isInHashTable(table, key = personToKey(moth))) {
-			appendToSequence(parents, key, el->value);
+			appendRootToSequence(parents, moth, el->value);
 			addToStringTable(table, key, null);
 		}
 	ENDSEQUENCE
@@ -370,7 +632,7 @@ Sequence* childSequence(Sequence* sequence) {
 			FORCHILDREN(fam, chil, childKey, num2, index)
 				String key = personToKey(chil);
 				if (!isInHashTable(table, key)) {
-					appendToSequence(children, key, 0);
+					appendRootToSequence(children, chil, 0);
 					addToStringTable(table, key, null);
 				}
 			ENDCHILDREN
@@ -386,7 +648,7 @@ Sequence* personToChildren(GNode* person, RecordIndex* index) {
 	Sequence* children = createSequence(index);
 	FORFAMSS(person, family, key, index)
 		FORCHILDREN(family, child, childKey, count, index)
-			appendToSequence(children, personToKey(child), 0);
+			appendRootToSequence(children, child, 0);
 		ENDCHILDREN
 	ENDFAMSS
 	if (lengthSequence(children)) return children;
@@ -402,7 +664,7 @@ Sequence* personToSpouses(GNode* person, RecordIndex* index) {
 	Sequence* spouses = createSequence(index);
 	FORFAMSS(person, family, key, index)
 		GNode* spouse = (sex == sexMale) ? familyToWife(family, index) : familyToHusband(family, index);
-		if (spouse) appendToSequence(spouses, personToKey(spouse), 0);
+		if (spouse) appendRootToSequence(spouses, spouse, 0);
 	ENDFAMSS
 	if (lengthSequence(spouses)) return spouses;
 	deleteSequence(spouses);
@@ -415,7 +677,7 @@ Sequence* personToFathers(GNode* person, RecordIndex* index) {
 	Sequence* fathers = createSequence(index);
 	FORFAMCS(person, family, key, index)  // For each family the person is a child in...
 		FORHUSBS(family, husb, husbKey, index)  // For each husband in that family...
-			appendToSequence(fathers, personToKey(husb), 0);  // Add to sequence.
+			appendRootToSequence(fathers, husb, 0);  // Add to sequence.
 		ENDHUSBS
 	ENDFAMCS
 	if (lengthSequence(fathers)) return fathers;
@@ -429,7 +691,7 @@ Sequence* personToMothers (GNode* indi, RecordIndex* index) {
 	Sequence* mothers = createSequence(index);
 	FORFAMCS(indi, fam, key, index)  // For each family the person is a child in...
 		FORWIFES(fam, wife, wifeKey, index)  // For each wife in that family...
-			appendToSequence(mothers, personToKey(wife), 0);  // Add to sequence.
+			appendRootToSequence(mothers, wife, 0);  // Add to sequence.
 		ENDWIFES
 	ENDFAMCS
 	if (lengthSequence(mothers)) return mothers;
@@ -444,11 +706,11 @@ Sequence* personToFamilies (GNode* person, bool fams, RecordIndex* index) {
 	Sequence* families = createSequence(index);
 	if (fams) {
 		FORFAMSS(person, family, key, index)
-			appendToSequence(families, key, 0);
+			appendRootToSequence(families, family, 0);
 		ENDFAMSS
 	} else {
 		FORFAMCS(person, family, key, index)
-			appendToSequence(families, key, 0);
+			appendRootToSequence(families, family, 0);
 		ENDFAMCS
 	}
 	if (lengthSequence(families) > 0) return families;
@@ -461,7 +723,7 @@ Sequence* familyToChildren(GNode* family, RecordIndex* index) {
 	if (!family) return null;
 	Sequence* children = createSequence(index);
 	FORCHILDREN(family, chil, key, num, index) {
-		appendToSequence(children, personToKey(chil), 0);
+		appendRootToSequence(children, chil, 0);
 	} ENDCHILDREN
 	if (lengthSequence(children) > 0) return children;
 	deleteSequence(children);
@@ -473,7 +735,7 @@ Sequence* familyToFathers(GNode* fam, RecordIndex* index) {
 	if (!fam) return null;
 	Sequence* seq = createSequence(index);
 	FORHUSBS(fam, husb, key, index)
-		appendToSequence(seq, personToKey(husb), 0);
+		appendRootToSequence(seq, husb, 0);
 	ENDHUSBS
 	if (lengthSequence(seq)) return seq;
 	deleteSequence(seq);
@@ -485,7 +747,7 @@ Sequence* familyToMothers(GNode* fam, RecordIndex* index) {
 	if (!fam) return null;
 	Sequence* seq = createSequence(index);
 	FORWIFES(fam, wife, key, index)
-		appendToSequence(seq, personToKey(wife), 0);
+		appendRootToSequence(seq, wife, 0);
 	ENDWIFES
 	if (lengthSequence(seq)) return seq;
 	deleteSequence(seq);
@@ -506,7 +768,7 @@ Sequence* siblingSequence(Sequence* sequence, bool close) {
 		GNode* person = keyToPerson(element->root->key, index);
 		GNode* famc = personToFamilyAsChild(person, index);
 		if (famc)
-			appendToSequence(familySequence, familyToKey(famc), 0);
+			appendRootToSequence(familySequence, famc, 0);
 		if (!close)
 			addToStringTable(tab, element->root->key, null);
 	}
@@ -516,7 +778,7 @@ Sequence* siblingSequence(Sequence* sequence, bool close) {
 		FORCHILDREN(fam, chil, chilKey, num2, index)
 			String key = personToKey(chil);
 			if (!isInHashTable(tab, key)) {
-				appendToSequence(siblingSequence, key, 0);
+				appendRootToSequence(siblingSequence, chil, 0);
 				addToStringTable(tab, key, null);
 			}
 		ENDCHILDREN
@@ -526,88 +788,56 @@ Sequence* siblingSequence(Sequence* sequence, bool close) {
 	return siblingSequence;
 }
 
-// ancestorSequence creates the Sequence of all ancestors of the persons in the input Sequence.
-// Persons in the input sequence are not in the ancestor sequence unless they are also an
-// ancestor of someone in the input Sequence.
-// TODO: Consider adding a "close" argument as done in siblingSequence.
-Sequence* ancestorSequence(Sequence* startSequence, bool close) {
-	ASSERT(startSequence);
-	RecordIndex* index = startSequence->index;
-	StringTable* ancestorKeys = createStringTable(numBucketsInSequenceTables);
-	List* ancestorQueue = createList(null, null, null, false); // Keys to process.
-	Sequence* ancestorSequence = createSequence(index);
-	if (close) uniqueSequenceInPlace(startSequence);
-
-	FORSEQUENCE(startSequence, el, num) // Init ancestor queue.
-		String key = el->root->key;
-		enqueueList(ancestorQueue, (void*) key);
-		if (close) {
-			appendToSequence(ancestorSequence, key, 0);
-			addToStringTable(ancestorKeys, key, null);
-		}
+// startIds returns the LineageGraph ids of the persons in a Sequence, in order.
+static int* startIds(Sequence* sequence, LineageGraph* graph, int* count) {
+	int* ids = (int*) stdalloc((lengthSequence(sequence) + 1)*sizeof(int));
+	*count = 0;
+	FORSEQUENCE(sequence, element, num)
+		int id = lineageId(graph, element->root->key);
+		if (id >= 0) ids[(*count)++] = id;
 	ENDSEQUENCE
+	return ids;
+}
 
-	while (!isEmptyList(ancestorQueue)) { // Process queue.
-		String key = (String) dequeueList(ancestorQueue);
-		String parentKey;
-		GNode* person = keyToPerson(key, index);
-		GNode* father = personToFather(person, index);
-		GNode* mother = personToMother(person, index);
-		if (father && !isInHashTable(ancestorKeys, parentKey = father->key)) {
-			appendToSequence(ancestorSequence, parentKey, 0);
-			enqueueList(ancestorQueue, strsave(parentKey));
-			addToStringTable(ancestorKeys, parentKey, null);
-		}
-		if (mother && !isInHashTable(ancestorKeys, parentKey = mother->key)) {
-			appendToSequence(ancestorSequence, parentKey, 0);
-			enqueueList(ancestorQueue, strsave(parentKey));
-			addToStringTable(ancestorKeys, parentKey, null);
-		}
-	}
-	deleteHashTable(ancestorKeys);
-	deleteList(ancestorQueue);
-	return ancestorSequence;
+// closureToSequence returns the Sequence of the persons in a Closure, in the order found.
+static Sequence* closureToSequence(Closure* closure, LineageGraph* graph, RecordIndex* index) {
+	Sequence* sequence = createSequence(index);
+	growSequence(sequence, closure->numIds);
+	for (int i = 0; i < closure->numIds; i++)
+		appendRootToSequence(sequence, graph->persons[closure->ids[i]], null);
+	return sequence;
 }
 
-// descendentSequence creates the descendant Sequence of a Sequence. Those in the input Sequence
-// are not in the descendents unless they are a descendent of someone in the input Sequence.
-// TODO: Consider adding a "close" flag to the interface.
-Sequence* descendentSequence(Sequence* startSequence, bool close) {
+// ancestorSequence creates the Sequence of the ancestors of the persons in a Sequence, nearest
+// generations first, up to limit generations if limit is positive. Persons in the input Sequence
+// are not in the ancestor Sequence unless close is true or they are also an ancestor of someone
+// in the input Sequence.
+Sequence* ancestorSequence(Sequence* startSequence, Database* database, bool close, int limit) {
 	if (!startSequence) return null;
-	RecordIndex* index = startSequence->index;
-	String key, descendentKey;
-	StringTable* descendentKeys = createStringTable(numBucketsInSequenceTables); // Persons processed.
-	StringTable* familyKeys = createStringTable(numBucketsInSequenceTables);  // Families processed.
-	List* descendentQueue = createList(null, null, null, false); // Descendent keys.
-	Sequence *descendentSequence = createSequence(index);
-	FORSEQUENCE(startSequence, element, count) // Init descendentQueue
-	String key = element->root->key;
-		enqueueList(descendentQueue, key);
-		if (close) {
-			appendToSequence(descendentSequence, key, 0);
-			addToStringTable(descendentKeys, key, null);
-		}
-	ENDSEQUENCE
-	while (!isEmptyList(descendentQueue)) { // Loop descendentQueue.
-		key = (String) dequeueList(descendentQueue);
-		GNode* person = keyToPerson(key, index);
-		FORFAMSS(person, family, key, index) {
-			if (isInHashTable(familyKeys, key)) goto a;
-			addToStringTable(familyKeys, strsave(key), null);
-			FORCHILDREN(family, child, chilKey, num, index)
-				if (!isInHashTable(descendentKeys, descendentKey = personToKey(child))) {
-					appendToSequence(descendentSequence, descendentKey, 0);
-					enqueueList(descendentQueue, strsave(descendentKey));
-					addToStringTable(descendentKeys, descendentKey, null);
-				}
-			ENDCHILDREN
-		a:;
-		} ENDFAMSS
-	}
-	deleteHashTable(descendentKeys);
-	deleteHashTable(familyKeys);
-	deleteList(descendentQueue);
-	return descendentSequence;
+	LineageGraph* graph = getDatabaseLineageGraph(database);
+	int numStart;
+	int* start = startIds(startSequence, graph, &numStart);
+	Closure* closure = ancestorClosure(graph, start, numStart, close, limit);
+	Sequence* ancestors = closureToSequence(closure, graph, startSequence->index);
+	deleteClosure(closure);
+	stdfree(start);
+	return ancestors;
+}
+
+// descendentSequence creates the Sequence of the descendents of the persons in a Sequence,
+// nearest generations first, up to limit generations if limit is positive. Persons in the input
+// Sequence are not in the descendent Sequence unless close is true or they are a descendent of
+// someone in the input Sequence.
+Sequence* descendentSequence(Sequence* startSequence, Database* database, bool close, int limit) {
+	if (!startSequence) return null;
+	LineageGraph* graph = getDatabaseLineageGraph(database);
+	int numStart;
+	int* start = startIds(startSequence, graph, &numStart);
+	Closure* closure = descendentClosure(graph, start, numStart, close, limit);
+	Sequence* descendents = closureToSequence(closure, graph, startSequence->index);
+	deleteClosure(closure);
+	stdfree(start);
+	return descendents;
 }
 
 // spouseSequence creates spouses Sequence of a Sequence.
@@ -621,7 +851,7 @@ Sequence* spouseSequence(Sequence *sequence) {
 		FORSPOUSES(person, spouse, fam, num1, index)
 			String key = personToKey(spouse);
 			if (!isInHashTable(table, key)) {
-				appendToSequence(spouses, key, el->value);
+				appendRootToSequence(spouses, spouse, el->value);
 				addToStringTable(table, key, null);
 			}
 		ENDSPOUSES
@@ -630,100 +860,12 @@ Sequence* spouseSequence(Sequence *sequence) {
 	return spouses;
 }
 
-static void writeLimitedPerson(GNode *person);
-static void writeLimitedFamily(GNode *family);
-
-// sequenceToGedcom generate a Gedcom file from a sequence of persons. Only persons in the
-// the sequence are written. Families with links to at least two persons in the sequence are also
-// written to the file. Other persons referred to in the families are not included, and the links
-// to the other persons are removed.
-static Sequence *personSequence; // Person in the sequence to be generated in a Gedcom file.
-static Sequence *familySequence; // Families that interconnect persons in the person sequence.
+// sequenceToGedcom writes a Gedcom file with the records of a Sequence, the families that join at
+// least two of its persons, and the records these refer to; see exportSequenceToGedcom. Writes to
+// stdout if fp is null.
 void sequenceToGedcom(Sequence *sequence, FILE *fp) {
 	if (!sequence) return;
-	RecordIndex* index = sequence->index;
-	if (!fp) fp = stdout;
-	personSequence = sequence;  // Yuck. External access to these two sequences are required.
-	familySequence = createSequence(index);
-	StringTable *personTable = createStringTable(numBucketsInSequenceTables); // Table of person keys.
-	StringTable *familyTable = createStringTable(numBucketsInSequenceTables); // Table of family keys.
-
-	// Add all person keys to the person key hash table.
-	FORSEQUENCE(sequence, element, num)
-		addToStringTable(personTable, element->root->key, null);
-	ENDSEQUENCE
-	FORSEQUENCE(sequence, element, num) // For each person in the sequence ...
-		GNode *person = keyToPerson(element->root->key, index);  // Get the person ...
-		SexType sex = SEXV(person);  //  ... and the person's sex.
-		//  Check the person's parent families to see if any FAMC families should be output.
-		FORFAMCS(person, family, key, index)
-			if (isInHashTable(familyTable, family->key)) goto a;
-			normalizeFamily(family);
-			GNode *husband = HUSB(family);
-			if (husband && isInHashTable(personTable, husband->value)) {
-				appendToSequence(familySequence, familyToKey(family), 0);
-				addToStringTable(familyTable, familyToKey(family), null);
-				goto a;
-			}
-			GNode *wife = WIFE(family);
-			if (wife && isInHashTable(personTable, wife->value)) {
-				appendToSequence(familySequence, familyToKey(family), 0);
-				addToStringTable(familyTable, familyToKey(family), null);
-				goto a;
-			}
-			// Check if any of the children in this family are in the sequence.
-			FORCHILDREN(family, child, chilKey, count, index)
-				String childKey = personToKey(child);
-				if (isInHashTable(personTable, childKey)) {
-					appendToSequence(familySequence, familyToKey(family), 0);
-					addToStringTable(familyTable, familyToKey(family), null);
-					goto a;
-				}
-			ENDCHILDREN
-		ENDFAMCS
-
-		//  Check the person's as parent families to see if they should output.
-	a:	FORFAMSS(person, family, key, index)
-			if (isInHashTable(familyTable, familyToKey(family))) goto b;
-			GNode *spouse = familyToSpouse(family, oppositeSex(sex), index);
-			if (spouse && isInHashTable(personTable, personToKey(spouse))) {
-				appendToSequence(familySequence, familyToKey(family), 0);
-				addToStringTable(familyTable, familyToKey(family), null);
-			}
-	b:;	ENDFAMSS
-	ENDSEQUENCE
-
-	FORSEQUENCE(personSequence, element, count)
-		writeLimitedPerson(keyToPerson(element->root->key, index));
-	ENDSEQUENCE
-
-	FORSEQUENCE(familySequence, element, count)
-		writeLimitedFamily(keyToFamily(element->root->key, index));
-	ENDSEQUENCE
-	deleteSequence(familySequence);
-	deleteHashTable(personTable);
-	deleteHashTable(familyTable);
-}
-
-// Still needed?
-bool limitPersonNode(GNode* node, int level) {
-	//  FOR TESTING. WE SHOULD SEE NO BIRTH EVENTS IN THE OUTPUT.
-	if (level == 1 && eqstr(node->tag, "BIRT")) return false;
-	writeGNode(stdout, level, node, false);
-	return true;
-}
-
-// writeLimitedPerson is used when writing a Sequence of persons to a Gedcom file. Will only
-// include links to families (and other objects) that are also to be in the Gedcom file.
-// TODO: NOT IMPLEMENTED.
-static void writeLimitedPerson (GNode* person) {
-	printf("writeLimitedPerson: %s\n", person->key);
-	traverseNodes(person, 0, limitPersonNode);
-}
-
-// writeLimitedFamily is used when
-static void writeLimitedFamily (GNode *family) {
-	printf("writeLimitedFamily: %s\n", family->key);
+	exportSequenceToGedcom(sequence, null, fp ? fp : stdout, 0, null);
 }
 
 // nameToSequence returns the Sequence of persons who match a Gedcom name. If the first letter of
@@ -732,37 +874,35 @@ static void writeLimitedFamily (GNode *family) {
 Sequence* nameToSequence(String name, RecordIndex* rindex, NameIndex* nindex) {
 	ASSERT(name && *name && rindex && nindex);
 	if (!name || *name == 0 || !rindex || !nindex) return null;
-	int num;
+	Block keys; // Person keys; the Strings are in rindex.
+	initBlock(&keys);
 	Sequence *seq = null;
 	if (*name != '*') { // Name does not start with '*'.
-		String *keys = personKeysFromName(name, rindex, nindex, &num); // MNOTE: keys is static.
-		if (num == 0) return null;
-		seq = createSequence(rindex);
-		for (int i = 0; i < num; i++)
-			appendToSequence(seq, keys[i], 0);
-		nameSortSequence(seq);
+		if (personKeysFromNameInBlock(name, rindex, nindex, &keys)) {
+			seq = createSequence(rindex);
+			for (int i = 0; i < keys.length; i++)
+				appendToSequence(seq, keys.elements[i], 0);
+			nameSortSequence(seq);
+		}
+		deleteBlock(&keys, null);
 		return seq;
 	}
 	// Name starts with a '*'.
 	char scratch[MAXLINELEN+1];
-	sprintf(scratch, "a/%s/", getSurname(name));
+	char surname[MAXLINELEN+1];
+	snprintf(scratch, MAXLINELEN+1, "a/%s/", getSurnameInBuffer(name, surname));
 	for (int c = 'a'; c <= 'z'; c++) {
 		scratch[0] = c;
-		String *keys = personKeysFromName(scratch, rindex, nindex, &num/*, true*/);
-		if (num == 0) continue;
-		if (!seq) seq = createSequence(rindex);
-		for (int i = 0; i < num; i++) {
-			appendToSequence(seq, keys[i], 0);
-		}
+		personKeysFromNameInBlock(scratch, rindex, nindex, &keys);
 	}
 	scratch[0] = '$';
-	String *keys = personKeysFromName(scratch, rindex, nindex, &num/*, true*/);
-	if (num) {
-		if (!seq) seq = createSequence(rindex);
-		for (int i = 0; i < num; i++) {
-			appendToSequence(seq, keys[i], 0);
-		}
+	personKeysFromNameInBlock(scratch, rindex, nindex, &keys);
+	if (keys.length) {
+		seq = createSequence(rindex);
+		for (int i = 0; i < keys.length; i++)
+			appendToSequence(seq, keys.elements[i], 0);
 	}
+	deleteBlock(&keys, null);
 	if (seq) {
 		Sequence* useq = uniqueSequence(seq);
 		deleteSequence(seq);
@@ -821,7 +961,7 @@ Sequence* keyToSequence(String key, RecordIndex* index) {
 	GNode* record = getRecord(key, index);
 	if (!record) return null;
 	Sequence* sequence = createSequence(index);
-	appendToSequence(sequence, key, null);
+	appendRootToSequence(sequence, record, null);
 	return sequence;
 }
 
@@ -831,7 +971,7 @@ Sequence* refnToSequence(String value, RecordIndex* index, RefnIndex* findex) {
 	GNode* record = getRecord(recordKey, index);
 	if (!record) return null;
 	Sequence* sequence = createSequence(index);
-	appendToSequence(sequence, recordKey, null);
+	appendRootToSequence(sequence, record, null);
 	return sequence;
 }
 
@@ -842,6 +982,6 @@ Sequence* stringToSequence(String name, Database* database) {
 //    sequence = find_named_seq(name);
 	if (!sequence) sequence = keyToSequence(name, database->recordIndex);
 	if (!sequence) sequence = refnToSequence(name, database->recordIndex, database->refnIndex);
-	if (!sequence) sequence = nameToSequence(name, database->recordIndex, database->nameIndex);
+	if (!sequence) sequence = cachedNameToSequence(name, database);
 	return sequence;
 }
@@ -3,11 +3,14 @@
 // symboltable.c holds the functions that implement SymbolTables.
 //
 // Created by Thomas Wetmore on 23 March 2023.
-// Last changed on 24 May 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "symboltable.h"
 
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memInterp
+
 // globalTable holds the Symbols defined in the global scope.
 extern SymbolTable* globalTable;
 
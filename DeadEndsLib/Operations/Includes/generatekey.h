@@ -3,13 +3,19 @@
 // generatekey.h
 //
 // Created by Thomas Wetmore on 20 July 2024.
-// Last changed on 20 July 2024.
+// Last changed on 18 October 2026.
 
 #ifndef generatekey_h
 #define generatekey_h
 
+#include <stdint.h>
+
+#define KEYBUFFERLEN 10 // Size of a buffer for a generated key, "@I0A1B2C@".
+#define NUMPERMUTEDKEYS 2176782336U // 36^6, the number of keys of each record type.
+
 void initRecordKeyGenerator(void);
 String generateRecordKey(RecordType);
+String permutedRecordKey(RecordType, uint32_t index, uint64_t seed, String buffer);
 
 
 #endif /* generatekey_h */
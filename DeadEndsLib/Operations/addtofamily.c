@@ -3,7 +3,7 @@
 // addtofamily.c has functions to add an existing child or spouse to an existing family.
 //
 // Created by Thomas Wetmore on 30 May 2024.
-// Last changed on 8 June 2024.
+// Last changed on 18 October 2026.
 
 #include "stdlib.h"
 #include "splitjoin.h"
@@ -11,8 +11,12 @@
 #include "gedcom.h"
 
 // addChildToFamily adds an existing child to an existing family in a Database; index can be used
-// to place the new child in the list of children.
+// to place the new child in the list of children. Copies of the records are edited and published,
+// so child and family are replaced by new versions.
 bool addChildToFamily (GNode *child, GNode *family, int index, Database *database) {
+	GNode *oldChild = child, *oldFamily = family;
+	child = copyRecordForEdit(oldChild);
+	family = copyRecordForEdit(oldFamily);
 	// Add CHIL family.
 	GNode *frefn, *husb, *wife, *chil, *rest;
 	splitFamily(family, &frefn, &husb, &wife, &chil, &rest);
@@ -47,11 +51,17 @@ bool addChildToFamily (GNode *child, GNode *family, int index, Database *databas
 	else
 		prev->sibling = nfmc;
 	joinPerson(child, names, irefns, sex, body, famcs, famss);
+	publishRecord(database, oldFamily, family);
+	publishRecord(database, oldChild, child);
 	return true;
 }
 
-//  addSpouseToFamily adds an existing spouse to an existing family.
+//  addSpouseToFamily adds an existing spouse to an existing family. Copies of the records are
+//  edited and published, so spouse and family are replaced by new versions.
 bool addSpouseToFamily (GNode* spouse, GNode* family, SexType sext, Database* database) {
+	GNode *oldSpouse = spouse, *oldFamily = family;
+	spouse = copyRecordForEdit(oldSpouse);
+	family = copyRecordForEdit(oldFamily);
 	// Add HUSB or WIFE to family.
 	GNode *frefn, *husb, *wife, *chil, *rest;
 	splitFamily(family, &frefn, &husb, &wife, &chil, &rest);
@@ -96,6 +106,8 @@ bool addSpouseToFamily (GNode* spouse, GNode* family, SexType sext, Database* da
 	else
 		prev->sibling = nfams;
 	joinPerson(spouse, names, irefns, sex, body, famcs, famss);
+	publishRecord(database, oldFamily, family);
+	publishRecord(database, oldSpouse, spouse);
 	return true;
 }
 
@@ -3,9 +3,10 @@
 // generatekey.c has the functions to generate random keys.
 //
 // Created by Thomas Wetmore on 1 June 2024.
-// Last changed on 20 June 2024.
+// Last changed on 18 October 2026.
 
 #include "stdlib.h"
+#include "stdint.h"
 #include "time.h"
 #include "gedcom.h"
 #include "stringtable.h"
@@ -32,7 +33,8 @@ static char recordChar(RecordType recType) {
 }
 
 // generateRecordKey generates a new random Gedcom key ('cross-reference identifier').
-static StringSet* keysInUse = null;
+static int numBucketsInKeyTable = 8191;
+static StringTable* keysInUse = null; // Hashed so checking and adding a key is near constant.
 String generateRecordKey(RecordType recType) {
 	static bool first = true;
 	if (first) {
@@ -48,13 +50,13 @@ void initRecordKeyGenerator(void) {
 	srand((unsigned)time(0));
 	keyBuffer[0] = keyBuffer[8] = '@';
 	keyBuffer[9] = 0;
-	if (keysInUse) deleteStringSet(keysInUse, true);
-	keysInUse = createStringSet();
+	if (keysInUse) deleteHashTable(keysInUse);
+	keysInUse = createStringTable(numBucketsInKeyTable);
 }
 
 // inUse returns true if the key is in use.
 static bool inUse(String key) {
-	return isInSet(keysInUse, key);
+	return isInStringTable(keysInUse, key);
 }
 
 // generateRecordKey generates a random record key.
@@ -67,12 +69,53 @@ static String generate(char type) {
 			keyBuffer[i] = keyCharacters[rand() % 36];
 		}
 		if (inUse(keyBuffer)) continue;
+		addToStringTable(keysInUse, keyBuffer, null);
 		return strsave(keyBuffer);
 	}
 	exit(2); // Could not generate a key.
 	return null;
 }
 
+// mixBits is the round function of keyPermutation; it mixes 16 bits with a seed and round.
+static uint32_t mixBits(uint32_t half, uint64_t seed, int round) {
+	uint64_t x = seed ^ ((uint64_t) half << 8) ^ (uint64_t) (round + 1)*0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30))*0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27))*0x94D049BB133111EBULL;
+	return (uint32_t) (x ^ (x >> 31)) & 0xffff;
+}
+
+// keyPermutation maps the numbers 0 to NUMPERMUTEDKEYS-1 onto themselves in a seeded random
+// order. A four round Feistel network permutes 32 bit numbers; results outside the range are
+// permuted again (cycle walking), which keeps the mapping one to one.
+static uint32_t keyPermutation(uint32_t index, uint64_t seed) {
+	uint32_t x = index;
+	do {
+		uint32_t left = x >> 16, right = x & 0xffff;
+		for (int round = 0; round < 4; round++) {
+			uint32_t next = left ^ mixBits(right, seed, round);
+			left = right;
+			right = next;
+		}
+		x = (left << 16) | right;
+	} while (x >= NUMPERMUTEDKEYS);
+	return x;
+}
+
+// permutedRecordKey returns the key with a given index in a seeded random order of all keys, in
+// a buffer of KEYBUFFERLEN chars. Different indexes always get different keys, so no table of
+// keys in use is needed. The index must be less than NUMPERMUTEDKEYS.
+String permutedRecordKey(RecordType recType, uint32_t index, uint64_t seed, String buffer) {
+	uint32_t value = keyPermutation(index, seed);
+	buffer[0] = buffer[8] = '@';
+	buffer[1] = recordChar(recType);
+	for (int i = 7; i >= 2; i--) {
+		buffer[i] = keyCharacters[value % 36];
+		value /= 36;
+	}
+	buffer[9] = 0;
+	return buffer;
+}
+
 Set* inPreviousFiles;
 Set* inCurrentFile;
 StringTable* newKeys;
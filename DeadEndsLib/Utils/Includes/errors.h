@@ -3,7 +3,7 @@
 // errors.h is the header file for DeadEnds Errors.
 //
 // Created by Thomas Wetmore on 4 July 2023.
-// Last changed on 21 May 2024.
+// Last changed on 18 October 2026.
 
 #ifndef errors_h
 #define errors_h
@@ -43,6 +43,7 @@ void deleteErrorLog(ErrorLog*);
 Error *createError(ErrorType type, String fileName, int lineNumber, String message);
 void deleteError(Error*);
 void addErrorToLog(ErrorLog*, Error*);
+void moveErrorsToLog(ErrorLog*, ErrorLog* from);
 void showErrorLog(ErrorLog*);
 void showError(Error*);
 
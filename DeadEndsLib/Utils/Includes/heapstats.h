@@ -0,0 +1,33 @@
+// DeadEnds
+//
+// heapstats.h is the header file for heap accounting. When DEBUGALLOCS is defined every stdalloc
+// and stdfree is counted by MemoryCategory, and allocation sites can be sampled into a ring.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#ifndef heapstats_h
+#define heapstats_h
+
+#include <stdio.h>
+#include "standard.h"
+
+// MemoryStats are the counters of a MemoryCategory.
+typedef struct MemoryStats {
+	long liveBytes; // Bytes allocated and not freed.
+	long peakBytes; // Largest value of liveBytes.
+	long liveBlocks;
+	long allocs; // Number of allocations.
+	long frees; // Number of frees.
+} MemoryStats;
+
+// Interface to heap accounting.
+void noteAllocation(void* ptr, MemoryCategory, String file, int line);
+void noteFree(void* ptr);
+MemoryCategory setMemoryCategory(MemoryCategory);
+void setSampleInterval(int interval);
+void getMemoryStats(MemoryCategory, MemoryStats*);
+String memoryCategoryName(MemoryCategory);
+void showMemoryReport(FILE*);
+
+#endif // heapstats_h
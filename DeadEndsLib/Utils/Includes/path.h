@@ -3,7 +3,7 @@
 // path.h
 //
 // Created by Thomas Wetmore on 14 December 2022.
-// Last changed 26 July 2024.
+// Last changed 18 October 2026.
 
 #ifndef path_h
 #define path_h
@@ -12,9 +12,11 @@
 #include "standard.h"
 
 #define MAXPATHLENGTH 1024
+#define MAXPATHBUFFER 4096
 
 FILE *fopenPath(String fileName, String mode, String searchPath);
 String resolveFile(String fileName, String searchPath);
 String lastPathSegment(String fileName);
+String lastPathSegmentInBuffer(String fileName, String buffer);
 
 #endif // path_h
@@ -3,7 +3,7 @@
 // standard.h defines useful things.
 //
 // Created by Thomas Wetmore on 1 November 2022.
-// Last changed on 16 November 2024.
+// Last changed on 18 October 2026.
 
 #ifndef standard_h
 #define standard_h
@@ -54,15 +54,25 @@ void basicDelete(void*);
 #define min(x,y) ((x)>(y)?(y):(x))
 #endif
 
+// MemoryCategory is the category heap memory is counted in when DEBUGALLOCS is defined (see
+// heapstats.c). A file counts its allocations in a category by redefining MEMORYCATEGORY after
+// its includes; allocations in files that don't are counted in the category set by
+// setMemoryCategory.
+typedef enum MemoryCategory {
+	memOther = 0, memGNode, memString, memIndex, memSequence, memPValue, memInterp,
+	numMemoryCategories
+} MemoryCategory;
+#define MEMORYCATEGORY memOther
+
 // User interface to the standard functions.
-void* _alloc(size_t, String, int);
+void* _alloc(size_t, MemoryCategory, String, int);
 void _free(void* ptr, String, int);
 bool isLetter(int);  // Is character is an Ascii letter?
 String trim(String, int); // Trim String to size.
-void _logAllocations(bool);  // Turn allocation logging on and off.
+void _logAllocations(bool);  // Turn sampling of allocation sites on and off.
 
 #ifdef DEBUGALLOCS // Debugging allocs and free.
-	#define stdalloc(l) _alloc(l, __FILE__, __LINE__)
+	#define stdalloc(l) _alloc(l, MEMORYCATEGORY, __FILE__, __LINE__)
 	#define stdfree(p)  _free(p, __FILE__, __LINE__)
 	#define logAllocations(b) _logAllocations((b))
 #else // Not debugging allocs and frees.
@@ -3,7 +3,7 @@
 //  DeadEnds
 //
 //  Created by Thomas Wetmore on 13 November 2022.
-//  Last changed on 5 July 2024.
+//  Last changed on 18 October 2026.
 //
 
 #ifndef utils_h
@@ -12,9 +12,15 @@
 #include <stdio.h>
 #include "standard.h"
 
+#define MSECONDSLEN 10 // Size of a getMsecondsStrInBuffer buffer.
+#define MAXWORKERTHREADS 64 // Most threads runThreads runs.
+
 double getMseconds(void);
 String getMsecondsStr(void);
+String getMsecondsStrInBuffer(String buffer);
 String substring(String, int, int);
 String rightjustify (String, int);
+int threadCount(int requested, int limit);
+void runThreads(void* (*worker)(void*), void* args, size_t argSize, int numThreads);
 
 #endif /* utils_h */
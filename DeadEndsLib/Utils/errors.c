@@ -3,7 +3,7 @@
 //  errors.c has code for handling DeadEnds errors.
 //
 //  Created by Thomas Wetmore on 4 July 2023.
-//  Last changed on 10 February 2025.
+//  Last changed on 18 October 2026.
 
 #include "errors.h"
 #include "list.h"
@@ -11,10 +11,11 @@
 #define NUMKEYS 64
 static bool debugging = false;
 
-// getKey returns the comparison key of an error.
+// getKey returns the comparison key of an error. The buffers are per thread so ErrorLogs can be
+// built by several threads at once.
 static String getKey(void* error) {
-	static char buffer[NUMKEYS][128];
-	static int dex = 0;
+	static _Thread_local char buffer[NUMKEYS][128];
+	static _Thread_local int dex = 0;
 	if (++dex > NUMKEYS - 1) dex = 0;
 	String scratch = buffer[dex];
 	String fileName = ((Error*) error)->fileName;
@@ -73,6 +74,14 @@ void addErrorToLog (ErrorLog* errorLog, Error* error) {
 	appendToList(errorLog, error);
 }
 
+// moveErrorsToLog moves the Errors in one ErrorLog to the end of another, leaving the first empty.
+void moveErrorsToLog(ErrorLog* errorLog, ErrorLog* from) {
+	FORLIST(from, error)
+		appendToList(errorLog, error);
+	ENDLIST
+	emptyBlock(&(from->block), null);
+}
+
 // showError shows an Error on standard output.
 void showError(Error* error) {
 	printf("error");
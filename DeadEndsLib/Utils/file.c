@@ -3,16 +3,18 @@
 // file.c
 //
 // Created by Thomas Wetmore on 1 July 2024.
-// Last changed on 7 July 2024.
+// Last changed on 18 October 2026.
 
 #include <stdio.h>
 #include "file.h"
+#include "path.h"
 
 // openFile creates a File structure.
 File* openFile(String path, String mode) {
 	if (!path || !mode) return null;
 	FILE* fp = fopen(path, mode);
-	String name = lastPathSegment(path);
+	char buffer[MAXPATHBUFFER];
+	String name = lastPathSegmentInBuffer(path, buffer);
 	if (!fp || !name) return null;
 	File* file = (File*) stdalloc(sizeof(File));
 	file->path = strsave(path);
@@ -0,0 +1,260 @@
+// DeadEnds
+//
+// heapstats.c counts heap memory by MemoryCategory. When DEBUGALLOCS is defined _alloc and _free
+// call noteAllocation and noteFree. Each tracked block is kept in an open addressing table keyed
+// by address with its size and category, so frees are counted in the category of the allocation.
+// Sizes come from the allocator (malloc_usable_size, or malloc_size on macOS), so blocks need no
+// header and stdfree still works on memory from malloc or strdup; those frees are only counted
+// as untracked. Every sampleInterval-th allocation site is saved in a ring for the report.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <pthread.h>
+#include <stdint.h>
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#define usableSize(p) malloc_size(p)
+#else
+#include <malloc.h>
+#define usableSize(p) malloc_usable_size(p)
+#endif
+#include "heapstats.h"
+#include "path.h"
+
+#define MEMORYRING 4096 // Number of sampled allocation sites kept.
+#define MAXSITES 16 // Number of allocation sites shown in a report.
+#define INITIALTABLESIZE 4096
+
+static String categoryNames[numMemoryCategories] = {
+	"other", "GNode", "string", "index", "sequence", "PValue", "interpreter"
+};
+
+// HeapEntry is a tracked block in the heap table; ptr is null in empty slots.
+typedef struct HeapEntry {
+	void* ptr;
+	size_t size;
+	MemoryCategory category;
+} HeapEntry;
+
+// HeapSample is a sampled allocation site.
+typedef struct HeapSample {
+	String file;
+	int line;
+	size_t size;
+	MemoryCategory category;
+} HeapSample;
+
+// The state is shared by all threads and guarded by heapLock. The table and ring are allocated
+// with malloc so they are not counted themselves.
+static pthread_mutex_t heapLock = PTHREAD_MUTEX_INITIALIZER;
+static HeapEntry* table = null;
+static size_t tableSize = 0; // A power of 2.
+static size_t numEntries = 0;
+static MemoryStats stats[numMemoryCategories];
+static long totalLive = 0, totalPeak = 0;
+static long untrackedFrees = 0;
+static HeapSample ring[MEMORYRING];
+static long numSamples = 0;
+static long numAllocs = 0;
+static int sampleInterval = 0; // 0 turns sampling off.
+static _Thread_local MemoryCategory currentCategory = memOther;
+
+// slotOf returns the home slot of an address.
+static size_t slotOf(void* ptr) {
+	uint64_t x = ((uintptr_t) ptr >> 4)*0x9E3779B97F4A7C15ULL;
+	return (size_t) (x >> 32) & (tableSize - 1);
+}
+
+// findEntry returns the slot of an address, or the empty slot where it goes.
+static size_t findEntry(void* ptr) {
+	size_t i = slotOf(ptr);
+	while (table[i].ptr && table[i].ptr != ptr) i = (i + 1) & (tableSize - 1);
+	return i;
+}
+
+// growTable doubles the size of the heap table.
+static void growTable(void) {
+	HeapEntry* old = table;
+	size_t oldSize = tableSize;
+	tableSize = oldSize ? 2*oldSize : INITIALTABLESIZE;
+	table = (HeapEntry*) calloc(tableSize, sizeof(HeapEntry));
+	for (size_t i = 0; i < oldSize; i++)
+		if (old[i].ptr) table[findEntry(old[i].ptr)] = old[i];
+	free(old);
+}
+
+// removeEntry empties a slot, moving later entries back so probe sequences stay unbroken.
+static void removeEntry(size_t i) {
+	size_t j = i;
+	while (true) {
+		table[i].ptr = null;
+		size_t k;
+		do {
+			j = (j + 1) & (tableSize - 1);
+			if (!table[j].ptr) return;
+			k = slotOf(table[j].ptr);
+		} while (i <= j ? (i < k && k <= j) : (i < k || k <= j));
+		table[i] = table[j];
+		i = j;
+	}
+}
+
+// countFree subtracts a tracked block from the counters.
+static void countFree(HeapEntry* entry) {
+	MemoryStats* stat = stats + entry->category;
+	stat->liveBytes -= entry->size;
+	stat->liveBlocks--;
+	stat->frees++;
+	totalLive -= entry->size;
+}
+
+// noteAllocation counts an allocation. Allocations in memOther are counted in the category set
+// by setMemoryCategory. If the address is already tracked its block was freed with free, not
+// stdfree, and it is counted as freed first.
+void noteAllocation(void* ptr, MemoryCategory category, String file, int line) {
+	if (!ptr) return;
+	if (category == memOther) category = currentCategory;
+	size_t size = usableSize(ptr);
+	pthread_mutex_lock(&heapLock);
+	if (2*(numEntries + 1) > tableSize) growTable();
+	size_t i = findEntry(ptr);
+	if (table[i].ptr) countFree(table + i);
+	else numEntries++;
+	table[i] = (HeapEntry) {ptr, size, category};
+	MemoryStats* stat = stats + category;
+	stat->allocs++;
+	stat->liveBlocks++;
+	stat->liveBytes += size;
+	if (stat->liveBytes > stat->peakBytes) stat->peakBytes = stat->liveBytes;
+	totalLive += size;
+	if (totalLive > totalPeak) totalPeak = totalLive;
+	if (sampleInterval && ++numAllocs % sampleInterval == 0)
+		ring[numSamples++ % MEMORYRING] = (HeapSample) {file, line, size, category};
+	pthread_mutex_unlock(&heapLock);
+}
+
+// noteFree counts a free.
+void noteFree(void* ptr) {
+	if (!ptr) return;
+	pthread_mutex_lock(&heapLock);
+	size_t i = tableSize ? findEntry(ptr) : 0;
+	if (tableSize && table[i].ptr) {
+		countFree(table + i);
+		removeEntry(i);
+		numEntries--;
+	} else {
+		untrackedFrees++;
+	}
+	pthread_mutex_unlock(&heapLock);
+}
+
+// setMemoryCategory sets the category of this thread's allocations in files that don't set
+// their own, and returns the previous one.
+MemoryCategory setMemoryCategory(MemoryCategory category) {
+	MemoryCategory previous = currentCategory;
+	currentCategory = category;
+	return previous;
+}
+
+// setSampleInterval samples every interval-th allocation site; 0 turns sampling off.
+void setSampleInterval(int interval) {
+	pthread_mutex_lock(&heapLock);
+	sampleInterval = interval > 0 ? interval : 0;
+	pthread_mutex_unlock(&heapLock);
+}
+
+// getMemoryStats gets the counters of a MemoryCategory.
+void getMemoryStats(MemoryCategory category, MemoryStats* stat) {
+	pthread_mutex_lock(&heapLock);
+	*stat = stats[category];
+	pthread_mutex_unlock(&heapLock);
+}
+
+// memoryCategoryName returns the name of a MemoryCategory.
+String memoryCategoryName(MemoryCategory category) {
+	return category < numMemoryCategories ? categoryNames[category] : "unknown";
+}
+
+// HeapSite is the sum of the samples of an allocation site.
+typedef struct HeapSite {
+	String file;
+	int line;
+	MemoryCategory category;
+	int count;
+	size_t bytes;
+} HeapSite;
+
+// compareSamples orders HeapSamples by site.
+static int compareSamples(const void* a, const void* b) {
+	const HeapSample* left = a;
+	const HeapSample* right = b;
+	int rc = strcmp(left->file, right->file);
+	return rc ? rc : left->line - right->line;
+}
+
+// compareSites orders HeapSites by sampled bytes, largest first.
+static int compareSites(const void* a, const void* b) {
+	const HeapSite* left = a;
+	const HeapSite* right = b;
+	return left->bytes < right->bytes ? 1 : left->bytes > right->bytes ? -1 : 0;
+}
+
+// showSites shows the allocation sites with the most sampled bytes.
+static void showSites(FILE* fp, HeapSample* samples, int count) {
+	qsort(samples, count, sizeof(HeapSample), compareSamples);
+	HeapSite* sites = (HeapSite*) malloc((count ? count : 1)*sizeof(HeapSite));
+	int numSites = 0;
+	for (int i = 0; i < count; i++) {
+		HeapSample* sample = samples + i;
+		HeapSite* site = numSites ? sites + numSites - 1 : null;
+		if (!site || compareSamples(sample, &(HeapSample) {site->file, site->line, 0, 0})) {
+			site = sites + numSites++;
+			*site = (HeapSite) {sample->file, sample->line, sample->category, 0, 0};
+		}
+		site->count++;
+		site->bytes += sample->size;
+	}
+	qsort(sites, numSites, sizeof(HeapSite), compareSites);
+	char segment[MAXPATHBUFFER], where[MAXPATHBUFFER + 16];
+	for (int i = 0; i < numSites && i < MAXSITES; i++) {
+		snprintf(where, sizeof(where), "%s:%d", lastPathSegmentInBuffer(sites[i].file, segment),
+				 sites[i].line);
+		fprintf(fp, "  %-24s %-12s %6d samples %12zu bytes\n", where,
+				memoryCategoryName(sites[i].category), sites[i].count, sites[i].bytes);
+	}
+	free(sites);
+}
+
+// showMemoryReport writes the heap counters and sampled allocation sites to a file.
+void showMemoryReport(FILE* fp) {
+#ifndef DEBUGALLOCS
+	fprintf(fp, "Heap accounting is off; compile with DEBUGALLOCS defined in standard.h.\n");
+	return;
+#endif
+	pthread_mutex_lock(&heapLock);
+	MemoryStats copy[numMemoryCategories];
+	memcpy(copy, stats, sizeof(stats));
+	long live = totalLive, peak = totalPeak, untracked = untrackedFrees;
+	int count = numSamples < MEMORYRING ? (int) numSamples : MEMORYRING;
+	int interval = sampleInterval;
+	HeapSample* samples = (HeapSample*) malloc((count ? count : 1)*sizeof(HeapSample));
+	memcpy(samples, ring, count*sizeof(HeapSample));
+	pthread_mutex_unlock(&heapLock);
+
+	fprintf(fp, "%-12s %14s %14s %12s %12s %12s\n", "Category", "Live bytes", "Peak bytes",
+			"Live blocks", "Allocs", "Frees");
+	for (int i = 0; i < numMemoryCategories; i++) {
+		MemoryStats* stat = copy + i;
+		if (!stat->allocs && !stat->frees) continue;
+		fprintf(fp, "%-12s %14ld %14ld %12ld %12ld %12ld\n", memoryCategoryName(i),
+				stat->liveBytes, stat->peakBytes, stat->liveBlocks, stat->allocs, stat->frees);
+	}
+	fprintf(fp, "%-12s %14ld %14ld\n", "total", live, peak);
+	if (untracked) fprintf(fp, "Frees of untracked blocks: %ld\n", untracked);
+	if (count) {
+		fprintf(fp, "Allocation sites (1 in %d allocations, last %d samples):\n", interval, count);
+		showSites(fp, samples, count);
+	}
+	free(samples);
+}
@@ -3,12 +3,10 @@
 // path.c has functions to manipulate UNIX file paths.
 //
 // Created by Thomas Wetmore on 14 December 2022.
-// Last changed on 28 October 2024.
+// Last changed on 18 October 2026.
 
 #include <unistd.h>
-#include "standard.h"
-
-#define MAXPATHBUFFER 4096
+#include "path.h"
 
 // resolveFile tries to find a file within a sequence of paths.
 String resolveFile(String name, String path) {
@@ -36,10 +34,17 @@ FILE *fopenPath(String name, String mode, String path) {
 
 // lastPathSegment returns the last componenet of a path. Returns static memory.
 String lastPathSegment (String path) {
-	static unsigned char scratch[MAXPATHBUFFER];
+	static char scratch[MAXPATHBUFFER];
+	return lastPathSegmentInBuffer(path, scratch);
+}
+
+// lastPathSegmentInBuffer returns the last component of a path in a buffer of MAXPATHBUFFER
+// chars.
+String lastPathSegmentInBuffer(String path, String buffer) {
 	if (!path || *path == 0) return NULL;
 	int len = (int) strlen(path);
-	String p = (String) scratch, q;
+	if (len >= MAXPATHBUFFER) return NULL;
+	String p = buffer, q;
 	strcpy(p, path);
 	if (p[len-1] == '/') {
 		len--;
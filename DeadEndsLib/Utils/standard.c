@@ -3,70 +3,39 @@
 // standard.c hold some standard utiltiy functions.
 //
 // Creates by Thomas Wetmore on 7 November 2022.
-// Last changed on 25 November 2024.
+// Last changed on 18 October 2026.
 
 #include <stdlib.h>
 #include "standard.h"
 #include "path.h"
-#include <malloc/malloc.h> // For malloc_size().
+#include "heapstats.h"
 
-#define ALLOCLOGFILE "~/alloc.log"
+// Strings from strsave and strconcat are counted as memString.
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memString
 
-static FILE *allocLogFile = null;  // The logging file.
-static bool logopen = false;       // The logging file is open for writing.
-static bool loggingAllocs = false; // Whether currently logging.
-static long bytesAllocated = 0;
-static long bytesFreed = 0;
+#define SAMPLEINTERVAL 64 // Sample 1 in this many allocations when logging.
 
 String version = "deadends.0.0.1";
 
-// logAllocations turns allocation logging on or off; for debugging heap memory.
+// _logAllocations turns sampling of allocation sites on or off; for debugging heap memory. The
+// counters in heapstats.c are kept whenever DEBUGALLOCS is defined.
 void _logAllocations(bool onOrOff) {
-    static bool firstOn = true;  // Open for writing on first call.
-    if (onOrOff) {
-        if (firstOn) {
-            bytesAllocated = 0;
-            bytesFreed = 0;
-            ASSERT(allocLogFile == null);
-            allocLogFile = fopen(ALLOCLOGFILE, "w");  // On first opening, open for writing.
-            if (!allocLogFile) fatal("Can't open log file");
-            firstOn = false;
-        } else {
-            if (!allocLogFile) allocLogFile = fopen(ALLOCLOGFILE, "a");  // Else open for appending.
-            if (!allocLogFile) fatal("Can't open log file");
-        }
-        loggingAllocs = true;
-    } else {
-        if (allocLogFile) {
-            fprintf(allocLogFile, "Bytes allocated: %ld\n", bytesAllocated);
-            fprintf(allocLogFile, "Bytes freed:     %ld\n", bytesFreed);
-            fclose(allocLogFile);
-            allocLogFile = null;
-        }
-        loggingAllocs = false;
-    }
+	setSampleInterval(onOrOff ? SAMPLEINTERVAL : 0);
 }
 
 // _alloc allocates memory; called by stdalloc.
-void* _alloc(size_t len, String file, int line) {
+void* _alloc(size_t len, MemoryCategory category, String file, int line) {
 	char* p;
 	if (len == 0) return null;
 	ASSERT(p = malloc(len));
-	if (loggingAllocs) {
-        bytesAllocated += malloc_size(p);
-        fprintf(allocLogFile, "A  %s\t%d\t%zu\t%ld\t%ld\n", lastPathSegment(file), line, len,
-				malloc_size(p), (long) p);
-	}
+	noteAllocation(p, category, file, line);
 	return p;
 }
 
 // _free deallocates memory; called by sdtfree.
 void _free (void* ptr, String file, int line) {
-	if (loggingAllocs) {
-        fprintf(allocLogFile, "F  %s\t%d\t%ld\t%ld\n", lastPathSegment(file), line,
-				malloc_size(ptr), (long) ptr);
-        bytesFreed += malloc_size(ptr);
-	}
+	noteFree(ptr);
 	free(ptr);
 }
 
@@ -3,10 +3,12 @@
 // utils.c
 //
 // Created by Thomas Wetmore on 13 November 2022.
-// Last changed on 6 December 2024.
+// Last changed on 18 October 2026.
 
 #include <sys/time.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "standard.h"
 #include "utils.h"
 
@@ -22,9 +24,13 @@ double getMseconds(void) {
 
 // getMsecondsStr gets the current time in milliseconds in a static String.
 String getMsecondsStr(void) {
-	double millis = getMseconds();
-	static char buffer[10];;
-	sprintf(buffer, "%2.3f", millis);
+	static char buffer[MSECONDSLEN];
+	return getMsecondsStrInBuffer(buffer);
+}
+
+// getMsecondsStrInBuffer gets the current time in milliseconds in a buffer of MSECONDSLEN chars.
+String getMsecondsStrInBuffer(String buffer) {
+	snprintf(buffer, MSECONDSLEN, "%2.3f", getMseconds());
 	return buffer;
 }
 
@@ -54,3 +60,28 @@ String rightjustify(String string, int len) {
 	s[i] = 0;
 	return scratch;
 }
+
+// threadCount returns the number of threads to use: requested, or one per processor if requested
+// is 0 or less, but no more than limit and at least 1.
+int threadCount(int requested, int limit) {
+	int numThreads = requested > 0 ? requested : (int) sysconf(_SC_NPROCESSORS_ONLN);
+	if (numThreads > limit) numThreads = limit;
+	return numThreads < 1 ? 1 : numThreads;
+}
+
+// runThreads runs a worker in numThreads threads, the calling thread being one of them. Thread i
+// gets the argument at args + i*argSize, so argSize 0 gives all threads the same argument, as for
+// workers that take work from a shared pool until none is left. The calling thread runs the
+// argument of any thread that can't be created after the others are joined.
+void runThreads(void* (*worker)(void*), void* args, size_t argSize, int numThreads) {
+	pthread_t threads[MAXWORKERTHREADS];
+	bool started[MAXWORKERTHREADS] = {false};
+	if (numThreads > MAXWORKERTHREADS) numThreads = MAXWORKERTHREADS;
+	for (int i = 1; i < numThreads; i++)
+		started[i] = pthread_create(threads + i, null, worker, (char*) args + i*argSize) == 0;
+	worker(args);
+	for (int i = 1; i < numThreads; i++) {
+		if (started[i]) pthread_join(threads[i], null);
+		else worker((char*) args + i*argSize);
+	}
+}
@@ -3,7 +3,7 @@
 // valfamily.c has the functions that validate family records.
 //
 // Created by Thomas Wetmore on 18 December 2023.
-// Last changed on 3 December 2024.
+// Last changed on 18 October 2026.
 
 #include "validate.h"
 #include "gnode.h"
@@ -35,7 +35,7 @@ static bool validateFamily(GNode* family, String name, RecordIndex* index, Integ
 						   ErrorLog* elog) {
 	normalizeFamily(family);
 	int errorCount = 0;
-	static char s[4096];
+	char s[4096];
 
 	// HUSB, WIFE and CHIL nodes must point to persons.
 	FORHUSBS(family, husband, key, index)
@@ -3,7 +3,7 @@
 // valperson.c contains functions that validate person records in a Database.
 //
 // Created by Thomas Wetmore on 17 December 2023.
-// Last changed on 8 December 2024.
+// Last changed on 18 October 2026.
 
 #include "validate.h"
 #include "gnode.h"
@@ -33,7 +33,9 @@ void validatePersons(RecordIndex* index, String name, IntegerTable* keymap, Erro
 			numPersonsValidated++;
 		}
 	ENDHASHTABLE
-	if (importDebugging) printf("%s: validatePersons: %d persons validated.\n", getMsecondsStr(), numPersonsValidated);
+	char msecs[MSECONDSLEN];
+	if (importDebugging) printf("%s: validatePersons: %d persons validated.\n",
+								getMsecondsStrInBuffer(msecs), numPersonsValidated);
 }
 
 // validatePerson validates a person record. Persons require at least one NAME and one SEX line
@@ -47,7 +49,7 @@ static bool validatePerson(GNode* person, String name, RecordIndex* index, Integ
 	ASSERT(line != NAN);
 	normalizePerson(person);
 	int errorCount = 0;
-	static char s[512]; // For error strings.
+	char s[512]; // For error strings.
 	// Warning: use of __node is fragile because it uses internal details of the macros.
 	FORFAMCS(person, family, key, index) // Check FAMC links to families.
 		if (!family) {
@@ -3,13 +3,15 @@
 //  MenuLibrary
 //
 // Created by Thomas Wetmore on 8 August 2024.
-// Last changed on 9 September 2024
+// Last changed on 18 October 2026
 
 #include "standard.h"
 #include "ask.h"
 #include "list.h"
 #include "stdarg.h"
 #include "regex.h"
+#include "gedcom.h"
+#include "name.h"
 
 static bool checkForInteger(String, int*);
 static bool isInStringList(String, List*);
@@ -206,21 +208,51 @@ AskReturn askForPattern(String msg, String pattern, int returnSet, String* resul
 	return askOkay; // Cannot get here.
 }
 
+// askForPerson asks a user for the name of a person and returns the person's root. Partial and
+// misspelled names are allowed; if more than one person matches the user chooses from a list.
 AskReturn askForPerson(Database* database, int codes, GNode** proot) {
 	String name = null;
+	*proot = null;
 	// Ask first time outside of loop.
-	AskReturn rcode = askForString("Enter the name of a person: ", askQuit, &name);
+	AskReturn rcode = askForString("Enter the name of a person", askQuit, &name);
 	if (rcode == askQuit) return rcode; // User backed out.
-
-	return askOkay;
+	while ((rcode = getPersonFromName(database, name, proot)) == askFail) {
+		if (!(codes & askQuit)) return rcode;
+		rcode = askForString("No person has that name; enter another name or q to quit", askQuit, &name);
+		if (rcode == askQuit || eqstr(name, "q")) return askQuit;
+	}
+	return rcode;
 }
 
-AskReturn getPersonFromName(Database* database, String name, GNode** root) {
-	// Get the list of persons who match the name.
-	// If the list is of length one, return that one person.
-	// Get user to choose person from a List.
-	// If user doesn't choose return askQuit.
-	// If user does choose return askOkay with the GNode* of the person's root.
+static int maxPersonChoices = 20; // Most persons the user chooses from.
+
+// getPersonFromName finds the persons whose names match a name. If one person matches it is
+// returned. If more match the user chooses one from a list of the best matches.
+AskReturn getPersonFromName(Database* database, String name, GNode** proot) {
+	*proot = null;
+	List* results = searchNameSearchIndex(database->nameSearchIndex, name, maxPersonChoices);
+	int length = lengthList(results);
+	if (length == 0) {
+		deleteList(results);
+		return askFail;
+	}
+	int choice = 1;
+	if (length > 1) {
+		int i = 0;
+		FORLIST(results, element)
+			GNode* person = keyToPerson(((NameSearchResult*) element)->recordKey, database->recordIndex);
+			GNode* node = NAME(person);
+			printf("%3d: %s (%s)\n", ++i, node && node->value ? nameString(node->value) : "no name",
+				   person->key);
+		ENDLIST
+		AskReturn rcode = askForInteger("Enter the number of the person", askQuit, &choice);
+		if (rcode != askOkay || choice < 1 || choice > length) {
+			deleteList(results);
+			return askQuit;
+		}
+	}
+	String key = ((NameSearchResult*) getListElement(results, choice - 1))->recordKey;
+	*proot = keyToPerson(key, database->recordIndex);
+	deleteList(results);
 	return askOkay;
 }
-
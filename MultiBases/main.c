@@ -5,7 +5,7 @@
 // will experiment with Database merging.
 //
 // Created by Thomas Wetmore on 16 November 2024.
-// Last changed on 12 December 2024.
+// Last changed on 18 October 2026.
 
 #include "standard.h"
 #include "utils.h"
@@ -13,6 +13,7 @@
 #include "database.h"
 #include "import.h"
 #include "errors.h"
+#include "duplicates.h"
 
 static bool debugging = true;
 static bool timing = true;
@@ -48,6 +49,18 @@ int main(int argc, char *argv[]) {
 	printf("The number of databases created was %d\n", lengthList(databases));
 	printf("The number of errors logged was %d\n", lengthList(errorLog));
 	if (lengthList(errorLog)) showErrorLog(errorLog);
+
+	// Show the persons in the first two Databases that may be duplicates.
+	if (lengthList(databases) >= 2) {
+		List* matches = findDuplicatePersons(getListElement(databases, 0),
+											 getListElement(databases, 1), 0.85, 0);
+		printf("The number of possible duplicate persons was %d\n", lengthList(matches));
+		int shown = 0;
+		FORLIST(matches, element)
+			if (shown++ < 20) showDuplicateMatch((DuplicateMatch*) element);
+		ENDLIST
+		deleteList(matches);
+	}
 }
 
 // getGedcomPath gets the Gedcom file search path by looking for the DE_GEDCOM_PATH environment
@@ -2,7 +2,7 @@
 // Partition
 //
 // Created by Thomas Wetmore on 5 October 2024.
-// Last changed on 11 October 2024.
+// Last changed on 18 October 2026.
 
 #ifndef connect_h
 #define connect_h
@@ -13,16 +13,17 @@
 #include "gnodeindex.h"
 
 // Connect data is the data field used in the GNodeIndexEls by the partition program. It holds
-// the numbers of ancestors and descendents of the persons in the index.
+// the numbers of distinct ancestors and descendents of the persons in the index.
 typedef struct ConnectData {
 	bool ancestorsDone;
 	int numAncestors;
 	bool descendentsDone;
 	int numDescendents;
+	bool estimated; // True if the numbers are estimates; they are shown as ~N.
 } ConnectData;
 
 ConnectData* createConnectData(void);
-void getConnections(List*, GNodeIndex*);
+void getConnections(GNodeIndex*);
 void debugGNodeIndex(GNodeIndex*);
 
 #endif // connect_h
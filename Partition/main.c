@@ -4,7 +4,7 @@
 // into closed sets of persons and families.
 //
 // Created by Thomas Wetmore on 4 October 2024.
-// Last changed on 13 December 2024.
+// Last changed on 18 October 2026.
 
 #include <stdio.h>
 #include "import.h"
@@ -76,10 +76,7 @@ int main(int argc, char** argv) {
 	if (timing) printf("%s: Partition: created %d partitions.\n", gms, lengthList(partitions));
 
 	// Get number of ancestors and descendents of all persons.
-	FORLIST(partitions, el)
-		List* partition = (List*) el;
-		getConnections(partition, index);
-	ENDLIST
+	getConnections(index);
 	if (timing) printf("%s: Partition: computed connectedness numbers.\n", gms);
 
 	showPartitions(partitions, index);
@@ -87,6 +84,7 @@ int main(int argc, char** argv) {
 	// Find the most connected person.
 	int max = 0;
 	GNode* topGun = null;
+	String mark = "";
 	FORLIST(persons, el)
 		GNode* person = (GNode*) el;
 		GNodeIndexEl* element = searchHashTable(index, person->key);
@@ -95,9 +93,10 @@ int main(int argc, char** argv) {
 		if (score > max) {
 			max = score;
 			topGun = person;
+			mark = data->estimated ? "~" : "";
 		}
 	ENDLIST
-	printf("Person: %s %s %d\n", topGun->key, topGun->child->value, max);
+	printf("Person: %s %s %s%d\n", topGun->key, topGun->child->value, mark, max);
 	if (timing) printf("%s: Partition: done.\n", gms);
 }
 
@@ -108,8 +107,9 @@ static void showConnects(List* list, GNodeIndex* index) {
 		GNode* root = el;
 		GNodeIndexEl* element = searchHashTable(index, root->key);
 		ConnectData* data = element->data;
-		printf("%s: %s: %d: %d\n", root->key, root->child->value, data->numAncestors,
-			   data->numDescendents);
+		String mark = data->estimated ? "~" : ""; // Estimated counts are shown as ~N.
+		printf("%s: %s: %s%d: %s%d\n", root->key, root->child->value, mark, data->numAncestors,
+			   mark, data->numDescendents);
 	ENDLIST
 }
 
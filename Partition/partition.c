@@ -3,84 +3,177 @@
 // partition.c contains functions that partitions persons from a GNodeList into a List of
 // RootLists of persons in closed sets based on FAMS, FAMC, HUSB, WIFE & CHIL relationships.
 //
+// The records are given integer ids and their links are kept as id arrays, so keys are looked
+// up once per link. The closed sets are the connected components found by a UnionFind over the
+// links. Each partition starts with the first of its persons in the list, and its persons are in
+// the breadth first order from that person used before the UnionFind.
+//
 // Created by Thomas Wetmore on 11 December 2024.
-// Last changed on 14 December 2024.
+// Last changed on 18 October 2026.
 
 #include <stdio.h>
 #include "errors.h"
 #include "gnodeindex.h"
 #include "gnodelist.h"
 #include "utils.h"
-#include "stringset.h"
+#include "unionfind.h"
 
 #define gms getMsecondsStr()
-static List* createPartition(GNode*, GNodeIndex*, StringSet*, ErrorLog*);
 static bool debugging = false;
 
+// RecordId maps a record key to its id.
+typedef struct RecordId {
+	String key;
+	int id;
+} RecordId;
+
+// PartitionGraph holds the records of a GNodeIndex by id and their links.
+typedef struct PartitionGraph {
+	int numRecords;
+	GNode** records; // Records by id.
+	RecordType* types;
+	RecordId* recordIds;
+	HashTable* ids; // Maps keys to RecordIds.
+	int* firstLink; // The links of record i are links[firstLink[i]..firstLink[i+1]-1].
+	int* links; // FAMS and FAMC families of persons, HUSB, WIFE and CHIL persons of families, in
+				// Gedcom order; -1 if the record isn't in the index.
+	int* edges; // Pairs of linked ids for the UnionFind.
+	int numEdges;
+} PartitionGraph;
+
+// getKey returns the key of a RecordId.
+static String getKey(void* element) {
+	return ((RecordId*) element)->key;
+}
+
+// compare compares two record keys.
+static int compare(String a, String b) {
+	return compareRecordKeys(a, b);
+}
+
+// findId returns the id of a key, or -1 if it is not in the index.
+static int findId(PartitionGraph* graph, String key) {
+	RecordId* recordId = key ? (RecordId*) searchHashTable(graph->ids, key) : null;
+	return recordId ? recordId->id : -1;
+}
+
+// isLink returns true if a line of a record is a link the partitions follow.
+static bool isLink(RecordType type, String tag) {
+	if (type == GRPerson) return eqstr(tag, "FAMS") || eqstr(tag, "FAMC");
+	if (type == GRFamily) return eqstr(tag, "HUSB") || eqstr(tag, "WIFE") || eqstr(tag, "CHIL");
+	return false;
+}
+
+// createPartitionGraph gives ids to the records in a GNodeIndex and finds their links.
+static void createPartitionGraph(GNodeIndex* index, PartitionGraph* graph) {
+	int numRecords = sizeHashTable(index);
+	graph->numRecords = numRecords;
+	graph->records = (GNode**) stdalloc((numRecords + 1)*sizeof(GNode*));
+	graph->types = (RecordType*) stdalloc((numRecords + 1)*sizeof(RecordType));
+	graph->recordIds = (RecordId*) stdalloc((numRecords + 1)*sizeof(RecordId));
+	graph->ids = createHashTable(getKey, compare, null, (numRecords | 1) + 2);
+	int id = 0, numLinks = 0;
+	FORHASHTABLE(index, element)
+		GNode* root = ((GNodeIndexEl*) element)->root;
+		graph->records[id] = root;
+		graph->types[id] = recordType(root);
+		graph->recordIds[id] = (RecordId) {root->key, id};
+		addToHashTable(graph->ids, graph->recordIds + id, false);
+		for (GNode* node = root->child; node; node = node->sibling)
+			if (isLink(graph->types[id], node->tag)) numLinks++;
+		id++;
+	ENDHASHTABLE
+	graph->firstLink = (int*) stdalloc((numRecords + 1)*sizeof(int));
+	graph->links = (int*) stdalloc((numLinks + 1)*sizeof(int));
+	graph->edges = (int*) stdalloc((2*numLinks + 1)*sizeof(int));
+	graph->numEdges = 0;
+	int next = 0;
+	for (id = 0; id < numRecords; id++) {
+		graph->firstLink[id] = next;
+		for (GNode* node = graph->records[id]->child; node; node = node->sibling) {
+			if (!isLink(graph->types[id], node->tag)) continue;
+			int link = findId(graph, node->value);
+			graph->links[next++] = link;
+			if (link < 0) continue;
+			graph->edges[2*graph->numEdges] = id;
+			graph->edges[2*graph->numEdges + 1] = link;
+			graph->numEdges++;
+		}
+	}
+	graph->firstLink[numRecords] = next;
+}
+
+// deletePartitionGraph frees a PartitionGraph.
+static void deletePartitionGraph(PartitionGraph* graph) {
+	deleteHashTable(graph->ids);
+	stdfree(graph->records);
+	stdfree(graph->types);
+	stdfree(graph->recordIds);
+	stdfree(graph->firstLink);
+	stdfree(graph->links);
+	stdfree(graph->edges);
+}
+
+// createPartition creates the partition of a person. Its persons are found breadth first from
+// the person; visited marks the records already found, and queue has room for every link.
+static List* createPartition(int person, PartitionGraph* graph, bool* visited, int* queue,
+							 ErrorLog* log) {
+	if (debugging) printf("%s: createPartition: start.\n", gms);
+	RootList* partition = createRootList(); // The new partition.
+	int head = 0, tail = 0;
+	queue[tail++] = person;
+	while (head < tail) {
+		int curr = queue[head++]; // Could be person or family.
+		if (visited[curr]) continue; // Skip if already processed.
+		visited[curr] = true;
+		RecordType type = graph->types[curr];
+		if (type == GRPerson) appendToList(partition, graph->records[curr]); // Add persons only.
+		for (int i = graph->firstLink[curr]; i < graph->firstLink[curr + 1]; i++) {
+			if (graph->links[i] < 0) { // Can't happen in a validated index.
+				if (type == GRPerson)
+					addErrorToLog(log, createError(linkageError, "file", 0, "Couldn't find a family"));
+				else
+					addErrorToLog(log, createError(linkageError, "", 0, "Couldn't find a person"));
+				continue;
+			}
+			queue[tail++] = graph->links[i];
+		}
+	}
+	return partition;
+}
+
 // getPartitions partitions a RootList of persons into a List of RootLists of persons. Each
 // partition is a closed set of persons. Persons is the RootList of all persons from a
 // Gedcom source, and index is the GNodeIndex of the persons and families from the source.
 List* getPartitions(RootList* persons, GNodeIndex* index, ErrorLog* log) {
 	if (debugging) printf("%s: getPartitions: start: |persons|: %d, |index|: %d.\n", gms,
 						  lengthList(persons), sizeHashTable(index));
-	StringSet* visited = createStringSet(); // Keys of persons and families already processed.
+	PartitionGraph graph;
+	createPartitionGraph(index, &graph);
+	UnionFind* unionFind = createUnionFind(graph.numRecords);
+	uniteEdges(unionFind, graph.edges, graph.numEdges, true);
+	int* labels = (int*) stdalloc((graph.numRecords + 1)*sizeof(int));
+	int numComponents = labelComponents(unionFind, labels);
+	deleteUnionFind(unionFind);
+	if (debugging) printf("%s: getPartitions: %d components.\n", gms, numComponents);
+
+	bool* started = (bool*) stdalloc(numComponents + 1); // Components with a partition.
+	memset(started, 0, numComponents + 1);
+	bool* visited = (bool*) stdalloc(graph.numRecords + 1);
+	memset(visited, 0, graph.numRecords + 1);
+	int* queue = (int*) stdalloc((graph.firstLink[graph.numRecords] + 2)*sizeof(int));
 	List* partitions = createList(null, null, null, false); // List of partitions returned.
 	FORLIST(persons, el)
 		GNode* person = (GNode*) el;
-		if (!isInSet(visited, person->key)) // Get person who starts the next partition.
-			appendToList(partitions, createPartition(person, index, visited, log));
+		int id = findId(&graph, person->key);
+		if (id < 0 || started[labels[id]]) continue;
+		started[labels[id]] = true; // Person starts the next partition.
+		appendToList(partitions, createPartition(id, &graph, visited, queue, log));
 	ENDLIST
-	deleteStringSet(visited, false);
+	stdfree(started);
+	stdfree(visited);
+	stdfree(queue);
+	stdfree(labels);
+	deletePartitionGraph(&graph);
 	return partitions;
 }
-
-// createPartition finds the closed set of persons that the argument person belongs to. Root is
-// a person, index is the GNodeIndex of all persons and families from a Gedcom file, visited is
-// the StringSet of person keys that have been visited. A partition is a RootList of persons.
-static List* createPartition(GNode* person, GNodeIndex* index, StringSet* visited, ErrorLog* log) {
-	if (debugging) printf("%s: createPartition: start.\n", gms);
-	RootList* partition = createRootList(); // The new partition.
-	List* queue = createList(null, null, null, false); // Queue of persons and families to add.
-	prependToList(queue, person); // Initialize queue with first person.
-
-	// Iterate until the queue is empty.
-	while (lengthList(queue) > 0) {
-		GNode* curr = getAndRemoveLastListElement(queue); // Could be person or family.
-		String key = curr->key;
-		if (isInSet(visited, key)) continue; // Skip if already processed.
-		addToSet(visited, key);
-		if (recordType(curr) == GRPerson) appendToList(partition, curr); // Add persons only.
-
-		// If curr is a person add its FAMS and FAMC families to the queue.
-		if (recordType(curr) == GRPerson) {
-			for (GNode* child = curr->child; child; child = child->sibling) {
-				String tag = child->tag;
-				if (eqstr(tag, "FAMS") || eqstr(tag, "FAMC")) {
-					String value = child->value;
-					GNode* node = searchGNodeIndex(index, value);
-					if (!node) { // Can't happen in a validated index.
-						addErrorToLog(log, createError(linkageError, "file", 0, "Couldn't find a family"));
-						continue;
-					}
-					prependToList(queue, node);
-				}
-			}
-		// If curr is a family add its HUSB, WIFE, and CHIL persons to the queue.
-		} else if (recordType(curr) == GRFamily) {
-			for (GNode* child = curr->child; child; child = child->sibling) {
-				String tag = child->tag;
-				if (eqstr(tag, "HUSB") || eqstr(tag, "WIFE") || eqstr(tag, "CHIL")) {
-					String value = child->value;
-					GNode* node = searchGNodeIndex(index, value);
-					if (!node) { // Can't happen in a validated index.
-						addErrorToLog(log, createError(linkageError, "", 0, "Couldn't find a person"));
-						continue;
-					}
-					prependToList(queue, node);
-				}
-			}
-		}
-	}
-	deleteList(queue);
-	return partition;
-}
@@ -2,14 +2,16 @@
 //
 // randomizekeys.c is the DeadEnds tool that randomizes the keys in a Gedcom file. It reads a
 // Gedcom file, generates a new random key for every record in the file, and then rewrites the
-// randomized Gedcom file to standard output.
+// randomized Gedcom file to standard output. With -s the file is rekeyed by streaming it twice
+// (see streamrekey.c), which does not build records and handles files of any size; -r gives the
+// seed for the new keys.
 //
 // Created by Thomas Wetmore on 14 July 2024.
-// Last changed on 25 November 2024.
+// Last changed on 18 October 2026.
 
 #include "randomizekeys.h"
 
-static void getArguments(int, char**, String*);
+static void getArguments(int, char**, String*, bool*, uint64_t*);
 static void getEnvironment(String*);
 static void usage(void);
 static void goAway(ErrorLog*);
@@ -20,10 +22,20 @@ static bool debugging = true;
 int main(int argc, char** argv) {
 	String gedcomFile = null;
 	String searchPath = null;
-	printf("%s: RandomizeKeys begin.\n", getMsecondsStr());
-	getArguments(argc, argv, &gedcomFile);
+	bool streaming = false;
+	uint64_t seed = (uint64_t) time(null);
+	getArguments(argc, argv, &gedcomFile, &streaming, &seed);
 	getEnvironment(&searchPath);
 	gedcomFile = resolveFile(gedcomFile, searchPath);
+	if (streaming) { // Messages go to standard error so standard out is only Gedcom.
+		if (!gedcomFile) {
+			usage();
+			exit(1);
+		}
+		fprintf(stderr, "%s: RandomizeKeys begin streaming %s.\n", getMsecondsStr(), gedcomFile);
+		return streamRekeyFile(gedcomFile, stdout, seed) ? 1 : 0;
+	}
+	printf("%s: RandomizeKeys begin.\n", getMsecondsStr());
 	if (debugging) printf("Resolved file: %s\n", gedcomFile);
 	// Get the Gedcom records from a file.
 	File* file = openFile(gedcomFile, "r");
@@ -87,14 +99,21 @@ int main(int argc, char** argv) {
 	return 0;
 }
 
-// getFileArguments gets the file name from the command line.
-static void getArguments(int argc, char* argv[], String* gedcomFile) {
+// getFileArguments gets the file name, streaming flag and seed from the command line.
+static void getArguments(int argc, char* argv[], String* gedcomFile, bool* streaming,
+						 uint64_t* seed) {
 	int ch;
-	while ((ch = getopt(argc, argv, "g:v")) != -1) {
+	while ((ch = getopt(argc, argv, "g:sr:v")) != -1) {
 		switch(ch) {
 		case 'g':
 			*gedcomFile = strsave(optarg);
 			break;
+		case 's':
+			*streaming = true;
+			break;
+		case 'r':
+			*seed = strtoull(optarg, null, 10);
+			break;
 		case 'v':
 			printf("version 1.0\n");
 			exit(1);
@@ -118,7 +137,7 @@ static void getEnvironment(String* gedcomPath) {
 
 // usage prints the RunScript usage message.
 static void usage(void) {
-	fprintf(stderr, "usage: RandomizeKeys -g gedcomfile\n");
+	fprintf(stderr, "usage: RandomizeKeys -g gedcomfile [-s] [-r seed]\n");
 }
 
 // goAway is called if anything does wrong. It prints the error log and exits.
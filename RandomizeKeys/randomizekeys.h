@@ -4,12 +4,13 @@
 // CloneOne
 //
 // Created by Thomas Wetmore on 14 July 24.
-// Last changed on 30 July 2024.
+// Last changed on 18 October 2026.
 
 #ifndef randomizekeys_h
 #define randomizekeys_h
 
 #include <stdio.h>
+#include <time.h>
 #include "import.h"
 #include "gnodelist.h"
 #include "utils.h"
@@ -18,4 +19,6 @@
 #include "writenode.h"
 #include "file.h"
 
+int streamRekeyFile(String path, FILE* out, uint64_t seed); // streamrekey.c
+
 #endif // randomizekeys_h
@@ -0,0 +1,246 @@
+// DeadEnds Tool
+//
+// streamrekey.c is the streaming mode of RandomizeKeys. It rekeys a Gedcom file in two passes
+// over the file without building GNode trees. The first pass finds the defining key of every
+// record and gives it the index of its new key. The second pass copies the file line by line,
+// replacing the defining key and any key valued line with the new keys. The new keys come from
+// a seeded permutation of all possible keys, so they never collide. Memory use is one KeyMap
+// entry per record and one line buffer, whatever the size of the file.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include "randomizekeys.h"
+
+#undef MEMORYCATEGORY
+#define MEMORYCATEGORY memIndex
+
+#define OUTPUTBUFFERSIZE (1 << 20)
+
+// KeyEl is an entry in a KeyMap; key is null in empty slots.
+typedef struct KeyEl {
+	String key; // Defining key from the file.
+	uint32_t index; // Index of its new key.
+	RecordType type; // Type of the record.
+} KeyEl;
+
+// KeyMap maps defining keys to KeyEls with open addressing. HashTable is not used because its
+// hash values are limited to 16 bits, which makes its buckets long for large files.
+typedef struct KeyMap {
+	KeyEl* slots;
+	uint32_t size; // Number of slots; a power of 2.
+	uint32_t count; // Number of keys.
+} KeyMap;
+
+// hashKey returns the FNV-1a hash of a key of some length.
+static uint64_t hashKey(String key, int length) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (int i = 0; i < length; i++) hash = (hash ^ (unsigned char) key[i])*0x100000001b3ULL;
+	return hash;
+}
+
+// createKeyMap creates an empty KeyMap.
+static KeyMap* createKeyMap(void) {
+	KeyMap* map = (KeyMap*) stdalloc(sizeof(KeyMap));
+	map->size = 1 << 16;
+	map->count = 0;
+	map->slots = (KeyEl*) stdalloc(map->size*sizeof(KeyEl));
+	memset(map->slots, 0, map->size*sizeof(KeyEl));
+	return map;
+}
+
+// deleteKeyMap frees a KeyMap and its keys.
+static void deleteKeyMap(KeyMap* map) {
+	for (uint32_t i = 0; i < map->size; i++)
+		if (map->slots[i].key) stdfree(map->slots[i].key);
+	stdfree(map->slots);
+	stdfree(map);
+}
+
+// findSlot returns the slot that holds a key of some length, or the empty slot where it goes.
+static KeyEl* findSlot(KeyEl* slots, uint32_t size, String key, int length) {
+	uint32_t i = (uint32_t) hashKey(key, length) & (size - 1);
+	while (slots[i].key) {
+		if (strncmp(slots[i].key, key, length) == 0 && slots[i].key[length] == 0) break;
+		i = (i + 1) & (size - 1);
+	}
+	return slots + i;
+}
+
+// growKeyMap doubles the number of slots in a KeyMap.
+static void growKeyMap(KeyMap* map) {
+	uint32_t size = map->size*2;
+	KeyEl* slots = (KeyEl*) stdalloc(size*sizeof(KeyEl));
+	memset(slots, 0, size*sizeof(KeyEl));
+	for (uint32_t i = 0; i < map->size; i++) {
+		KeyEl* el = map->slots + i;
+		if (el->key) *findSlot(slots, size, el->key, (int) strlen(el->key)) = *el;
+	}
+	stdfree(map->slots);
+	map->slots = slots;
+	map->size = size;
+}
+
+// addKey adds a key of some length to a KeyMap with the next index; returns false if the key
+// is already there.
+static bool addKey(KeyMap* map, String key, int length, RecordType type) {
+	if (2*(map->count + 1) > map->size) growKeyMap(map);
+	KeyEl* el = findSlot(map->slots, map->size, key, length);
+	if (el->key) return false;
+	el->key = (String) stdalloc(length + 1);
+	memcpy(el->key, key, length);
+	el->key[length] = 0;
+	el->index = map->count++;
+	el->type = type;
+	return true;
+}
+
+// searchKey returns the KeyEl of a key of some length, or null.
+static KeyEl* searchKey(KeyMap* map, String key, int length) {
+	KeyEl* el = findSlot(map->slots, map->size, key, length);
+	return el->key ? el : null;
+}
+
+// LineFields locates the fields of a Gedcom line that can hold keys.
+typedef struct LineFields {
+	int level;
+	String key; // Defining key, with its @'s, or null.
+	int keyLength;
+	String tag;
+	int tagLength;
+	String value; // Value if it is a key, or null.
+	int valueLength;
+} LineFields;
+
+// findFields finds the fields of a Gedcom line; returns false if the line has no level.
+static bool findFields(String line, LineFields* fields) {
+	String p = line;
+	fields->key = fields->tag = fields->value = null;
+	fields->keyLength = fields->tagLength = fields->valueLength = 0;
+	while (iswhite(*p)) p++;
+	if (chartype(*p) != DIGIT) return false;
+	fields->level = 0;
+	while (chartype(*p) == DIGIT) fields->level = fields->level*10 + *p++ - '0';
+	while (iswhite(*p)) p++;
+	if (*p == '@') { // Defining key.
+		String q = strchr(p + 1, '@');
+		if (!q) return false;
+		fields->key = p;
+		fields->keyLength = (int) (q - p) + 1;
+		p = q + 1;
+		while (iswhite(*p)) p++;
+	}
+	fields->tag = p;
+	while (*p && !iswhite(*p)) p++;
+	fields->tagLength = (int) (p - fields->tag);
+	if (!*p) return true;
+	p++;
+	while (iswhite(*p)) p++;
+	String end = p + strlen(p); // Value is a key if it is all one @...@ token.
+	while (end > p && (iswhite(end[-1]) || end[-1] == '\n' || end[-1] == '\r')) end--;
+	if (end - p >= 3 && *p == '@' && end[-1] == '@' && p[1] != '@' && !memchr(p + 1, '@', end - p - 2)) {
+		fields->value = p;
+		fields->valueLength = (int) (end - p);
+	}
+	return true;
+}
+
+// collectKeys is the first pass; it adds the defining keys of a Gedcom file to a KeyMap. Returns
+// the number of errors.
+static int collectKeys(FILE* fp, String name, KeyMap* map) {
+	String line = null;
+	size_t capacity = 0;
+	int lineNumber = 0, errors = 0;
+	char tag[32];
+	LineFields fields;
+	while (getline(&line, &capacity, fp) >= 0) {
+		lineNumber++;
+		if (!findFields(line, &fields) || fields.level != 0 || !fields.key) continue;
+		int length = fields.tagLength < 31 ? fields.tagLength : 31;
+		memcpy(tag, fields.tag, length);
+		tag[length] = 0;
+		if (!addKey(map, fields.key, fields.keyLength, tagToRecordType(tag))) {
+			fprintf(stderr, "%s: line %d: duplicate key %.*s\n", name, lineNumber, fields.keyLength,
+					fields.key);
+			errors++;
+		}
+	}
+	free(line); // Allocated by getline.
+	return errors;
+}
+
+// writeKey writes the new key of a key of some length. If the key is not in the KeyMap it is
+// written unchanged and false is returned.
+static bool writeKey(FILE* out, KeyMap* map, String key, int length, uint64_t seed) {
+	KeyEl* el = searchKey(map, key, length);
+	if (!el) {
+		fwrite(key, 1, length, out);
+		return false;
+	}
+	char buffer[KEYBUFFERLEN];
+	fputs(permutedRecordKey(el->type, el->index, seed, buffer), out);
+	return true;
+}
+
+// rewriteKeys is the second pass; it copies a Gedcom file to out with the keys replaced. Returns
+// the number of references to undefined keys, which are left unchanged.
+static int rewriteKeys(FILE* fp, String name, FILE* out, KeyMap* map, uint64_t seed) {
+	String line = null;
+	size_t capacity = 0;
+	ssize_t length;
+	int lineNumber = 0, errors = 0;
+	LineFields fields;
+	while ((length = getline(&line, &capacity, fp)) >= 0) {
+		lineNumber++;
+		if (!memchr(line, '@', length) || !findFields(line, &fields)) {
+			fwrite(line, 1, length, out);
+			continue;
+		}
+		String p = line;
+		if (fields.key) {
+			fwrite(p, 1, fields.key - p, out);
+			writeKey(out, map, fields.key, fields.keyLength, seed);
+			p = fields.key + fields.keyLength;
+		}
+		if (fields.value) {
+			fwrite(p, 1, fields.value - p, out);
+			if (!writeKey(out, map, fields.value, fields.valueLength, seed)) {
+				fprintf(stderr, "%s: line %d: undefined key %.*s\n", name, lineNumber,
+						fields.valueLength, fields.value);
+				errors++;
+			}
+			p = fields.value + fields.valueLength;
+		}
+		fwrite(p, 1, line + length - p, out);
+	}
+	free(line); // Allocated by getline.
+	return errors;
+}
+
+// streamRekeyFile rekeys a Gedcom file to out in two passes. Returns the number of errors found;
+// if the first pass finds duplicate keys nothing is written.
+int streamRekeyFile(String path, FILE* out, uint64_t seed) {
+	File* file = openFile(path, "r");
+	if (!file) {
+		fprintf(stderr, "Could not open %s\n", path);
+		return 1;
+	}
+	KeyMap* map = createKeyMap();
+	int errors = collectKeys(file->fp, file->name, map);
+	fprintf(stderr, "randomize keys: %s: collected %u keys.\n", getMsecondsStr(), map->count);
+	if (errors == 0 && map->count > NUMPERMUTEDKEYS) {
+		fprintf(stderr, "%s: too many records to rekey\n", file->name);
+		errors++;
+	}
+	if (errors == 0) {
+		static char buffer[OUTPUTBUFFERSIZE];
+		setvbuf(out, buffer, _IOFBF, OUTPUTBUFFERSIZE);
+		rewind(file->fp);
+		errors = rewriteKeys(file->fp, file->name, out, map, seed);
+		fflush(out);
+		fprintf(stderr, "randomize keys: %s: rewrote file.\n", getMsecondsStr());
+	}
+	deleteKeyMap(map);
+	closeFile(file);
+	return errors;
+}
@@ -10,7 +10,7 @@
 // If DE_GEDCOM_PATH and/or DE_SCRIPTS_PATH are defined, they may be used to find the files.
 //
 // Created by Thomas Wetmore on 21 July 2024
-// Last changed on 7 December 2024.
+// Last changed on 18 October 2026.
 
 #include "runscript.h"
 
@@ -43,6 +43,13 @@ int main(int argc, char* argv[]) {
 	parseProgram(scriptFile, scriptPath);
 	fprintf(stderr, "%s: Script parsed.\n", getMsecondsStr());
 	runScript(database, scriptFile);
+	reclaimVersions(database); // The script's handles to replaced records are gone.
+	if (database->dirty) { // Save the script's edits to the journal.
+		if (commitJournal(database)) fprintf(stderr, "%s: Edits committed.\n", getMsecondsStr());
+		else fprintf(stderr, "Could not commit edits to %s.\n", database->journal->path);
+		if (finishCompaction(database, true)) // A commit may have started one.
+			fprintf(stderr, "%s: Journal compacted.\n", getMsecondsStr());
+	}
 	fprintf(stderr, "%s: RunScript done.\n", getMsecondsStr());
 }
 
@@ -2,7 +2,7 @@
 // main.c is the main procedure of the a program that tests DeadEnds dates.
 //
 // Created by Thomas Wetmore on 4 September 2024.
-// Last changed on 10 September 2024.
+// Last changed on 18 October 2026.
 
 #include <stdio.h>
 #include "standard.h"
@@ -13,6 +13,7 @@
 static void runExtractTest(String date);
 static void outDate(String date, int mod, int day, int month, int year, String yrstr);
 static void testGedDataToken(void);
+static void runParseTest(String date);
 
 int main(int argc, const char * argv[]) {
 	String date;
@@ -21,6 +22,15 @@ int main(int argc, const char * argv[]) {
 	runExtractTest("12/18/1949");
 	runExtractTest("18/12/1949");
 	testGedDataToken();
+	runParseTest("18 December 1949");
+	runParseTest("Dec 1949");
+	runParseTest("ABT 1850");
+	runParseTest("BEF 3 MAR 1800");
+	runParseTest("AFT 1900");
+	runParseTest("BET 1800 AND 1850");
+	runParseTest("FROM JAN 1800 TO FEB 1801");
+	runParseTest("0044 BC");
+	runParseTest("unknown");
 	return 0;
 }
 
@@ -47,3 +57,11 @@ static void runExtractTest(String date) {
 static void outDate(String date, int mod, int day, int month, int year, String yrstr) {
 	printf("%s\t%i\t%i\t%i\t%i\t%s\n", date, mod, day, month, year, yrstr);
 }
+
+// runParseTest tests the parseDate function.
+static void runParseTest(String date) {
+	PackedDate packed;
+	bool parsed = parseDate(date, &packed);
+	printf("%s\t%s\t%d\t%d\t%d\t%d\t%d\t%d\n", date, parsed ? "parsed" : "not parsed", packed.modifier,
+		   packed.day, packed.month, packed.year, packed.minDay, packed.maxDay);
+}
@@ -3,7 +3,7 @@
 //  test.c holds test functions used during development.
 //
 //  Created by Thomas Wetmore on 5 October 2023.
-//  Last changed on 7 December 2024.
+//  Last changed on 18 October 2026.
 
 #include <stdio.h>
 #include "standard.h"
@@ -44,6 +44,10 @@ extern bool validateDatabase(Database*, ErrorLog*);
 extern void testGedcomStrings(int);
 extern void testWriteDatabase(String file, Database*);
 extern void testGedPaths(Database*, int);
+extern void testThreads(Database*, int);
+extern void testDuplicates(int);
+extern void testLineage(Database*, int);
+extern void testSequencePaths(Database*, int);
 
 extern Database* importDatabaseTest(ErrorLog*, int);
 
@@ -65,6 +69,10 @@ int main(void) {
 	//if (database) indexNamesTest(database, ++testNumber);
 	if (database) testSequence(database, ++testNumber);
 	//if (validated) testGedPaths(database, ++testNumber);
+	if (validated) testThreads(database, ++testNumber);
+	testDuplicates(++testNumber);
+	if (validated) testLineage(database, ++testNumber);
+	if (validated) testSequencePaths(database, ++testNumber);
 	//if (validated) forTraverseTest(database, ++testNumber);
 	//if (validated) parseAndRunProgramTest(database, ++testNumber);
 	//if (validated) testWriteDatabase("/Users/ttw4/output.ged", database);
@@ -0,0 +1,220 @@
+// testduplicates.c
+// TestProgram
+//
+// testduplicates.c benchmarks findDuplicatePersons. It writes two synthetic Gedcom files of
+// random families; the second file also holds copies of some families of the first, with typos,
+// shifted and missing dates, and missing places. The copies have keys that point back to their
+// originals (@I12@ becomes @K12@), so the matches found can be checked.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <sys/time.h>
+#include "import.h"
+#include "duplicates.h"
+#include "gedcom.h"
+#include "utils.h"
+
+#define NUMFAMILIES 4000 // Families in each file.
+#define NUMCOPIES 1000 // Families of the first file copied into the second.
+#define MINSCORE 0.85
+
+static String surnames[] = {"Smith", "Johnson", "Williams", "Brown", "Jones", "Miller", "Davis",
+	"Wilson", "Anderson", "Taylor", "Thomas", "Moore", "Martin", "Jackson", "Thompson", "White",
+	"Harris", "Clark", "Lewis", "Robinson", "Walker", "Young", "Allen", "King", "Wright", "Scott",
+	"Hill", "Green", "Adams", "Baker", "Nelson", "Carter", "Mitchell", "Roberts", "Turner",
+	"Phillips", "Campbell", "Parker", "Evans", "Edwards", "Collins", "Stewart", "Morris", "Murphy",
+	"Cook", "Rogers", "Morgan", "Cooper", "Peterson", "Reed", "Bailey", "Bell", "Kelly", "Howard",
+	"Ward", "Cox", "Richardson", "Wood", "Watson", "Brooks", "Bennett", "Gray", "Hughes", "Price",
+	"Sanders", "Myers", "Long", "Ross", "Foster", "Wetmore"};
+static String maleNames[] = {"John", "William", "James", "George", "Charles", "Thomas", "Joseph",
+	"Henry", "Edward", "Samuel", "David", "Robert", "Daniel", "Benjamin", "Frank", "Walter",
+	"Arthur", "Albert", "Harry", "Frederick", "Richard", "Peter", "Isaac", "Nathaniel"};
+static String femaleNames[] = {"Mary", "Elizabeth", "Sarah", "Anna", "Margaret", "Emma", "Alice",
+	"Martha", "Jane", "Catherine", "Ellen", "Harriet", "Susan", "Clara", "Lucy", "Abigail",
+	"Hannah", "Rebecca", "Lydia", "Eliza", "Julia", "Frances", "Caroline", "Louisa"};
+static String towns[] = {"Salem", "Springfield", "Fairfield", "Franklin", "Greenville", "Bristol",
+	"Clinton", "Madison", "Georgetown", "Marion", "Oxford", "Ashland", "Burlington", "Dover"};
+static String states[] = {"Massachusetts", "Connecticut", "New York", "Vermont", "Ohio", "Maine"};
+static String months[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT",
+	"NOV", "DEC"};
+
+#define PICK(array) (array[random() % ARRAYSIZE(array)])
+
+// SynthPerson is a generated person.
+typedef struct SynthPerson {
+	char given[32];
+	String surname;
+	bool male;
+	int year, month, day;
+	String town, state;
+} SynthPerson;
+
+// SynthFamily is a generated family of two parents and their children.
+typedef struct SynthFamily {
+	SynthPerson parents[2];
+	SynthPerson children[4];
+	int numChildren;
+} SynthFamily;
+
+// seconds returns the current time in seconds.
+static double seconds(void) {
+	struct timeval time;
+	gettimeofday(&time, null);
+	return time.tv_sec + time.tv_usec/1000000.0;
+}
+
+// randomPerson generates a person.
+static void randomPerson(SynthPerson* person, String surname, bool male, int year) {
+	strcpy(person->given, male ? PICK(maleNames) : PICK(femaleNames));
+	person->surname = surname;
+	person->male = male;
+	person->year = year;
+	person->month = (int) (random() % 12) + 1;
+	person->day = (int) (random() % 28) + 1;
+	person->town = PICK(towns);
+	person->state = PICK(states);
+}
+
+// randomFamily generates a family.
+static void randomFamily(SynthFamily* family) {
+	String surname = PICK(surnames);
+	int year = 1700 + (int) (random() % 220);
+	randomPerson(&family->parents[0], surname, true, year);
+	randomPerson(&family->parents[1], PICK(surnames), false, year + (int) (random() % 6));
+	family->numChildren = 1 + (int) (random() % 4);
+	for (int i = 0; i < family->numChildren; i++)
+		randomPerson(&family->children[i], surname, random() % 2, year + 20 + 2*i);
+}
+
+// perturbPerson changes a copied person the way a second researcher might have recorded them.
+static void perturbPerson(SynthPerson* person) {
+	int length = (int) strlen(person->given);
+	if (random() % 5 == 0 && length > 3) { // Swap two letters.
+		char c = person->given[1];
+		person->given[1] = person->given[2];
+		person->given[2] = c;
+	}
+	if (random() % 4 == 0) person->year += random() % 2 ? 1 : -1;
+	if (random() % 5 == 0) person->month = 0; // Year only.
+	if (random() % 6 == 0) person->year = 0; // No birth date.
+	if (random() % 5 == 0) person->town = null; // No birth place.
+}
+
+// writePerson writes a person to a Gedcom file.
+static void writePerson(FILE* fp, SynthPerson* person, char prefix, int key, char famPrefix,
+						int famKey, bool isChild) {
+	fprintf(fp, "0 @%c%d@ INDI\n1 NAME %s /%s/\n1 SEX %s\n", prefix, key, person->given,
+			person->surname, person->male ? "M" : "F");
+	if (person->year || person->town) {
+		fprintf(fp, "1 BIRT\n");
+		if (person->year && person->month)
+			fprintf(fp, "2 DATE %d %s %d\n", person->day, months[person->month - 1], person->year);
+		else if (person->year)
+			fprintf(fp, "2 DATE %d\n", person->year);
+		if (person->town) fprintf(fp, "2 PLAC %s, %s\n", person->town, person->state);
+	}
+	fprintf(fp, "1 %s @%c%d@\n", isChild ? "FAMC" : "FAMS", famPrefix, famKey);
+}
+
+// writeFamily writes a family and its persons to a Gedcom file. Persons are numbered from
+// *pkey; they get the keys prefix and the family gets famPrefix.
+static void writeFamily(FILE* fp, SynthFamily* family, char prefix, char famPrefix, int famKey,
+						int* pkey) {
+	int first = *pkey;
+	writePerson(fp, &family->parents[0], prefix, (*pkey)++, famPrefix, famKey, false);
+	writePerson(fp, &family->parents[1], prefix, (*pkey)++, famPrefix, famKey, false);
+	for (int i = 0; i < family->numChildren; i++)
+		writePerson(fp, &family->children[i], prefix, (*pkey)++, famPrefix, famKey, true);
+	fprintf(fp, "0 @%c%d@ FAM\n1 HUSB @%c%d@\n1 WIFE @%c%d@\n", famPrefix, famKey, prefix, first,
+			prefix, first + 1);
+	for (int i = 0; i < family->numChildren; i++)
+		fprintf(fp, "1 CHIL @%c%d@\n", prefix, first + 2 + i);
+}
+
+// writeSyntheticFiles writes the two Gedcom files; returns the number of copied persons.
+static int writeSyntheticFiles(String pathOne, String pathTwo) {
+	srandom(1);
+	SynthFamily* families = (SynthFamily*) stdalloc(NUMFAMILIES*sizeof(SynthFamily));
+	FILE* one = fopen(pathOne, "w");
+	FILE* two = fopen(pathTwo, "w");
+	fprintf(one, "0 HEAD\n");
+	fprintf(two, "0 HEAD\n");
+	int key = 1, copyKey = 1, numCopied = 0;
+	for (int f = 0; f < NUMFAMILIES; f++) {
+		randomFamily(families + f);
+		writeFamily(one, families + f, 'I', 'F', f + 1, &key);
+	}
+	key = 1;
+	for (int f = 0; f < NUMFAMILIES; f++) { // New families, then the copies.
+		SynthFamily family;
+		randomFamily(&family);
+		writeFamily(two, &family, 'J', 'G', f + 1, &key);
+	}
+	for (int f = 0; f < NUMCOPIES; f++) {
+		SynthFamily copy = families[f*(NUMFAMILIES/NUMCOPIES)];
+		for (int i = 0; i < 2; i++) perturbPerson(&copy.parents[i]);
+		for (int i = 0; i < copy.numChildren; i++) perturbPerson(&copy.children[i]);
+		copyKey = 1; // Find the key of the original's first person.
+		for (int g = 0; g < f*(NUMFAMILIES/NUMCOPIES); g++) copyKey += 2 + families[g].numChildren;
+		writeFamily(two, &copy, 'K', 'H', f + 1, &copyKey);
+		numCopied += 2 + copy.numChildren;
+	}
+	fprintf(one, "0 TRLR\n");
+	fprintf(two, "0 TRLR\n");
+	fclose(one);
+	fclose(two);
+	stdfree(families);
+	return numCopied;
+}
+
+// isTrueMatch returns true if the second person of a match is the copy of the first.
+static bool isTrueMatch(DuplicateMatch* match) {
+	String one = match->one->key, two = match->two->key;
+	return two[1] == 'K' && eqstr(one + 2, two + 2);
+}
+
+// testDuplicates runs the duplicate matching benchmark.
+void testDuplicates(int testNumber) {
+	printf("%d: START OF TEST DUPLICATES: %2.3f\n", testNumber, getMseconds());
+	String pathOne = "/tmp/deadends-duplicates-1.ged";
+	String pathTwo = "/tmp/deadends-duplicates-2.ged";
+	int numCopied = writeSyntheticFiles(pathOne, pathTwo);
+	ErrorLog* errorLog = createErrorLog();
+	Database* one = getDatabaseFromFile(pathOne, 0, errorLog);
+	Database* two = getDatabaseFromFile(pathTwo, 0, errorLog);
+	if (!one || !two) {
+		showErrorLog(errorLog);
+		return;
+	}
+	int numOne = lengthList(one->personRoots), numTwo = lengthList(two->personRoots);
+	List* candidates = findDuplicatePersons(one, two, 0.0, 1);
+	printf("%d x %d persons: %d candidate pairs of %ld.\n", numOne, numTwo, lengthList(candidates),
+		   (long) numOne*numTwo);
+	deleteList(candidates);
+	int threads[] = {1, 2, 4, 8};
+	for (int i = 0; i < ARRAYSIZE(threads); i++) {
+		double start = seconds();
+		List* matches = findDuplicatePersons(one, two, MINSCORE, threads[i]);
+		double time = seconds() - start;
+		int numTrue = 0;
+		FORLIST(matches, element)
+			if (isTrueMatch((DuplicateMatch*) element)) numTrue++;
+		ENDLIST
+		int numMatches = lengthList(matches);
+		printf("%d threads: %.3f seconds, %d matches, precision %.3f, recall %.3f.\n", threads[i],
+			   time, numMatches, numMatches ? (double) numTrue/numMatches : 0.0,
+			   (double) numTrue/numCopied);
+		if (i == 0) {
+			int shown = 0;
+			FORLIST(matches, element)
+				if (shown++ < 5) showDuplicateMatch((DuplicateMatch*) element);
+			ENDLIST
+		}
+		deleteList(matches);
+	}
+	deleteDatabase(one);
+	deleteDatabase(two);
+	deleteErrorLog(errorLog);
+	printf("%d: END OF TEST DUPLICATES: %2.3f\n", testNumber, getMseconds());
+}
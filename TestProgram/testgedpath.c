@@ -2,11 +2,13 @@
 // TestProgram
 //
 // Created by Thomas Wetmore on 15 October 2024.
-// Last changed on 16 October 2024.
+// Last changed on 18 October 2026.
 
 #include "database.h"
 #include "gedpath.h"
 #include "gnodelist.h"
+#include "pathindex.h"
+#include "gedcom.h"
 #include "utils.h"
 
 void testGedPaths(Database* database, int testNumber) {
@@ -28,6 +30,18 @@ void testGedPaths(Database* database, int testNumber) {
 		showGNode(0, node);
 		showGNodePath(node, 0);
 	ENDLIST
+	deleteGNodeList(matches, null);
+	deleteGedPath(path);
+
+	// Index the dates of all persons and find the persons with the person's birth date.
+	PathIndex* index = addPathIndex(database, "INDI->ANY*->DATE*", null);
+	showPathIndexStats(index);
+	GNode* birth = person ? BIRT(person) : null;
+	GNode* date = birth ? DATE(birth) : null;
+	if (date) {
+		Set* keys = searchPathIndex(index, date->value);
+		printf("Persons with date %s: %d\n", date->value, keys ? lengthSet(keys) : 0);
+	}
 	printf("%d: END OF TEST GED PATHS: %2.3f\n", testNumber, getMseconds());
 
 }
@@ -0,0 +1,626 @@
+// testlineage.c
+// TestProgram
+//
+// testlineage.c checks the calculators that work on the LineageGraph of a Database, and the
+// UnionFind some of them use, against slower ways of finding the same results.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <stdlib.h>
+#include "database.h"
+#include "lineage.h"
+#include "lineagegraph.h"
+#include "relationship.h"
+#include "kinship.h"
+#include "unionfind.h"
+#include "lineagecounts.h"
+#include "sequence.h"
+#include "lineagecycles.h"
+#include "import.h"
+#include "utils.h"
+
+#define PERSONSTEP 97 // Checks start from every PERSONSTEP-th person.
+#define NUMPARTNERS 6 // Persons whose relationships to each start person are checked.
+#define MAXSMALLPEDIGREE 64 // Most ancestors of a person whose kinships are found the slow way.
+#define COUNTSTEP 7 // Lineage counts are checked for every COUNTSTEP-th person.
+#define MAXESTIMATEERROR 0.1 // Largest mean relative error of the estimated lineage counts.
+#define NUMSYNTHETIC 1000 // Persons of the synthetic file with cycles, before the cycles.
+#define RINGSIZE 100 // Persons on a cycle too large to be searched from every person.
+#define SMALLCYCLEGROUP 64 // Largest group of persons on cycles searched from every person.
+#define NUMELEMENTS 200000 // Elements of the random UnionFind.
+#define NUMEDGES 150000 // Edges of the random UnionFind; enough to be united by several threads.
+
+static bool testRelationships(Database*);
+static bool testKinship(Database*);
+static bool testUnionFind(void);
+static bool testLineageCounts(Database*);
+static bool testAdoptions(void);
+static bool testCycles(Database*);
+
+// testLineage runs the lineage tests.
+void testLineage(Database* database, int testNumber) {
+	printf("%d: START OF TEST LINEAGE: %2.3f\n", testNumber, getMseconds());
+	bool passed = testRelationships(database);
+	passed = testKinship(database) && passed;
+	passed = testUnionFind() && passed;
+	passed = testLineageCounts(database) && passed;
+	passed = testAdoptions() && passed;
+	passed = testCycles(database) && passed;
+	printf("%d: END OF TEST LINEAGE: %s %2.3f\n", testNumber, passed ? "PASSED" : "FAILED",
+		   getMseconds());
+}
+
+// Distances are the generations up from a person to each of its ancestors, found by walking the
+// parents of its record.
+typedef struct Distances {
+	int* distance; // By id; -1 if not an ancestor.
+	int* found; // Ids of the person and its ancestors, in the order found.
+	int numFound;
+} Distances;
+
+// findDistances finds the Distances of a person. The distances of the last person are cleared.
+static void findDistances(LineageGraph* graph, RecordIndex* index, int id, Distances* distances) {
+	for (int i = 0; i < distances->numFound; i++) distances->distance[distances->found[i]] = -1;
+	distances->numFound = 0;
+	distances->distance[id] = 0;
+	distances->found[distances->numFound++] = id;
+	for (int head = 0; head < distances->numFound; head++) {
+		int child = distances->found[head];
+		GNode* person = graph->persons[child];
+		GNode* parents[] = {personToFather(person, index), personToMother(person, index)};
+		for (int i = 0; i < 2; i++) {
+			int parent = parents[i] ? lineageId(graph, parents[i]->key) : -1;
+			if (parent < 0 || distances->distance[parent] >= 0) continue;
+			distances->distance[parent] = distances->distance[child] + 1;
+			distances->found[distances->numFound++] = parent;
+		}
+	}
+}
+
+// initDistances allocates the arrays of Distances for the persons of a LineageGraph.
+static void initDistances(Distances* distances, int numPersons) {
+	distances->distance = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) distances->distance[i] = -1;
+	distances->found = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	distances->numFound = 0;
+}
+
+// termDistances frees the arrays of Distances.
+static void termDistances(Distances* distances) {
+	stdfree(distances->distance);
+	stdfree(distances->found);
+}
+
+// isParent returns true if a person is a parent of another.
+static bool isParent(LineageGraph* graph, int parent, int child) {
+	return graph->parents[2*child] == parent || graph->parents[2*child + 1] == parent;
+}
+
+// checkBlood checks a blood relationship against the Distances of its persons: the ancestor must
+// be nearest to both, and of the nearest the most even, and the path must follow parent links.
+static bool checkBlood(LineageGraph* graph, Relationship* relationship, Distances* one,
+					   Distances* two) {
+	int best = -1, evenness = -1;
+	for (int i = 0; i < one->numFound; i++) {
+		int id = one->found[i];
+		if (two->distance[id] < 0) continue;
+		int sum = one->distance[id] + two->distance[id];
+		int difference = abs(one->distance[id] - two->distance[id]);
+		if (best < 0 || sum < best || (sum == best && difference < evenness)) {
+			best = sum;
+			evenness = difference;
+		}
+	}
+	bool blood = relationship && relationship->spouse < 0;
+	if (best < 0 || !blood) return best < 0 && !blood;
+	int ancestor = relationship->ancestor, up = relationship->up, down = relationship->down;
+	if (one->distance[ancestor] != up || two->distance[ancestor] != down) return false;
+	if (up + down != best || abs(up - down) != evenness) return false;
+	if (relationship->pathLength != up + down + 1) return false;
+	int* path = relationship->path;
+	if (path[0] != relationship->from || path[up] != ancestor ||
+		path[up + down] != relationship->to) return false;
+	for (int i = 0; i < up; i++)
+		if (!isParent(graph, path[i + 1], path[i])) return false;
+	for (int i = up; i < up + down; i++)
+		if (!isParent(graph, path[i], path[i + 1])) return false;
+	return true;
+}
+
+// sameRelationship returns true if two Relationships are the same.
+static bool sameRelationship(Relationship* one, Relationship* two) {
+	if (!one || !two) return one == two;
+	return one->ancestor == two->ancestor && one->spouse == two->spouse && one->up == two->up &&
+		one->down == two->down && eqstr(one->name, two->name);
+}
+
+// pickPartner picks the i-th person whose relationship to a person is checked. The first half
+// are the last children of ancestors of the person, so most are blood relatives; the rest are
+// spread over the graph.
+static int pickPartner(LineageGraph* graph, int from, Distances* ancestors, int i) {
+	if (i >= NUMPARTNERS/2 || ancestors->numFound < 2)
+		return (int) (((long) from*7919 + i*104729) % graph->numPersons);
+	int ancestor = ancestors->found[1 + i*(ancestors->numFound - 1)/(NUMPARTNERS/2)];
+	int last = graph->firstChild[ancestor + 1] - 1;
+	return last >= graph->firstChild[ancestor] ? graph->children[last] : ancestor;
+}
+
+// testRelationships checks the relationships the RelationshipFinder finds, one at a time and for
+// a person with several others at once, against the ancestors found from the records.
+static bool testRelationships(Database* database) {
+	LineageGraph* graph = getDatabaseLineageGraph(database);
+	RecordIndex* index = database->recordIndex;
+	int numPersons = graph->numPersons;
+	RelationshipFinder* finder = createRelationshipFinder(graph);
+	Distances one, two;
+	initDistances(&one, numPersons);
+	initDistances(&two, numPersons);
+	int numPairs = 0, numBlood = 0, numInLaw = 0, numWrong = 0;
+	for (int from = 0; from < numPersons; from += PERSONSTEP) {
+		findDistances(graph, index, from, &one);
+		int to[NUMPARTNERS];
+		Relationship* batch[NUMPARTNERS];
+		for (int i = 0; i < NUMPARTNERS; i++) to[i] = pickPartner(graph, from, &one, i);
+		findRelationships(finder, from, to, NUMPARTNERS, batch);
+		for (int i = 0; i < NUMPARTNERS; i++) {
+			numPairs++;
+			findDistances(graph, index, to[i], &two);
+			Relationship* relationship = findRelationship(finder, from, to[i]);
+			if (relationship && relationship->spouse < 0) numBlood++;
+			else if (relationship) numInLaw++;
+			if (!checkBlood(graph, relationship, &one, &two) ||
+				!sameRelationship(relationship, batch[i])) {
+				numWrong++;
+				printf("Relationship of %s to %s: %s\n", graph->persons[from]->key,
+					   graph->persons[to[i]]->key, relationship ? relationship->name : "none");
+			}
+			deleteRelationship(relationship);
+			deleteRelationship(batch[i]);
+		}
+	}
+	termDistances(&one);
+	termDistances(&two);
+	deleteRelationshipFinder(finder);
+	printf("Relationships: %d pairs, %d by blood, %d by marriage, %d wrong.\n", numPairs, numBlood,
+		   numInLaw, numWrong);
+	return numWrong == 0;
+}
+
+// recordParent returns the id of the father or mother of a person found from its record, or -1.
+static int recordParent(LineageGraph* graph, RecordIndex* index, int id, int which) {
+	if (id < 0) return -1;
+	GNode* person = graph->persons[id];
+	GNode* parent = which == 0 ? personToFather(person, index) : personToMother(person, index);
+	return parent ? lineageId(graph, parent->key) : -1;
+}
+
+// findDepth finds the generations between a person and its furthest ancestor, so a person is
+// deeper than its ancestors. Returns -1 if the person is on or below a parent cycle.
+static int findDepth(LineageGraph* graph, RecordIndex* index, int id, int* depth) {
+	if (id < 0) return 0;
+	if (depth[id] != -1) return depth[id] == -2 ? -1 : depth[id];
+	depth[id] = -2; // Being found.
+	int deepest = 0;
+	for (int which = 0; which < 2; which++) {
+		int parent = recordParent(graph, index, id, which);
+		int parentDepth = parent < 0 ? -1 : findDepth(graph, index, parent, depth);
+		if (parent >= 0 && parentDepth < 0) return -1; // Stays marked, so it is found again as -1.
+		if (parent >= 0 && parentDepth + 1 > deepest) deepest = parentDepth + 1;
+	}
+	return depth[id] = deepest;
+}
+
+// slowKinship finds the kinship coefficient of two persons from the definition, with no cache:
+// a person's kinship with itself is half of one plus the kinship of its parents, and otherwise
+// the deeper person, who can't be an ancestor of the other, is replaced by each of its parents.
+static double slowKinship(LineageGraph* graph, RecordIndex* index, int* depth, int a, int b) {
+	if (a < 0 || b < 0) return 0.0;
+	if (a == b) return (1.0 + slowKinship(graph, index, depth, recordParent(graph, index, a, 0),
+										  recordParent(graph, index, a, 1)))/2.0;
+	if (depth[a] < depth[b]) {
+		int swap = a;
+		a = b;
+		b = swap;
+	}
+	return (slowKinship(graph, index, depth, recordParent(graph, index, a, 0), b) +
+			slowKinship(graph, index, depth, recordParent(graph, index, a, 1), b))/2.0;
+}
+
+// sameCoefficient returns true if two coefficients differ by no more than rounding.
+static bool sameCoefficient(double a, double b) {
+	return a - b <= 1e-12 && b - a <= 1e-12;
+}
+
+// testKinship checks the inbreeding coefficients of persons with small pedigrees, and the
+// kinship coefficients of them with their siblings, against the slow definition. It checks that
+// the coefficients of all persons found together are those found one at a time.
+static bool testKinship(Database* database) {
+	LineageGraph* graph = getDatabaseLineageGraph(database);
+	RecordIndex* index = database->recordIndex;
+	int numPersons = graph->numPersons;
+	Kinship* kinship = createKinship(graph);
+	int* depth = (int*) stdalloc((numPersons + 1)*sizeof(int));
+	for (int i = 0; i < numPersons; i++) depth[i] = -1;
+	for (int i = 0; i < numPersons; i++) findDepth(graph, index, i, depth);
+	Distances ancestors;
+	initDistances(&ancestors, numPersons);
+	int numChecked = 0, numInbred = 0, numWrong = 0;
+	for (int id = 0; id < numPersons; id++) {
+		if (depth[id] < 0) continue;
+		findDistances(graph, index, id, &ancestors);
+		if (ancestors.numFound > MAXSMALLPEDIGREE + 1) continue;
+		numChecked++;
+		double fast = inbreedingCoefficient(kinship, id);
+		double slow = slowKinship(graph, index, depth, recordParent(graph, index, id, 0),
+								  recordParent(graph, index, id, 1));
+		if (slow > 0.0) numInbred++;
+		int father = recordParent(graph, index, id, 0), sibling = id;
+		if (father >= 0 && graph->firstChild[father] < graph->firstChild[father + 1])
+			sibling = graph->children[graph->firstChild[father]];
+		double fastKinship = kinshipCoefficient(kinship, id, sibling);
+		double slowSibling = slowKinship(graph, index, depth, id, sibling);
+		if (!sameCoefficient(fast, slow) || !sameCoefficient(fastKinship, slowSibling)) {
+			numWrong++;
+			printf("Kinship of %s: %g != %g or %g != %g\n", graph->persons[id]->key, fast, slow,
+				   fastKinship, slowSibling);
+		}
+	}
+	double* all = allInbreedingCoefficients(kinship);
+	int numDiffer = 0;
+	for (int id = 0; id < numPersons; id++)
+		if (!sameCoefficient(all[id], inbreedingCoefficient(kinship, id))) numDiffer++;
+	stdfree(all);
+	termDistances(&ancestors);
+	stdfree(depth);
+	deleteKinship(kinship);
+	printf("Kinship: %d small pedigrees, %d inbred, %d wrong; %d of all coefficients differ.\n",
+		   numChecked, numInbred, numWrong, numDiffer);
+	return numWrong == 0 && numDiffer == 0;
+}
+
+// searchComponents numbers the connected components of a graph given as pairs of elements by
+// breadth first searches, in the order of their first elements, and sets the label of each
+// element. Returns the number of components.
+static int searchComponents(int count, int* edges, int numEdges, int* labels) {
+	int* first = (int*) stdalloc((count + 2)*sizeof(int)); // Adjacency lists of the elements.
+	memset(first, 0, (count + 2)*sizeof(int));
+	for (int i = 0; i < 2*numEdges; i++) first[edges[i] + 2]++;
+	for (int i = 0; i < count; i++) first[i + 2] += first[i + 1];
+	int* adjacent = (int*) stdalloc((2*numEdges + 1)*sizeof(int));
+	for (int i = 0; i < numEdges; i++) {
+		adjacent[first[edges[2*i] + 1]++] = edges[2*i + 1];
+		adjacent[first[edges[2*i + 1] + 1]++] = edges[2*i];
+	}
+	int* queue = (int*) stdalloc((count + 1)*sizeof(int));
+	for (int i = 0; i < count; i++) labels[i] = -1;
+	int numComponents = 0;
+	for (int start = 0; start < count; start++) {
+		if (labels[start] >= 0) continue;
+		int head = 0, tail = 0;
+		labels[start] = numComponents;
+		queue[tail++] = start;
+		while (head < tail) {
+			int element = queue[head++];
+			for (int i = first[element]; i < first[element + 1]; i++) {
+				if (labels[adjacent[i]] >= 0) continue;
+				labels[adjacent[i]] = numComponents;
+				queue[tail++] = adjacent[i];
+			}
+		}
+		numComponents++;
+	}
+	stdfree(first);
+	stdfree(adjacent);
+	stdfree(queue);
+	return numComponents;
+}
+
+// testUnionFind checks the components a UnionFind finds from random edges, united by one thread
+// and by several, against breadth first searches.
+static bool testUnionFind(void) {
+	srandom(2);
+	int* edges = (int*) stdalloc(2*NUMEDGES*sizeof(int));
+	for (int i = 0; i < 2*NUMEDGES; i++) edges[i] = (int) (random() % NUMELEMENTS);
+	int* expected = (int*) stdalloc(NUMELEMENTS*sizeof(int));
+	int* labels = (int*) stdalloc(NUMELEMENTS*sizeof(int));
+	int numExpected = searchComponents(NUMELEMENTS, edges, NUMEDGES, expected);
+	bool passed = true;
+	for (int parallel = 0; parallel < 2; parallel++) {
+		UnionFind* unionFind = createUnionFind(NUMELEMENTS);
+		uniteEdges(unionFind, edges, NUMEDGES, parallel);
+		int numComponents = labelComponents(unionFind, labels);
+		deleteUnionFind(unionFind);
+		bool same = numComponents == numExpected &&
+			memcmp(labels, expected, NUMELEMENTS*sizeof(int)) == 0;
+		printf("UnionFind%s: %d components, %d expected: %s.\n", parallel ? " in parallel" : "",
+			   numComponents, numExpected, same ? "same" : "different");
+		passed = passed && same;
+	}
+	stdfree(edges);
+	stdfree(expected);
+	stdfree(labels);
+	return passed;
+}
+
+// slowCount returns the number of ancestors or descendents of a person found with a Sequence.
+static int slowCount(Database* database, GNode* person, bool ancestors) {
+	Sequence* start = createSequence(database->recordIndex);
+	appendToSequence(start, person->key, null);
+	Sequence* found = ancestors ? ancestorSequence(start, database, false, 0)
+		: descendentSequence(start, database, false, 0);
+	int count = lengthSequence(found);
+	deleteSequence(start);
+	deleteSequence(found);
+	return count;
+}
+
+// testLineageCounts checks the exact numbers of ancestors and descendents of persons against the
+// lengths of their ancestor and descendent Sequences, and checks that the estimated numbers are
+// near them.
+static bool testLineageCounts(Database* database) {
+	LineageGraph* graph = getDatabaseLineageGraph(database);
+	LineageCounts* exact = getLineageCounts(graph, lineageExact);
+	LineageCounts* estimated = getLineageCounts(graph, lineageEstimate);
+	int numChecked = 0, numWrong = 0, numEstimated = 0;
+	double error = 0.0, maxError = 0.0;
+	for (int id = 0; id < graph->numPersons; id += COUNTSTEP) {
+		numChecked++;
+		int counts[] = {slowCount(database, graph->persons[id], true),
+			slowCount(database, graph->persons[id], false)};
+		int exacts[] = {exact->ancestors[id], exact->descendents[id]};
+		int estimates[] = {estimated->ancestors[id], estimated->descendents[id]};
+		for (int i = 0; i < 2; i++) {
+			if (exacts[i] != counts[i]) {
+				numWrong++;
+				printf("Lineage count of %s: %d != %d\n", graph->persons[id]->key, exacts[i],
+					   counts[i]);
+			}
+			if (counts[i] == 0) continue;
+			double relative = (double) abs(estimates[i] - counts[i])/counts[i];
+			error += relative;
+			if (relative > maxError) maxError = relative;
+			numEstimated++;
+		}
+	}
+	if (numEstimated) error /= numEstimated;
+	bool passed = numWrong == 0 && !exact->estimated && estimated->estimated &&
+		error <= MAXESTIMATEERROR;
+	printf("Lineage counts: %d persons, %d wrong; estimates off by %.3f on average, %.3f most.\n",
+		   numChecked, numWrong, error, maxError);
+	deleteLineageCounts(exact);
+	deleteLineageCounts(estimated);
+	return passed;
+}
+
+// recordCount returns the number of ancestors or descendents of a person found by walking the
+// records: the HUSBs and WIFEs of every FAMC family, or the CHILs of every FAMS family.
+static int recordCount(RecordIndex* index, GNode* person, bool ancestors) {
+	StringTable* found = createStringTable(61);
+	Block queue;
+	initBlock(&queue);
+	appendToBlock(&queue, person);
+	addToStringTable(found, person->key, null);
+	for (int head = 0; head < queue.length; head++) {
+		GNode* root = (GNode*) queue.elements[head];
+		for (GNode* link = root->child; link; link = link->sibling) {
+			if (!eqstr(link->tag, ancestors ? "FAMC" : "FAMS")) continue;
+			GNode* family = searchRecordIndex(index, link->value);
+			for (GNode* node = family ? family->child : null; node; node = node->sibling) {
+				bool member = ancestors ? eqstr(node->tag, "HUSB") || eqstr(node->tag, "WIFE")
+					: eqstr(node->tag, "CHIL");
+				if (!member || isInStringTable(found, node->value)) continue;
+				GNode* next = searchRecordIndex(index, node->value);
+				if (!next) continue;
+				addToStringTable(found, node->value, null);
+				appendToBlock(&queue, next);
+			}
+		}
+	}
+	int count = queue.length - 1;
+	deleteBlock(&queue, null);
+	deleteHashTable(found);
+	return count;
+}
+
+// testAdoptions checks the lineage counts of a file where a person has birth and adoptive
+// families that share a mother. The person must count the ancestors of both families once, and
+// every count must match a walk of the records.
+static bool testAdoptions(void) {
+	String path = "/tmp/deadends-adoptions.ged";
+	FILE* fp = fopen(path, "w");
+	fprintf(fp, "0 HEAD\n"
+			"0 @I1@ INDI\n1 SEX M\n1 FAMC @F1@\n1 FAMC @F2@\n"
+			"0 @I2@ INDI\n1 SEX M\n1 FAMS @F1@\n1 FAMC @F3@\n"
+			"0 @I3@ INDI\n1 SEX F\n1 FAMS @F1@\n1 FAMS @F2@\n"
+			"0 @I4@ INDI\n1 SEX M\n1 FAMS @F2@\n1 FAMC @F4@\n"
+			"0 @I6@ INDI\n1 SEX M\n1 FAMS @F3@\n"
+			"0 @I7@ INDI\n1 SEX F\n1 FAMS @F4@\n"
+			"0 @F1@ FAM\n1 HUSB @I2@\n1 WIFE @I3@\n1 CHIL @I1@\n"
+			"0 @F2@ FAM\n1 HUSB @I4@\n1 WIFE @I3@\n1 CHIL @I1@\n"
+			"0 @F3@ FAM\n1 HUSB @I6@\n1 CHIL @I2@\n"
+			"0 @F4@ FAM\n1 WIFE @I7@\n1 CHIL @I4@\n"
+			"0 TRLR\n");
+	fclose(fp);
+	ErrorLog* errorLog = createErrorLog();
+	RecordIndex* index = getRecordIndexFromFile(path, null, null, null, errorLog);
+	if (!index) {
+		showErrorLog(errorLog);
+		return false;
+	}
+	LineageGraph* graph = getLineageGraph(index);
+	LineageCounts* counts = getLineageCounts(graph, lineageExact);
+	int numWrong = 0;
+	for (int id = 0; id < graph->numPersons; id++) {
+		GNode* person = graph->persons[id];
+		if (counts->ancestors[id] != recordCount(index, person, true) ||
+			counts->descendents[id] != recordCount(index, person, false)) numWrong++;
+	}
+	int adopted = lineageId(graph, "@I1@");
+	bool passed = numWrong == 0 && adopted >= 0 && counts->ancestors[adopted] == 5;
+	printf("Adoptions: %d persons, %d counts wrong.\n", graph->numPersons, numWrong);
+	deleteLineageCounts(counts);
+	deleteLineageGraph(graph);
+	FORHASHTABLE(index, element)
+		freeGNodes((GNode*) element);
+	ENDHASHTABLE
+	deleteRecordIndex(index);
+	deleteErrorLog(errorLog);
+	return passed;
+}
+
+// slowCycle returns the length of a shortest cycle of parent links through a person, found by
+// walking the parents of the records, or 0 if the person isn't their own ancestor.
+static int slowCycle(LineageGraph* graph, RecordIndex* index, int id, Distances* distances) {
+	findDistances(graph, index, id, distances);
+	int shortest = 0;
+	for (int i = 0; i < distances->numFound; i++) {
+		int ancestor = distances->found[i];
+		for (int which = 0; which < 2; which++) {
+			int length = distances->distance[ancestor] + 1;
+			if (recordParent(graph, index, ancestor, which) != id) continue;
+			if (!shortest || length < shortest) shortest = length;
+		}
+	}
+	return shortest;
+}
+
+// checkCycles checks the AncestryCycles found in a LineageGraph against the records. Each cycle
+// must follow parent links, there must be one cycle for each group of persons who are each
+// other's ancestors, and each cycle must be a shortest one through its first person, and through
+// any person of its group if the group is small.
+static bool checkCycles(LineageGraph* graph, RecordIndex* index, String name) {
+	int numPersons = graph->numPersons;
+	Distances mine, theirs;
+	initDistances(&mine, numPersons);
+	initDistances(&theirs, numPersons);
+	int* length = (int*) stdalloc((numPersons + 1)*sizeof(int)); // Of a shortest cycle, or 0.
+	int* group = (int*) stdalloc((numPersons + 1)*sizeof(int)); // -1 if on no cycle.
+	int numOnCycles = 0, numGroups = 0;
+	for (int id = 0; id < numPersons; id++) {
+		length[id] = slowCycle(graph, index, id, &mine);
+		group[id] = -1;
+		if (length[id]) numOnCycles++;
+	}
+	for (int id = 0; id < numPersons; id++) { // Persons in a group are ancestors of each other.
+		if (!length[id] || group[id] >= 0) continue;
+		findDistances(graph, index, id, &mine);
+		for (int i = 0; i < mine.numFound; i++) {
+			int ancestor = mine.found[i];
+			if (!length[ancestor] || group[ancestor] >= 0) continue;
+			findDistances(graph, index, ancestor, &theirs);
+			if (theirs.distance[id] >= 0) group[ancestor] = numGroups;
+		}
+		group[id] = numGroups++;
+	}
+	List* cycles = findAncestryCycles(graph);
+	int numWrong = 0;
+	bool* hasCycle = (bool*) stdalloc(numGroups + 1);
+	memset(hasCycle, 0, numGroups + 1);
+	FORLIST(cycles, element)
+		AncestryCycle* cycle = (AncestryCycle*) element;
+		int first = cycle->persons[0], shortest = length[first];
+		bool okay = group[first] >= 0 && !hasCycle[group[first]] && cycle->length == shortest;
+		for (int i = 0; okay && i < cycle->length; i++) {
+			int person = cycle->persons[i], parent = cycle->persons[(i + 1)%cycle->length];
+			okay = group[person] == group[first] && isParent(graph, parent, person);
+		}
+		int size = 0;
+		for (int id = 0; okay && id < numPersons; id++) {
+			if (group[id] != group[first]) continue;
+			size++;
+			if (length[id] < shortest) shortest = length[id];
+		}
+		if (size <= SMALLCYCLEGROUP && shortest != cycle->length) okay = false;
+		if (okay) hasCycle[group[first]] = true;
+		else {
+			numWrong++;
+			printf("Cycle from %s of length %d is wrong.\n", graph->persons[first]->key,
+				   cycle->length);
+		}
+	ENDLIST
+	bool passed = numWrong == 0 && lengthList(cycles) == numGroups;
+	printf("Cycles in %s: %d persons on cycles in %d groups; %d cycles found, %d wrong.\n", name,
+		   numOnCycles, numGroups, lengthList(cycles), numWrong);
+	deleteList(cycles);
+	stdfree(hasCycle);
+	stdfree(length);
+	stdfree(group);
+	termDistances(&mine);
+	termDistances(&theirs);
+	return passed;
+}
+
+// writeCycleFile writes a Gedcom file of random families over several generations, with cycles
+// added: a person who is their own father, two men who are each other's fathers, three persons
+// with cycles of two and three, a ring of RINGSIZE men, and a founder made the son of a man who
+// descends from him through his sons. Every person with parents has a family of their own.
+static void writeCycleFile(String path) {
+	int numPersons = NUMSYNTHETIC + 10 + 2*RINGSIZE;
+	int* father = (int*) stdalloc(numPersons*sizeof(int));
+	int* mother = (int*) stdalloc(numPersons*sizeof(int));
+	srandom(3);
+	for (int i = 0; i < numPersons; i++) { // Even persons are men.
+		father[i] = mother[i] = -1;
+		if (i < 40 || i >= NUMSYNTHETIC) continue;
+		father[i] = 2*(int) (random() % (i/2));
+		mother[i] = 2*(int) (random() % (i/2)) + 1;
+	}
+	int n = NUMSYNTHETIC;
+	father[n] = n; // Their own father.
+	father[n + 2] = n + 4; // Each other's fathers.
+	father[n + 4] = n + 2;
+	father[n + 6] = n + 8; // Cycles of two and three.
+	mother[n + 6] = n + 7;
+	mother[n + 8] = n + 7;
+	father[n + 7] = n + 6;
+	for (int k = 0; k < RINGSIZE; k++) father[n + 10 + 2*k] = n + 10 + 2*((k + 1)%RINGSIZE);
+	int founder = NUMSYNTHETIC - 2;
+	while (father[founder] >= 0) founder = father[founder];
+	father[founder] = NUMSYNTHETIC - 2; // Son of his descendent.
+	FILE* fp = fopen(path, "w");
+	fprintf(fp, "0 HEAD\n");
+	for (int i = 0; i < numPersons; i++) {
+		fprintf(fp, "0 @I%d@ INDI\n1 NAME Person /Number%d/\n1 SEX %s\n", i, i, i%2 ? "F" : "M");
+		if (father[i] >= 0 || mother[i] >= 0) fprintf(fp, "1 FAMC @F%d@\n", i);
+		for (int j = 0; j < numPersons; j++)
+			if (father[j] == i || mother[j] == i) fprintf(fp, "1 FAMS @F%d@\n", j);
+	}
+	for (int i = 0; i < numPersons; i++) {
+		if (father[i] < 0 && mother[i] < 0) continue;
+		fprintf(fp, "0 @F%d@ FAM\n", i);
+		if (father[i] >= 0) fprintf(fp, "1 HUSB @I%d@\n", father[i]);
+		if (mother[i] >= 0) fprintf(fp, "1 WIFE @I%d@\n", mother[i]);
+		fprintf(fp, "1 CHIL @I%d@\n", i);
+	}
+	fprintf(fp, "0 TRLR\n");
+	fclose(fp);
+	stdfree(father);
+	stdfree(mother);
+}
+
+// testCycles checks the ancestry cycles of a Database, which has none, and of a synthetic file.
+// The synthetic file is read without importing it, since importing rejects cycles.
+static bool testCycles(Database* database) {
+	bool passed = checkCycles(getDatabaseLineageGraph(database), database->recordIndex,
+							  database->name);
+	String path = "/tmp/deadends-cycles.ged";
+	writeCycleFile(path);
+	ErrorLog* errorLog = createErrorLog();
+	RecordIndex* index = getRecordIndexFromFile(path, null, null, null, errorLog);
+	if (!index) {
+		showErrorLog(errorLog);
+		return false;
+	}
+	LineageGraph* graph = getLineageGraph(index);
+	passed = checkCycles(graph, index, "the synthetic file") && passed;
+	int numCycles = checkAncestryCycles(graph, path, null, errorLog);
+	passed = passed && numCycles == lengthList(errorLog) && numCycles > 0;
+	deleteLineageGraph(graph);
+	FORHASHTABLE(index, element)
+		freeGNodes((GNode*) element);
+	ENDHASHTABLE
+	deleteRecordIndex(index);
+	deleteErrorLog(errorLog);
+	return passed;
+}
@@ -0,0 +1,593 @@
+// testseqpaths.c
+// TestProgram
+//
+// testseqpaths.c checks the fast paths of Sequences against the slower ways of finding the same
+// results.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <ctype.h>
+#include <stdlib.h>
+#include "database.h"
+#include "name.h"
+#include "sequence.h"
+#include "seqbitmap.h"
+#include "seqpipeline.h"
+#include "seqexport.h"
+#include "stringtable.h"
+#include "import.h"
+#include "utils.h"
+
+#define NUMBITMAPIDS 330000 // Range of the ids of the random SequenceBitmaps; six chunks.
+#define NUMBITMAPTRIALS 4 // Pairs of random SequenceBitmaps.
+#define NUMSETTRIALS 4 // Pairs of random Sequences of persons.
+#define NUMPIPELINES 300 // Random chains of lazy Sequence operations.
+#define LONGPIPELINE 25 // Every LONGPIPELINE-th chain has more steps than a pipeline holds.
+#define NUMNAMEPAIRS 200000 // Random pairs of names whose collation keys are compared.
+#define NUMEXPORTS 5 // Subsets exported.
+
+static bool testBitmaps(void);
+static bool testSetOperations(Database*);
+static bool testPipelines(Database*);
+static bool testCollation(Database*);
+static bool testExports(Database*);
+
+// testSequencePaths runs the Sequence path tests.
+void testSequencePaths(Database* database, int testNumber) {
+	printf("%d: START OF TEST SEQUENCE PATHS: %2.3f\n", testNumber, getMseconds());
+	bool passed = testBitmaps();
+	passed = testSetOperations(database) && passed;
+	passed = testPipelines(database) && passed;
+	passed = testCollation(database) && passed;
+	passed = testExports(database) && passed;
+	printf("%d: END OF TEST SEQUENCE PATHS: %s %2.3f\n", testNumber, passed ? "PASSED" : "FAILED",
+		   getMseconds());
+}
+
+// sameBitmap returns true if a SequenceBitmap holds the ids that are true in an array.
+static bool sameBitmap(SequenceBitmap* bitmap, bool* expected, int* ids) {
+	int count = sequenceBitmapToArray(bitmap, ids);
+	if (count != lengthSequenceBitmap(bitmap)) return false;
+	int next = 0;
+	for (int id = 0; id < NUMBITMAPIDS; id++) {
+		if (isInSequenceBitmap(bitmap, id) != expected[id]) return false;
+		if (!expected[id]) continue;
+		if (next >= count || ids[next] != id) return false;
+		next++;
+	}
+	return next == count;
+}
+
+// randomIds fills an array with random ids, with a density that changes from chunk to chunk so
+// some chunks are arrays, some are bit sets, and some are near the size where one becomes the
+// other. Returns the SequenceBitmap of the ids, added out of order and some of them twice.
+static SequenceBitmap* randomIds(bool* ids, int trial) {
+	static const int densities[] = {500, 10, 61, 64, 900, 0, 1000}; // Per thousand.
+	int numDensities = sizeof(densities)/sizeof(int);
+	SequenceBitmap* bitmap = createSequenceBitmap();
+	for (int id = 0; id < NUMBITMAPIDS; id++) {
+		int density = densities[((id >> 16) + trial) % numDensities];
+		ids[id] = random() % 1000 < density;
+	}
+	for (int id = NUMBITMAPIDS - 1; id >= 0; id -= 2)
+		if (ids[id]) addToSequenceBitmap(bitmap, id);
+	for (int id = 0; id < NUMBITMAPIDS; id++)
+		if (ids[id] && (id % 2 == 0 || id % 7 == 0)) addToSequenceBitmap(bitmap, id);
+	return bitmap;
+}
+
+// testBitmaps checks the unions, intersections and differences of random SequenceBitmaps against
+// those of arrays of flags.
+static bool testBitmaps(void) {
+	srandom(4);
+	bool* one = (bool*) stdalloc(NUMBITMAPIDS*sizeof(bool));
+	bool* two = (bool*) stdalloc(NUMBITMAPIDS*sizeof(bool));
+	bool* expected = (bool*) stdalloc(NUMBITMAPIDS*sizeof(bool));
+	int* ids = (int*) stdalloc((NUMBITMAPIDS + 1)*sizeof(int));
+	int numWrong = 0;
+	for (int trial = 0; trial < NUMBITMAPTRIALS; trial++) {
+		SequenceBitmap* first = randomIds(one, trial);
+		SequenceBitmap* second = randomIds(two, 2*trial + 1);
+		SequenceBitmap* empty = createSequenceBitmap();
+		SequenceBitmap* copy = copySequenceBitmap(first);
+		if (!sameBitmap(first, one, ids) || !sameBitmap(copy, one, ids)) numWrong++;
+		SequenceBitmap* results[] = {unionSequenceBitmap(first, second),
+			intersectSequenceBitmap(first, second), differenceSequenceBitmap(first, second),
+			differenceSequenceBitmap(second, first), unionSequenceBitmap(first, empty),
+			intersectSequenceBitmap(empty, second)};
+		for (int i = 0; i < 6; i++) {
+			for (int id = 0; id < NUMBITMAPIDS; id++) {
+				switch (i) {
+				case 0: expected[id] = one[id] || two[id]; break;
+				case 1: expected[id] = one[id] && two[id]; break;
+				case 2: expected[id] = one[id] && !two[id]; break;
+				case 3: expected[id] = two[id] && !one[id]; break;
+				case 4: expected[id] = one[id]; break;
+				case 5: expected[id] = false; break;
+				}
+			}
+			if (!sameBitmap(results[i], expected, ids)) {
+				printf("SequenceBitmap operation %d of trial %d is wrong.\n", i, trial);
+				numWrong++;
+			}
+			deleteSequenceBitmap(results[i]);
+		}
+		deleteSequenceBitmap(first);
+		deleteSequenceBitmap(second);
+		deleteSequenceBitmap(empty);
+		deleteSequenceBitmap(copy);
+	}
+	printf("SequenceBitmaps: %d trials of %d ids, %d wrong.\n", NUMBITMAPTRIALS, NUMBITMAPIDS,
+		   numWrong);
+	stdfree(one);
+	stdfree(two);
+	stdfree(expected);
+	stdfree(ids);
+	return numWrong == 0;
+}
+
+// allPersons returns an array of the persons in a RecordIndex.
+static GNode** allPersons(RecordIndex* index, int* numPersons) {
+	GNode** persons = (GNode**) stdalloc((sizeHashTable(index) + 1)*sizeof(GNode*));
+	*numPersons = 0;
+	FORHASHTABLE(index, element)
+		GNode* root = (GNode*) element;
+		if (recordType(root) == GRPerson) persons[(*numPersons)++] = root;
+	ENDHASHTABLE
+	return persons;
+}
+
+// sameElements returns true if two Sequences have the same records in the same order.
+static bool sameElements(Sequence* one, Sequence* two) {
+	if (lengthSequence(one) != lengthSequence(two)) return false;
+	for (int i = 0; i < lengthSequence(one); i++) {
+		String key1, key2, name;
+		elementFromSequence(one, i, &key1, &name);
+		elementFromSequence(two, i, &key2, &name);
+		if (!eqstr(key1, key2)) return false;
+	}
+	return true;
+}
+
+// randomPersons appends random persons to two Sequences, one without values, whose set operations
+// use bitmaps, and one with values, whose set operations sort and merge. Flags the persons added.
+static void randomPersons(GNode** persons, int numPersons, int density, bool* in, Sequence* fast,
+						  Sequence* slow) {
+	static int value;
+	for (int i = 0; i < numPersons; i++) in[i] = random() % 1000 < density;
+	for (int i = numPersons - 1; i >= 0; i--) {
+		if (!in[i]) continue;
+		appendRootToSequence(fast, persons[i], null);
+		appendRootToSequence(slow, persons[i], &value);
+		if (i % 5 == 0) appendRootToSequence(fast, persons[i], null);
+	}
+}
+
+// testSetOperations checks the unions, intersections and differences of large Sequences of
+// persons, found with bitmaps, against those found by sorting and merging.
+static bool testSetOperations(Database* database) {
+	static const int densities[] = {10, 100, 500, 950}; // Per thousand.
+	srandom(5);
+	RecordIndex* index = database->recordIndex;
+	int numPersons;
+	GNode** persons = allPersons(index, &numPersons);
+	bool* inOne = (bool*) stdalloc((numPersons + 1)*sizeof(bool));
+	bool* inTwo = (bool*) stdalloc((numPersons + 1)*sizeof(bool));
+	int numWrong = 0, numBitmap = 0;
+	for (int trial = 0; trial < NUMSETTRIALS; trial++) {
+		Sequence* one = createSequence(index);
+		Sequence* two = createSequence(index);
+		Sequence* slowOne = createSequence(index);
+		Sequence* slowTwo = createSequence(index);
+		randomPersons(persons, numPersons, densities[trial], inOne, one, slowOne);
+		randomPersons(persons, numPersons, densities[NUMSETTRIALS - trial - 1], inTwo, two,
+					  slowTwo);
+		for (int i = 0; i < numPersons; i++)
+			if (isInSequence(one, persons[i]->key) != inOne[i]) numWrong++;
+		Sequence* fast[] = {unionSequence(one, two), intersectSequence(one, two),
+			differenceSequence(one, two), differenceSequence(two, one)};
+		Sequence* slow[] = {unionSequence(slowOne, slowTwo), intersectSequence(slowOne, slowTwo),
+			differenceSequence(slowOne, slowTwo), differenceSequence(slowTwo, slowOne)};
+		Sequence* fastAgain = differenceSequence(fast[0], two); // Bitmap of a bitmap result.
+		Sequence* slowAgain = differenceSequence(slow[0], slowTwo);
+		for (int i = 0; i < 4; i++) {
+			if (fast[i]->inBitmap) numBitmap++;
+			if (slow[i]->inBitmap || !sameElements(fast[i], slow[i])) {
+				printf("Set operation %d of trial %d is wrong.\n", i, trial);
+				numWrong++;
+			}
+			deleteSequence(fast[i]);
+			deleteSequence(slow[i]);
+		}
+		if (!sameElements(fastAgain, slowAgain)) numWrong++;
+		deleteSequence(fastAgain);
+		deleteSequence(slowAgain);
+		deleteSequence(one);
+		deleteSequence(two);
+		deleteSequence(slowOne);
+		deleteSequence(slowTwo);
+	}
+	printf("Set operations: %d trials of %d persons, %d with bitmaps, %d wrong.\n", NUMSETTRIALS,
+		   numPersons, numBitmap, numWrong);
+	stdfree(persons);
+	stdfree(inOne);
+	stdfree(inTwo);
+	return numWrong == 0 && numBitmap == 4*NUMSETTRIALS;
+}
+
+// eagerSequenceOp returns the result of an operation on a Sequence found right away.
+static Sequence* eagerSequenceOp(SequenceOp op, Sequence* sequence, int limit, Database* database) {
+	switch (op) {
+	case seqParents: return parentSequence(sequence);
+	case seqChildren: return childSequence(sequence);
+	case seqSpouses: return spouseSequence(sequence);
+	case seqAncestors: return ancestorSequence(sequence, database, false, limit);
+	case seqDescendents: return descendentSequence(sequence, database, false, limit);
+	default: return null;
+	}
+}
+
+// sameValues returns true if two Sequences have the same records with the same values in the
+// same order.
+static bool sameValues(Sequence* one, Sequence* two) {
+	materializeSequence(one);
+	materializeSequence(two);
+	if (one->length != two->length) return false;
+	for (int i = 0; i < one->length; i++)
+		if (one->roots[i] != two->roots[i] || one->values[i] != two->values[i]) return false;
+	return true;
+}
+
+// testPipelines checks lazy Sequences made by random chains of parent, child, spouse, ancestor and
+// descendent operations against the Sequences the eager functions find at each step. Lengths are
+// checked before the elements are made, and copies, long chains, and pipelines run because they
+// are pending are checked too.
+static bool testPipelines(Database* database) {
+	static const SequenceOp ops[] = {seqParents, seqChildren, seqSpouses, seqAncestors,
+		seqDescendents};
+	static int values[5];
+	srandom(6);
+	RecordIndex* index = database->recordIndex;
+	int numPersons;
+	GNode** persons = allPersons(index, &numPersons);
+	int numWrong = 0, numFound = 0;
+	for (int chain = 0; chain < NUMPIPELINES; chain++) {
+		Sequence* eager = createSequence(index);
+		int numStart = 1 + (int) (random() % 5);
+		for (int i = 0; i < numStart; i++) {
+			void* value = random() % 2 ? &values[i] : null;
+			appendRootToSequence(eager, persons[random() % numPersons], value);
+		}
+		Sequence* lazy = copySequence(eager);
+		int numSteps = chain % LONGPIPELINE ? 1 + (int) (random() % 4) : MAXPIPELINESTEPS + 2;
+		for (int step = 0; step < numSteps; step++) {
+			SequenceOp op = ops[random() % 5];
+			int limit = (int) (random() % 4);
+			if (chain % LONGPIPELINE == 0) op = step % 2 ? seqChildren : seqParents;
+			Sequence* nextEager = eagerSequenceOp(op, eager, limit, database);
+			Sequence* nextLazy = lazySequenceOp(op, lazy, limit, database);
+			deleteSequence(eager);
+			deleteSequence(lazy);
+			eager = nextEager;
+			lazy = nextLazy;
+		}
+		if (chain % 2 && lengthSequence(lazy) != lengthSequence(eager)) numWrong++;
+		Sequence* copy = copySequence(lazy);
+		if (chain % 3 == 0) runPendingSequences();
+		if ((chain % 3 == 0 && (lazy->pipeline || copy->pipeline)) || !sameValues(lazy, eager) ||
+			!sameValues(copy, eager)) {
+			printf("Pipeline %d of %d steps is wrong.\n", chain, numSteps);
+			numWrong++;
+		}
+		numFound += lengthSequence(eager);
+		deleteSequence(eager);
+		deleteSequence(lazy);
+		deleteSequence(copy);
+	}
+	printf("Pipelines: %d chains, %d persons found, %d wrong.\n", NUMPIPELINES, numFound,
+		   numWrong);
+	stdfree(persons);
+	return numWrong == 0;
+}
+
+// sign returns the sign of a comparison.
+static int sign(int compare) { return compare < 0 ? -1 : compare > 0; }
+
+// compareNamesIndirect is the qsort compare function for an array of names.
+static int compareNamesIndirect(const void* a, const void* b) {
+	return compareNames(*(String*) a, *(String*) b);
+}
+
+// sameCollation returns true if the collation keys of two names compare as the names do.
+static bool sameCollation(String name1, String name2) {
+	char key1[COLLATIONKEYLEN], key2[COLLATIONKEYLEN];
+	nameCollationKeyInBuffer(name1, false, key1);
+	nameCollationKeyInBuffer(name2, false, key2);
+	if (sign(strcmp(key1, key2)) == sign(compareNames(name1, name2))) return true;
+	printf("Collation of \"%s\" and \"%s\" is wrong.\n", name1, name2);
+	return false;
+}
+
+// isAscii returns true if a name is all ASCII.
+static bool isAscii(String name) {
+	for (; *name; name++)
+		if ((unsigned char) *name >= 0x80) return false;
+	return true;
+}
+
+// sameFolded returns true if the folded collation key of a name is the key of another name.
+static bool sameFolded(String name, String folded) {
+	char key1[COLLATIONKEYLEN], key2[COLLATIONKEYLEN];
+	nameCollationKeyInBuffer(name, true, key1);
+	nameCollationKeyInBuffer(folded, false, key2);
+	if (eqstr(key1, key2)) return true;
+	printf("Folded collation key of \"%s\" is wrong.\n", name);
+	return false;
+}
+
+// testCollation checks that collation keys compare as compareNames compares their names, on
+// random pairs of the names of the persons of a Database, on names that sort next to each other,
+// and on names with odd forms. It checks that a name sorted Sequence is in the order of a sort
+// with compareNames, and that folded keys ignore case and Latin-1 diacritics.
+static bool testCollation(Database* database) {
+	static String oddNames[] = {"", "/Smith/", "John", "John /Smith/", "John Jr /Smith/",
+		"/Smith/ John", "John  Paul /Smith/ Jr", "john /smith/", "John /Smith", "John //",
+		"1John /Smith/", "John /Smit/", "John /Smith Jones/", "John\t/Smith/", "J /Smith/",
+		"Jo /Smith/", "John /Smith/ /Jones/", "John / Smith /", "/_Smith/", "John /1Smith/",
+		"\xC3\x88ve /Dupr\xC3\xA9/", "Eve /Dupre/", "John Paul", "John Paula /Smith/"};
+	int numOdd = sizeof(oddNames)/sizeof(String);
+	srandom(7);
+	RecordIndex* index = database->recordIndex;
+	int numPersons, numNames = 0, numWrong = 0;
+	GNode** persons = allPersons(index, &numPersons);
+	String* names = (String*) stdalloc((numPersons + numOdd + 1)*sizeof(String));
+	for (int i = 0; i < numPersons; i++)
+		if (NAME(persons[i])) names[numNames++] = NAME(persons[i])->value;
+	for (int i = 0; i < NUMNAMEPAIRS; i++)
+		if (!sameCollation(names[random() % numNames], names[random() % numNames])) numWrong++;
+
+	Sequence* sequence = createSequence(index); // Name sort against a sort with compareNames.
+	for (int i = 0; i < numPersons; i++) appendRootToSequence(sequence, persons[i], null);
+	nameSortSequence(sequence);
+	qsort(names, numNames, sizeof(String), compareNamesIndirect);
+	int numSorted = 0;
+	for (int i = 0; i < numPersons; i++) {
+		String name = sequence->names[i];
+		if (!name && numSorted == 0) continue; // Persons without names sort first.
+		if (!name || numSorted >= numNames || compareNames(name, names[numSorted++])) {
+			printf("Name sort of %s is wrong.\n", sequence->roots[i]->key);
+			numWrong++;
+			break;
+		}
+	}
+	deleteSequence(sequence);
+
+	for (int i = 0; i < numOdd; i++) {
+		names[numNames++] = oddNames[i];
+		for (int j = 0; j < numOdd; j++)
+			if (!sameCollation(oddNames[i], oddNames[j])) numWrong++;
+	}
+	qsort(names, numNames, sizeof(String), compareNamesIndirect);
+	for (int i = 1; i < numNames; i++)
+		if (!sameCollation(names[i - 1], names[i])) numWrong++;
+
+	char upper[MAXLINELEN + 1];
+	int numFolded = 0;
+	for (int i = 0; i < numNames; i++) {
+		if (!isAscii(names[i]) || strlen(names[i]) > MAXLINELEN) continue;
+		int j = 0;
+		for (; names[i][j]; j++) upper[j] = toupper((unsigned char) names[i][j]);
+		upper[j] = 0;
+		if (!sameFolded(names[i], upper)) numWrong++;
+		numFolded++;
+	}
+	if (!sameFolded("\xC3\x88ve /Dupr\xC3\xA9/", "EVE /DUPRE/") ||
+		!sameFolded("J\xC3\xBCrgen /M\xC3\xBCller/", "JURGEN /MULLER/") ||
+		!sameFolded("\xC3\x86thelred /\xC3\x98stergaard/", "AETHELRED /OSTERGAARD/")) numWrong++;
+	printf("Collation: %d names, %d random pairs, %d folded, %d wrong.\n", numNames, NUMNAMEPAIRS,
+		   numFolded, numWrong);
+	stdfree(persons);
+	stdfree(names);
+	return numWrong == 0;
+}
+
+// exportToString returns the text of a subset export, or null if it fails.
+static String exportToString(Sequence* sequence, GNode* header, int numThreads,
+							 ExportCounts* counts) {
+	char* text = null;
+	size_t length = 0;
+	FILE* fp = open_memstream(&text, &length);
+	bool okay = exportSequenceToGedcom(sequence, header, fp, numThreads, counts);
+	fclose(fp);
+	if (okay) return text;
+	free(text);
+	return null;
+}
+
+// isLineageRecord returns true if a record is a person or a family.
+static bool isLineageRecord(GNode* root) {
+	return recordType(root) == GRPerson || recordType(root) == GRFamily;
+}
+
+// addReferences adds the records other than persons and families that lines refer to to a table
+// of keys, and puts them on a stack.
+static void addReferences(GNode* node, RecordIndex* index, StringTable* table, GNode** stack,
+						  int* top) {
+	for (; node; node = node->sibling) {
+		GNode* root = isKey(node->value) ? getRecord(node->value, index) : null;
+		if (root && !isLineageRecord(root) && !isInStringTable(table, root->key)) {
+			addToStringTable(table, root->key, null);
+			stack[(*top)++] = root;
+		}
+		addReferences(node->child, index, table, stack, top);
+	}
+}
+
+// countPruned returns the number of lines that point to records not in a table of keys, not
+// counting the lines under them.
+static int countPruned(GNode* node, StringTable* table) {
+	int count = 0;
+	for (; node; node = node->sibling) {
+		if (isKey(node->value) && !isInStringTable(table, node->value)) count++;
+		else count += countPruned(node->child, table);
+	}
+	return count;
+}
+
+// slowSubset finds the records and counts of a subset export with a table of keys: the persons of
+// a Sequence, the families of the Database with at least two of them as spouses or children, and
+// the records these and the header refer to, found by searching from each record added.
+static StringTable* slowSubset(Sequence* sequence, Database* database, ExportCounts* counts) {
+	RecordIndex* index = database->recordIndex;
+	StringTable* table = createStringTable(1009);
+	int size = sizeHashTable(index);
+	GNode** records = (GNode**) stdalloc((size + 1)*sizeof(GNode*));
+	int numRecords = 0;
+	Sequence* persons = materializeSequence(sequence);
+	for (int i = 0; i < persons->length; i++) {
+		GNode* person = persons->roots[i];
+		if (isInStringTable(table, person->key)) continue;
+		addToStringTable(table, person->key, null);
+		records[numRecords++] = person;
+	}
+	counts->persons = numRecords;
+	FORHASHTABLE(index, element)
+		GNode* family = (GNode*) element;
+		if (recordType(family) != GRFamily) continue;
+		int numMembers = 0;
+		for (GNode* node = family->child; node; node = node->sibling)
+			if ((eqstr(node->tag, "HUSB") || eqstr(node->tag, "WIFE") || eqstr(node->tag, "CHIL"))
+				&& isKey(node->value) && isInStringTable(table, node->value)) numMembers++;
+		if (numMembers >= 2) records[numRecords++] = family;
+	ENDHASHTABLE
+	counts->families = numRecords - counts->persons;
+	for (int i = counts->persons; i < numRecords; i++)
+		addToStringTable(table, records[i]->key, null);
+	GNode** stack = (GNode**) stdalloc((size + 1)*sizeof(GNode*));
+	int top = 0;
+	for (int i = 0; i < numRecords; i++)
+		addReferences(records[i]->child, index, table, stack, &top);
+	if (database->header) addReferences(database->header->child, index, table, stack, &top);
+	counts->others = 0;
+	while (top > 0) {
+		GNode* other = stack[--top];
+		records[numRecords++] = other;
+		counts->others++;
+		addReferences(other->child, index, table, stack, &top);
+	}
+	counts->pruned = database->header ? countPruned(database->header->child, table) : 0;
+	for (int i = 0; i < numRecords; i++) counts->pruned += countPruned(records[i]->child, table);
+	stdfree(records);
+	stdfree(stack);
+	return table;
+}
+
+// checkExportOrder returns true if the records of an export are persons, then families, then
+// others, each in key order.
+static bool checkExportOrder(String text, Database* database) {
+	int lastGroup = 0;
+	char lastKey[MAXLINELEN + 1] = "";
+	for (String line = text; *line; line = strchr(line, '\n') + 1) { // Every line ends in \n.
+		if (line[0] != '0' || line[1] != ' ' || line[2] != '@') continue;
+		char key[MAXLINELEN + 1];
+		int length = (int) (strchr(line + 3, '@') - line) - 1;
+		memcpy(key, line + 2, length);
+		key[length] = 0;
+		GNode* root = getRecord(key, database->recordIndex);
+		if (!root) return false;
+		RecordType type = recordType(root);
+		int group = type == GRPerson ? 0 : type == GRFamily ? 1 : 2;
+		if (group < lastGroup || (group == lastGroup && *lastKey &&
+								  compareRecordKeys(lastKey, key) >= 0)) return false;
+		lastGroup = group;
+		strcpy(lastKey, key);
+	}
+	return true;
+}
+
+// hasDanglingPointers returns true if a line of a record points to a record not in an index.
+static bool hasDanglingPointers(GNode* node, RecordIndex* index) {
+	for (; node; node = node->sibling) {
+		if (isKey(node->value) && !getRecord(node->value, index)) return true;
+		if (hasDanglingPointers(node->child, index)) return true;
+	}
+	return false;
+}
+
+// checkExportFile reads the text of an export back in and returns true if its records are those
+// in a table of keys and every line that points to a record points to one in the file.
+static bool checkExportFile(String text, StringTable* table, ExportCounts* counts) {
+	String path = "/tmp/deadends-export.ged";
+	FILE* fp = fopen(path, "w");
+	if (!fp) return false;
+	fputs(text, fp);
+	fclose(fp);
+	ErrorLog* errorLog = createErrorLog();
+	RecordIndex* index = getRecordIndexFromFile(path, null, null, null, errorLog);
+	bool passed = index && lengthList(errorLog) == 0;
+	int numRecords = 0;
+	if (index) {
+		FORHASHTABLE(index, element)
+			GNode* root = (GNode*) element;
+			numRecords++;
+			if (!isInStringTable(table, root->key) || hasDanglingPointers(root->child, index))
+				passed = false;
+		ENDHASHTABLE
+		FORHASHTABLE(index, element)
+			freeGNodes((GNode*) element);
+		ENDHASHTABLE
+		deleteRecordIndex(index);
+	}
+	deleteErrorLog(errorLog);
+	return passed && numRecords == counts->persons + counts->families + counts->others;
+}
+
+// testExports checks subset exports of the persons of several Sequences against the records and
+// counts found with tables of keys. An export must be the same for one thread and for many, in
+// the right order, and read back in with no pointers to records it doesn't have.
+static bool testExports(Database* database) {
+	srandom(8);
+	RecordIndex* index = database->recordIndex;
+	int numPersons;
+	GNode** persons = allPersons(index, &numPersons);
+	int numWrong = 0, numRecords = 0, numOthers = 0, numPruned = 0;
+	for (int trial = 0; trial < NUMEXPORTS; trial++) {
+		Sequence* sequence = createSequence(index);
+		if (trial == 1) appendRootToSequence(sequence, persons[random() % numPersons], null);
+		else if (trial == 2 || trial == 3) {
+			Sequence* start = createSequence(index);
+			appendToSequence(start, "@I1@", null);
+			Sequence* found = trial == 2 ? ancestorSequence(start, database, true, 0)
+				: descendentSequence(start, database, true, 0);
+			appendSequenceToSequence(sequence, found);
+			deleteSequence(start);
+			deleteSequence(found);
+		} else if (trial == 4) {
+			for (int i = 0; i < numPersons; i++)
+				if (random() % 10 < 3) appendRootToSequence(sequence, persons[i], null);
+		}
+		ExportCounts one, many, expected;
+		String oneText = exportToString(sequence, database->header, 1, &one);
+		String manyText = exportToString(sequence, database->header, 8, &many);
+		StringTable* table = slowSubset(sequence, database, &expected);
+		if (!oneText || !manyText || strcmp(oneText, manyText) ||
+			memcmp(&one, &many, sizeof(ExportCounts)) ||
+			memcmp(&one, &expected, sizeof(ExportCounts)) || !checkExportOrder(oneText, database) ||
+			!checkExportFile(oneText, table, &expected)) {
+			printf("Export %d of %d persons is wrong.\n", trial, lengthSequence(sequence));
+			numWrong++;
+		}
+		numRecords += expected.persons + expected.families + expected.others;
+		numOthers += expected.others;
+		numPruned += expected.pruned;
+		free(oneText);
+		free(manyText);
+		deleteHashTable(table);
+		deleteSequence(sequence);
+	}
+	printf("Exports: %d subsets, %d records, %d others, %d lines pruned, %d wrong.\n", NUMEXPORTS,
+		   numRecords, numOthers, numPruned, numWrong);
+	stdfree(persons);
+	return numWrong == 0;
+}
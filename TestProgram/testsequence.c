@@ -3,15 +3,16 @@
 // testsequence.c has code to test the Sequence data type.
 //
 // Created by Thomas Wetmore on 2 May 2024.
-// Last changed on 16 May 2024.
+// Last changed on 18 October 2026.
 
 #include "sequence.h"
 #include "utils.h"
 
 static void checkTest(String, int, int);
-static Sequence* tomsAncestors(RecordIndex*);
-static Sequence* lusAncestors(RecordIndex*);
-static Sequence* tomAndLusAncestorsClosed(RecordIndex*);
+static bool sameKeys(Sequence*, Sequence*);
+static Sequence* tomsAncestors(Database*);
+static Sequence* lusAncestors(Database*);
+static Sequence* tomAndLusAncestorsClosed(Database*);
 
 // testSequence is the starting function to test the Sequence type.
 void testSequence(Database* database, int testNumber) {
@@ -77,7 +78,7 @@ void testSequence(Database* database, int testNumber) {
 
 	// Test ancestorSequence.
 	printf("Testing ancestorSequence\n");
-	Sequence* ancestors = tomsAncestors(index);
+	Sequence* ancestors = tomsAncestors(database);
 	showSequence(ancestors, "Tom's Ancestors");
 	printf("Sort ancestors by key\n");
 	keySortSequence(ancestors);
@@ -88,15 +89,32 @@ void testSequence(Database* database, int testNumber) {
 	// Test closed form of ancestorSequence.
 	printf("Testing ancestorSequence with close set to true\n");
 	emptySequence(ancestors);
-	ancestors = tomAndLusAncestorsClosed(index);
+	ancestors = tomAndLusAncestorsClosed(database);
 	showSequence(ancestors, "tom and lu's ancestors closed");
 
+	// Test the generation limit of ancestorSequence.
+	printf("Testing ancestorSequence with a generation limit\n");
+	emptySequence(sequence);
+	appendToSequence(sequence, "@I1@", null);
+	Sequence* firstParents = parentSequence(sequence);
+	Sequence* oneGeneration = ancestorSequence(sequence, database, false, 1);
+	checkTest("One generation of ancestors are the parents", 1,
+			  sameKeys(firstParents, oneGeneration));
+	deleteSequence(firstParents);
+	deleteSequence(oneGeneration);
+	Sequence* firstChildren = childSequence(sequence);
+	oneGeneration = descendentSequence(sequence, database, false, 1);
+	checkTest("One generation of descendents are the children", 1,
+			  sameKeys(firstChildren, oneGeneration));
+	deleteSequence(firstChildren);
+	deleteSequence(oneGeneration);
+
 	// Test uniqueSequence.
 	printf("Setting up to test uniqueSequence\n");
 	emptySequence(sequence);
 	emptySequence(ancestors);
 	appendToSequence(sequence, "@I2@", null);
-	ancestors = ancestorSequence(sequence, false);
+	ancestors = ancestorSequence(sequence, database, false, 0);
 	printf("THIS SHOULD BE LU'S ANCESTORS\n");
 	showSequence(ancestors, "Lu's ancestors");
 	emptySequence(copied);
@@ -167,7 +185,7 @@ void testSequence(Database* database, int testNumber) {
 	showSequence(spouses, "Spouses of tomwets");
 	// Test descendentSequence.
 	printf("Testing descendentSequence\n");
-	Sequence* desc = descendentSequence(tomwets, false);
+	Sequence* desc = descendentSequence(tomwets, database, false, 0);
 	showSequence(desc, "Descendents of tomwets");
 	// Test siblingSequence
 	printf("Testing siblingSequence\n");
@@ -182,8 +200,8 @@ void testSequence(Database* database, int testNumber) {
 	}
 	// Test unionSequence.
 	printf("Testing unionSequence\n");
-	Sequence* toms = tomsAncestors(index);
-	Sequence* lus = lusAncestors(index);
+	Sequence* toms = tomsAncestors(database);
+	Sequence* lus = lusAncestors(database);
 	Sequence* unionseq = unionSequence(toms, lus);
 	showSequence(unionseq, "Union of Tom and Lu's ancestors");
 	// Test intersectSequence.
@@ -204,43 +222,62 @@ void testSequence(Database* database, int testNumber) {
 //	void sequenceToGedcom(Sequence*, FILE*);
 }
 
-static Sequence* tomsAncestors(RecordIndex* index) {
-	Sequence* s = createSequence(index);
+static Sequence* tomsAncestors(Database* database) {
+	Sequence* s = createSequence(database->recordIndex);
 	appendToSequence(s, "@I1@", null);
-	Sequence* a = ancestorSequence(s, false);
+	Sequence* a = ancestorSequence(s, database, false, 0);
 	deleteSequence(s);
 	return a;
 }
-static Sequence* tomAndLusAncestorsClosed(RecordIndex* index) {
-	Sequence* s = createSequence(index);
+static Sequence* tomAndLusAncestorsClosed(Database* database) {
+	Sequence* s = createSequence(database->recordIndex);
 	appendToSequence(s, "@I1@", null);
 	appendToSequence(s, "@I2@", null);
-	Sequence* a = ancestorSequence(s, true);
+	Sequence* a = ancestorSequence(s, database, true, 0);
 	deleteSequence(s);
 	return a;
 }
-static Sequence* lusAncestors(RecordIndex* index) {
-	Sequence* s = createSequence(index);
+static Sequence* lusAncestors(Database* database) {
+	Sequence* s = createSequence(database->recordIndex);
 	appendToSequence(s, "@I2@", null);
-	Sequence* a = ancestorSequence(s, false);
+	Sequence* a = ancestorSequence(s, database, false, 0);
 	deleteSequence(s);
 	return a;
 }
-static Sequence* tomsDescendents(RecordIndex* index) {
-	Sequence* s = createSequence(index);
+static Sequence* tomsDescendents(Database* database) {
+	Sequence* s = createSequence(database->recordIndex);
 	appendToSequence(s, "@I1@", null);
-	Sequence* d = descendentSequence(s, false);
+	Sequence* d = descendentSequence(s, database, false, 0);
 	deleteSequence(s);
 	return d;
 }
-static Sequence* lusDescendents(RecordIndex* index) {
-	Sequence* s = createSequence(index);
+static Sequence* lusDescendents(Database* database) {
+	Sequence* s = createSequence(database->recordIndex);
 	appendToSequence(s, "@I2@", null);
-	Sequence* d = descendentSequence(s, false);
+	Sequence* d = descendentSequence(s, database, false, 0);
 	deleteSequence(s);
 	return d;
 }
 
+// sameKeys returns true if two Sequences hold the same record keys.
+static bool sameKeys(Sequence* one, Sequence* two) {
+	if (lengthSequence(one) != lengthSequence(two)) return false;
+	Sequence* first = copySequence(one);
+	Sequence* second = copySequence(two);
+	keySortSequence(first);
+	keySortSequence(second);
+	bool same = true;
+	for (int i = 0; same && i < lengthSequence(first); i++) {
+		String key1, key2, name;
+		elementFromSequence(first, i, &key1, &name);
+		elementFromSequence(second, i, &key2, &name);
+		same = eqstr(key1, key2);
+	}
+	deleteSequence(first);
+	deleteSequence(second);
+	return same;
+}
+
 static void checkTest(String name, int should, int was) {
 	printf("TEST: %s: ", name);
 	if (should == was) printf("PASSED\n");
@@ -0,0 +1,114 @@
+// testthreads.c
+// TestProgram
+//
+// testthreads.c runs name lookups and searches and lineage walks over a Database from several
+// threads and checks that they get the same results as one thread. Build the libraries and this
+// program with -fsanitize=thread to have ThreadSanitizer check for data races.
+//
+// Created by Thomas Wetmore on 18 October 2026.
+// Last changed on 18 October 2026.
+
+#include <pthread.h>
+#include "database.h"
+#include "name.h"
+#include "date.h"
+#include "lineage.h"
+#include "gedcom.h"
+#include "utils.h"
+
+#define NUMTHREADS 8
+#define MAXDEPTH 8
+#define SEARCHSTEP 50 // Name searches are done for every SEARCHSTEP-th person.
+
+// ThreadTest is the work and results of one thread.
+typedef struct ThreadTest {
+	Database* database;
+	int first, step; // The thread handles persons first, first + step, ...
+	int names, found, searched, events, ancestors; // Results.
+} ThreadTest;
+
+// countAncestors counts the ancestors of a person up to a depth.
+static int countAncestors(GNode* person, RecordIndex* index, int depth) {
+	if (!person || depth == 0) return 0;
+	int count = 0;
+	GNode* father = personToFather(person, index);
+	GNode* mother = personToMother(person, index);
+	if (father) count += 1 + countAncestors(father, index, depth - 1);
+	if (mother) count += 1 + countAncestors(mother, index, depth - 1);
+	return count;
+}
+
+// runThreadTest looks up and searches for the names of persons, formats their names and births,
+// and walks their ancestors.
+static void* runThreadTest(void* arg) {
+	ThreadTest* test = (ThreadTest*) arg;
+	Database* database = test->database;
+	RootList* persons = database->personRoots;
+	char name[MAXNAMELEN+1], event[MAXLINELEN+1];
+	PackedDate date;
+	Block keys;
+	initBlock(&keys);
+	for (int i = test->first; i < lengthList(persons); i += test->step) {
+		GNode* person = getListElement(persons, i);
+		GNode* node = NAME(person);
+		if (node && node->value && strchr(node->value, '/')) {
+			test->names++;
+			keys.length = 0;
+			personKeysFromNameInBlock(node->value, database->recordIndex, database->nameIndex, &keys);
+			for (int j = 0; j < keys.length; j++) {
+				if (eqstr(keys.elements[j], person->key)) {
+					test->found++;
+					break;
+				}
+			}
+			personToNameInBuffer(person, 30, name);
+			if (i % SEARCHSTEP == 0) {
+				List* results = searchNameSearchIndex(database->nameSearchIndex, node->value, 0);
+				FORLIST(results, element)
+					if (eqstr(((NameSearchResult*) element)->recordKey, person->key)) {
+						test->searched++;
+						break;
+					}
+				ENDLIST
+				deleteList(results);
+			}
+		}
+		if (eventToStringInBuffer(BIRT(person), true, event)) test->events++;
+		node = BIRT(person) ? DATE(BIRT(person)) : null;
+		if (node && parseDate(node->value, &date)) test->events++;
+		test->ancestors += countAncestors(person, database->recordIndex, MAXDEPTH);
+	}
+	deleteBlock(&keys, null);
+	return null;
+}
+
+// testThreads runs the thread test.
+void testThreads(Database* database, int testNumber) {
+	printf("%d: START OF TEST THREADS: %2.3f\n", testNumber, getMseconds());
+	prepareDatabaseForReaders(database);
+	ThreadTest single = {database, 0, 1, 0, 0, 0, 0, 0};
+	runThreadTest(&single);
+	ThreadTest tests[NUMTHREADS];
+	pthread_t threads[NUMTHREADS];
+	for (int i = 0; i < NUMTHREADS; i++) {
+		tests[i] = (ThreadTest) {database, i, NUMTHREADS, 0, 0, 0, 0, 0};
+		pthread_create(&threads[i], null, runThreadTest, &tests[i]);
+	}
+	ThreadTest total = {database, 0, 0, 0, 0, 0, 0, 0};
+	for (int i = 0; i < NUMTHREADS; i++) {
+		pthread_join(threads[i], null);
+		total.names += tests[i].names;
+		total.found += tests[i].found;
+		total.searched += tests[i].searched;
+		total.events += tests[i].events;
+		total.ancestors += tests[i].ancestors;
+	}
+	printf("One thread: %d names, %d found, %d searched, %d events, %d ancestors.\n", single.names,
+		   single.found, single.searched, single.events, single.ancestors);
+	printf("%d threads: %d names, %d found, %d searched, %d events, %d ancestors.\n", NUMTHREADS,
+		   total.names, total.found, total.searched, total.events, total.ancestors);
+	bool same = single.names == total.names && single.found == total.found &&
+		single.searched == total.searched && single.events == total.events &&
+		single.ancestors == total.ancestors;
+	printf("%d: END OF TEST THREADS: %s %2.3f\n", testNumber, same ? "PASSED" : "FAILED", getMseconds());
+}
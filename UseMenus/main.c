@@ -3,9 +3,10 @@
 // main.c is the main program of the UseMenus test program.
 //
 // Created by Thomas Wetmore on 31 July 2024.
-// Last changed on 13 December 2024.
+// Last changed on 18 October 2026.
 
 #include <stdio.h>
+#include <time.h>
 #include "menu.h"
 #include "list.h"
 #include "database.h"
@@ -81,6 +82,28 @@ int main(int argc, char** argv) {
 	printf("%d %s\n", n, element->name);
 	ENDSEQUENCE
 
+	// TRY IT WITH THE NAME SEARCH INDEX; EACH TYPEAHEAD PREFIX IS TIMED OVER MANY SEARCHES.
+	String prefixes[] = {"t", "th", "thom", "thom w", "thom wetm", "thomas /wetmore/", "tomas wetmoor", null};
+	for (int i = 0; prefixes[i]; i++) {
+		int numSearches = 100;
+		clock_t start = clock();
+		for (int j = 0; j < numSearches; j++)
+			deleteList(searchNameSearchIndex(database->nameSearchIndex, prefixes[i], 10));
+		double usecs = 1000000.0*(clock() - start)/CLOCKS_PER_SEC/numSearches;
+		List* results = searchNameSearchIndex(database->nameSearchIndex, prefixes[i], 10);
+		printf("\"%s\": %d results in %.1f usecs:", prefixes[i], lengthList(results), usecs);
+		FORLIST(results, element)
+			printf(" %s", ((NameSearchResult*) element)->recordKey);
+		ENDLIST
+		printf("\n");
+		deleteList(results);
+	}
+	GNode* person = null;
+	while (askForPerson(database, askQuit, &person) == askOkay && person) {
+		GNode* name = NAME(person);
+		printf("%s: %s\n", person->key, name && name->value ? nameString(name->value) : "no name");
+	}
+
 	int answer;
 	//AskReturn rcode = 0;
 